@@ -0,0 +1,87 @@
+// A contiguous block of memory that's only ever added to or emptied all at once
+
+#include "arena.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+// The least committed at once, so small arenas don't commit a page at a time
+#define MIN_COMMIT (64 * 1024)
+
+// Both operating systems commit in whole pages of at least this size
+#define PAGE_SIZE 4096
+
+bool initialiseArena(Arena *arena, size_t reserveBytes)
+{
+    arena->used = 0;
+    arena->committed = 0;
+    arena->reserved = (reserveBytes + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+
+#ifdef _WIN32
+    arena->base = (unsigned char *) VirtualAlloc(NULL, arena->reserved, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void *base = mmap(NULL, arena->reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    arena->base = base != MAP_FAILED ? (unsigned char *) base : NULL;
+#endif
+
+    return arena->base != NULL;
+}
+
+bool arenaCommit(Arena *arena, size_t bytes)
+{
+    if (bytes <= arena->committed) return true;
+    if (bytes > arena->reserved) return false;
+
+    // Double what's committed so the number of commits only grows with the log of the size
+    size_t target = arena->committed * 2;
+    if (target < MIN_COMMIT) target = MIN_COMMIT;
+    if (target < bytes) target = bytes;
+    target = (target + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    if (target > arena->reserved) target = arena->reserved;
+
+    unsigned char *start = arena->base + arena->committed;
+    size_t size = target - arena->committed;
+
+#ifdef _WIN32
+    if (VirtualAlloc(start, size, MEM_COMMIT, PAGE_READWRITE) == NULL) return false;
+#else
+    if (mprotect(start, size, PROT_READ | PROT_WRITE) != 0) return false;
+#endif
+
+    arena->committed = target;
+    return true;
+}
+
+void *arenaPush(Arena *arena, size_t bytes)
+{
+    if (bytes > arena->reserved - arena->used) return NULL;
+    if (!arenaCommit(arena, arena->used + bytes)) return NULL;
+
+    void *start = arena->base + arena->used;
+    arena->used += bytes;
+    return start;
+}
+
+void resetArena(Arena *arena)
+{
+    arena->used = 0;
+}
+
+void freeArena(Arena *arena)
+{
+    if (arena->base == NULL) return;
+
+#ifdef _WIN32
+    VirtualFree(arena->base, 0, MEM_RELEASE);
+#else
+    munmap(arena->base, arena->reserved);
+#endif
+
+    arena->base = NULL;
+    arena->used = 0;
+    arena->committed = 0;
+    arena->reserved = 0;
+}
@@ -0,0 +1,46 @@
+// A contiguous block of memory that's only ever added to or emptied all at once
+//
+// A large range of address space is reserved up front but only backed by memory as it's used,
+// so pushing onto the arena never moves what's already in it and never copies anything. The
+// committed part grows by doubling, so pushing is amortised O(1) no matter how big it gets.
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+    unsigned char *base;
+    size_t used;            // Bytes handed out by arenaPush
+    size_t committed;       // Bytes backed by memory
+    size_t reserved;        // Bytes of address space the arena can grow into
+} Arena;
+
+/// Reserve address space for an arena without using any memory yet
+/// @param arena The arena to initialise
+/// @param reserveBytes The most the arena can ever hold
+/// @return False if the address space couldn't be reserved
+bool initialiseArena(Arena *arena, size_t reserveBytes);
+
+/// Take bytes from the end of the arena, committing more memory if it's needed
+/// @param arena The arena to push onto
+/// @param bytes The number of bytes to take
+/// @return The start of the bytes, or NULL if the arena is full or out of memory
+void *arenaPush(Arena *arena, size_t bytes);
+
+/// Make sure at least a number of bytes are committed so pushing up to them can't fail
+/// @param arena The arena to grow
+/// @param bytes The number of bytes that need to be committed
+/// @return False if they can't be
+bool arenaCommit(Arena *arena, size_t bytes);
+
+/// Hand out everything in the arena again, keeping its memory committed
+/// @param arena The arena to empty
+void resetArena(Arena *arena);
+
+/// Release the arena's memory and address space
+/// @param arena The arena to free
+void freeArena(Arena *arena);
+
+#endif
@@ -10,6 +10,12 @@
 ********************************************************************************************/
 
 #include "raylib.h"
+#include "raymath.h"
+#include "ring_store.h"
+#include "ring_mesh.h"
+#include "ring_index.h"
+#include "recaman.h"
+#include "profiler_overlay.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -17,72 +23,165 @@
 #define CAMERA_CONTROLS true
 #define __USE_MINGW_ANSI_STDIO 1
 
+// Only draw the rings in view, each with only as many segments as it needs at the camera's zoom
+#define CULL_RINGS true
+
+// Tessellate each ring once when it's added and draw them all from one GPU buffer, rather than
+// calling DrawRing on every ring every frame, used when the rings aren't culled
+#define CACHED_RINGS true
+
+// The number of terms of the sequence added each frame, and how far apart consecutive values are
+#define TERMS_PER_FRAME 1
+#define TERM_SPACING 10.0f
+
+// The fewest vertices a GPU buffer is made with, it doubles whenever it fills up
+#define MIN_GPU_VERTICES 65536
+
+// A GPU copy of a ring mesh, its buffers have room for capacity vertices and the first vertices
+// of them have been uploaded
 typedef struct {
-    Vector2 centre;
-    float innerRadius;
-    float outerRadius;
-    float startAngle;
-    float endAngle;
-    int segments;
-    Color colour;
-} Ring;
+    Mesh mesh;
+    size_t capacity;
+    size_t vertices;
+} GpuRingMesh;
+
+RingStore rings;
+RingIndex ringIndex;
 
-typedef struct node {
-    Ring ring;
-    struct node *next;
-} node_t;
+// Every ring tessellated once, for when they aren't culled
+RingMesh ringMesh;
+size_t tessellatedRings = 0;
+GpuRingMesh allRingsGpu = { 0 };
 
+// The rings in view tessellated for the camera's zoom, rebuilt every frame
+RingMesh visibleMesh;
+GpuRingMesh visibleRingsGpu = { 0 };
+size_t visibleRings = 0;
 
-node_t *head = NULL;
+Material ringMaterial;
 
-void addRing(Ring ring)
+// Index or tessellate the rings added to the store since the last call
+void addNewRings()
 {
-    //printf("Adding a ring\n");
-    
-    node_t *node = (node_t *)malloc(sizeof(node_t));
-    node_t *current = head;
+    if (CULL_RINGS)
+    {
+        while (ringIndex.count < rings.count)
+        {
+            if (!indexNextRing(&ringIndex, &rings))
+            {
+                printf("Couldn't index ring %zu\n", ringIndex.count);
+                return;
+            }
+        }
+    }
+    else if (CACHED_RINGS)
+    {
+        for (; tessellatedRings < rings.count; tessellatedRings++)
+        {
+            if (!appendRingMesh(&ringMesh, &rings.rings[tessellatedRings]))
+            {
+                printf("Couldn't tessellate ring %zu\n", tessellatedRings);
+                return;
+            }
+        }
+    }
+}
+
+// The mesh's vertex arrays belong to a RingMesh, so they're detached before raylib frees the rest
+void unloadGpuMesh(GpuRingMesh *gpu)
+{
+    if (gpu->capacity == 0) return;
+
+    gpu->mesh.vertices = NULL;
+    gpu->mesh.colors = NULL;
+    UnloadMesh(gpu->mesh);
+    *gpu = (GpuRingMesh){ 0 };
+}
 
-    node->next = NULL;
-    node->ring = ring;
+// Upload the vertices of a ring mesh from a vertex on, the ones before it are already uploaded
+void uploadRingMesh(GpuRingMesh *gpu, RingMesh *mesh, size_t from)
+{
+    if (mesh->vertexCount > gpu->capacity)
+    {
+        // The GPU buffers can't grow so they're replaced with ones twice the size, which are
+        // filled from the committed memory past the end of the mesh so it's only uploaded once
+        size_t capacity = gpu->capacity * 2;
+        if (capacity < MIN_GPU_VERTICES) capacity = MIN_GPU_VERTICES;
+        if (capacity < mesh->vertexCount) capacity = mesh->vertexCount;
+        if (capacity > mesh->maxVertices) capacity = mesh->maxVertices;
+        if (!reserveRingVertices(mesh, capacity)) return;
 
-    if (head == NULL) 
+        unloadGpuMesh(gpu);
+        gpu->mesh.vertices = ringMeshPositions(mesh);
+        gpu->mesh.colors = ringMeshColours(mesh);
+        gpu->mesh.vertexCount = (int) capacity;
+        UploadMesh(&gpu->mesh, true);
+        gpu->capacity = capacity;
+    }
+    else if (mesh->vertexCount > from)
     {
-        //printf("Making head node in add function\n");
-        head = node;
-        return;
+        size_t added = mesh->vertexCount - from;
+        UpdateMeshBuffer(gpu->mesh, 0, ringMeshPositions(mesh) + from * 3, (int) (added * 3 * sizeof(float)),
+            (int) (from * 3 * sizeof(float)));
+        UpdateMeshBuffer(gpu->mesh, 3, ringMeshColours(mesh) + from * 4, (int) (added * 4), (int) (from * 4));
     }
 
-    while (current->next != NULL) current = current->next;
+    // Only the vertices in the mesh are drawn, not the rest of the buffers
+    gpu->vertices = mesh->vertexCount;
+    gpu->mesh.vertexCount = (int) gpu->vertices;
+    gpu->mesh.triangleCount = (int) (gpu->vertices / 3);
+}
+
+void addVisibleRing(const Ring *ring, void *context)
+{
+    float zoom = *(const float *) context;
+    if (!appendRingMeshLod(&visibleMesh, ring, zoom)) printf("Couldn't tessellate a visible ring\n");
+}
+
+// Tessellate the rings a camera can see into visibleMesh and upload it
+void updateVisibleRings(Camera2D camera)
+{
+    Vector2 topLeft = GetScreenToWorld2D((Vector2){ 0, 0 }, camera);
+    Vector2 bottomRight = GetScreenToWorld2D((Vector2){ GetScreenWidth(), GetScreenHeight() }, camera);
 
-    current->next = node;
+    resetRingMesh(&visibleMesh);
+    visibleRings = queryRingIndex(&ringIndex, &rings, fminf(topLeft.x, bottomRight.x), fminf(topLeft.y, bottomRight.y),
+        fmaxf(topLeft.x, bottomRight.x), fmaxf(topLeft.y, bottomRight.y), addVisibleRing, &camera.zoom);
+    uploadRingMesh(&visibleRingsGpu, &visibleMesh, 0);
 }
 
-void drawRingFromStruct(Ring ring)
+void drawRingFromStruct(const Ring *ring)
 {
     DrawRing(
-        ring.centre,
-        ring.innerRadius,
-        ring.outerRadius,
-        ring.startAngle,
-        ring.endAngle,
-        ring.segments,
-        ring.colour
+        (Vector2){ ring->centreX, ring->centreY },
+        ring->innerRadius,
+        ring->outerRadius,
+        ring->startAngle,
+        ring->endAngle,
+        ring->segments,
+        (Color){ ring->colour[0], ring->colour[1], ring->colour[2], ring->colour[3] }
     );
     
 }
 
 void drawRingList()
 {
-    //printf("Started drawing list\n");
-    node_t *current = head;
-    int numRingsDrawn = 0;
+    // The rings being drawn are all in one buffer so they're drawn with a single call
+    if (CULL_RINGS)
+    {
+        if (visibleRingsGpu.vertices > 0) DrawMesh(visibleRingsGpu.mesh, ringMaterial, MatrixIdentity());
+        return;
+    }
+
+    if (CACHED_RINGS)
+    {
+        if (allRingsGpu.vertices > 0) DrawMesh(allRingsGpu.mesh, ringMaterial, MatrixIdentity());
+        return;
+    }
 
-    while (current != NULL) 
+    for (size_t i = 0; i < rings.count; i++)
     {
-        //printf("Drawing a ring from the list\n");
-        drawRingFromStruct(current->ring);
-        current = current->next;
-        numRingsDrawn++;
+        drawRingFromStruct(&rings.rings[i]);
     }
 }
 
@@ -95,50 +194,82 @@ int main(void)
 
     InitWindow(screenWidth, screenHeight, "Reaction Diffusion by Justin Johnson");
 
-    // Setup the camera
+    // Setup the camera, looking at the x axis the arcs are drawn along
     Camera2D camera = { 0 };
     camera.target = (Vector2){ 0, 0 };
-    camera.offset = (Vector2){ 0.0f, 0.0f };
+    camera.offset = (Vector2){ 0.0f, screenHeight / 2 };
     camera.rotation = 0.0f;
     camera.zoom = 1.0f;
 
     SetTargetFPS(30);
+
+    // The rings are kept in one growing array, only the address space for them is reserved here
+    Recaman sequence;
+    if (!initialiseRingStore(&rings, 0) || !initialiseRingIndex(&ringIndex, 0, 0) || !initialiseRingMesh(&ringMesh, 0)
+        || !initialiseRingMesh(&visibleMesh, 0) || !initialiseRecaman(&sequence, 0))
+    {
+        printf("Couldn't reserve memory for the rings\n");
+        CloseWindow();
+        return 1;
+    }
+
+    ringMaterial = LoadMaterialDefault();
     //-----------------------------------------------------------------------------------
 
-    int count = 1;
-    int increment = 25;
-    
     // Main sim loop
     while (!WindowShouldClose())        // Detect window close button or ESC key
     {
         // Update
         //-------------------------------------------------------------------------------
 
-        double radius =  ((count + increment) - count) / 2;
-        double centreX = count + increment / 2;
-        Ring ring = {(Vector2){centreX, screenHeight / 2}, radius, radius + 1, 90, 270, 100, BLACK};
-        addRing(ring);
+        // Each term of the Recamán sequence is an arc from the last one
+        PROFILE_START(PROFILE_STEP);
+        appendRecamanRings(&sequence, &rings, TERMS_PER_FRAME, TERM_SPACING, 1.0f, 0.0f);
+        addNewRings();
+        PROFILE_STOP(PROFILE_STEP);
+
+        // Zoom out to keep every term so far on screen
+        camera.zoom = fminf(1.0f, 0.95f * screenWidth / (TERM_SPACING * (float) (sequence.largest + 1)));
+        camera.offset = (Vector2){ 0.025f * screenWidth, screenHeight / 2 };
+
+        // Tessellating and uploading the rings to draw is this program's equivalent of colouring
+        PROFILE_START(PROFILE_COLOUR);
+        if (CULL_RINGS) updateVisibleRings(camera);
+        else if (CACHED_RINGS) uploadRingMesh(&allRingsGpu, &ringMesh, allRingsGpu.vertices);
+        PROFILE_STOP(PROFILE_COLOUR);
 
         // Draw
         //-------------------------------------------------------------------------------
+        PROFILE_START(PROFILE_DRAW);
         BeginDrawing();
             ClearBackground(RAYWHITE);
             BeginMode2D(camera);
                 drawRingList();
-                count += increment;
-                //camera.offset = (Vector2){GetScreenWidth() - ((ring.outerRadius * 2) * ((count + increment) / increment)), 0.0f};
-                camera.offset = (Vector2){screenWidth - (increment * ((count + increment) / increment)), 0.0f};                
-                //printf("Camera offset is %f %f\n", camera.offset.x, camera.offset.y);
-                //camera.zoom = screenWidth / count;
             EndMode2D();
             DrawFPS(0, 0);
-            char *text = TextFormat("Number of rings drawn %d", (count + increment) / increment);
+            const char *text = TextFormat("Number of rings drawn %zu", rings.count);
             DrawText(text, screenWidth - 280, 0, 20, BLACK);
+            if (CULL_RINGS) DrawText(TextFormat("Rings in view %zu", visibleRings), screenWidth - 280, 20, 20, BLACK);
+            PROFILE_OVERLAY(0, 20, 10, DARKGRAY);
+            PROFILE_STOP(PROFILE_DRAW);
+
+            // Presenting includes waiting for the target frame rate
+            PROFILE_START(PROFILE_PRESENT);
         EndDrawing();
+        PROFILE_STOP(PROFILE_PRESENT);
         //-------------------------------------------------------------------------------
     }
     // De-Initialization
     //-----------------------------------------------------------------------------------
+    PROFILE_DUMP("circle_test_profile");
+    unloadGpuMesh(&allRingsGpu);
+    unloadGpuMesh(&visibleRingsGpu);
+    UnloadMaterial(ringMaterial);
+    freeRingMesh(&visibleMesh);
+    freeRingMesh(&ringMesh);
+    freeRingIndex(&ringIndex);
+    freeRingStore(&rings);
+    freeRecaman(&sequence);
     CloseWindow();        // Close window and OpenGL context
     //-----------------------------------------------------------------------------------
 
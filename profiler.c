@@ -0,0 +1,154 @@
+// Times the phases of each frame, stepping, colouring, drawing and presenting, separately
+
+#include "profiler.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+
+typedef struct {
+    float samples[PROFILE_SAMPLES];     // In seconds, the oldest are overwritten once it's full
+    uint64_t written;                   // The number of samples ever recorded, only the writer changes it
+} ProfileRing;
+
+static ProfileRing rings[PROFILE_PHASE_COUNT];
+
+static const char *phaseNames[PROFILE_PHASE_COUNT] = { "step", "colour", "draw", "present" };
+
+double profileNow(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency, now;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    return (double) now.QuadPart / (double) frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+#endif
+}
+
+void recordProfileSample(ProfilePhase phase, double seconds)
+{
+    ProfileRing *ring = &rings[phase];
+    uint64_t written = __atomic_load_n(&ring->written, __ATOMIC_RELAXED);
+
+    // The release makes sure the sample is visible before a reader can see it's been written
+    ring->samples[written & (PROFILE_SAMPLES - 1)] = (float) seconds;
+    __atomic_store_n(&ring->written, written + 1, __ATOMIC_RELEASE);
+}
+
+// Copy out a phase's latest samples oldest first, a sample overwritten while it's being copied
+// just means a slightly newer one is counted instead
+static size_t copySamples(ProfilePhase phase, float *samples)
+{
+    const ProfileRing *ring = &rings[phase];
+    uint64_t written = __atomic_load_n(&ring->written, __ATOMIC_ACQUIRE);
+    size_t count = written < PROFILE_SAMPLES ? (size_t) written : PROFILE_SAMPLES;
+
+    for (size_t s = 0; s < count; s++)
+    {
+        samples[s] = ring->samples[(written - count + s) & (PROFILE_SAMPLES - 1)];
+    }
+
+    return count;
+}
+
+static int compareSamples(const void *a, const void *b)
+{
+    float x = *(const float *) a;
+    float y = *(const float *) b;
+    return (x > y) - (x < y);
+}
+
+// The stats of samples that are already sorted
+static void sortedStats(const float *sorted, size_t count, ProfileStats *stats)
+{
+    *stats = (ProfileStats){ 0 };
+    if (count == 0) return;
+
+    double total = 0.0;
+    for (size_t s = 0; s < count; s++) total += sorted[s];
+
+    stats->count = count;
+    stats->mean = total / count;
+    stats->p50 = sorted[(count - 1) / 2];
+    stats->p99 = sorted[(count - 1) * 99 / 100];
+    stats->max = sorted[count - 1];
+}
+
+void profileStats(ProfilePhase phase, ProfileStats *stats)
+{
+    float samples[PROFILE_SAMPLES];
+    size_t count = copySamples(phase, samples);
+
+    qsort(samples, count, sizeof(float), compareSamples);
+    sortedStats(samples, count, stats);
+}
+
+const char *profilePhaseName(ProfilePhase phase)
+{
+    return phase >= 0 && phase < PROFILE_PHASE_COUNT ? phaseNames[phase] : "unknown";
+}
+
+bool dumpProfile(const char *csvPath, const char *jsonPath)
+{
+    static float samples[PROFILE_PHASE_COUNT][PROFILE_SAMPLES];
+    size_t counts[PROFILE_PHASE_COUNT];
+    bool written = true;
+
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) counts[p] = copySamples((ProfilePhase) p, samples[p]);
+
+    if (csvPath != NULL)
+    {
+        FILE *file = fopen(csvPath, "w");
+        if (file != NULL)
+        {
+            fprintf(file, "phase,sample,milliseconds\n");
+            for (int p = 0; p < PROFILE_PHASE_COUNT; p++)
+            {
+                for (size_t s = 0; s < counts[p]; s++)
+                {
+                    fprintf(file, "%s,%zu,%.4f\n", phaseNames[p], s, samples[p][s] * 1000.0);
+                }
+            }
+            written = fclose(file) == 0 && written;
+        }
+        else
+        {
+            written = false;
+        }
+    }
+
+    if (jsonPath != NULL)
+    {
+        FILE *file = fopen(jsonPath, "w");
+        if (file != NULL)
+        {
+            fprintf(file, "{\n");
+            for (int p = 0; p < PROFILE_PHASE_COUNT; p++)
+            {
+                ProfileStats stats;
+                qsort(samples[p], counts[p], sizeof(float), compareSamples);
+                sortedStats(samples[p], counts[p], &stats);
+
+                fprintf(file, "  \"%s\": { \"samples\": %zu, \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p99_ms\": %.4f, "
+                    "\"max_ms\": %.4f }%s\n", phaseNames[p], stats.count, stats.mean * 1000.0, stats.p50 * 1000.0,
+                    stats.p99 * 1000.0, stats.max * 1000.0, p + 1 < PROFILE_PHASE_COUNT ? "," : "");
+            }
+            fprintf(file, "}\n");
+            written = fclose(file) == 0 && written;
+        }
+        else
+        {
+            written = false;
+        }
+    }
+
+    return written;
+}
@@ -0,0 +1,78 @@
+// Times the phases of each frame, stepping, colouring, drawing and presenting, separately
+//
+// Each phase keeps its latest samples in a ring buffer that one thread writes and any thread can
+// read without locking, so the simulation thread can time its own phases while the render loop
+// shows them. The visualisations are built with PROFILE_PHASES set to 1, otherwise the macros
+// below compile to nothing and the profiler costs nothing at all.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef PROFILE_PHASES
+    #define PROFILE_PHASES 0
+#endif
+
+/// The number of latest samples kept for each phase, a power of two
+#define PROFILE_SAMPLES 4096
+
+/// The phases of a frame, each one has to only ever be timed by one thread at a time
+typedef enum {
+    PROFILE_STEP,           // Stepping the simulation
+    PROFILE_COLOUR,         // Turning the simulation into something to draw
+    PROFILE_DRAW,           // Uploading and submitting draw calls
+    PROFILE_PRESENT,        // Waiting for the frame to be presented
+    PROFILE_PHASE_COUNT
+} ProfilePhase;
+
+typedef struct {
+    size_t count;           // The number of samples the rest are from
+    double mean;            // All in seconds
+    double p50;
+    double p99;
+    double max;
+} ProfileStats;
+
+#if PROFILE_PHASES
+    /// Start timing a phase, the matching PROFILE_STOP has to be in the same scope
+    #define PROFILE_START(phase) double profileStart##phase = profileNow()
+
+    /// Stop timing a phase and record how long it took
+    #define PROFILE_STOP(phase) recordProfileSample(phase, profileNow() - profileStart##phase)
+
+    /// Write every phase's samples and stats out, as name.csv and name.json
+    #define PROFILE_DUMP(name) dumpProfile(name ".csv", name ".json")
+#else
+    #define PROFILE_START(phase) ((void) 0)
+    #define PROFILE_STOP(phase) ((void) 0)
+    #define PROFILE_DUMP(name) ((void) 0)
+#endif
+
+/// Get the time from a monotonic clock
+/// @return The time in seconds since an arbitrary point
+double profileNow(void);
+
+/// Record how long a phase took
+/// @param phase The phase that was timed
+/// @param seconds How long it took
+void recordProfileSample(ProfilePhase phase, double seconds);
+
+/// Work out the percentiles of a phase's latest samples
+/// @param phase The phase to check
+/// @param stats Filled with the stats, all zero if there are no samples yet
+void profileStats(ProfilePhase phase, ProfileStats *stats);
+
+/// Get the name of a phase
+/// @param phase The phase to name
+/// @return Its name, e.g. "step"
+const char *profilePhaseName(ProfilePhase phase);
+
+/// Write the latest samples of every phase to a CSV file and their stats to a JSON file
+/// @param csvPath Where to write the samples, one row per sample, NULL to skip
+/// @param jsonPath Where to write the stats of each phase, NULL to skip
+/// @return False if either file couldn't be written
+bool dumpProfile(const char *csvPath, const char *jsonPath);
+
+#endif
@@ -0,0 +1,29 @@
+// Shows the profiler's p50 and p99 for each phase on screen
+
+#include "profiler_overlay.h"
+
+// How often the percentiles are worked out again, sorting every phase's samples each frame
+// would show up in the draw phase it's measuring
+#define OVERLAY_REFRESH 0.25
+
+void drawProfilerOverlay(int x, int y, int fontSize, Color colour)
+{
+    static ProfileStats stats[PROFILE_PHASE_COUNT];
+    static double refreshed = -OVERLAY_REFRESH;
+
+    double now = profileNow();
+    if (now - refreshed >= OVERLAY_REFRESH)
+    {
+        for (int p = 0; p < PROFILE_PHASE_COUNT; p++) profileStats((ProfilePhase) p, &stats[p]);
+        refreshed = now;
+    }
+
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++)
+    {
+        if (stats[p].count == 0) continue;
+
+        DrawText(TextFormat("%-8s p50 %6.2f ms  p99 %6.2f ms", profilePhaseName((ProfilePhase) p),
+            stats[p].p50 * 1000.0, stats[p].p99 * 1000.0), x, y, fontSize, colour);
+        y += fontSize;
+    }
+}
@@ -0,0 +1,24 @@
+// Shows the profiler's p50 and p99 for each phase on screen
+
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+#include "raylib.h"
+#include "profiler.h"
+
+#if PROFILE_PHASES
+    /// Draw the profiler overlay, or nothing when the profiler is compiled out
+    #define PROFILE_OVERLAY(x, y, fontSize, colour) drawProfilerOverlay(x, y, fontSize, colour)
+#else
+    #define PROFILE_OVERLAY(x, y, fontSize, colour) ((void) 0)
+#endif
+
+/// Draw a line for each phase that's been timed with its p50 and p99 in milliseconds, the
+/// percentiles are only worked out again a few times a second
+/// @param x The left of the overlay
+/// @param y The top of the overlay
+/// @param fontSize The height of each line
+/// @param colour The colour of the text
+void drawProfilerOverlay(int x, int y, int fontSize, Color colour);
+
+#endif
@@ -0,0 +1,150 @@
+// The 2D array layout the original reaction_diffusion_array.c stepped
+// Based on this tutorial http://karlsims.com/rd.html
+
+#include "rd_array.h"
+#include <stdlib.h>
+
+/// calculate the average of all neighbours with weights depending position
+static double convolution(ArrayCell **oldCells, int cellX, int cellY, bool a)
+{
+    double convolution = 0.0;
+
+    if (a)
+    {
+        // Calculate adjacent neightbours at a weight of 0.2
+        convolution += oldCells[cellX][cellY + 1].a * 0.2;
+        convolution += oldCells[cellX + 1][cellY].a * 0.2;
+        convolution += oldCells[cellX - 1][cellY].a * 0.2;
+        convolution += oldCells[cellX][cellY - 1].a * 0.2;
+
+        // Calculate diagonal neightbours at a weight of 0.05
+        convolution += oldCells[cellX + 1][cellY + 1].a * 0.05;
+        convolution += oldCells[cellX + 1][cellY - 1].a * 0.05;
+        convolution += oldCells[cellX - 1][cellY + 1].a * 0.05;
+        convolution += oldCells[cellX - 1][cellY - 1].a * 0.05;
+
+        convolution -= oldCells[cellX][cellY].a;
+    }
+    else
+    {
+        // Calculate adjacent neightbours at a weight of 0.2
+        convolution += oldCells[cellX][cellY + 1].b * 0.2;
+        convolution += oldCells[cellX + 1][cellY].b * 0.2;
+        convolution += oldCells[cellX - 1][cellY].b * 0.2;
+        convolution += oldCells[cellX][cellY - 1].b * 0.2;
+
+        // Calculate diagonal neightbours at a weight of 0.05
+        convolution += oldCells[cellX + 1][cellY + 1].b * 0.05;
+        convolution += oldCells[cellX + 1][cellY - 1].b * 0.05;
+        convolution += oldCells[cellX - 1][cellY + 1].b * 0.05;
+        convolution += oldCells[cellX - 1][cellY - 1].b * 0.05;
+
+        convolution -= oldCells[cellX][cellY].b;
+    }
+
+    return convolution;
+}
+
+/// Free a grid of cells, including one that was only partly allocated
+static void freeCells(ArrayCell **cells, int rows)
+{
+    if (cells == NULL) return;
+    for (int i = 0; i < rows; i++)
+    {
+        free(cells[i]);
+    }
+    free(cells);
+}
+
+/// Malloc a grid of cells all set to a = 1, b = 0, or NULL if there isn't the memory
+static ArrayCell **allocateCells(int rows, int columns)
+{
+    ArrayCell **cells = (ArrayCell **) calloc(rows, sizeof(ArrayCell *));
+    if (cells == NULL) return NULL;
+    for (int i = 0; i < rows; i++)
+    {
+        cells[i] = (ArrayCell *) malloc(columns * sizeof(ArrayCell));
+        if (cells[i] == NULL)
+        {
+            freeCells(cells, rows);
+            return NULL;
+        }
+        for (int j = 0; j < columns; j++)
+        {
+            cells[i][j].a = 1;
+            cells[i][j].b = 0;
+        }
+    }
+
+    return cells;
+}
+
+bool initialiseArrayGrid(ArrayGrid *grid, int rows, int columns, RDSeed seed, int bSquareSize)
+{
+    grid->rows = rows;
+    grid->columns = columns;
+    grid->current = 0;
+    grid->cells[0] = grid->cells[1] = NULL;
+
+    // The seed squares are set without bounds checks, so refuse any that would reach the border
+    if (!rdSeedFits(seed, rows, columns, bSquareSize)) return false;
+
+    grid->cells[0] = allocateCells(rows, columns);
+    grid->cells[1] = allocateCells(rows, columns);
+    if (grid->cells[0] == NULL || grid->cells[1] == NULL)
+    {
+        freeArrayGrid(grid);
+        return false;
+    }
+
+    // Initiase small squares were b = 1
+    RDSeedSquare squares[RD_MAX_SEED_SQUARES];
+    int numSquares = rdSeedSquares(seed, rows, columns, squares);
+
+    for (int s = 0; s < numSquares; s++)
+    {
+        for (int i = -bSquareSize; i < bSquareSize; i++)
+        {
+            for (int j = -bSquareSize; j < bSquareSize; j++)
+            {
+                grid->cells[0][squares[s].x + i][squares[s].y + j].a = 1;
+                grid->cells[0][squares[s].x + i][squares[s].y + j].b = 1;
+            }
+        }
+    }
+
+    return true;
+}
+
+void stepArrayGrid(ArrayGrid *grid, const RDParams *params)
+{
+    ArrayCell **oldCells = grid->cells[grid->current];
+    ArrayCell **newCells = grid->cells[(grid->current + 1) % 2];
+
+    for (int i = 1; i < grid->rows - 1; i++)
+    {
+        for (int j = 1; j < grid->columns - 1; j++)
+        {
+            ArrayCell *oldCell = &oldCells[i][j];
+            ArrayCell *newCell = &newCells[i][j];
+            double a = oldCell->a;
+            double b = oldCell->b;
+            double aConvolution = convolution(oldCells, i, j, true);
+            double bConvolution = convolution(oldCells, i, j, false);
+
+            newCell->a = a + (params->dA * aConvolution - a * (b * b) + params->feedRate * (1 - a));
+            newCell->b = b + (params->dB * bConvolution + a * (b * b) - (params->killRate + params->feedRate) * b);
+        }
+    }
+
+    grid->current = (grid->current + 1) % 2;
+}
+
+void freeArrayGrid(ArrayGrid *grid)
+{
+    for (int g = 0; g < 2; g++)
+    {
+        freeCells(grid->cells[g], grid->rows);
+        grid->cells[g] = NULL;
+    }
+}
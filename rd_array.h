@@ -0,0 +1,41 @@
+// The 2D array layout the original reaction_diffusion_array.c stepped, where two whole grids of cells are
+// swapped between generations
+
+#ifndef RD_ARRAY_H
+#define RD_ARRAY_H
+
+#include "rd_engine.h"
+
+typedef struct {
+    double a;
+    double b;
+} ArrayCell;
+
+typedef struct {
+    ArrayCell **cells[2];   // Two grids used so the new grid can be calculated without changing the old one
+    int rows;
+    int columns;
+    int current;            // Which of the two grids holds the latest generation
+} ArrayGrid;
+
+/// initiailse both grids with cells set to a = 1, b = 0 then set squares of cells in the
+/// starting grid to a = 1, b = 1
+/// @param grid The pair of grids to initialise
+/// @param rows The number of horizontal pixels in the simulation
+/// @param columns The number of vertical pixels in the simulation
+/// @param seed The layout of the starting squares
+/// @param bSquareSize Half the size of the squares of pixels used to start the simulation
+/// @return False if the seed squares don't fit inside the border or there wasn't the memory, leaving
+///         nothing allocated
+bool initialiseArrayGrid(ArrayGrid *grid, int rows, int columns, RDSeed seed, int bSquareSize);
+
+/// Advance every cell not on the border of the grid by one generation
+/// @param grid The pair of grids to step
+/// @param params The feed, kill and diffusion rates to use
+void stepArrayGrid(ArrayGrid *grid, const RDParams *params);
+
+/// Free all the memory used by both grids
+/// @param grid The pair of grids to free
+void freeArrayGrid(ArrayGrid *grid);
+
+#endif
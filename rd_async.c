@@ -0,0 +1,264 @@
+// Runs the simulation on its own thread so it isn't limited by the display's frame rate
+
+#include "rd_async.h"
+#include "rd_colour.h"
+#include "profiler.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+// Set in the shared slot index when it holds a frame the render loop hasn't picked up yet
+#define FRESH_FRAME 4
+
+// How often the rates in RDAsyncStats are recalculated
+#define STATS_WINDOW 0.5
+
+struct RDAsyncSim {
+    RDField *field;
+    const RDParams *params;
+    RDWorkerPool *pool;
+    RDTiles *tiles;
+    RDStepper *stepper;     // Steps and colours instead of the pool and tiles when set
+    int stepsPerPublish;
+
+    // When colouring a view, the pyramid it's coloured from and the view the render loop last set
+    RDMipPyramid *pyramid;
+    RDView view;
+    pthread_mutex_t viewLock;
+
+    pthread_t thread;
+    int running;
+
+    // The triple buffer, the simulation thread owns the back slot, the render loop owns the
+    // front slot and they swap their slot with the shared one to hand frames over
+    RDFrame frames[3];
+    int back;
+    int shared;
+    int front;
+
+    // A snapshot waiting to be queued by the simulation thread
+    RDSnapshotWriter *snapshotWriter;
+    const char *snapshotPath;
+    int snapshotRequested;
+
+    // Records each frame as it's coloured when set, the lock keeps it from being swapped out mid copy
+    RDRecorder *recorder;
+    pthread_mutex_t recorderLock;
+
+    // Totals read by updateAsyncStats
+    long long generation;
+    long long publishes;
+};
+
+static void *simulationMain(void *arg)
+{
+    RDAsyncSim *sim = (RDAsyncSim *) arg;
+    long long generation = 0;
+
+    while (__atomic_load_n(&sim->running, __ATOMIC_ACQUIRE))
+    {
+        PROFILE_START(PROFILE_STEP);
+        if (sim->stepper != NULL) stepStepper(sim->stepper, sim->params, sim->stepsPerPublish);
+        else if (sim->tiles != NULL) stepTiles(sim->pool, sim->tiles, sim->field, sim->params, sim->stepsPerPublish);
+        else stepFieldParallel(sim->pool, sim->field, sim->params, sim->stepsPerPublish);
+        generation += sim->stepsPerPublish;
+        PROFILE_STOP(PROFILE_STEP);
+
+        // The back slot still holds the frame it was last coloured with, so with tiles only the
+        // ones written since then need colouring again. A view is small enough to colour whole.
+        PROFILE_START(PROFILE_COLOUR);
+        RDFrame *frame = &sim->frames[sim->back];
+        const RDPalette *palette = colourPalette();
+        if (sim->pyramid != NULL)
+        {
+            pthread_mutex_lock(&sim->viewLock);
+            frame->view = sim->view;
+            pthread_mutex_unlock(&sim->viewLock);
+
+            // A stepper copies its simulation back into the field as it colours, so snapshots
+            // below see the generation just stepped
+            if (sim->stepper != NULL) colouriseStepper(sim->stepper, sim->pyramid, &frame->view, frame->pixels);
+            else
+            {
+                updateMipPyramid(sim->pool, sim->pyramid, sim->field, sim->tiles);
+                colourView(sim->field, sim->pyramid, &frame->view, frame->pixels);
+            }
+        }
+        else if (sim->tiles != NULL)
+        {
+            // Every tile is coloured again after the palette changes, not just the ones written
+            long long since = frame->palette == palette ? frame->generation : -1;
+            colourChangedTiles(sim->tiles, sim->field, frame->pixels, since);
+        }
+        else colourField(sim->field, frame->pixels);
+        PROFILE_STOP(PROFILE_COLOUR);
+        frame->palette = palette;
+        frame->generation = generation;
+
+        // Recording only copies the frame into a free slot, or drops it if the disk is behind
+        pthread_mutex_lock(&sim->recorderLock);
+        if (sim->recorder != NULL) recordPixels(sim->recorder, frame->pixels, generation);
+        pthread_mutex_unlock(&sim->recorderLock);
+
+        frame->publishTime = rdGetTime();
+
+        // Hand the finished frame over and take back whichever slot was shared, the release
+        // makes sure the pixels are visible before the render loop can see the new index
+        sim->back = __atomic_exchange_n(&sim->shared, sim->back | FRESH_FRAME, __ATOMIC_ACQ_REL) & ~FRESH_FRAME;
+
+        __atomic_store_n(&sim->generation, generation, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&sim->publishes, 1, __ATOMIC_RELAXED);
+
+        // Only the copy into the writer's buffer happens here, the file is written on its thread
+        if (__atomic_load_n(&sim->snapshotRequested, __ATOMIC_ACQUIRE)
+            && queueSnapshot(sim->snapshotWriter, sim->snapshotPath, sim->field, sim->params))
+        {
+            __atomic_store_n(&sim->snapshotRequested, 0, __ATOMIC_RELAXED);
+        }
+    }
+
+    return NULL;
+}
+
+static RDAsyncSim *startSim(RDField *field, const RDParams *params, RDWorkerPool *pool, RDTiles *tiles,
+    RDStepper *stepper, int stepsPerPublish, RDMipPyramid *pyramid, const RDView *view)
+{
+    RDAsyncSim *sim = (RDAsyncSim *) calloc(1, sizeof(RDAsyncSim));
+    if (sim == NULL) return NULL;
+
+    sim->field = field;
+    sim->params = params;
+    sim->pool = pool;
+    sim->tiles = tiles;
+    sim->stepper = stepper;
+    sim->stepsPerPublish = stepsPerPublish > 0 ? stepsPerPublish : 1;
+    sim->pyramid = pyramid;
+    if (view != NULL) sim->view = *view;
+
+    // Frames are the size of the view when there is one, otherwise the whole field
+    size_t bufferSize = pyramid != NULL ? (size_t) view->width * view->height * RD_PIXEL_SIZE
+        : (size_t) field->width * field->height * RD_PIXEL_SIZE;
+    for (int i = 0; i < 3; i++)
+    {
+        sim->frames[i].pixels = (unsigned char *) malloc(bufferSize);
+        sim->frames[i].generation = -1;
+    }
+    sim->back = 0;
+    sim->shared = 1;
+    sim->front = 2;
+
+    if (sim->frames[0].pixels == NULL || sim->frames[1].pixels == NULL || sim->frames[2].pixels == NULL)
+    {
+        for (int i = 0; i < 3; i++) free(sim->frames[i].pixels);
+        free(sim);
+        return NULL;
+    }
+
+    pthread_mutex_init(&sim->viewLock, NULL);
+    pthread_mutex_init(&sim->recorderLock, NULL);
+    sim->running = 1;
+    if (pthread_create(&sim->thread, NULL, simulationMain, sim) != 0)
+    {
+        pthread_mutex_destroy(&sim->recorderLock);
+        pthread_mutex_destroy(&sim->viewLock);
+        for (int i = 0; i < 3; i++) free(sim->frames[i].pixels);
+        free(sim);
+        return NULL;
+    }
+
+    return sim;
+}
+
+RDAsyncSim *startAsyncSim(RDField *field, const RDParams *params, RDWorkerPool *pool, RDTiles *tiles, int stepsPerPublish)
+{
+    return startSim(field, params, pool, tiles, NULL, stepsPerPublish, NULL, NULL);
+}
+
+RDAsyncSim *startAsyncViewSim(RDField *field, const RDParams *params, RDWorkerPool *pool, RDTiles *tiles,
+    int stepsPerPublish, RDMipPyramid *pyramid, const RDView *view)
+{
+    return startSim(field, params, pool, tiles, NULL, stepsPerPublish, pyramid, view);
+}
+
+RDAsyncSim *startAsyncStepperSim(RDStepper *stepper, const RDParams *params, int stepsPerPublish,
+    RDMipPyramid *pyramid, const RDView *view)
+{
+    return startSim(stepper->field, params, stepper->pool, NULL, stepper, stepsPerPublish, pyramid, view);
+}
+
+void setAsyncView(RDAsyncSim *sim, const RDView *view)
+{
+    pthread_mutex_lock(&sim->viewLock);
+    sim->view = *view;
+    pthread_mutex_unlock(&sim->viewLock);
+}
+
+const RDFrame *latestFrame(RDAsyncSim *sim)
+{
+    // Only swap when there's something new, otherwise keep showing the current front frame
+    if (__atomic_load_n(&sim->shared, __ATOMIC_RELAXED) & FRESH_FRAME)
+    {
+        sim->front = __atomic_exchange_n(&sim->shared, sim->front, __ATOMIC_ACQ_REL) & ~FRESH_FRAME;
+    }
+
+    const RDFrame *frame = &sim->frames[sim->front];
+    return frame->generation >= 0 ? frame : NULL;
+}
+
+void updateAsyncStats(RDAsyncSim *sim, const RDFrame *frame, RDAsyncStats *stats)
+{
+    double now = rdGetTime();
+    long long generation = __atomic_load_n(&sim->generation, __ATOMIC_RELAXED);
+    long long publishes = __atomic_load_n(&sim->publishes, __ATOMIC_RELAXED);
+
+    if (frame != NULL)
+    {
+        stats->staleness = now - frame->publishTime;
+        stats->generationsBehind = generation - frame->generation;
+    }
+
+    if (stats->windowStart == 0.0)
+    {
+        stats->windowStart = now;
+        stats->windowGeneration = generation;
+        stats->windowPublishes = publishes;
+    }
+    else if (now - stats->windowStart >= STATS_WINDOW)
+    {
+        double elapsed = now - stats->windowStart;
+        stats->stepsPerSecond = (generation - stats->windowGeneration) / elapsed;
+        stats->publishesPerSecond = (publishes - stats->windowPublishes) / elapsed;
+        stats->windowStart = now;
+        stats->windowGeneration = generation;
+        stats->windowPublishes = publishes;
+    }
+}
+
+void requestAsyncSnapshot(RDAsyncSim *sim, RDSnapshotWriter *writer, const char *path)
+{
+    // A request already waiting is left alone rather than changing its writer from under it
+    if (__atomic_load_n(&sim->snapshotRequested, __ATOMIC_ACQUIRE)) return;
+
+    sim->snapshotWriter = writer;
+    sim->snapshotPath = path;
+    __atomic_store_n(&sim->snapshotRequested, 1, __ATOMIC_RELEASE);
+}
+
+void setAsyncRecorder(RDAsyncSim *sim, RDRecorder *recorder)
+{
+    pthread_mutex_lock(&sim->recorderLock);
+    sim->recorder = recorder;
+    pthread_mutex_unlock(&sim->recorderLock);
+}
+
+void stopAsyncSim(RDAsyncSim *sim)
+{
+    if (sim == NULL) return;
+
+    __atomic_store_n(&sim->running, 0, __ATOMIC_RELEASE);
+    pthread_join(sim->thread, NULL);
+    pthread_mutex_destroy(&sim->recorderLock);
+    pthread_mutex_destroy(&sim->viewLock);
+
+    for (int i = 0; i < 3; i++) free(sim->frames[i].pixels);
+    free(sim);
+}
@@ -0,0 +1,116 @@
+// Runs the simulation on its own thread so it isn't limited by the display's frame rate
+//
+// The simulation thread steps a batch of generations, colours the result into the back buffer
+// of a triple buffer and publishes it. The render loop picks up the most recently published
+// frame without ever waiting on the simulation, and the simulation never waits on the render
+// loop, it just overwrites frames nobody looked at.
+//
+// Started with a view, it colours just the part of the field in the view instead of all of it,
+// from a mip pyramid it keeps up to date, and the render loop can move the view at any time.
+// Started with a stepper, it steps and colours the view with whichever backend that runs.
+
+#ifndef RD_ASYNC_H
+#define RD_ASYNC_H
+
+#include "rd_field.h"
+#include "rd_threads.h"
+#include "rd_tiles.h"
+#include "rd_snapshot.h"
+#include "rd_record.h"
+#include "rd_view.h"
+#include "rd_backend.h"
+#include "rd_palette.h"
+
+/// A coloured generation published by the simulation thread
+typedef struct {
+    unsigned char *pixels;      // width * height RGBA pixels
+    long long generation;       // The number of generations stepped when it was coloured
+    double publishTime;         // When it was published, from rdGetTime
+    RDView view;                // The part of the field it shows, when started with a view
+    const RDPalette *palette;   // The palette it was coloured with
+} RDFrame;
+
+typedef struct RDAsyncSim RDAsyncSim;
+
+/// How the simulation and display are keeping up, updated by updateAsyncStats
+typedef struct {
+    double stepsPerSecond;      // Generations stepped per second by the simulation thread
+    double publishesPerSecond;  // Frames published per second by the simulation thread
+    double staleness;           // Seconds between the displayed frame being published and shown
+    long long generationsBehind;    // Generations stepped since the displayed frame was coloured
+
+    // Used to measure the rates over a window rather than a single frame
+    double windowStart;
+    long long windowGeneration;
+    long long windowPublishes;
+} RDAsyncStats;
+
+/// Start stepping a field on a background thread, the field mustn't be touched until the
+/// simulation is stopped
+/// @param field The field to step
+/// @param params The feed, kill and diffusion rates to use, must stay valid while running
+/// @param pool The pool to step with, NULL steps on the simulation thread alone
+/// @param tiles Freshly initialised tiles to step and colour only the active parts of the field with,
+///              NULL steps every cell
+/// @param stepsPerPublish The number of generations stepped between published frames
+/// @return The running simulation, or NULL if it couldn't be started
+RDAsyncSim *startAsyncSim(RDField *field, const RDParams *params, RDWorkerPool *pool, RDTiles *tiles, int stepsPerPublish);
+
+/// Start stepping a field on a background thread, colouring only the part of it in a view each
+/// time a frame is published
+/// @param field The field to step
+/// @param params The feed, kill and diffusion rates to use, must stay valid while running
+/// @param pool The pool to step with, NULL steps on the simulation thread alone
+/// @param tiles Freshly initialised tiles to step with, NULL steps every cell
+/// @param stepsPerPublish The number of generations stepped between published frames
+/// @param pyramid A freshly initialised pyramid for the field, kept up to date by the simulation thread
+/// @param view The view to colour to start with, its width and height are the size of every frame
+/// @return The running simulation, or NULL if it couldn't be started
+RDAsyncSim *startAsyncViewSim(RDField *field, const RDParams *params, RDWorkerPool *pool, RDTiles *tiles,
+    int stepsPerPublish, RDMipPyramid *pyramid, const RDView *view);
+
+/// Start stepping a field with a backend on a background thread, colouring only the part of it in
+/// a view each time a frame is published
+/// @param stepper The started stepper, neither it nor its field may be touched until the simulation is stopped
+/// @param params The feed, kill and diffusion rates to use, must stay valid while running
+/// @param stepsPerPublish The number of generations stepped between published frames
+/// @param pyramid A freshly initialised pyramid for the field, kept up to date by the simulation thread
+/// @param view The view to colour to start with, its width and height are the size of every frame
+/// @return The running simulation, or NULL if it couldn't be started
+RDAsyncSim *startAsyncStepperSim(RDStepper *stepper, const RDParams *params, int stepsPerPublish,
+    RDMipPyramid *pyramid, const RDView *view);
+
+/// Move the view a simulation started with startAsyncViewSim or startAsyncStepperSim colours, from the next frame on
+/// @param sim The running simulation
+/// @param view The new view, the same width and height as the one it started with
+void setAsyncView(RDAsyncSim *sim, const RDView *view);
+
+/// Get the most recently published frame without blocking
+/// @param sim The running simulation
+/// @return The frame, which stays valid until the next call, or NULL if nothing has been published yet
+const RDFrame *latestFrame(RDAsyncSim *sim);
+
+/// Measure how the simulation and display are keeping up, call once per displayed frame
+/// @param sim The running simulation
+/// @param frame The frame being displayed, from latestFrame, can be NULL
+/// @param stats The stats to update, zero them before the first call
+void updateAsyncStats(RDAsyncSim *sim, const RDFrame *frame, RDAsyncStats *stats);
+
+/// Ask the simulation thread to queue a snapshot of the field once it finishes its current batch,
+/// it keeps trying each batch while the writer is busy with an earlier one
+/// @param sim The running simulation
+/// @param writer The writer to queue the snapshot on
+/// @param path The file to write, must stay valid until the snapshot is queued
+void requestAsyncSnapshot(RDAsyncSim *sim, RDSnapshotWriter *writer, const char *path);
+
+/// Record every frame the simulation colours from now on, or stop recording them
+/// @param sim The running simulation
+/// @param recorder A recorder created the size of the frames, or NULL to stop recording. Once this
+///                 returns the simulation thread won't touch the recorder it had before, so it can be freed.
+void setAsyncRecorder(RDAsyncSim *sim, RDRecorder *recorder);
+
+/// Stop the simulation thread and free everything but the field
+/// @param sim The simulation to stop
+void stopAsyncSim(RDAsyncSim *sim);
+
+#endif
@@ -0,0 +1,401 @@
+// Interchangeable ways of stepping and colouring a field, picked at runtime
+
+#include "rd_backend.h"
+#include "rd_neighbour.h"
+#include "rd_array.h"
+#include "rd_tiles.h"
+#include "rd_blocking.h"
+#include "rd_domain.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// The state of the backends that step a grid of their own
+typedef struct {
+    void *grid;
+    long long generation;   // The generation of the grid, copied to the field with it
+} GridState;
+
+// The original pointer neighbour layout
+
+static bool initNeighbour(RDStepper *stepper)
+{
+    RDField *field = stepper->field;
+    NeighbourGrid *grid = (NeighbourGrid *) malloc(sizeof(NeighbourGrid));
+    GridState *state = (GridState *) malloc(sizeof(GridState));
+    if (grid == NULL || state == NULL)
+    {
+        free(grid);
+        free(state);
+        return false;
+    }
+
+    // Started without seed squares, then every cell is copied in, into both generations so the
+    // border that's never stepped matches too
+    if (!initialiseNeighbourGrid(grid, field->width, field->height, SEED_CENTRE_SQUARE, 0))
+    {
+        free(grid);
+        free(state);
+        return false;
+    }
+    for (int y = 0; y < field->height; y++)
+    {
+        for (int x = 0; x < field->width; x++)
+        {
+            NeighbourCell *cell = &grid->cells[x][y];
+            cell->a[0] = cell->a[1] = rdRealToDouble(fieldA(field)[y * field->stride + x]);
+            cell->b[0] = cell->b[1] = rdRealToDouble(fieldB(field)[y * field->stride + x]);
+        }
+    }
+
+    state->grid = grid;
+    state->generation = field->generation;
+    stepper->state = state;
+    return true;
+}
+
+static void stepNeighbour(RDStepper *stepper, const RDParams *params, int steps)
+{
+    GridState *state = (GridState *) stepper->state;
+    for (int i = 0; i < steps; i++) stepNeighbourGrid((NeighbourGrid *) state->grid, params);
+    state->generation += steps;
+}
+
+static void colouriseNeighbour(RDStepper *stepper, RDMipPyramid *pyramid, const RDView *view, unsigned char *pixels)
+{
+    GridState *state = (GridState *) stepper->state;
+    const NeighbourGrid *grid = (const NeighbourGrid *) state->grid;
+    RDField *field = stepper->field;
+
+    for (int y = 0; y < field->height; y++)
+    {
+        for (int x = 0; x < field->width; x++)
+        {
+            fieldA(field)[y * field->stride + x] = rdRealFromDouble(grid->cells[x][y].a[grid->current]);
+            fieldB(field)[y * field->stride + x] = rdRealFromDouble(grid->cells[x][y].b[grid->current]);
+        }
+    }
+    field->generation = state->generation;
+
+    updateMipPyramid(stepper->pool, pyramid, field, NULL);
+    colourView(field, pyramid, view, pixels);
+}
+
+static void freeNeighbour(RDStepper *stepper)
+{
+    GridState *state = (GridState *) stepper->state;
+    freeNeighbourGrid((NeighbourGrid *) state->grid);
+    free(state->grid);
+    free(state);
+}
+
+// The original 2D array layout
+
+static bool initArray(RDStepper *stepper)
+{
+    RDField *field = stepper->field;
+    ArrayGrid *grid = (ArrayGrid *) malloc(sizeof(ArrayGrid));
+    GridState *state = (GridState *) malloc(sizeof(GridState));
+    if (grid == NULL || state == NULL)
+    {
+        free(grid);
+        free(state);
+        return false;
+    }
+
+    if (!initialiseArrayGrid(grid, field->width, field->height, SEED_CENTRE_SQUARE, 0))
+    {
+        free(grid);
+        free(state);
+        return false;
+    }
+    for (int y = 0; y < field->height; y++)
+    {
+        for (int x = 0; x < field->width; x++)
+        {
+            ArrayCell cell = {
+                rdRealToDouble(fieldA(field)[y * field->stride + x]), rdRealToDouble(fieldB(field)[y * field->stride + x])
+            };
+            grid->cells[0][x][y] = cell;
+            grid->cells[1][x][y] = cell;
+        }
+    }
+
+    state->grid = grid;
+    state->generation = field->generation;
+    stepper->state = state;
+    return true;
+}
+
+static void stepArray(RDStepper *stepper, const RDParams *params, int steps)
+{
+    GridState *state = (GridState *) stepper->state;
+    for (int i = 0; i < steps; i++) stepArrayGrid((ArrayGrid *) state->grid, params);
+    state->generation += steps;
+}
+
+static void colouriseArray(RDStepper *stepper, RDMipPyramid *pyramid, const RDView *view, unsigned char *pixels)
+{
+    GridState *state = (GridState *) stepper->state;
+    const ArrayGrid *grid = (const ArrayGrid *) state->grid;
+    RDField *field = stepper->field;
+
+    for (int y = 0; y < field->height; y++)
+    {
+        for (int x = 0; x < field->width; x++)
+        {
+            fieldA(field)[y * field->stride + x] = rdRealFromDouble(grid->cells[grid->current][x][y].a);
+            fieldB(field)[y * field->stride + x] = rdRealFromDouble(grid->cells[grid->current][x][y].b);
+        }
+    }
+    field->generation = state->generation;
+
+    updateMipPyramid(stepper->pool, pyramid, field, NULL);
+    colourView(field, pyramid, view, pixels);
+}
+
+static void freeArray(RDStepper *stepper)
+{
+    GridState *state = (GridState *) stepper->state;
+    freeArrayGrid((ArrayGrid *) state->grid);
+    free(state->grid);
+    free(state);
+}
+
+// The field layout, stepped a generation at a time, a tile at a time or a block at a time
+
+static bool initField(RDStepper *stepper)
+{
+    stepper->field->kernel = stepper->config.kernel;
+    return true;
+}
+
+static void stepWholeField(RDStepper *stepper, const RDParams *params, int steps)
+{
+    stepFieldParallel(stepper->pool, stepper->field, params, steps);
+}
+
+static void colouriseField(RDStepper *stepper, RDMipPyramid *pyramid, const RDView *view, unsigned char *pixels)
+{
+    updateMipPyramid(stepper->pool, pyramid, stepper->field, NULL);
+    colourView(stepper->field, pyramid, view, pixels);
+}
+
+static void freeNothing(RDStepper *stepper) {}
+
+static bool initTiles(RDStepper *stepper)
+{
+    stepper->field->kernel = stepper->config.kernel;
+
+    RDTiles *tiles = (RDTiles *) malloc(sizeof(RDTiles));
+    if (tiles == NULL) return false;
+    if (!initialiseTiles(tiles, stepper->field, stepper->config.tileSize, stepper->config.tileEpsilon))
+    {
+        free(tiles);
+        return false;
+    }
+
+    stepper->state = tiles;
+    return true;
+}
+
+static void stepActiveTiles(RDStepper *stepper, const RDParams *params, int steps)
+{
+    stepTiles(stepper->pool, (RDTiles *) stepper->state, stepper->field, params, steps);
+}
+
+// Only the parts of the pyramid over tiles that changed are averaged again
+static void colouriseTiles(RDStepper *stepper, RDMipPyramid *pyramid, const RDView *view, unsigned char *pixels)
+{
+    updateMipPyramid(stepper->pool, pyramid, stepper->field, (const RDTiles *) stepper->state);
+    colourView(stepper->field, pyramid, view, pixels);
+}
+
+static void freeActiveTiles(RDStepper *stepper)
+{
+    freeTiles((RDTiles *) stepper->state);
+    free(stepper->state);
+}
+
+// The scratch fields are allocated once for the stepper's pool, not on every step
+static bool initBlocked(RDStepper *stepper)
+{
+    stepper->field->kernel = stepper->config.kernel;
+
+    RDBlocks *blocks = (RDBlocks *) malloc(sizeof(RDBlocks));
+    if (blocks == NULL) return false;
+    if (!initialiseBlocks(blocks, stepper->pool, 0, stepper->config.blockSteps))
+    {
+        free(blocks);
+        return false;
+    }
+
+    stepper->state = blocks;
+    return true;
+}
+
+static void stepBlockedField(RDStepper *stepper, const RDParams *params, int steps)
+{
+    stepBlocks(stepper->pool, (RDBlocks *) stepper->state, stepper->field, params, steps);
+}
+
+static void freeBlocked(RDStepper *stepper)
+{
+    freeBlocks((RDBlocks *) stepper->state);
+    free(stepper->state);
+}
+
+// The field split between worker processes, gathered back into the field to colour
+
+static bool initDomain(RDStepper *stepper)
+{
+    stepper->field->kernel = stepper->config.kernel;
+
+    // The workers are forked, so the pool's threads are stopped while they start and started
+    // again after, and the threads are shared out between the workers
+    int threads = workerPoolSize(stepper->pool);
+    int processes = stepper->config.processes > 0 ? stepper->config.processes : rdDefaultDomainWorkers();
+    freeWorkerPool(stepper->pool);
+
+    RDDomain *domain = startDomain(stepper->field, processes, threads > processes ? threads / processes : 1,
+        HALO_SHARED_MEMORY);
+    stepper->pool = threads > 1 ? createWorkerPool(threads) : NULL;
+    if (domain == NULL) return false;
+
+    stepper->state = domain;
+    return true;
+}
+
+// A worker that has died stops the field changing, stepDomain can't do any more than that
+static void stepDomainField(RDStepper *stepper, const RDParams *params, int steps)
+{
+    stepDomain((RDDomain *) stepper->state, params, steps);
+}
+
+static void colouriseDomain(RDStepper *stepper, RDMipPyramid *pyramid, const RDView *view, unsigned char *pixels)
+{
+    gatherDomain((RDDomain *) stepper->state, stepper->field);
+    updateMipPyramid(stepper->pool, pyramid, stepper->field, NULL);
+    colourView(stepper->field, pyramid, view, pixels);
+}
+
+static void freeDomain(RDStepper *stepper)
+{
+    stopDomain((RDDomain *) stepper->state);
+}
+
+static const RDBackend neighbourBackend = {
+    "neighbour", false, false, false, false, initNeighbour, stepNeighbour, colouriseNeighbour, freeNeighbour
+};
+static const RDBackend arrayBackend = {
+    "array", false, false, false, false, initArray, stepArray, colouriseArray, freeArray
+};
+static const RDBackend fieldBackend = {
+    "field", true, false, false, false, initField, stepWholeField, colouriseField, freeNothing
+};
+static const RDBackend tilesBackend = {
+    "tiles", true, true, false, false, initTiles, stepActiveTiles, colouriseTiles, freeActiveTiles
+};
+static const RDBackend blockedBackend = {
+    "blocked", true, false, true, false, initBlocked, stepBlockedField, colouriseField, freeBlocked
+};
+static const RDBackend domainBackend = {
+    "domain", true, false, false, true, initDomain, stepDomainField, colouriseDomain, freeDomain
+};
+
+// The built in backends come first, registered ones after them
+static const RDBackend *backends[RD_MAX_BACKENDS] = {
+    &neighbourBackend, &arrayBackend, &fieldBackend, &tilesBackend, &blockedBackend, &domainBackend
+};
+static int numBackends = 6;
+
+bool registerBackend(const RDBackend *backend)
+{
+    if (numBackends >= RD_MAX_BACKENDS || findBackend(backend->name) != NULL) return false;
+
+    backends[numBackends++] = backend;
+    return true;
+}
+
+int backendCount(void)
+{
+    return numBackends;
+}
+
+const RDBackend *getBackend(int index)
+{
+    return backends[index];
+}
+
+const RDBackend *findBackend(const char *name)
+{
+    for (int i = 0; i < numBackends; i++)
+    {
+        if (strcmp(backends[i]->name, name) == 0) return backends[i];
+    }
+    return NULL;
+}
+
+bool startStepper(RDStepper *stepper, RDField *field, const RDBackendConfig *config)
+{
+    stepper->backend = findBackend(config->backend);
+    stepper->config = *config;
+    stepper->field = field;
+    stepper->state = NULL;
+    stepper->pool = NULL;
+    if (stepper->backend == NULL) return false;
+
+    // The original layouts only step with the params' feed and kill rates
+    if (fieldHasRates(field) && !stepper->backend->usesKernel) return false;
+
+    // A pool of one thread is no pool at all, the calling thread steps on its own
+    stepper->pool = config->threads != 1 ? createWorkerPool(config->threads) : NULL;
+    if (stepper->backend->init(stepper)) return true;
+
+    freeWorkerPool(stepper->pool);
+    stepper->pool = NULL;
+    return false;
+}
+
+void stepStepper(RDStepper *stepper, const RDParams *params, int steps)
+{
+    stepper->backend->step(stepper, params, steps);
+}
+
+void colouriseStepper(RDStepper *stepper, RDMipPyramid *pyramid, const RDView *view, unsigned char *pixels)
+{
+    stepper->backend->colourise(stepper, pyramid, view, pixels);
+}
+
+void describeBackend(const RDBackendConfig *config, char *description, size_t size)
+{
+    const RDBackend *backend = findBackend(config->backend);
+    int length = snprintf(description, size, "%s", config->backend);
+
+    if (backend != NULL && backend->usesKernel && length >= 0 && (size_t) length < size)
+    {
+        length += snprintf(description + length, size - length, " %s %d thread%s", rdKernelName(config->kernel),
+            config->threads, config->threads == 1 ? "" : "s");
+    }
+    if (backend != NULL && backend->usesTiles && length >= 0 && (size_t) length < size)
+    {
+        length += snprintf(description + length, size - length, " %dx%d", config->tileSize, config->tileSize);
+    }
+    if (backend != NULL && backend->usesBlocks && length >= 0 && (size_t) length < size)
+    {
+        length += snprintf(description + length, size - length, " %d steps", config->blockSteps);
+    }
+    if (backend != NULL && backend->usesProcesses && length >= 0 && (size_t) length < size)
+    {
+        int processes = config->processes > 0 ? config->processes : rdDefaultDomainWorkers();
+        snprintf(description + length, size - length, " %d processes", processes);
+    }
+}
+
+void stopStepper(RDStepper *stepper)
+{
+    if (stepper->backend != NULL && stepper->state != NULL) stepper->backend->free(stepper);
+    freeWorkerPool(stepper->pool);
+    stepper->state = NULL;
+    stepper->pool = NULL;
+}
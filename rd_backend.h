@@ -0,0 +1,118 @@
+// Interchangeable ways of stepping and colouring a field, picked at runtime
+//
+// Every backend keeps its own copy of the simulation in whatever layout suits it, starting from
+// a field, and copies it back into the field when asked to colour it, so the field is always
+// what's snapshotted and shown. The field layouts step the field itself, the original pointer
+// neighbour and 2D array layouts step their own grids, and the domain backend splits it between
+// worker processes and gathers it back to colour. Faster backends are added by passing them to
+// registerBackend.
+//
+// The domain backend forks its workers when it starts, stopping the stepper's own threads while
+// it does, so start it before anything else starts a thread.
+
+#ifndef RD_BACKEND_H
+#define RD_BACKEND_H
+
+#include "rd_field.h"
+#include "rd_kernel.h"
+#include "rd_threads.h"
+#include "rd_view.h"
+
+/// The most backends that can be registered, built in ones included
+#define RD_MAX_BACKENDS 16
+
+/// Which backend to use and the settings it's run with
+typedef struct {
+    const char *backend;    // The name of the backend
+    RDKernelType kernel;    // The row kernel, for backends that step a field
+    int threads;            // The number of threads to step with
+    int tileSize;           // The width and height of the tiles, for the tiles backend
+    double tileEpsilon;     // How close to the background a tile has to be to stop stepping it
+    int blockSteps;         // The generations stepped at a time, for the blocked backend
+    int processes;          // The worker processes the threads are split between, for the domain backend,
+                            // 0 or less uses rdDefaultDomainWorkers
+} RDBackendConfig;
+
+typedef struct RDStepper RDStepper;
+
+/// The functions a backend provides
+typedef struct {
+    const char *name;
+    bool usesKernel;        // Whether the kernel and threads in its config make a difference
+    bool usesTiles;         // Whether the tile size does
+    bool usesBlocks;        // Whether the block steps do
+    bool usesProcesses;     // Whether the number of processes does
+
+    /// Set up the backend's state from the stepper's field
+    bool (*init)(RDStepper *stepper);
+
+    /// Advance the simulation by a number of generations
+    void (*step)(RDStepper *stepper, const RDParams *params, int steps);
+
+    /// Bring the field and a pyramid up to date with the simulation and colour a view of it
+    void (*colourise)(RDStepper *stepper, RDMipPyramid *pyramid, const RDView *view, unsigned char *pixels);
+
+    /// Free the backend's state
+    void (*free)(RDStepper *stepper);
+} RDBackend;
+
+/// A field being stepped by a backend
+struct RDStepper {
+    const RDBackend *backend;
+    RDBackendConfig config;
+    RDField *field;         // Holds the simulation as of the last colourise
+    RDWorkerPool *pool;     // Started with config.threads threads
+    void *state;            // Whatever the backend keeps for itself
+};
+
+/// Add a backend to the ones startStepper and the auto-tuner can use
+/// @param backend The backend, which must stay valid for the rest of the run
+/// @return False if there's no room for it or a backend with its name is already registered
+bool registerBackend(const RDBackend *backend);
+
+/// Get the number of registered backends
+/// @return The number of backends, the built in ones included
+int backendCount(void);
+
+/// Get a registered backend
+/// @param index Which backend, from 0 to backendCount() - 1
+/// @return The backend
+const RDBackend *getBackend(int index);
+
+/// Find a registered backend by name
+/// @param name The name of the backend
+/// @return The backend, or NULL if there isn't one with that name
+const RDBackend *findBackend(const char *name);
+
+/// Start stepping a field with a backend
+/// @param stepper The stepper to start
+/// @param field The field to start from, which the stepper copies the simulation back into
+/// @param config The backend and its settings
+/// @return False if the backend doesn't exist or couldn't be started, or the field has a rate map the
+///         backend can't step with
+bool startStepper(RDStepper *stepper, RDField *field, const RDBackendConfig *config);
+
+/// Advance the simulation by a number of generations
+/// @param stepper The stepper
+/// @param params The feed, kill and diffusion rates to use
+/// @param steps The number of generations to step
+void stepStepper(RDStepper *stepper, const RDParams *params, int steps);
+
+/// Copy the simulation back into the field, update a pyramid of it and colour a view
+/// @param stepper The stepper
+/// @param pyramid The pyramid for the field, kept up to date
+/// @param view The part of the field to colour
+/// @param pixels Where to write view->width * view->height RGBA pixels
+void colouriseStepper(RDStepper *stepper, RDMipPyramid *pyramid, const RDView *view, unsigned char *pixels);
+
+/// Describe a backend and its settings, e.g. "tiles avx2 8 threads 32x32"
+/// @param config The backend and its settings
+/// @param description Filled with the description
+/// @param size The size of description
+void describeBackend(const RDBackendConfig *config, char *description, size_t size);
+
+/// Stop a stepper and free everything it started, but not the field
+/// @param stepper The stepper to stop
+void stopStepper(RDStepper *stepper);
+
+#endif
@@ -0,0 +1,248 @@
+// Runs a batch of independent simulations across the threads of a worker pool
+
+#include "rd_batch.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Each thread's runs, the ones from top up to bottom in the batch's order, packed into one word
+// so taking from either end is a single compare and swap. The owner takes from the bottom and
+// thieves take from the top, and each deque has a cache line to itself so threads taking their
+// own runs don't slow each other down.
+typedef struct {
+    uint64_t range;
+    char padding[RD_FIELD_ALIGN - sizeof(uint64_t)];
+} RunDeque;
+
+typedef struct {
+    const RDBatchSettings *settings;
+    RDBatchRun *runs;
+    RunDeque *deques;
+    double *busySeconds;    // Per thread
+    int *steals;            // Per thread
+    int failed;
+} BatchJob;
+
+static inline uint64_t packRange(uint32_t top, uint32_t bottom)
+{
+    return (uint64_t) top << 32 | bottom;
+}
+
+// Take the last run from a thread's own deque
+static bool popRun(RunDeque *deque, int *run)
+{
+    uint64_t range = __atomic_load_n(&deque->range, __ATOMIC_ACQUIRE);
+
+    while (true)
+    {
+        uint32_t top = (uint32_t) (range >> 32), bottom = (uint32_t) range;
+        if (top >= bottom) return false;
+
+        if (__atomic_compare_exchange_n(&deque->range, &range, packRange(top, bottom - 1), false, __ATOMIC_ACQ_REL,
+            __ATOMIC_ACQUIRE))
+        {
+            *run = (int) bottom - 1;
+            return true;
+        }
+    }
+}
+
+// Take the first run from another thread's deque, the one its owner would get to last
+static bool stealRun(RunDeque *deque, int *run)
+{
+    uint64_t range = __atomic_load_n(&deque->range, __ATOMIC_ACQUIRE);
+
+    while (true)
+    {
+        uint32_t top = (uint32_t) (range >> 32), bottom = (uint32_t) range;
+        if (top >= bottom) return false;
+
+        if (__atomic_compare_exchange_n(&deque->range, &range, packRange(top + 1, bottom), false, __ATOMIC_ACQ_REL,
+            __ATOMIC_ACQUIRE))
+        {
+            *run = (int) top;
+            return true;
+        }
+    }
+}
+
+// Shrink b into a thumbnail, each thumbnail pixel the mean grey of the cells it covers
+static void makeThumbnail(const RDField *field, const RDBatchSettings *settings, unsigned char *thumbnail)
+{
+    const RDReal *a = fieldA(field);
+    const RDReal *b = fieldB(field);
+
+    for (int ty = 0; ty < settings->thumbnailHeight; ty++)
+    {
+        int top = ty * field->height / settings->thumbnailHeight;
+        int bottom = (ty + 1) * field->height / settings->thumbnailHeight;
+        if (bottom <= top) bottom = top + 1;
+
+        for (int tx = 0; tx < settings->thumbnailWidth; tx++)
+        {
+            int left = tx * field->width / settings->thumbnailWidth;
+            int right = (tx + 1) * field->width / settings->thumbnailWidth;
+            if (right <= left) right = left + 1;
+
+            // The same grey the visualisations colour each cell
+            double total = 0.0;
+            for (int y = top; y < bottom; y++)
+            {
+                for (int x = left; x < right; x++)
+                {
+                    size_t i = (size_t) y * field->stride + x;
+                    double grey = (rdRealToDouble(a[i]) - rdRealToDouble(b[i])) * 255.0;
+                    total += grey < 0.0 ? 0.0 : grey > 255.0 ? 255.0 : grey;
+                }
+            }
+
+            thumbnail[ty * settings->thumbnailWidth + tx] = (unsigned char) (total / ((bottom - top) * (right - left)));
+        }
+    }
+}
+
+static bool runOne(const RDBatchSettings *settings, RDBatchRun *run)
+{
+    RDField field;
+    if (!initialiseField(&field, settings->width, settings->height, settings->seed, settings->bSquareSize)) return false;
+
+    for (int s = 0; s < settings->steps; s++) stepField(&field, &run->params);
+
+    // After a step the other planes still hold the generation before, which shows how much it's still changing
+    const RDReal *a = fieldA(&field);
+    const RDReal *b = fieldB(&field);
+    const RDReal *lastB = field.b[1 - field.current];
+    double totalA = 0.0, totalB = 0.0, maxB = 0.0, change = 0.0;
+    long long pattern = 0;
+
+    for (int y = 0; y < field.height; y++)
+    {
+        for (int x = 0; x < field.width; x++)
+        {
+            size_t i = (size_t) y * field.stride + x;
+            double cellB = rdRealToDouble(b[i]);
+
+            totalA += rdRealToDouble(a[i]);
+            totalB += cellB;
+            if (cellB > maxB) maxB = cellB;
+            pattern += cellB > RD_BATCH_PATTERN_THRESHOLD;
+            change += fabs(cellB - rdRealToDouble(lastB[i]));
+        }
+    }
+
+    double cells = (double) field.width * field.height;
+    run->meanA = totalA / cells;
+    run->meanB = totalB / cells;
+    run->maxB = maxB;
+    run->patternFraction = pattern / cells;
+    run->activity = settings->steps > 0 ? change / cells : 0.0;
+
+    if (run->thumbnail != NULL) makeThumbnail(&field, settings, run->thumbnail);
+
+    freeField(&field);
+    return true;
+}
+
+static void runBatchShare(void *data, int thread, int numThreads)
+{
+    BatchJob *job = (BatchJob *) data;
+    int run;
+
+    while (true)
+    {
+        bool stolen = false;
+        bool found = popRun(&job->deques[thread], &run);
+
+        // Once its own runs are gone a thread looks for any left on the others, nothing adds
+        // runs after the batch starts so finding none anywhere means it's done
+        for (int v = 1; !found && v < numThreads; v++)
+        {
+            found = stolen = stealRun(&job->deques[(thread + v) % numThreads], &run);
+        }
+
+        if (!found) return;
+
+        double start = rdGetTime();
+        RDBatchRun *batchRun = &job->runs[run];
+        batchRun->finished = runOne(job->settings, batchRun);
+        batchRun->seconds = rdGetTime() - start;
+
+        if (!batchRun->finished) __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        job->busySeconds[thread] += batchRun->seconds;
+        job->steals[thread] += stolen;
+    }
+}
+
+bool runBatch(RDWorkerPool *pool, const RDBatchSettings *settings, RDBatchRun *runs, int numRuns, RDBatchStats *stats)
+{
+    int numThreads = workerPoolSize(pool);
+    // The deques are aligned to a cache line the same way the field's planes are
+    void *dequeMemory = malloc(sizeof(RunDeque) * numThreads + RD_FIELD_ALIGN);
+    RunDeque *deques = (RunDeque *) (((uintptr_t) dequeMemory + RD_FIELD_ALIGN - 1) & ~(uintptr_t) (RD_FIELD_ALIGN - 1));
+    double *busySeconds = (double *) calloc(numThreads, sizeof(double));
+    int *steals = (int *) calloc(numThreads, sizeof(int));
+    bool allocated = dequeMemory != NULL && busySeconds != NULL && steals != NULL;
+
+    size_t thumbnailSize = (size_t) settings->thumbnailWidth * settings->thumbnailHeight;
+    for (int r = 0; r < numRuns; r++)
+    {
+        runs[r].finished = false;
+        runs[r].thumbnail = NULL;
+        if (thumbnailSize > 0 && allocated)
+        {
+            runs[r].thumbnail = (unsigned char *) malloc(thumbnailSize);
+            allocated = runs[r].thumbnail != NULL;
+        }
+    }
+
+    if (!allocated)
+    {
+        free(dequeMemory);
+        free(busySeconds);
+        free(steals);
+        freeBatchThumbnails(runs, numRuns);
+        return false;
+    }
+
+    // Deal the runs out in contiguous blocks, so neighbouring parameters start on the same thread
+    for (int t = 0; t < numThreads; t++)
+    {
+        uint32_t top = (uint32_t) ((long long) numRuns * t / numThreads);
+        uint32_t bottom = (uint32_t) ((long long) numRuns * (t + 1) / numThreads);
+        deques[t].range = packRange(top, bottom);
+    }
+
+    BatchJob batchJob = { settings, runs, deques, busySeconds, steals, 0 };
+    RDPoolJob job = { runBatchShare, NULL, &batchJob, 1 };
+
+    double start = rdGetTime();
+    runPoolJob(pool, &job);
+    double seconds = rdGetTime() - start;
+
+    if (stats != NULL)
+    {
+        *stats = (RDBatchStats){ numThreads, seconds, 0.0, 0, 0 };
+        for (int t = 0; t < numThreads; t++)
+        {
+            stats->busySeconds += busySeconds[t];
+            stats->steals += steals[t];
+        }
+
+        long long cellsPerRun = (long long) (settings->width - 2) * (settings->height - 2) * settings->steps;
+        for (int r = 0; r < numRuns; r++) stats->cellSteps += runs[r].finished ? cellsPerRun : 0;
+    }
+
+    free(dequeMemory);
+    free(busySeconds);
+    free(steals);
+    return !batchJob.failed;
+}
+
+void freeBatchThumbnails(RDBatchRun *runs, int numRuns)
+{
+    for (int r = 0; r < numRuns; r++)
+    {
+        free(runs[r].thumbnail);
+        runs[r].thumbnail = NULL;
+    }
+}
@@ -0,0 +1,63 @@
+// Runs a batch of independent simulations across the threads of a worker pool
+//
+// Each run is a whole field stepped on one thread, so the threads never wait on each other. The
+// runs are dealt out to the threads in blocks and a thread that runs out steals from the others,
+// so a batch keeps every core busy to the end even when some runs take longer than others.
+
+#ifndef RD_BATCH_H
+#define RD_BATCH_H
+
+#include "rd_field.h"
+#include "rd_threads.h"
+
+/// What every run in a batch has in common
+typedef struct {
+    int width;              // The size of each run's field
+    int height;
+    int steps;              // The number of generations each run is stepped
+    RDSeed seed;
+    int bSquareSize;
+    int thumbnailWidth;     // The size each run's thumbnail is shrunk to, 0 for no thumbnail
+    int thumbnailHeight;
+} RDBatchSettings;
+
+/// A run of the batch, its parameters and what it ended up as
+typedef struct {
+    RDParams params;
+    bool finished;
+    double meanA;
+    double meanB;
+    double maxB;
+    double patternFraction;     // The fraction of cells with b over RD_BATCH_PATTERN_THRESHOLD
+    double activity;            // The mean change in b over the last generation, 0 once it's settled
+    double seconds;             // How long the run took on its thread
+    unsigned char *thumbnail;   // thumbnailWidth * thumbnailHeight greys, allocated by runBatch
+} RDBatchRun;
+
+/// The totals for a whole batch
+typedef struct {
+    int threads;
+    double seconds;             // The wall clock time the batch took
+    double busySeconds;         // The time every thread spent running, summed
+    long long cellSteps;        // The cells stepped by every run, summed
+    int steals;                 // The number of runs taken from another thread
+} RDBatchStats;
+
+/// The level of b counted as part of the pattern in patternFraction
+#define RD_BATCH_PATTERN_THRESHOLD 0.2
+
+/// Run every run in a batch, spread over the threads of a pool
+/// @param pool The pool to run on, NULL runs every run on the calling thread
+/// @param settings What every run has in common
+/// @param runs The runs, with their params set, the rest is filled in
+/// @param numRuns The number of runs
+/// @param stats Filled with the totals for the batch, can be NULL
+/// @return False if any run couldn't allocate its field
+bool runBatch(RDWorkerPool *pool, const RDBatchSettings *settings, RDBatchRun *runs, int numRuns, RDBatchStats *stats);
+
+/// Free the thumbnails of a batch's runs
+/// @param runs The runs
+/// @param numRuns The number of runs
+void freeBatchThumbnails(RDBatchRun *runs, int numRuns);
+
+#endif
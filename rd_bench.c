@@ -0,0 +1,1694 @@
+// This program times the reaction diffusion engine without opening a window
+//
+// Usage: rd_bench [--kernel name] [--steps n] [--time seconds] [--threads n] [--colour] [--palette name] [--tiles n]
+//   [--epsilon e] [--block-steps k] [--block-size n] [--async] [--steps-per-frame n] [--view] [--checkpoint]
+//   [--warm-start scale:steps,...] [--processes n] [--transport shm|socket] [--divergence]
+//   [--golden file] [--update-golden] [--history file] [--slowdown fraction] [--tune] [--implicit dt,...]
+//   [--record path] [--record-format y4m|ppm|pgm] [--record-every n] [--rates gradient|feed.pgm,kill.pgm]
+//   [--verify] [size ...]
+// Each size is the width and height of a square grid, e.g. rd_bench 200 1024 4096
+// --threads steps the field kernels with a worker pool, 0 uses one thread per core
+// --colour also times turning the field into RGBA pixels for the field kernels, --palette picks the
+//   palette everything is coloured with (grey by default)
+// --tiles n only steps the active n by n tiles of the field kernels, --epsilon sets how close to the
+//   background a tile has to be to go dormant (0 by default, which gives exact results)
+// --block-steps k steps each --block-size square of the field kernels k generations at a time while
+//   it's in cache, which gives exactly the same results as stepping one generation at a time
+// --async runs the simulation on its own thread against a 144Hz display loop, publishing a frame
+//   every --steps-per-frame generations, and reports throughput and display staleness separately
+// --view times colouring only a VIEW_WIDTH by VIEW_HEIGHT window onto the field at a range of zooms,
+//   and keeping the mip pyramid it reads when zoomed out up to date, against colouring every cell
+// --checkpoint times saving a snapshot in the background, how long stepping stalls for the copy
+//   and how long the write takes, and loading it back through a memory map
+// --warm-start stages steps from the seed squares until the pattern has filled the grid and settled, both
+//   directly and warm started from coarse stages written scale:steps, e.g. 4:3000,2:1000, and reports the
+//   generations, full resolution steps and time each took (--steps caps the generations, 200000 by default)
+// --processes n steps the field in n worker processes, each owning a stripe of rows and stepping it
+//   with --threads threads, that exchange their edge rows through --transport (shm by default) and
+//   gathers a frame back every DOMAIN_BATCH_STEPS generations
+// --divergence steps this build's precision and the original double layout side by side for
+//   --steps generations (2000 by default) and reports how far the values, pattern and greys drift
+// --golden steps every kernel --steps generations (GOLDEN_STEPS by default) from its seed on each grid
+//   (GOLDEN_SIZE by default), the original layouts only in the double build, and checks it ends up in
+//   the state recorded in the file, exactly or within GOLDEN_TOLERANCE, and how far it is from the
+//   scalar kernel. --update-golden records the states instead. --history appends each kernel's
+//   steps/sec to a CSV file and flags any that are more than --slowdown (0.15 by default) slower than
+//   the median of this machine's last HISTORY_RUNS runs, once there are HISTORY_MIN_RUNS of them
+// --tune times every backend the visualisation's auto-tuner tries, stepping STEPS_PER_BATCH generations
+//   and colouring a VIEW_WIDTH by VIEW_HEIGHT view at a time for --time seconds each (TUNE_SECONDS by default)
+// --implicit 1,2,4,8 steps the seed squares --steps generations (IMPLICIT_GENERATIONS by default) with
+//   the implicit integrator at each timestep, and explicitly with the rates scaled up to each timestep,
+//   and reports the simulated generations per second and how far each pattern is from stepping one
+//   generation at a time
+// --record steps the seed squares --steps generations (RECORD_GENERATIONS by default) without recording, then
+//   again recording every --record-every generations (RECORD_EVERY by default) to path in --record-format
+//   (y4m by default, or ppm or pgm sequences named path_000000.ppm and so on), and reports the steps/sec of
+//   both, the longest stall for a copy, the frames written and dropped and how long the rest took to write.
+//   With --async it records every frame the simulation thread publishes instead
+// --rates steps the field kernels with a rate map, Karl Sims' gradient of feed and kill rates or greyscale
+//   PGMs of them, and reports their steps/sec with the map and with the default rates everywhere. --async
+//   steps with the map too
+// --verify runs the checks in rd_verify.c instead of timing anything, every SIMD kernel, colour pass, backend,
+//   implicit solve, rate map, the worker pool and worker processes against the scalar ones, and reading back
+//   a recording in every format
+
+#include "rd_engine.h"
+#include "rd_neighbour.h"
+#include "rd_array.h"
+#include "rd_field.h"
+#include "rd_kernel.h"
+#include "rd_threads.h"
+#include "rd_colour.h"
+#include "rd_async.h"
+#include "rd_tiles.h"
+#include "rd_blocking.h"
+#include "rd_snapshot.h"
+#include "rd_multigrid.h"
+#include "rd_view.h"
+#include "rd_domain.h"
+#include "rd_backend.h"
+#include "rd_tune.h"
+#include "rd_implicit.h"
+#include "rd_record.h"
+#include "rd_rates.h"
+#include "rd_verify.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_MIN_TIME 1.0
+#define WARMUP_STEPS 2
+#define VERIFY_STEPS 200
+#define SNAPSHOT_PATH "rd_bench.rdsnap"
+#define DIVERGENCE_STEPS 2000
+#define DISPLAY_RATE 144.0
+#define VIEW_WIDTH 1280
+#define VIEW_HEIGHT 720
+#define VIEW_FRAMES 50
+#define DEVELOPED_CHECK_STEPS 250
+#define DEVELOPED_BLOCK_SIZE 16
+#define DEVELOPED_COVERAGE 0.99
+#define DEVELOPED_CHANGE 0.002
+#define DEVELOPED_MAX_STEPS 200000
+#define DOMAIN_BATCH_STEPS 50
+#define GOLDEN_SIZE 256
+#define GOLDEN_STEPS 1000
+#define GOLDEN_BLOCKS 8
+#define GOLDEN_TIMING_STEPS 50
+#define GOLDEN_TOLERANCE 1e-6
+#define GOLDEN_MAX_STATES 64
+#define HISTORY_RUNS 5
+#define HISTORY_MIN_RUNS 3
+#define DEFAULT_SLOWDOWN 0.15
+#define STEPS_PER_BATCH 8
+#define TUNE_SECONDS 0.2
+#define IMPLICIT_GENERATIONS 4000
+#define RECORD_GENERATIONS 2000
+#define RECORD_EVERY 10
+#define RATES_REPEATS 3
+
+// The pool field kernels are stepped with, NULL when stepping on one thread
+static RDWorkerPool *pool = NULL;
+
+// Whether to time the colour pass as well as stepping
+static bool timeColour = false;
+
+// The size of the tiles field kernels are stepped in, 0 steps every cell
+static int tileSize = 0;
+static double tileEpsilon = 0.0;
+
+// The number of generations each block of the field kernels is stepped at a time, 0 steps a
+// generation at a time
+static int blockSteps = 0;
+static int blockSize = RD_DEFAULT_BLOCK_SIZE;
+
+// Where the field kernels' rate maps come from, "gradient" or feed and kill PGMs separated by a
+// comma, NULL steps with the params' feed and kill rates everywhere
+static const char *rateSource = NULL;
+
+/// A field and the tiles or blocks it's stepped in when tileSize or blockSteps is set
+typedef struct {
+    RDField field;
+    RDTiles tiles;
+    RDBlocks blocks;
+} BenchField;
+
+/// The functions needed to time one of the engine's grid layouts
+typedef struct {
+    const char *name;
+    int option;     // The row kernel for field layouts, -1 for the others
+    void *(*create)(int size, int option);
+    void (*step)(void *grid, const RDParams *params, int steps);
+    void (*destroy)(void *grid);
+    void (*getCell)(const void *grid, int x, int y, double *a, double *b);
+} Kernel;
+
+static void *createNeighbour(int size, int option)
+{
+    NeighbourGrid *grid = (NeighbourGrid *) malloc(sizeof(NeighbourGrid));
+    if (grid == NULL || !initialiseNeighbourGrid(grid, size, size, SEED_CENTRE_SQUARE, 5))
+    {
+        printf("Couldn't allocate a %dx%d grid\n", size, size);
+        exit(1);
+    }
+    return grid;
+}
+
+static void stepNeighbour(void *grid, const RDParams *params, int steps)
+{
+    for (int i = 0; i < steps; i++) stepNeighbourGrid((NeighbourGrid *) grid, params);
+}
+
+static void destroyNeighbour(void *grid) { freeNeighbourGrid((NeighbourGrid *) grid); free(grid); }
+
+static void getNeighbourCell(const void *grid, int x, int y, double *a, double *b)
+{
+    const NeighbourGrid *neighbourGrid = (const NeighbourGrid *) grid;
+    *a = neighbourGrid->cells[x][y].a[neighbourGrid->current];
+    *b = neighbourGrid->cells[x][y].b[neighbourGrid->current];
+}
+
+static void *createArray(int size, int option)
+{
+    ArrayGrid *grid = (ArrayGrid *) malloc(sizeof(ArrayGrid));
+    if (grid == NULL || !initialiseArrayGrid(grid, size, size, SEED_CENTRE_SQUARE, 5))
+    {
+        printf("Couldn't allocate a %dx%d grid\n", size, size);
+        exit(1);
+    }
+    return grid;
+}
+
+static void stepArray(void *grid, const RDParams *params, int steps)
+{
+    for (int i = 0; i < steps; i++) stepArrayGrid((ArrayGrid *) grid, params);
+}
+
+static void destroyArray(void *grid) { freeArrayGrid((ArrayGrid *) grid); free(grid); }
+
+static void getArrayCell(const void *grid, int x, int y, double *a, double *b)
+{
+    const ArrayGrid *arrayGrid = (const ArrayGrid *) grid;
+    *a = arrayGrid->cells[arrayGrid->current][x][y].a;
+    *b = arrayGrid->cells[arrayGrid->current][x][y].b;
+}
+
+/// Give a field the rate map rateSource describes, over the range of rates of Karl Sims' map
+/// @param field The field
+/// @param source "gradient", or the feed and kill PGMs separated by a comma, either of which can be
+///               left out for the low rate everywhere
+/// @return False if the map couldn't be made
+static bool applyRates(RDField *field, const char *source)
+{
+    if (strcmp(source, "gradient") == 0)
+    {
+        return setGradientRates(field, RD_GRADIENT_FEED_LOW, RD_GRADIENT_FEED_HIGH, RD_GRADIENT_KILL_LOW,
+            RD_GRADIENT_KILL_HIGH);
+    }
+
+    char feedPath[1024];
+    const char *comma = strchr(source, ',');
+    size_t feedLength = comma != NULL ? (size_t) (comma - source) : strlen(source);
+    if (feedLength >= sizeof(feedPath)) return false;
+    memcpy(feedPath, source, feedLength);
+    feedPath[feedLength] = '\0';
+
+    const char *killPath = comma != NULL && comma[1] != '\0' ? comma + 1 : NULL;
+    return loadRateImages(field, feedLength > 0 ? feedPath : NULL, RD_GRADIENT_FEED_LOW, RD_GRADIENT_FEED_HIGH,
+        killPath, RD_GRADIENT_KILL_LOW, RD_GRADIENT_KILL_HIGH);
+}
+
+static void *createField(int size, int option)
+{
+    BenchField *grid = (BenchField *) calloc(1, sizeof(BenchField));
+    if (!initialiseField(&grid->field, size, size, SEED_CENTRE_SQUARE, 5)
+        || (tileSize > 0 && !initialiseTiles(&grid->tiles, &grid->field, tileSize, tileEpsilon))
+        || (blockSteps > 0 && !initialiseBlocks(&grid->blocks, pool, blockSize, blockSteps)))
+    {
+        printf("Couldn't allocate a %dx%d field\n", size, size);
+        exit(1);
+    }
+    if (option >= 0) grid->field.kernel = option;
+    if (rateSource != NULL && !applyRates(&grid->field, rateSource))
+    {
+        printf("Couldn't make the rate map %s\n", rateSource);
+        exit(1);
+    }
+    return grid;
+}
+
+static void stepFieldKernel(void *grid, const RDParams *params, int steps)
+{
+    BenchField *benchField = (BenchField *) grid;
+
+    if (tileSize > 0) stepTiles(pool, &benchField->tiles, &benchField->field, params, steps);
+    else if (blockSteps > 0) stepBlocks(pool, &benchField->blocks, &benchField->field, params, steps);
+    else stepFieldParallel(pool, &benchField->field, params, steps);
+}
+
+static void destroyField(void *grid)
+{
+    BenchField *benchField = (BenchField *) grid;
+
+    if (tileSize > 0) freeTiles(&benchField->tiles);
+    if (blockSteps > 0) freeBlocks(&benchField->blocks);
+    freeField(&benchField->field);
+    free(grid);
+}
+
+static void getFieldCell(const void *grid, int x, int y, double *a, double *b)
+{
+    const RDField *field = &((const BenchField *) grid)->field;
+    *a = rdRealToDouble(fieldA(field)[y * field->stride + x]);
+    *b = rdRealToDouble(fieldB(field)[y * field->stride + x]);
+}
+
+static const Kernel kernels[] = {
+    { "neighbour", -1, createNeighbour, stepNeighbour, destroyNeighbour, getNeighbourCell },
+    { "array", -1, createArray, stepArray, destroyArray, getArrayCell },
+    { "scalar", KERNEL_SCALAR, createField, stepFieldKernel, destroyField, getFieldCell },
+    { "sse2", KERNEL_SSE2, createField, stepFieldKernel, destroyField, getFieldCell },
+    { "avx2", KERNEL_AVX2, createField, stepFieldKernel, destroyField, getFieldCell },
+    { "avx512", KERNEL_AVX512, createField, stepFieldKernel, destroyField, getFieldCell },
+};
+
+#define NUM_KERNELS (int) (sizeof(kernels) / sizeof(kernels[0]))
+
+/// Time turning a field into pixels and print a line of results
+/// @param field The field to colour
+/// @param frames The number of times to colour it
+static void timeColourPass(const RDField *field, int frames)
+{
+    unsigned char *pixels = (unsigned char *) malloc((size_t) field->width * field->height * RD_PIXEL_SIZE);
+    colourField(field, pixels);
+
+    double start = rdGetTime();
+    for (int i = 0; i < frames; i++) colourField(field, pixels);
+    double seconds = rdGetTime() - start;
+
+    double totalPixels = (double) field->width * field->height * frames;
+    printf("%-10s %11s %8d %12.2f %14.0f %10.3f\n",
+        "  colour", "", frames, frames / seconds, totalPixels / seconds, seconds * 1e9 / totalPixels);
+
+    free(pixels);
+}
+
+/// Step a grid a number of generations, or for a length of time, after a few warm up generations
+/// @param kernel The kernel the grid belongs to
+/// @param grid The grid to step
+/// @param steps The number of generations to time, or 0 to run for minTime instead
+/// @param minTime The minimum number of seconds to run for when steps is 0
+/// @param params The feed, kill and diffusion rates to use
+/// @param seconds Set to how long the timed generations took
+/// @return The number of generations timed
+static int timeSteps(const Kernel *kernel, void *grid, int steps, double minTime, const RDParams *params,
+    double *seconds)
+{
+    // Blocked field kernels are stepped a whole block of generations at a time
+    int batch = (kernel->option >= 0 && blockSteps > 0) ? blockSteps : 1;
+
+    kernel->step(grid, params, WARMUP_STEPS);
+
+    double start = rdGetTime();
+    int done = 0;
+    *seconds = 0.0;
+
+    while ((steps > 0) ? (done < steps) : (*seconds < minTime))
+    {
+        kernel->step(grid, params, batch);
+        done += batch;
+        *seconds = rdGetTime() - start;
+    }
+
+    return done;
+}
+
+/// Time a kernel on a square grid and print a line of results
+/// @param kernel The kernel to time
+/// @param size The width and height of the grid
+/// @param steps The number of generations to time, or 0 to run for minTime instead
+/// @param minTime The minimum number of seconds to run for when steps is 0
+/// @param params The feed, kill and diffusion rates to use
+static void runKernel(const Kernel *kernel, int size, int steps, double minTime, const RDParams *params)
+{
+    void *grid = kernel->create(size, kernel->option);
+    double seconds;
+    int done = timeSteps(kernel, grid, steps, minTime, params, &seconds);
+
+    // Only cells inside the border are stepped
+    double cells = (double) (size - 2) * (double) (size - 2) * done;
+
+    printf("%-10s %5dx%-5d %8d %12.2f %14.0f %10.3f\n",
+        kernel->name, size, size, done, done / seconds, cells / seconds, seconds * 1e9 / cells);
+
+    if (kernel->option >= 0 && tileSize > 0)
+    {
+        RDTiles *tiles = &((BenchField *) grid)->tiles;
+        double totalTiles = (double) tiles->tilesX * tiles->tilesY * tiles->generation;
+        printf("%-10s %11s %7.3f%% of tiles stepped, %.3f%% active now\n", "  tiles", "",
+            tiles->tilesStepped * 100.0 / totalTiles, activeTileFraction(tiles) * 100.0);
+    }
+
+    if (timeColour && kernel->option >= 0) timeColourPass(&((BenchField *) grid)->field, done);
+
+    kernel->destroy(grid);
+}
+
+/// Run the simulation on its own thread while polling it like a display would and print how
+/// fast it stepped and how old the frames were when they were shown
+/// @param size The width and height of the grid
+/// @param stepsPerFrame The number of generations stepped between published frames
+/// @param seconds How long to run for
+/// @param params The feed, kill and diffusion rates to use
+/// @param recorder Records every published frame when not NULL
+static void runAsync(int size, int stepsPerFrame, double seconds, const RDParams *params, RDRecorder *recorder)
+{
+    BenchField *grid = (BenchField *) createField(size, -1);
+    RDAsyncSim *sim = startAsyncSim(&grid->field, params, pool, tileSize > 0 ? &grid->tiles : NULL, stepsPerFrame);
+    if (sim == NULL)
+    {
+        printf("Couldn't start the simulation thread\n");
+        exit(1);
+    }
+    if (recorder != NULL) setAsyncRecorder(sim, recorder);
+
+    RDAsyncStats stats = { 0 };
+    const RDFrame *frame = NULL;
+    double start = rdGetTime();
+    double totalStaleness = 0.0;
+    double maxStaleness = 0.0;
+    long long totalBehind = 0;
+    int displayed = 0;
+
+    while (rdGetTime() - start < seconds)
+    {
+        frame = latestFrame(sim);
+        updateAsyncStats(sim, frame, &stats);
+
+        if (frame != NULL)
+        {
+            totalStaleness += stats.staleness;
+            if (stats.staleness > maxStaleness) maxStaleness = stats.staleness;
+            totalBehind += stats.generationsBehind;
+            displayed++;
+        }
+
+        rdSleep(1.0 / DISPLAY_RATE);
+    }
+
+    long long generations = frame != NULL ? frame->generation : 0;
+    double elapsed = frame != NULL ? frame->publishTime - start : seconds;
+    if (recorder != NULL) setAsyncRecorder(sim, NULL);
+    stopAsyncSim(sim);
+    destroyField(grid);
+
+    if (displayed == 0)
+    {
+        printf("%-10s %5dx%-5d no frames were published\n", "async", size, size);
+        return;
+    }
+
+    printf("%-10s %5dx%-5d %8lld %12.2f %14.2f %10d %12.3f %12.3f %10.1f\n",
+        "async", size, size, generations, generations / elapsed, stats.publishesPerSecond, displayed,
+        totalStaleness / displayed * 1000.0, maxStaleness * 1000.0, (double) totalBehind / displayed);
+}
+
+/// Time every backend the auto-tuner tries on a freshly seeded field and print a line for each,
+/// marking the one it would pick
+/// @param size The width and height of the grid
+/// @param seconds How long to time each backend for
+/// @param params The feed, kill and diffusion rates to use
+static void runTune(int size, double seconds, const RDParams *params)
+{
+    RDField field;
+    if (!initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5))
+    {
+        printf("Couldn't allocate a %dx%d field\n", size, size);
+        exit(1);
+    }
+
+    RDView view = { 0.0, 0.0, fmax((double) size / VIEW_WIDTH, (double) size / VIEW_HEIGHT), VIEW_WIDTH, VIEW_HEIGHT };
+    RDBackendConfig candidates[RD_MAX_TUNE_CANDIDATES];
+    double rates[RD_MAX_TUNE_CANDIDATES];
+    int numCandidates = listBackendCandidates(candidates, RD_MAX_TUNE_CANDIDATES, 0.0);
+    int best = 0;
+
+    for (int c = 0; c < numCandidates; c++)
+    {
+        rates[c] = timeBackend(&field, &candidates[c], params, &view, STEPS_PER_BATCH, seconds);
+        if (rates[c] > rates[best]) best = c;
+    }
+
+    for (int c = 0; c < numCandidates; c++)
+    {
+        char description[128];
+        describeBackend(&candidates[c], description, sizeof(description));
+        printf("%-38s %5dx%-5d %12.2f %14.0f%s\n", description, size, size, rates[c],
+            rates[c] * (size - 2) * (size - 2), c == best ? "  fastest" : "");
+    }
+
+    freeField(&field);
+}
+
+/// Time colouring a window onto a field at a range of zooms against colouring every cell, and
+/// print a line of results for each
+/// @param size The width and height of the grid
+/// @param params The feed, kill and diffusion rates to use
+static void runView(int size, const RDParams *params)
+{
+    BenchField *grid = (BenchField *) createField(size, -1);
+    RDMipPyramid pyramid;
+    if (!initialiseMipPyramid(&pyramid, &grid->field))
+    {
+        printf("Couldn't allocate a pyramid for a %dx%d field\n", size, size);
+        exit(1);
+    }
+    stepFieldKernel(grid, params, 200);
+
+    // Colouring every cell is what the visualisations did before, however small the window
+    unsigned char *pixels = (unsigned char *) malloc((size_t) size * size * RD_PIXEL_SIZE);
+    double start = rdGetTime();
+    for (int i = 0; i < VIEW_FRAMES; i++) colourField(&grid->field, pixels);
+    double seconds = (rdGetTime() - start) / VIEW_FRAMES;
+    printf("%-10s %5dx%-5d %8s %6s %12.3f %12.3f\n", "field", size, size, "", "", seconds * 1000.0,
+        seconds * 1e9 / ((double) size * size));
+    free(pixels);
+
+    // Averaging the whole field into the pyramid, with tiles only the changed ones are averaged
+    start = rdGetTime();
+    for (int i = 0; i < VIEW_FRAMES; i++) updateMipPyramid(pool, &pyramid, &grid->field, NULL);
+    seconds = (rdGetTime() - start) / VIEW_FRAMES;
+    printf("%-10s %5dx%-5d %8s %6s %12.3f %12.3f\n", "pyramid", size, size, "", "", seconds * 1000.0,
+        seconds * 1e9 / ((double) size * size));
+
+    pixels = (unsigned char *) malloc((size_t) VIEW_WIDTH * VIEW_HEIGHT * RD_PIXEL_SIZE);
+    double fit = (double) size / VIEW_WIDTH > (double) size / VIEW_HEIGHT ? (double) size / VIEW_WIDTH
+        : (double) size / VIEW_HEIGHT;
+    double zooms[] = { 0.25, 1.0, 4.0, fit };
+
+    for (int z = 0; z < 4; z++)
+    {
+        RDView view = { size * 0.5 - VIEW_WIDTH * zooms[z] * 0.5, size * 0.5 - VIEW_HEIGHT * zooms[z] * 0.5, zooms[z],
+            VIEW_WIDTH, VIEW_HEIGHT };
+
+        start = rdGetTime();
+        for (int i = 0; i < VIEW_FRAMES; i++) colourView(&grid->field, &pyramid, &view, pixels);
+        seconds = (rdGetTime() - start) / VIEW_FRAMES;
+        printf("%-10s %5dx%-5d %8.3g %6d %12.3f %12.3f\n", "view", size, size, zooms[z], viewLevel(&pyramid, &view),
+            seconds * 1000.0, seconds * 1e9 / ((double) VIEW_WIDTH * VIEW_HEIGHT));
+    }
+
+    free(pixels);
+    freeMipPyramid(&pyramid);
+    destroyField(grid);
+}
+
+/// Time stepping a field split between worker processes, gathering a frame back every
+/// DOMAIN_BATCH_STEPS generations the way a display would, and print a line of results
+/// @param size The width and height of the grid
+/// @param processes The number of worker processes
+/// @param threads The number of threads each worker steps with
+/// @param transport How the workers exchange their edge rows
+/// @param seconds How long to run for
+/// @param params The feed, kill and diffusion rates to use
+static void runDomain(int size, int processes, int threads, RDHaloTransport transport, double seconds,
+    const RDParams *params)
+{
+    RDField field;
+    if (!initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5))
+    {
+        printf("Couldn't allocate a %dx%d field\n", size, size);
+        exit(1);
+    }
+
+    RDDomain *domain = startDomain(&field, processes, threads, transport);
+    if (domain == NULL)
+    {
+        printf("Couldn't start %d worker processes\n", processes);
+        exit(1);
+    }
+
+    long long generations = 0;
+    int gathers = 0;
+    double gatherSeconds = 0.0;
+    bool running = true;
+    double start = rdGetTime();
+
+    while (running && rdGetTime() - start < seconds)
+    {
+        running = stepDomain(domain, params, DOMAIN_BATCH_STEPS);
+        double gatherStart = rdGetTime();
+        running = running && gatherDomain(domain, &field);
+        gatherSeconds += rdGetTime() - gatherStart;
+        generations += DOMAIN_BATCH_STEPS;
+        gathers++;
+    }
+
+    double elapsed = rdGetTime() - start;
+    stopDomain(domain);
+    freeField(&field);
+
+    if (!running)
+    {
+        printf("%-10s %5dx%-5d a worker process died\n", haloTransportName(transport), size, size);
+        return;
+    }
+
+    double cells = (double) (size - 2) * (size - 2) * generations;
+    printf("%-10s %5dx%-5d %9d %8lld %12.2f %14.0f %10.3f %12.3f\n", haloTransportName(transport), size, size,
+        processes, generations, generations / elapsed, cells / elapsed, elapsed * 1e9 / cells,
+        gatherSeconds / gathers * 1000.0);
+}
+
+/// Time saving and loading a snapshot and print a line of results
+/// @param size The width and height of the grid
+/// @param params The feed, kill and diffusion rates to use
+static void runCheckpoint(int size, const RDParams *params)
+{
+    RDField field;
+    if (!initialiseField(&field, size, size, SEED_CENTRE_SQUARE, 5))
+    {
+        printf("Couldn't allocate a %dx%d field\n", size, size);
+        exit(1);
+    }
+
+    RDSnapshotWriter *writer = createSnapshotWriter();
+    if (writer == NULL)
+    {
+        printf("Couldn't start the snapshot writer\n");
+        exit(1);
+    }
+
+    // The step loop only stalls for the copy, the write happens while it carries on
+    double start = rdGetTime();
+    bool queued = queueSnapshot(writer, SNAPSHOT_PATH, &field, params);
+    double stall = rdGetTime() - start;
+    while (snapshotPending(writer)) stepFieldParallel(pool, &field, params, 1);
+    double written = rdGetTime() - start;
+    bool succeeded = queued && lastSnapshotSucceeded(writer);
+    freeSnapshotWriter(writer);
+    freeField(&field);
+
+    if (!succeeded)
+    {
+        printf("%-10s %5dx%-5d couldn't write %s\n", "checkpoint", size, size, SNAPSHOT_PATH);
+        remove(SNAPSHOT_PATH);
+        return;
+    }
+
+    start = rdGetTime();
+    bool loaded = loadSnapshot(SNAPSHOT_PATH, &field, NULL);
+    double loadTime = rdGetTime() - start;
+    remove(SNAPSHOT_PATH);
+
+    if (!loaded)
+    {
+        printf("%-10s %5dx%-5d couldn't load %s\n", "checkpoint", size, size, SNAPSHOT_PATH);
+        return;
+    }
+
+    double megabytes = 2.0 * field.stride * field.height * sizeof(RDReal) / 1e6;
+    printf("%-10s %5dx%-5d %10.1f %12.3f %12.3f %12.3f %12.1f\n", "checkpoint", size, size,
+        megabytes, stall * 1000.0, written * 1000.0, loadTime * 1000.0, megabytes / loadTime);
+    freeField(&field);
+}
+
+/// Step the seed squares without recording, then again recording a frame every so many generations,
+/// and print how much recording slowed stepping down, how long the longest copy stalled it for and
+/// how many frames were written or dropped
+/// @param size The width and height of the grid
+/// @param path The file or start of the file names to record to
+/// @param format The format to record in
+/// @param every The number of generations between frames
+/// @param generations The number of generations to step
+/// @param params The feed, kill and diffusion rates to use
+static void runRecord(int size, const char *path, RDRecordFormat format, int every, int generations,
+    const RDParams *params)
+{
+    RDField field;
+    if (!initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5))
+    {
+        printf("Couldn't allocate a %dx%d field\n", size, size);
+        exit(1);
+    }
+
+    double start = rdGetTime();
+    for (int done = 0; done < generations; done += every) stepFieldParallel(pool, &field, params, every);
+    double plainSeconds = rdGetTime() - start;
+    freeField(&field);
+
+    initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+    RDRecorder *recorder = createRecorder(path, format, size, size, every, 0);
+    if (recorder == NULL)
+    {
+        printf("Couldn't start recording to %s\n", path);
+        exit(1);
+    }
+
+    // Only the copy into a slot holds up stepping, the frames are encoded and written meanwhile
+    double maxStall = 0.0;
+    start = rdGetTime();
+    for (int done = 0; done < generations; done += every)
+    {
+        stepFieldParallel(pool, &field, params, every);
+        double copyStart = rdGetTime();
+        recordField(recorder, &field);
+        maxStall = fmax(maxStall, rdGetTime() - copyStart);
+    }
+    double recordSeconds = rdGetTime() - start;
+
+    // Whatever is still waiting is written before the recorder stops
+    RDRecordStats stats;
+    bool succeeded = freeRecorder(recorder, &stats);
+    double drainSeconds = rdGetTime() - start - recordSeconds;
+
+    printf("%-10s %5dx%-5d %4s %6d %8lld %8lld %8lld %10.1f %12.1f %12.1f %10.2f %10.3f%s\n", "record", size, size,
+        recordFormatName(format), every, stats.framesRecorded, stats.framesWritten, stats.framesDropped,
+        stats.bytesWritten / 1e6, generations / plainSeconds, generations / recordSeconds, maxStall * 1000.0,
+        drainSeconds, succeeded ? "" : " (write failed)");
+    freeField(&field);
+}
+
+/// Step this build's field alongside the original double array layout and print how far apart
+/// they end up, both in value and in the pattern and greys that are shown
+/// @param size The width and height of the grid
+/// @param steps The number of generations to step both for
+/// @param params The feed, kill and diffusion rates to use
+static void reportDivergence(int size, int steps, const RDParams *params)
+{
+    ArrayGrid reference;
+    RDField field;
+    if (!initialiseArrayGrid(&reference, size, size, SEED_FIVE_SQUARES, 5))
+    {
+        printf("Couldn't allocate a %dx%d grid\n", size, size);
+        exit(1);
+    }
+    if (!initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5))
+    {
+        printf("Couldn't allocate a %dx%d field\n", size, size);
+        exit(1);
+    }
+    for (int i = 0; i < steps; i++) stepArrayGrid(&reference, params);
+
+    double start = rdGetTime();
+    stepFieldParallel(pool, &field, params, steps);
+    double seconds = rdGetTime() - start;
+
+    double maxA = 0.0;
+    double maxB = 0.0;
+    double totalB = 0.0;
+    long long patternDiffers = 0;
+    long long greyDiffers = 0;
+
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            ArrayCell expected = reference.cells[reference.current][x][y];
+            double a = rdRealToDouble(fieldA(&field)[y * field.stride + x]);
+            double b = rdRealToDouble(fieldB(&field)[y * field.stride + x]);
+
+            maxA = fmax(maxA, fabs(a - expected.a));
+            maxB = fmax(maxB, fabs(b - expected.b));
+            totalB += fabs(b - expected.b);
+
+            // Whether the cell is part of the pattern, and the grey it's drawn with
+            patternDiffers += (b > RD_PATTERN_THRESHOLD) != (expected.b > RD_PATTERN_THRESHOLD);
+            int grey = (int) fmin(fmax((a - b) * 255, 0), 255);
+            int expectedGrey = (int) fmin(fmax((expected.a - expected.b) * 255, 0), 255);
+            greyDiffers += abs(grey - expectedGrey) > 1;
+        }
+    }
+
+    double cells = (double) size * size;
+    printf("%-10s %5dx%-5d %8d %12.3g %12.3g %12.3g %11.3f%% %11.3f%% %10.3f\n", RD_PRECISION_NAME, size, size, steps,
+        maxA, maxB, totalB / cells, patternDiffers * 100.0 / cells, greyDiffers * 100.0 / cells,
+        seconds * 1e9 / ((double) (size - 2) * (size - 2) * steps));
+
+    freeField(&field);
+    freeArrayGrid(&reference);
+}
+
+/// Get the fraction of cells in the pattern and the fraction of DEVELOPED_BLOCK_SIZE blocks the
+/// pattern has reached
+/// @param field The field to check
+/// @param pattern Set to the fraction of cells with b over RD_PATTERN_THRESHOLD
+/// @return The fraction of blocks with any cell in the pattern
+static double patternCoverage(const RDField *field, double *pattern)
+{
+    int blocksX = (field->width + DEVELOPED_BLOCK_SIZE - 1) / DEVELOPED_BLOCK_SIZE;
+    int blocksY = (field->height + DEVELOPED_BLOCK_SIZE - 1) / DEVELOPED_BLOCK_SIZE;
+    bool *reached = (bool *) calloc((size_t) blocksX * blocksY, sizeof(bool));
+    long long cells = 0;
+
+    const RDReal *b = fieldB(field);
+    for (int y = 0; y < field->height; y++)
+    {
+        for (int x = 0; x < field->width; x++)
+        {
+            bool inPattern = rdRealToDouble(b[y * field->stride + x]) > RD_PATTERN_THRESHOLD;
+            cells += inPattern;
+            if (inPattern) reached[(y / DEVELOPED_BLOCK_SIZE) * blocksX + x / DEVELOPED_BLOCK_SIZE] = true;
+        }
+    }
+
+    int blocks = 0;
+    for (int i = 0; i < blocksX * blocksY; i++) blocks += reached[i];
+    free(reached);
+
+    *pattern = (double) cells / ((double) field->width * field->height);
+    return (double) blocks / (blocksX * blocksY);
+}
+
+/// Step a field until its pattern has reached every part of it and stopped growing
+/// @param field The field to step
+/// @param params The feed, kill and diffusion rates to use
+/// @param maxSteps The generation to give up at
+/// @param pattern Set to the fraction of cells in the pattern at the end
+/// @return The number of generations stepped
+static long long stepUntilDeveloped(RDField *field, const RDParams *params, long long maxSteps, double *pattern)
+{
+    long long start = field->generation;
+    double lastPattern = -1.0;
+
+    while (field->generation < maxSteps)
+    {
+        double coverage = patternCoverage(field, pattern);
+        if (coverage >= DEVELOPED_COVERAGE && fabs(*pattern - lastPattern) < DEVELOPED_CHANGE) break;
+
+        lastPattern = *pattern;
+        stepFieldParallel(pool, field, params, DEVELOPED_CHECK_STEPS);
+    }
+
+    return field->generation - start;
+}
+
+/// Time developing a pattern from the seed squares directly and warm started from coarse stages,
+/// and print a line of results for each
+/// @param size The width and height of the grid
+/// @param stages The coarse stages of the warm start, coarsest first
+/// @param numStages The number of stages
+/// @param maxSteps The generation to give up developing at
+/// @param params The feed, kill and diffusion rates to use
+static void runWarmStart(int size, const RDWarmStage *stages, int numStages, long long maxSteps,
+    const RDParams *params)
+{
+    RDField field;
+    if (!initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5))
+    {
+        printf("Couldn't allocate a %dx%d field\n", size, size);
+        exit(1);
+    }
+
+    double pattern;
+    double start = rdGetTime();
+    long long directSteps = stepUntilDeveloped(&field, params, maxSteps, &pattern);
+    double directSeconds = rdGetTime() - start;
+    freeField(&field);
+
+    printf("%-10s %5dx%-5d %12lld %12lld %12.3f %10.1f%% %10s%s\n", "direct", size, size, directSteps, directSteps,
+        directSeconds, pattern * 100.0, "", directSteps >= maxSteps ? " (didn't develop)" : "");
+
+    start = rdGetTime();
+    if (!warmStartField(pool, &field, size, size, SEED_FIVE_SQUARES, 5, params, stages, numStages))
+    {
+        printf("Couldn't allocate a %dx%d field\n", size, size);
+        exit(1);
+    }
+    double coarseSeconds = rdGetTime() - start;
+    long long fullSteps = stepUntilDeveloped(&field, params, maxSteps, &pattern);
+    double warmSeconds = rdGetTime() - start;
+
+    printf("%-10s %5dx%-5d %12lld %12lld %12.3f %10.1f%% %9.2fx  %.3fs coarse%s\n", "warm", size, size,
+        field.generation, fullSteps, warmSeconds, pattern * 100.0, directSeconds / warmSeconds, coarseSeconds,
+        field.generation >= maxSteps ? " (didn't develop)" : "");
+
+    freeField(&field);
+}
+
+/// Parse a list of implicit timesteps separated by commas, e.g. "1,2,4,8"
+/// @param text The text to parse
+/// @param timeSteps Filled with the timesteps
+/// @param maxTimeSteps The most timesteps to fill
+/// @return The number of timesteps, 0 if the text isn't a list of positive whole numbers
+static int parseTimeSteps(const char *text, int *timeSteps, int maxTimeSteps)
+{
+    int numTimeSteps = 0;
+    while (*text != '\0' && numTimeSteps < maxTimeSteps)
+    {
+        char *end;
+        long timeStep = strtol(text, &end, 10);
+        if (end == text || timeStep <= 0 || (*end != ',' && *end != '\0')) return 0;
+
+        timeSteps[numTimeSteps++] = (int) timeStep;
+        text = *end == ',' ? end + 1 : end;
+    }
+    return numTimeSteps;
+}
+
+/// Print a line of results for one integrator against the explicit reference
+static void printIntegrator(const char *name, int size, int timeStep, long long timeSteps, double seconds,
+    const RDField *field, const RDField *expected)
+{
+    double maxDifference, pattern;
+    double differs = patternDifference(field, expected, &maxDifference);
+    patternCoverage(field, &pattern);
+
+    double generations = (double) field->generation;
+    printf("%-10s %5dx%-5d %4d %10lld %10.3f %12.2f %12.3g %10.2f%% %10.2f%%%s\n", name, size, size, timeStep,
+        timeSteps, seconds, generations / seconds, maxDifference, differs * 100.0, pattern * 100.0,
+        isfinite(maxDifference) ? "" : " (unstable)");
+}
+
+/// Step the seed squares the same number of generations explicitly a generation at a time, as the
+/// reference, then for each timestep explicitly with the rates scaled up to match and with the
+/// implicit integrator, and print how fast each got there and how far it ended up from the reference
+/// @param size The width and height of the grid
+/// @param timeSteps The timesteps to try, in generations
+/// @param numTimeSteps The number of timesteps
+/// @param generations The number of generations to advance
+/// @param params The feed, kill and diffusion rates to use
+static void runImplicit(int size, const int *timeSteps, int numTimeSteps, int generations, const RDParams *params)
+{
+    RDField expected, field;
+    if (!initialiseField(&expected, size, size, SEED_FIVE_SQUARES, 5))
+    {
+        printf("Couldn't allocate a %dx%d field\n", size, size);
+        exit(1);
+    }
+
+    double start = rdGetTime();
+    stepFieldParallel(pool, &expected, params, generations);
+    printIntegrator("explicit", size, 1, generations, rdGetTime() - start, &expected, &expected);
+
+    for (int t = 0; t < numTimeSteps; t++)
+    {
+        int timeStep = timeSteps[t];
+
+        // An explicit step of the rates times the timestep is an explicit timestep that long,
+        // which is what the implicit integrator has to beat
+        if (timeStep > 1)
+        {
+            RDParams scaled = { params->feedRate * timeStep, params->killRate * timeStep, params->dA * timeStep,
+                params->dB * timeStep };
+            initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+            start = rdGetTime();
+            stepFieldParallel(pool, &field, &scaled, generations / timeStep);
+            double seconds = rdGetTime() - start;
+            field.generation *= timeStep;
+            printIntegrator("explicit", size, timeStep, generations / timeStep, seconds, &field, &expected);
+            freeField(&field);
+        }
+
+        initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+        start = rdGetTime();
+        if (!stepFieldImplicit(pool, &field, params, generations, timeStep))
+        {
+            printf("Couldn't allocate the implicit integrator's scratch memory\n");
+            exit(1);
+        }
+        printIntegrator("implicit", size, timeStep, (generations + timeStep - 1) / timeStep, rdGetTime() - start,
+            &field, &expected);
+        freeField(&field);
+    }
+
+    freeField(&expected);
+}
+
+/// Time a field kernel stepping with the params' feed and kill rates and with the rate map in
+/// rateSource, taking turns so both see the same conditions, and print a line of the best of each
+/// @param kernel The kernel to time, a field kernel
+/// @param size The width and height of the grid
+/// @param steps The number of generations to time each turn, or 0 to run for minTime instead
+/// @param minTime The minimum number of seconds to run each turn for when steps is 0
+/// @param params The diffusion rates to use, and the feed and kill rates without the map
+static void runRates(const Kernel *kernel, int size, int steps, double minTime, const RDParams *params)
+{
+    BenchField *uniform = (BenchField *) kernel->create(size, kernel->option);
+    BenchField *mapped = (BenchField *) kernel->create(size, kernel->option);
+    removeFieldRates(&uniform->field);
+
+    double uniformRate = 0.0;
+    double mappedRate = 0.0;
+    for (int r = 0; r < RATES_REPEATS; r++)
+    {
+        double seconds;
+        int done = timeSteps(kernel, uniform, steps, minTime, params, &seconds);
+        uniformRate = fmax(uniformRate, done / seconds);
+        done = timeSteps(kernel, mapped, steps, minTime, params, &seconds);
+        mappedRate = fmax(mappedRate, done / seconds);
+    }
+
+    printf("%-10s %5dx%-5d %12.2f %12.2f %+9.1f%%\n", kernel->name, size, size, uniformRate, mappedRate,
+        (mappedRate / uniformRate - 1.0) * 100.0);
+
+    kernel->destroy(uniform);
+    kernel->destroy(mapped);
+}
+
+/// A kernel's state after a fixed number of generations from the seed, as kept in the golden file
+typedef struct {
+    char kernel[16];
+    char precision[16];
+    int size;
+    int steps;
+    uint64_t hash;                              // Of the bits of every a and b, so any change shows
+    double meanA;
+    double blocksB[GOLDEN_BLOCKS * GOLDEN_BLOCKS];  // The mean b of each block, to tell how far off a change is
+} GoldenState;
+
+/// Step a kernel from its seed and record the state it ends up in
+/// @param kernel The kernel to step
+/// @param size The width and height of the grid
+/// @param steps The number of generations to step
+/// @param params The feed, kill and diffusion rates to use
+/// @param seconds Set to how long the fastest generations took each
+/// @return The state the grid ended up in
+static GoldenState measureGolden(const Kernel *kernel, int size, int steps, const RDParams *params, double *seconds)
+{
+    GoldenState state = { { 0 } };
+    snprintf(state.kernel, sizeof(state.kernel), "%s", kernel->name);
+    snprintf(state.precision, sizeof(state.precision), "%s", kernel->option >= 0 ? RD_PRECISION_NAME : "double");
+    state.size = size;
+    state.steps = steps;
+
+    // Timed in batches and the fastest one kept, so one interruption doesn't read as a slowdown
+    void *grid = kernel->create(size, kernel->option);
+    *seconds = INFINITY;
+    for (int done = 0; done < steps; done += GOLDEN_TIMING_STEPS)
+    {
+        int batch = steps - done < GOLDEN_TIMING_STEPS ? steps - done : GOLDEN_TIMING_STEPS;
+        double start = rdGetTime();
+        kernel->step(grid, params, batch);
+        *seconds = fmin(*seconds, (rdGetTime() - start) / batch);
+    }
+
+    // FNV-1a over each value widened to a double, which is exact for every precision
+    state.hash = 14695981039346656037ULL;
+    double totalA = 0.0;
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            double values[2];
+            kernel->getCell(grid, x, y, &values[0], &values[1]);
+
+            const unsigned char *bytes = (const unsigned char *) values;
+            for (size_t i = 0; i < sizeof(values); i++) state.hash = (state.hash ^ bytes[i]) * 1099511628211ULL;
+
+            totalA += values[0];
+            state.blocksB[(y * GOLDEN_BLOCKS / size) * GOLDEN_BLOCKS + x * GOLDEN_BLOCKS / size] += values[1];
+        }
+    }
+
+    state.meanA = totalA / ((double) size * size);
+    for (int by = 0; by < GOLDEN_BLOCKS; by++)
+    {
+        for (int bx = 0; bx < GOLDEN_BLOCKS; bx++)
+        {
+            int width = (bx + 1) * size / GOLDEN_BLOCKS - bx * size / GOLDEN_BLOCKS;
+            int height = (by + 1) * size / GOLDEN_BLOCKS - by * size / GOLDEN_BLOCKS;
+            state.blocksB[by * GOLDEN_BLOCKS + bx] /= (double) width * height;
+        }
+    }
+
+    kernel->destroy(grid);
+    return state;
+}
+
+/// Get the largest difference between the means of two states
+/// @param state The state to check
+/// @param expected The state it should match
+/// @return The largest difference in the mean a or any block's mean b
+static double goldenDifference(const GoldenState *state, const GoldenState *expected)
+{
+    double difference = fabs(state->meanA - expected->meanA);
+    for (int i = 0; i < GOLDEN_BLOCKS * GOLDEN_BLOCKS; i++)
+    {
+        difference = fmax(difference, fabs(state->blocksB[i] - expected->blocksB[i]));
+    }
+    return difference;
+}
+
+/// Read the states in a golden file, a line for each written kernel precision size steps hash
+/// mean-a then each block's mean b, with # starting a comment
+/// @param path The file to read
+/// @param states Filled with the states read
+/// @param maxStates The most states to read
+/// @return The number of states read, 0 if the file doesn't exist
+static int loadGoldenStates(const char *path, GoldenState *states, int maxStates)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return 0;
+
+    int numStates = 0;
+    char line[4096];
+    while (numStates < maxStates && fgets(line, sizeof(line), file) != NULL)
+    {
+        GoldenState *state = &states[numStates];
+        int offset;
+        if (line[0] == '#' || sscanf(line, "%15s %15s %d %d %" SCNx64 " %lf%n", state->kernel, state->precision,
+            &state->size, &state->steps, &state->hash, &state->meanA, &offset) != 6) continue;
+
+        const char *next = line + offset;
+        int blocks = 0;
+        while (blocks < GOLDEN_BLOCKS * GOLDEN_BLOCKS && sscanf(next, "%lf%n", &state->blocksB[blocks], &offset) == 1)
+        {
+            next += offset;
+            blocks++;
+        }
+        if (blocks == GOLDEN_BLOCKS * GOLDEN_BLOCKS) numStates++;
+    }
+
+    fclose(file);
+    return numStates;
+}
+
+/// Write states to a golden file, replacing what was there
+/// @param path The file to write
+/// @param states The states to write
+/// @param numStates The number of states
+/// @return False if the file couldn't be written
+static bool saveGoldenStates(const char *path, const GoldenState *states, int numStates)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL) return false;
+
+    fprintf(file, "# The state each kernel reaches from its seed, checked by rd_bench --golden and rewritten by\n"
+        "# --update-golden. Each line is kernel precision size steps hash mean-a then the mean b of each\n"
+        "# of %dx%d blocks, the hash covers the bits of every cell.\n", GOLDEN_BLOCKS, GOLDEN_BLOCKS);
+    for (int i = 0; i < numStates; i++)
+    {
+        fprintf(file, "%s %s %d %d %016" PRIx64 " %.17g", states[i].kernel, states[i].precision, states[i].size,
+            states[i].steps, states[i].hash, states[i].meanA);
+        for (int b = 0; b < GOLDEN_BLOCKS * GOLDEN_BLOCKS; b++) fprintf(file, " %.17g", states[i].blocksB[b]);
+        fprintf(file, "\n");
+    }
+
+    return fclose(file) == 0;
+}
+
+/// Find the state in a list with the same kernel, precision, size and steps as another
+/// @param states The states to search
+/// @param numStates The number of states
+/// @param match The state to match
+/// @return The matching state, or NULL if there isn't one
+static GoldenState *findGoldenState(GoldenState *states, int numStates, const GoldenState *match)
+{
+    for (int i = 0; i < numStates; i++)
+    {
+        if (strcmp(states[i].kernel, match->kernel) == 0 && strcmp(states[i].precision, match->precision) == 0
+            && states[i].size == match->size && states[i].steps == match->steps) return &states[i];
+    }
+    return NULL;
+}
+
+/// Get the median speed of the last HISTORY_RUNS runs of a kernel recorded in a history file
+/// @param path The history file, a CSV line for each run
+/// @param machine The machine the runs have to be from
+/// @param state The kernel, precision, size and steps the runs have to match
+/// @param threads The number of threads the runs have to have used
+/// @return The median steps/sec, or 0 if there are fewer than HISTORY_MIN_RUNS matching runs
+static double historyBaseline(const char *path, const char *machine, const GoldenState *state, int threads)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return 0.0;
+
+    double speeds[HISTORY_RUNS];
+    int numRuns = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char lineMachine[256], kernel[16], precision[16];
+        int size, steps, lineThreads;
+        double speed;
+        if (sscanf(line, "%*[^,],%255[^,],%15[^,],%15[^,],%d,%d,%d,%lf", lineMachine, precision, kernel, &size, &steps,
+            &lineThreads, &speed) != 7) continue;
+
+        if (strcmp(lineMachine, machine) == 0 && strcmp(precision, state->precision) == 0
+            && strcmp(kernel, state->kernel) == 0 && size == state->size && steps == state->steps
+            && lineThreads == threads)
+        {
+            speeds[numRuns++ % HISTORY_RUNS] = speed;
+        }
+    }
+    fclose(file);
+
+    // One or two runs are too few to tell a slowdown from a run that happened to be quick
+    if (numRuns < HISTORY_MIN_RUNS) return 0.0;
+    int count = numRuns < HISTORY_RUNS ? numRuns : HISTORY_RUNS;
+
+    // Sort the few speeds to take the median
+    for (int i = 1; i < count; i++)
+    {
+        for (int j = i; j > 0 && speeds[j - 1] > speeds[j]; j--)
+        {
+            double swap = speeds[j];
+            speeds[j] = speeds[j - 1];
+            speeds[j - 1] = swap;
+        }
+    }
+    return count % 2 == 1 ? speeds[count / 2] : 0.5 * (speeds[count / 2 - 1] + speeds[count / 2]);
+}
+
+/// Add a run to a history file, starting it with a header if it's new
+/// @param path The history file
+/// @param machine The machine the run was on
+/// @param state The kernel, precision, size and steps of the run
+/// @param threads The number of threads the run used
+/// @param speed The steps/sec it reached
+static void appendHistory(const char *path, const char *machine, const GoldenState *state, int threads,
+    double speed)
+{
+    FILE *file = fopen(path, "a+");
+    if (file == NULL)
+    {
+        printf("Couldn't open the history file %s\n", path);
+        return;
+    }
+
+    fseek(file, 0, SEEK_END);
+    if (ftell(file) == 0) fprintf(file, "time,machine,precision,kernel,size,steps,threads,steps_per_sec\n");
+
+    char timestamp[32];
+    time_t now = time(NULL);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    fprintf(file, "%s,%s,%s,%s,%d,%d,%d,%.3f\n", timestamp, machine, state->precision, state->kernel, state->size,
+        state->steps, threads, speed);
+    fclose(file);
+}
+
+/// Step every supported kernel from its seed, compare where each ends up with the golden file and
+/// with the scalar kernel, and record and compare how fast each was
+/// @param goldenPath The golden file
+/// @param update Whether to rewrite this build's states in the golden file instead of checking them
+/// @param historyPath The history file to record speeds in, or NULL not to
+/// @param slowdown The fraction slower than the recent runs in the history that's flagged
+/// @param kernelName The kernel to run, or all
+/// @param size The width and height of the grid
+/// @param steps The number of generations to step
+/// @param params The feed, kill and diffusion rates to use
+/// @return False if any kernel differs from its golden state or has slowed down
+static bool runGolden(const char *goldenPath, bool update, const char *historyPath, double slowdown,
+    const char *kernelName, int size, int steps, const RDParams *params)
+{
+    static GoldenState states[GOLDEN_MAX_STATES];
+    int numStates = loadGoldenStates(goldenPath, states, GOLDEN_MAX_STATES);
+
+    GoldenState measured[NUM_KERNELS];
+    double speeds[NUM_KERNELS];
+    bool ran[NUM_KERNELS] = { false };
+    const GoldenState *scalar = NULL;
+
+    for (int k = 0; k < NUM_KERNELS; k++)
+    {
+        if (strcmp(kernelName, "all") != 0 && strcmp(kernelName, kernels[k].name) != 0) continue;
+        if (kernels[k].option >= 0 && !rdKernelSupported(kernels[k].option)) continue;
+
+        // The original layouts only step doubles, so only the double build checks and times them,
+        // otherwise every build would add runs of them to the same rows of the history
+#if RD_PRECISION != RD_PRECISION_DOUBLE
+        if (kernels[k].option < 0)
+        {
+            if (strcmp(kernelName, "all") != 0) printf("%-10s only runs in the double build\n", kernels[k].name);
+            continue;
+        }
+#endif
+
+        double seconds;
+        measured[k] = measureGolden(&kernels[k], size, steps, params, &seconds);
+        speeds[k] = 1.0 / seconds;
+        ran[k] = true;
+        if (kernels[k].option == KERNEL_SCALAR) scalar = &measured[k];
+    }
+
+    char machine[256];
+    rdMachineName(machine, sizeof(machine));
+    bool passed = true;
+
+    for (int k = 0; k < NUM_KERNELS; k++)
+    {
+        if (!ran[k]) continue;
+
+        // Checked against the golden state, and how far off the scalar kernel it is for comparison
+        GoldenState *golden = findGoldenState(states, numStates, &measured[k]);
+        char result[32];
+        if (update)
+        {
+            if (golden == NULL && numStates < GOLDEN_MAX_STATES) golden = &states[numStates++];
+            if (golden != NULL) *golden = measured[k];
+            snprintf(result, sizeof(result), "updated");
+        }
+        else if (golden == NULL)
+        {
+            snprintf(result, sizeof(result), "no golden");
+        }
+        else if (golden->hash == measured[k].hash)
+        {
+            snprintf(result, sizeof(result), "exact");
+        }
+        else
+        {
+            double difference = goldenDifference(&measured[k], golden);
+            snprintf(result, sizeof(result), "%s %.2g", difference <= GOLDEN_TOLERANCE ? "within" : "DIFFERS", difference);
+            passed = passed && difference <= GOLDEN_TOLERANCE;
+        }
+
+        char agreement[16] = "";
+        if (scalar != NULL) snprintf(agreement, sizeof(agreement), "%.2g", goldenDifference(&measured[k], scalar));
+
+        // Compared with the recent runs on this machine before this one is added to them
+        int threads = kernels[k].option >= 0 ? workerPoolSize(pool) : 1;
+        double baseline = historyPath != NULL ? historyBaseline(historyPath, machine, &measured[k], threads) : 0.0;
+        bool slower = baseline > 0.0 && speeds[k] < baseline * (1.0 - slowdown);
+        passed = passed && !slower;
+        if (historyPath != NULL) appendHistory(historyPath, machine, &measured[k], threads, speeds[k]);
+
+        char change[16] = "";
+        if (baseline > 0.0) snprintf(change, sizeof(change), "%+.1f%%", (speeds[k] / baseline - 1.0) * 100.0);
+
+        printf("%-10s %5dx%-5d %8d %-9s %-14s %10s %12.2f %10s%s\n", kernels[k].name, size, size, steps,
+            measured[k].precision, result, agreement, speeds[k], change, slower ? " SLOWER" : "");
+    }
+
+    if (update && !saveGoldenStates(goldenPath, states, numStates))
+    {
+        printf("Couldn't write the golden file %s\n", goldenPath);
+        return false;
+    }
+
+    return passed;
+}
+
+static void printUsage(void)
+{
+    printf("Usage: rd_bench [--kernel all|neighbour|array|scalar|sse2|avx2|avx512] [--steps n] [--time seconds] [--threads n] [--colour]\n"
+        "    [--palette name] [--tiles n] [--epsilon e] [--block-steps k] [--block-size n] [--async] [--steps-per-frame n] [--view] [--checkpoint]\n"
+        "    [--warm-start scale:steps,...] [--processes n] [--transport shm|socket] [--divergence]\n"
+        "    [--golden file] [--update-golden] [--history file] [--slowdown fraction] [--tune] [--implicit dt,...]\n"
+        "    [--record path] [--record-format y4m|ppm|pgm] [--record-every n] [--rates gradient|feed.pgm,kill.pgm]\n"
+        "    [--verify] [size ...]\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *kernelName = "all";
+    int steps = 0;
+    double minTime = DEFAULT_MIN_TIME;
+    int sizes[32];
+    int numSizes = 0;
+    bool verify = false;
+    int threads = 1;
+    bool async = false;
+    int stepsPerFrame = 1;
+    bool checkpoint = false;
+    bool viewport = false;
+    bool divergence = false;
+    const char *warmStart = NULL;
+    int processes = 0;
+    RDHaloTransport transport = HALO_SHARED_MEMORY;
+    const char *goldenPath = NULL;
+    bool updateGolden = false;
+    const char *historyPath = NULL;
+    double slowdown = DEFAULT_SLOWDOWN;
+    bool tune = false;
+    const char *paletteName = NULL;
+    const char *implicit = NULL;
+    const char *recordPath = NULL;
+    RDRecordFormat recordFormat = RECORD_Y4M;
+    int recordEvery = RECORD_EVERY;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) kernelName = argv[++i];
+        else if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc) steps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) minTime = atof(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--colour") == 0) timeColour = true;
+        else if (strcmp(argv[i], "--palette") == 0 && i + 1 < argc) paletteName = argv[++i];
+        else if (strcmp(argv[i], "--tiles") == 0 && i + 1 < argc) tileSize = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--epsilon") == 0 && i + 1 < argc) tileEpsilon = atof(argv[++i]);
+        else if (strcmp(argv[i], "--block-steps") == 0 && i + 1 < argc) blockSteps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--block-size") == 0 && i + 1 < argc) blockSize = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--async") == 0) async = true;
+        else if (strcmp(argv[i], "--steps-per-frame") == 0 && i + 1 < argc) stepsPerFrame = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--view") == 0) viewport = true;
+        else if (strcmp(argv[i], "--checkpoint") == 0) checkpoint = true;
+        else if (strcmp(argv[i], "--warm-start") == 0 && i + 1 < argc) warmStart = argv[++i];
+        else if (strcmp(argv[i], "--processes") == 0 && i + 1 < argc) processes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--transport") == 0 && i + 1 < argc)
+        {
+            const char *name = argv[++i];
+            if (strcmp(name, "shm") != 0 && strcmp(name, "socket") != 0)
+            {
+                printUsage();
+                return 1;
+            }
+            transport = strcmp(name, "socket") == 0 ? HALO_SOCKET : HALO_SHARED_MEMORY;
+        }
+        else if (strcmp(argv[i], "--divergence") == 0) divergence = true;
+        else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) goldenPath = argv[++i];
+        else if (strcmp(argv[i], "--update-golden") == 0) updateGolden = true;
+        else if (strcmp(argv[i], "--history") == 0 && i + 1 < argc) historyPath = argv[++i];
+        else if (strcmp(argv[i], "--slowdown") == 0 && i + 1 < argc) slowdown = atof(argv[++i]);
+        else if (strcmp(argv[i], "--tune") == 0) tune = true;
+        else if (strcmp(argv[i], "--implicit") == 0 && i + 1 < argc) implicit = argv[++i];
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordPath = argv[++i];
+        else if (strcmp(argv[i], "--record-format") == 0 && i + 1 < argc)
+        {
+            if (!findRecordFormat(argv[++i], &recordFormat))
+            {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--record-every") == 0 && i + 1 < argc) recordEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rates") == 0 && i + 1 < argc) rateSource = argv[++i];
+        else if (strcmp(argv[i], "--verify") == 0) verify = true;
+        else if (argv[i][0] != '-' && numSizes < 32) sizes[numSizes++] = atoi(argv[i]);
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (paletteName != NULL)
+    {
+        const RDPalette *palette = findPalette(paletteName);
+        if (palette == NULL)
+        {
+            printf("There's no palette called %s, it should be one of", paletteName);
+            for (int p = 0; p < RD_PALETTE_COUNT; p++) printf(" %s", getPalette(p)->name);
+            printf("\n");
+            return 1;
+        }
+        setColourPalette(palette);
+    }
+
+    RDWarmStage warmStages[RD_MAX_WARM_STAGES];
+    int numWarmStages = warmStart != NULL ? parseWarmStages(warmStart, warmStages, RD_MAX_WARM_STAGES) : 0;
+    if (warmStart != NULL && numWarmStages == 0)
+    {
+        printf("Couldn't parse the warm start stages %s, they should be written like 4:3000,2:1000\n", warmStart);
+        return 1;
+    }
+
+    int timeSteps[16];
+    int numTimeSteps = implicit != NULL ? parseTimeSteps(implicit, timeSteps, 16) : 0;
+    if (implicit != NULL && numTimeSteps == 0)
+    {
+        printf("Couldn't parse the timesteps %s, they should be written like 1,2,4,8\n", implicit);
+        return 1;
+    }
+
+    // The grids are seeded with both layouts, which the field and grid initialisers refuse to place
+    // over the border, so a grid too small for them is turned down before anything is stepped
+    for (int i = 0; i < numSizes; i++)
+    {
+        if (!rdSeedFits(SEED_FIVE_SQUARES, sizes[i], sizes[i], 5)
+            || !rdSeedFits(SEED_CENTRE_SQUARE, sizes[i], sizes[i], 5))
+        {
+            printf("Grid size %d is too small for the seed squares\n", sizes[i]);
+            return 1;
+        }
+    }
+
+    if (rateSource != NULL)
+    {
+        // Found out now rather than after the first header has been printed
+        RDField check;
+        bool made = initialiseField(&check, 16, 16, SEED_CENTRE_SQUARE, 0) && applyRates(&check, rateSource);
+        freeField(&check);
+        if (!made)
+        {
+            printf("Couldn't make the rate map %s, it should be gradient or greyscale PGMs like feed.pgm,kill.pgm\n",
+                rateSource);
+            return 1;
+        }
+    }
+
+    if (rateSource != NULL && goldenPath != NULL)
+    {
+        printf("--golden checks the states the default rates reach, so it can't be used with --rates\n");
+        return 1;
+    }
+
+    if (goldenPath == NULL && (updateGolden || historyPath != NULL))
+    {
+        printf("--update-golden and --history need --golden to say which golden file to use\n");
+        return 1;
+    }
+
+    if (numSizes == 0 && goldenPath != NULL)
+    {
+        sizes[numSizes++] = GOLDEN_SIZE;
+    }
+    else if (numSizes == 0)
+    {
+        sizes[numSizes++] = 200;
+        sizes[numSizes++] = 1024;
+    }
+
+    RDParams params = RD_DEFAULT_PARAMS;
+
+    // The worker processes start their own pools, so this one's pool would sit idle
+    if (processes > 0)
+    {
+        printf("%-10s %11s %9s %8s %12s %14s %10s %12s\n", "transport", "grid", "processes", "steps", "steps/sec",
+            "cells/sec", "ns/cell", "gather ms");
+        for (int i = 0; i < numSizes; i++)
+        {
+            runDomain(sizes[i], processes, threads, transport, minTime, &params);
+            fflush(stdout);
+        }
+        return 0;
+    }
+
+    // The domain backend forks worker processes, which start their own pools
+    if (tune)
+    {
+        printf("%-38s %11s %12s %14s\n", "backend", "grid", "steps/sec", "cells/sec");
+        for (int i = 0; i < numSizes; i++)
+        {
+            runTune(sizes[i], minTime != DEFAULT_MIN_TIME ? minTime : TUNE_SECONDS, &params);
+            fflush(stdout);
+        }
+        return 0;
+    }
+
+    // Worker processes are forked, so the checks that fork them run before this process starts any threads
+    bool forkedPassed = true;
+    for (int i = 0; verify && i < numSizes; i++)
+    {
+        forkedPassed = runVerifyChecks(NULL, true, sizes[i], steps > 0 ? steps : VERIFY_STEPS, &params) && forkedPassed;
+    }
+
+    if (threads != 1)
+    {
+        pool = createWorkerPool(threads);
+        if (pool == NULL)
+        {
+            printf("Couldn't start the worker pool\n");
+            return 1;
+        }
+        printf("Stepping field kernels with %d threads\n", workerPoolSize(pool));
+    }
+
+    if (verify)
+    {
+        bool passed = forkedPassed;
+        for (int i = 0; i < numSizes; i++)
+        {
+            passed = runVerifyChecks(pool, false, sizes[i], steps > 0 ? steps : VERIFY_STEPS, &params) && passed;
+        }
+        freeWorkerPool(pool);
+        return passed ? 0 : 1;
+    }
+
+    if (goldenPath != NULL)
+    {
+        bool passed = true;
+        printf("%-10s %11s %8s %-9s %-14s %10s %12s %10s\n", "kernel", "grid", "steps", "precision", "golden",
+            "vs scalar", "steps/sec", "vs recent");
+        for (int i = 0; i < numSizes; i++)
+        {
+            passed = runGolden(goldenPath, updateGolden, historyPath, slowdown, kernelName, sizes[i],
+                steps > 0 ? steps : GOLDEN_STEPS, &params) && passed;
+            fflush(stdout);
+        }
+        freeWorkerPool(pool);
+        return passed ? 0 : 1;
+    }
+
+    if (divergence)
+    {
+        printf("%-10s %11s %8s %12s %12s %12s %12s %12s %10s\n", "precision", "grid", "steps", "max a diff",
+            "max b diff", "mean b diff", "pattern", "greys", "ns/cell");
+        for (int i = 0; i < numSizes; i++)
+        {
+            reportDivergence(sizes[i], steps > 0 ? steps : DIVERGENCE_STEPS, &params);
+            fflush(stdout);
+        }
+        freeWorkerPool(pool);
+        return 0;
+    }
+
+    if (numTimeSteps > 0)
+    {
+        printf("%-10s %11s %4s %10s %10s %12s %12s %11s %11s\n", "integrator", "grid", "dt", "timesteps", "seconds",
+            "gens/sec", "max b diff", "pattern", "coverage");
+        for (int i = 0; i < numSizes; i++)
+        {
+            runImplicit(sizes[i], timeSteps, numTimeSteps, steps > 0 ? steps : IMPLICIT_GENERATIONS, &params);
+            fflush(stdout);
+        }
+        freeWorkerPool(pool);
+        return 0;
+    }
+
+    if (numWarmStages > 0)
+    {
+        printf("%-10s %11s %12s %12s %12s %11s %10s\n", "mode", "grid", "generations", "full steps", "seconds",
+            "pattern", "speedup");
+        for (int i = 0; i < numSizes; i++)
+        {
+            runWarmStart(sizes[i], warmStages, numWarmStages, steps > 0 ? steps : DEVELOPED_MAX_STEPS, &params);
+            fflush(stdout);
+        }
+        freeWorkerPool(pool);
+        return 0;
+    }
+
+    if (viewport)
+    {
+        printf("%-10s %11s %8s %6s %12s %12s\n", "colour", "grid", "zoom", "level", "ms/frame", "ns/pixel");
+        for (int i = 0; i < numSizes; i++)
+        {
+            runView(sizes[i], &params);
+            fflush(stdout);
+        }
+        freeWorkerPool(pool);
+        return 0;
+    }
+
+    if (recordPath != NULL && !async)
+    {
+        printf("%-10s %11s %4s %6s %8s %8s %8s %10s %12s %12s %10s %10s\n", "mode", "grid", "fmt", "every",
+            "frames", "written", "dropped", "MB", "steps/sec", "recording", "stall ms", "drain s");
+        for (int i = 0; i < numSizes; i++)
+        {
+            runRecord(sizes[i], recordPath, recordFormat, recordEvery > 0 ? recordEvery : 1,
+                steps > 0 ? steps : RECORD_GENERATIONS, &params);
+            fflush(stdout);
+        }
+        freeWorkerPool(pool);
+        return 0;
+    }
+
+    if (checkpoint)
+    {
+        printf("%-10s %11s %10s %12s %12s %12s %12s\n", "mode", "grid", "MB", "stall ms", "written ms",
+            "load ms", "load MB/s");
+        for (int i = 0; i < numSizes; i++)
+        {
+            runCheckpoint(sizes[i], &params);
+            fflush(stdout);
+        }
+        freeWorkerPool(pool);
+        return 0;
+    }
+
+    if (async)
+    {
+        // The simulation thread only has the coloured frames to record
+        if (recordPath != NULL && recordFormat == RECORD_PGM)
+        {
+            printf("--async records the frames it publishes, which are coloured, so only as y4m or ppm\n");
+            return 1;
+        }
+
+        printf("%-10s %11s %8s %12s %14s %10s %12s %12s %10s\n", "mode", "grid", "steps", "steps/sec",
+            "publishes/sec", "displayed", "stale ms", "max stale ms", "behind");
+        for (int i = 0; i < numSizes; i++)
+        {
+            // Each published frame is recorded, so it's up to --steps-per-frame how often that is
+            RDRecorder *recorder = NULL;
+            if (recordPath != NULL)
+            {
+                recorder = createRecorder(recordPath, recordFormat, sizes[i], sizes[i], 1, 0);
+                if (recorder == NULL)
+                {
+                    printf("Couldn't start recording to %s\n", recordPath);
+                    return 1;
+                }
+            }
+
+            runAsync(sizes[i], stepsPerFrame, minTime, &params, recorder);
+
+            RDRecordStats stats;
+            if (recorder != NULL)
+            {
+                if (!freeRecorder(recorder, &stats)) printf("Couldn't write every frame to %s\n", recordPath);
+                printf("%-10s %5dx%-5d %lld frames recorded, %lld written, %lld dropped, %.1f MB\n", "record",
+                    sizes[i], sizes[i], stats.framesRecorded, stats.framesWritten, stats.framesDropped,
+                    stats.bytesWritten / 1e6);
+            }
+            fflush(stdout);
+        }
+        freeWorkerPool(pool);
+        return 0;
+    }
+
+    bool ranKernel = false;
+
+    if (rateSource != NULL)
+    {
+        printf("%-10s %11s %12s %12s %10s\n", "kernel", "grid", "uniform", "rate map", "change");
+    }
+    else
+    {
+        printf("%-10s %11s %8s %12s %14s %10s\n", "kernel", "grid", "steps", "steps/sec", "cells/sec", "ns/cell");
+    }
+
+    for (int k = 0; k < NUM_KERNELS; k++)
+    {
+        if (strcmp(kernelName, "all") != 0 && strcmp(kernelName, kernels[k].name) != 0) continue;
+
+        // The original layouts only step with the params' rates
+        if (rateSource != NULL && kernels[k].option < 0)
+        {
+            if (strcmp(kernelName, "all") != 0) printf("%-10s can't step with a rate map\n", kernels[k].name);
+            ranKernel = true;
+            continue;
+        }
+
+        if (kernels[k].option >= 0 && !rdKernelSupported(kernels[k].option))
+        {
+            printf("%-10s not supported on this machine\n", kernels[k].name);
+            ranKernel = true;
+            continue;
+        }
+
+        for (int i = 0; i < numSizes; i++)
+        {
+            if (rateSource != NULL) runRates(&kernels[k], sizes[i], steps, minTime, &params);
+            else runKernel(&kernels[k], sizes[i], steps, minTime, &params);
+            fflush(stdout);
+        }
+        ranKernel = true;
+    }
+
+    freeWorkerPool(pool);
+
+    if (!ranKernel)
+    {
+        printf("Unknown kernel %s\n", kernelName);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+// Steps a field several generations at a time, one cache sized block at a time
+
+#include "rd_blocking.h"
+#include <stdlib.h>
+#include <string.h>
+
+/// The data for stepping every block of a field a number of generations
+typedef struct {
+    RDField *field;
+    const RDParams *params;
+    RDField *scratch;       // One scratch field per thread
+    int blockSize;
+    int blockSteps;
+    int blocksX;
+    int blocksY;
+} BlockJob;
+
+static inline int minInt(int a, int b)
+{
+    return a < b ? a : b;
+}
+
+static inline int maxInt(int a, int b)
+{
+    return a > b ? a : b;
+}
+
+/// Copy a rectangle of both chemicals from one pair of planes to another
+static void copyRect(const RDReal *aFrom, const RDReal *bFrom, int fromStride, RDReal *aTo, RDReal *bTo,
+    int toStride, int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        memcpy(aTo + (size_t) y * toStride, aFrom + (size_t) y * fromStride, width * sizeof(RDReal));
+        memcpy(bTo + (size_t) y * toStride, bFrom + (size_t) y * fromStride, width * sizeof(RDReal));
+    }
+}
+
+/// Step one block of the field blockSteps generations, writing it to the field's next generation
+static void stepBlock(const BlockJob *job, RDField *scratch, int block)
+{
+    RDField *field = job->field;
+    int k = job->blockSteps;
+
+    int left = (block % job->blocksX) * job->blockSize;
+    int top = (block / job->blocksX) * job->blockSize;
+    int right = minInt(left + job->blockSize, field->width);
+    int bottom = minInt(top + job->blockSize, field->height);
+
+    // The block and its halo, clipped to the field
+    int haloLeft = maxInt(left - k, 0);
+    int haloTop = maxInt(top - k, 0);
+    int haloRight = minInt(right + k, field->width);
+    int haloBottom = minInt(bottom + k, field->height);
+
+    size_t origin = (size_t) haloTop * field->stride + haloLeft;
+    int haloWidth = haloRight - haloLeft;
+    int haloHeight = haloBottom - haloTop;
+    copyRect(field->a[field->current] + origin, field->b[field->current] + origin, field->stride,
+        scratch->a[0], scratch->b[0], scratch->stride, haloWidth, haloHeight);
+
+    // Any of the field's border inside the halo is never stepped, so the other scratch generation
+    // needs a copy of it too to read the same whichever one is current
+    if (haloTop == 0) copyRect(scratch->a[0], scratch->b[0], scratch->stride, scratch->a[1], scratch->b[1],
+        scratch->stride, haloWidth, 1);
+    if (haloBottom == field->height)
+    {
+        size_t last = (size_t) (haloHeight - 1) * scratch->stride;
+        copyRect(scratch->a[0] + last, scratch->b[0] + last, scratch->stride, scratch->a[1] + last,
+            scratch->b[1] + last, scratch->stride, haloWidth, 1);
+    }
+    if (haloLeft == 0) copyRect(scratch->a[0], scratch->b[0], scratch->stride, scratch->a[1], scratch->b[1],
+        scratch->stride, 1, haloHeight);
+    if (haloRight == field->width)
+    {
+        copyRect(scratch->a[0] + haloWidth - 1, scratch->b[0] + haloWidth - 1, scratch->stride,
+            scratch->a[1] + haloWidth - 1, scratch->b[1] + haloWidth - 1, scratch->stride, 1, haloHeight);
+    }
+    scratch->current = 0;
+    shareFieldRates(scratch, &field->rates, haloLeft, haloTop);
+
+    // After each generation one less ring of the halo is still valid, the border of the field
+    // stays valid because it never changes
+    for (int g = 1; g <= k; g++)
+    {
+        int stepLeft = maxInt(left - (k - g), 1);
+        int stepTop = maxInt(top - (k - g), 1);
+        int stepRight = minInt(right + (k - g), field->width - 1);
+        int stepBottom = minInt(bottom + (k - g), field->height - 1);
+
+        stepFieldRect(scratch, job->params, stepLeft - haloLeft, stepTop - haloTop,
+            stepRight - haloLeft, stepBottom - haloTop);
+        swapField(scratch);
+    }
+
+    // Write just the block back, the halo belongs to the neighbouring blocks
+    size_t blockOrigin = (size_t) top * field->stride + left;
+    size_t scratchOrigin = (size_t) (top - haloTop) * scratch->stride + (left - haloLeft);
+    copyRect(scratch->a[scratch->current] + scratchOrigin, scratch->b[scratch->current] + scratchOrigin,
+        scratch->stride, field->a[1 - field->current] + blockOrigin, field->b[1 - field->current] + blockOrigin,
+        field->stride, right - left, bottom - top);
+}
+
+/// Step one thread's share of the blocks
+static void stepBlockShare(void *data, int thread, int numThreads)
+{
+    BlockJob *job = (BlockJob *) data;
+
+    for (int block = thread; block < job->blocksX * job->blocksY; block += numThreads)
+    {
+        stepBlock(job, &job->scratch[thread], block);
+    }
+}
+
+/// Make the generation every block was written to current
+static void finishBlocks(void *data)
+{
+    BlockJob *job = (BlockJob *) data;
+    swapField(job->field);
+    job->field->generation += job->blockSteps - 1;
+}
+
+bool initialiseBlocks(RDBlocks *blocks, const RDWorkerPool *pool, int blockSize, int blockSteps)
+{
+    blocks->blockSize = blockSize > 0 ? blockSize : RD_DEFAULT_BLOCK_SIZE;
+    blocks->blockSteps = blockSteps > 0 ? blockSteps : RD_DEFAULT_BLOCK_STEPS;
+    blocks->numScratch = workerPoolSize(pool);
+
+    // Each thread needs its own scratch field big enough for a block and its halo
+    int scratchSize = blocks->blockSize + 2 * blocks->blockSteps;
+    blocks->scratch = (RDField *) calloc(blocks->numScratch, sizeof(RDField));
+    if (blocks->scratch == NULL) return false;
+
+    bool allocated = true;
+    for (int t = 0; t < blocks->numScratch && allocated; t++)
+    {
+        // Half a square size of 0 means no seed squares are set
+        allocated = initialiseField(&blocks->scratch[t], scratchSize, scratchSize, SEED_CENTRE_SQUARE, 0);
+    }
+
+    if (!allocated) freeBlocks(blocks);
+    return allocated;
+}
+
+void stepBlocks(RDWorkerPool *pool, RDBlocks *blocks, RDField *field, const RDParams *params, int steps)
+{
+    if (steps <= 0) return;
+
+    for (int t = 0; t < blocks->numScratch; t++) blocks->scratch[t].kernel = field->kernel;
+
+    int blockSize = blocks->blockSize;
+    BlockJob blockJob = { field, params, blocks->scratch, blockSize, blocks->blockSteps,
+        (field->width + blockSize - 1) / blockSize, (field->height + blockSize - 1) / blockSize };
+
+    // Whole passes of blockSteps generations, then one shorter pass for whatever is left
+    RDPoolJob job = { stepBlockShare, finishBlocks, &blockJob, steps / blocks->blockSteps };
+    runPoolJob(pool, &job);
+
+    blockJob.blockSteps = steps % blocks->blockSteps;
+    job.generations = blockJob.blockSteps > 0 ? 1 : 0;
+    runPoolJob(pool, &job);
+}
+
+void freeBlocks(RDBlocks *blocks)
+{
+    // Fields that were never initialised are still zeroed, which freeField leaves alone
+    for (int t = 0; blocks->scratch != NULL && t < blocks->numScratch; t++) freeField(&blocks->scratch[t]);
+    free(blocks->scratch);
+    blocks->scratch = NULL;
+}
+
+bool stepFieldBlocked(RDWorkerPool *pool, RDField *field, const RDParams *params, int steps,
+    int blockSize, int blockSteps)
+{
+    if (steps <= 0) return true;
+
+    RDBlocks blocks;
+    if (!initialiseBlocks(&blocks, pool, blockSize, blockSteps)) return false;
+
+    stepBlocks(pool, &blocks, field, params, steps);
+    freeBlocks(&blocks);
+    return true;
+}
@@ -0,0 +1,70 @@
+// Steps a field several generations at a time, one cache sized block at a time
+//
+// Stepping a generation at a time streams all four planes through memory once per generation,
+// which is limited by memory bandwidth once the field doesn't fit in cache. Temporal blocking
+// copies a block of the field plus a halo of k cells on each side into a small scratch field,
+// steps the scratch field k generations while it stays in cache, shrinking the stepped area by
+// a cell on each side every generation, and writes the middle of it back. The halo is stepped
+// by every neighbouring block as well, but the field is only read and written once per k
+// generations.
+//
+// Each cell goes through the same row kernel with the same neighbours as it would when stepped
+// a generation at a time, so the results are bit identical to k calls to stepField.
+
+#ifndef RD_BLOCKING_H
+#define RD_BLOCKING_H
+
+#include "rd_field.h"
+#include "rd_threads.h"
+
+/// The default width and height of a block in cells, with a halo of 8 its scratch field fits
+/// comfortably in a 1MB L2 cache
+#define RD_DEFAULT_BLOCK_SIZE 128
+
+/// The default number of generations each block is stepped at a time
+#define RD_DEFAULT_BLOCK_STEPS 8
+
+/// The scratch fields a field is stepped in, one per thread, kept between calls so stepping
+/// doesn't allocate
+typedef struct {
+    int blockSize;
+    int blockSteps;
+    int numScratch;
+    RDField *scratch;       // One scratch field per thread, big enough for a block and its halo
+} RDBlocks;
+
+/// Allocate the scratch fields for stepping with a pool
+/// @param blocks The blocks to initialise
+/// @param pool The pool they'll be stepped with, NULL for the calling thread
+/// @param blockSize The width and height of a block in cells, 0 or less uses RD_DEFAULT_BLOCK_SIZE
+/// @param blockSteps The number of generations to step each block at a time, 0 or less uses
+///                   RD_DEFAULT_BLOCK_STEPS
+/// @return False if the scratch fields couldn't be allocated
+bool initialiseBlocks(RDBlocks *blocks, const RDWorkerPool *pool, int blockSize, int blockSteps);
+
+/// Advance a field by a number of generations, blockSteps at a time for each block
+/// @param pool The pool the blocks were initialised for
+/// @param blocks The scratch fields to step in
+/// @param field The field to step
+/// @param params The feed, kill and diffusion rates to use
+/// @param steps The number of generations to step
+void stepBlocks(RDWorkerPool *pool, RDBlocks *blocks, RDField *field, const RDParams *params, int steps);
+
+/// Free the scratch fields
+/// @param blocks The blocks to free
+void freeBlocks(RDBlocks *blocks);
+
+/// Advance a field by a number of generations, blockSteps at a time for each block, with scratch
+/// fields allocated for just this call
+/// @param pool The pool to step with, NULL steps on the calling thread
+/// @param field The field to step
+/// @param params The feed, kill and diffusion rates to use
+/// @param steps The number of generations to step
+/// @param blockSize The width and height of a block in cells, 0 or less uses RD_DEFAULT_BLOCK_SIZE
+/// @param blockSteps The number of generations to step each block at a time, 0 or less uses
+///                   RD_DEFAULT_BLOCK_STEPS
+/// @return False if the scratch fields couldn't be allocated, in which case the field isn't stepped
+bool stepFieldBlocked(RDWorkerPool *pool, RDField *field, const RDParams *params, int steps,
+    int blockSize, int blockSteps);
+
+#endif
@@ -0,0 +1,190 @@
+// Turns a field into RGBA pixels
+
+#include "rd_colour.h"
+
+#include <pthread.h>
+
+#if RD_KERNEL_SIMD
+    #include <immintrin.h>
+#endif
+
+// The tables of every built in palette and which one the passes use
+static uint32_t tables[RD_PALETTE_COUNT][RD_COLOUR_LEVELS];
+static pthread_once_t tablesBuilt = PTHREAD_ONCE_INIT;
+static int currentPalette = 0;
+
+static void buildTables(void)
+{
+    for (int p = 0; p < RD_PALETTE_COUNT; p++) buildColourTable(getPalette(p), tables[p], RD_COLOUR_LEVELS);
+}
+
+void setColourPalette(const RDPalette *palette)
+{
+    __atomic_store_n(&currentPalette, (int) (palette - getPalette(0)), __ATOMIC_RELAXED);
+}
+
+const RDPalette *colourPalette(void)
+{
+    return getPalette(__atomic_load_n(&currentPalette, __ATOMIC_RELAXED));
+}
+
+const uint32_t *colourTable(void)
+{
+    pthread_once(&tablesBuilt, buildTables);
+    return tables[__atomic_load_n(&currentPalette, __ATOMIC_RELAXED)];
+}
+
+/// Colour a run of cells
+/// @param a The a values of the cells
+/// @param b The b values of the cells
+/// @param table The colour of each level
+/// @param pixels Where to write the pixels of the cells
+/// @param count The number of cells
+typedef void (*ColourRun)(const RDReal *a, const RDReal *b, const uint32_t *table, unsigned char *pixels, int count);
+
+static void colourRunScalar(const RDReal *a, const RDReal *b, const uint32_t *table, unsigned char *pixels, int count)
+{
+    uint32_t *words = (uint32_t *) pixels;
+    for (int x = 0; x < count; x++) words[x] = table[colourLevel(a[x], b[x])];
+}
+
+#if RD_KERNEL_SIMD
+
+// SSE2 has no gather, so the levels are worked out four at a time and looked up one at a time
+__attribute__((target("sse2")))
+static inline void lookUpLevels(__m128i levels, const uint32_t *table, unsigned char *pixels)
+{
+    int32_t level[4];
+    _mm_storeu_si128((__m128i *) level, levels);
+
+    uint32_t *words = (uint32_t *) pixels;
+    for (int i = 0; i < 4; i++) words[i] = table[level[i]];
+}
+
+#if RD_PRECISION == RD_PRECISION_DOUBLE
+
+__attribute__((target("sse2")))
+static void colourRunSSE2(const double *a, const double *b, const uint32_t *table, unsigned char *pixels, int count)
+{
+    __m128d scale = _mm_set1_pd(RD_COLOUR_LEVELS);
+    __m128d top = _mm_set1_pd(RD_COLOUR_LEVELS - 1);
+    __m128d zero = _mm_setzero_pd();
+
+    int x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        __m128d low = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(a + x), _mm_loadu_pd(b + x)), scale);
+        __m128d high = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(a + x + 2), _mm_loadu_pd(b + x + 2)), scale);
+        low = _mm_min_pd(_mm_max_pd(low, zero), top);
+        high = _mm_min_pd(_mm_max_pd(high, zero), top);
+
+        __m128i levels = _mm_unpacklo_epi64(_mm_cvttpd_epi32(low), _mm_cvttpd_epi32(high));
+        lookUpLevels(levels, table, pixels + x * RD_PIXEL_SIZE);
+    }
+
+    colourRunScalar(a + x, b + x, table, pixels + x * RD_PIXEL_SIZE, count - x);
+}
+
+__attribute__((target("avx2")))
+static void colourRunAVX2(const double *a, const double *b, const uint32_t *table, unsigned char *pixels, int count)
+{
+    __m256d scale = _mm256_set1_pd(RD_COLOUR_LEVELS);
+    __m256d top = _mm256_set1_pd(RD_COLOUR_LEVELS - 1);
+    __m256d zero = _mm256_setzero_pd();
+
+    int x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m256d low = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(a + x), _mm256_loadu_pd(b + x)), scale);
+        __m256d high = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(a + x + 4), _mm256_loadu_pd(b + x + 4)), scale);
+        low = _mm256_min_pd(_mm256_max_pd(low, zero), top);
+        high = _mm256_min_pd(_mm256_max_pd(high, zero), top);
+
+        __m256i levels = _mm256_set_m128i(_mm256_cvttpd_epi32(high), _mm256_cvttpd_epi32(low));
+        __m256i rgba = _mm256_i32gather_epi32((const int *) table, levels, 4);
+        _mm256_storeu_si256((__m256i *) (pixels + x * RD_PIXEL_SIZE), rgba);
+    }
+
+    colourRunScalar(a + x, b + x, table, pixels + x * RD_PIXEL_SIZE, count - x);
+}
+
+#else
+
+__attribute__((target("sse2")))
+static void colourRunSSE2(const float *a, const float *b, const uint32_t *table, unsigned char *pixels, int count)
+{
+    __m128 scale = _mm_set1_ps(RD_COLOUR_LEVELS);
+    __m128 top = _mm_set1_ps(RD_COLOUR_LEVELS - 1);
+    __m128 zero = _mm_setzero_ps();
+
+    int x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        __m128 level = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(a + x), _mm_loadu_ps(b + x)), scale);
+        level = _mm_min_ps(_mm_max_ps(level, zero), top);
+        lookUpLevels(_mm_cvttps_epi32(level), table, pixels + x * RD_PIXEL_SIZE);
+    }
+
+    colourRunScalar(a + x, b + x, table, pixels + x * RD_PIXEL_SIZE, count - x);
+}
+
+__attribute__((target("avx2")))
+static void colourRunAVX2(const float *a, const float *b, const uint32_t *table, unsigned char *pixels, int count)
+{
+    __m256 scale = _mm256_set1_ps(RD_COLOUR_LEVELS);
+    __m256 top = _mm256_set1_ps(RD_COLOUR_LEVELS - 1);
+    __m256 zero = _mm256_setzero_ps();
+
+    int x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m256 level = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(a + x), _mm256_loadu_ps(b + x)), scale);
+        level = _mm256_min_ps(_mm256_max_ps(level, zero), top);
+
+        __m256i rgba = _mm256_i32gather_epi32((const int *) table, _mm256_cvttps_epi32(level), 4);
+        _mm256_storeu_si256((__m256i *) (pixels + x * RD_PIXEL_SIZE), rgba);
+    }
+
+    colourRunScalar(a + x, b + x, table, pixels + x * RD_PIXEL_SIZE, count - x);
+}
+
+#endif
+
+#endif
+
+/// Pick the widest colour pass allowed by a kernel, there's no AVX-512 pass as the conversion
+/// is limited by memory long before that
+static ColourRun getColourRun(RDKernelType kernel)
+{
+#if RD_KERNEL_SIMD
+    if (kernel >= KERNEL_AVX2 && rdKernelSupported(KERNEL_AVX2)) return colourRunAVX2;
+    if (kernel >= KERNEL_SSE2 && rdKernelSupported(KERNEL_SSE2)) return colourRunSSE2;
+#endif
+
+    return colourRunScalar;
+}
+
+void colourFieldRect(const RDField *field, unsigned char *pixels, int left, int top, int right, int bottom)
+{
+    ColourRun colourRun = getColourRun(field->kernel);
+    const uint32_t *table = colourTable();
+    const RDReal *a = fieldA(field);
+    const RDReal *b = fieldB(field);
+
+    for (int y = top; y < bottom; y++)
+    {
+        size_t row = (size_t) y * field->stride + left;
+        size_t pixel = ((size_t) y * field->width + left) * RD_PIXEL_SIZE;
+        colourRun(a + row, b + row, table, pixels + pixel, right - left);
+    }
+}
+
+void colourFieldRows(const RDField *field, unsigned char *pixels, int firstRow, int lastRow)
+{
+    colourFieldRect(field, pixels, 0, firstRow, field->width, lastRow);
+}
+
+void colourField(const RDField *field, unsigned char *pixels)
+{
+    colourFieldRows(field, pixels, 0, field->height);
+}
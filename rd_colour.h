@@ -0,0 +1,89 @@
+// Turns a field into RGBA pixels without needing a window or OpenGL context, so the buffer can
+// be uploaded to a texture once a frame or checked headlessly
+//
+// Each cell's a - b is clamped to 0-1, NaN counting as 0, quantised to one of RD_COLOUR_LEVELS
+// levels and looked up in a table of RGBA pixels built from the current palette, so there's no
+// per pixel arithmetic past the quantising and values outside 0-1 can't wrap around. The tables
+// are built once, the first time anything is coloured, and switching palette just switches
+// table. The SIMD passes produce exactly the same bytes as
+// the scalar one, the AVX2 pass gathers eight pixels from the table at a time.
+
+#ifndef RD_COLOUR_H
+#define RD_COLOUR_H
+
+#include "rd_field.h"
+#include "rd_palette.h"
+
+/// The number of bytes in each pixel of a colour buffer, one each of red, green, blue and alpha
+#define RD_PIXEL_SIZE 4
+
+/// The number of levels a - b is quantised to, and entries in each colour table, from 256 to 4096
+#ifndef RD_COLOUR_LEVELS
+    #define RD_COLOUR_LEVELS 1024
+#endif
+
+/// Get the level of the colour table a cell is coloured with
+/// @param a The cell's a
+/// @param b The cell's b
+/// @return a - b quantised and clamped to 0 to RD_COLOUR_LEVELS - 1
+static inline int colourLevel(RDReal a, RDReal b)
+{
+#if RD_PRECISION == RD_PRECISION_FIXED16
+    int level = ((a - b) * RD_COLOUR_LEVELS) >> RD_FIXED_SHIFT;
+    if (level < 0) level = 0;
+#else
+    // Written so NaN goes to 0 too, the way the SIMD passes' max does
+    RDReal level = (a - b) * RD_COLOUR_LEVELS;
+    if (!(level > 0)) level = 0;
+#endif
+    if (level > RD_COLOUR_LEVELS - 1) level = RD_COLOUR_LEVELS - 1;
+    return (int) level;
+}
+
+/// Get the level of the colour table a block of a mip pyramid is coloured with
+/// @param a The block's average a
+/// @param b The block's average b
+/// @return a - b quantised and clamped to 0 to RD_COLOUR_LEVELS - 1
+static inline int blockColourLevel(float a, float b)
+{
+    float level = (a - b) * RD_COLOUR_LEVELS;
+    if (!(level > 0.0f)) level = 0.0f;
+    if (level > RD_COLOUR_LEVELS - 1) level = RD_COLOUR_LEVELS - 1;
+    return (int) level;
+}
+
+/// Pick the palette every colour pass uses from now on, passes already running on other threads
+/// finish with the palette they started with
+/// @param palette One of the built in palettes, from getPalette or findPalette
+void setColourPalette(const RDPalette *palette);
+
+/// Get the palette the colour passes use, the greys until another is picked
+/// @return The palette
+const RDPalette *colourPalette(void);
+
+/// Get the table of the palette the colour passes use
+/// @return RD_COLOUR_LEVELS opaque RGBA pixels, indexed by colourLevel
+const uint32_t *colourTable(void);
+
+/// Colour every cell of a field, using the widest pass the field's kernel allows
+/// @param field The field to colour
+/// @param pixels A buffer of width * height * RD_PIXEL_SIZE bytes to fill
+void colourField(const RDField *field, unsigned char *pixels);
+
+/// Colour a range of rows of a field
+/// @param field The field to colour
+/// @param pixels A buffer of width * height * RD_PIXEL_SIZE bytes, only the rows in range are written
+/// @param firstRow The first row to colour
+/// @param lastRow One past the last row to colour
+void colourFieldRows(const RDField *field, unsigned char *pixels, int firstRow, int lastRow);
+
+/// Colour a rectangle of a field
+/// @param field The field to colour
+/// @param pixels A buffer of width * height * RD_PIXEL_SIZE bytes, only the rectangle is written
+/// @param left The first column to colour
+/// @param top The first row to colour
+/// @param right One past the last column to colour
+/// @param bottom One past the last row to colour
+void colourFieldRect(const RDField *field, unsigned char *pixels, int left, int top, int right, int bottom);
+
+#endif
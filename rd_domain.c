@@ -0,0 +1,619 @@
+// Splits a field across several worker processes that exchange the rows along their edges
+
+// For sched_setaffinity and the CPU_* macros
+#define _GNU_SOURCE
+
+#include "rd_domain.h"
+#include "rd_threads.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+    #include <errno.h>
+    #include <poll.h>
+    #include <sched.h>
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+// The number of rows each ring buffer can hold before its sender has to wait
+#define RING_SLOTS 4
+
+// The number of times a worker checks a ring before giving up the rest of its time slice
+#define SPIN_LIMIT 256
+
+// The commands the coordinator sends its workers
+#define COMMAND_STEP 1
+#define COMMAND_GATHER 2
+#define COMMAND_QUIT 3
+
+const char *haloTransportName(RDHaloTransport transport)
+{
+    return transport == HALO_SOCKET ? "socket" : "shm";
+}
+
+#ifdef _WIN32
+
+int rdDefaultDomainWorkers(void)
+{
+    return 2;
+}
+
+RDDomain *startDomain(const RDField *field, int numWorkers, int threadsPerWorker, RDHaloTransport transport)
+{
+    return NULL;
+}
+
+bool stepDomain(RDDomain *domain, const RDParams *params, int steps) { return false; }
+bool gatherDomain(RDDomain *domain, RDField *field) { return false; }
+void stopDomain(RDDomain *domain) {}
+
+#else
+
+/// The counts of a ring buffer carrying rows from one worker to its neighbour, each on its own
+/// cache line so the sender and receiver don't slow each other down
+typedef struct {
+    uint64_t written;
+    char writtenPadding[RD_FIELD_ALIGN - sizeof(uint64_t)];
+    uint64_t read;
+    char readPadding[RD_FIELD_ALIGN - sizeof(uint64_t)];
+} HaloRing;
+
+typedef struct {
+    int type;
+    int steps;
+    RDParams params;    // The rates to step with, for COMMAND_STEP
+} Command;
+
+/// One worker, as the coordinator and the worker itself see it
+typedef struct {
+    pid_t pid;
+    int control;        // The coordinator's end of the socket commands are sent over
+    int firstRow;       // The rows of the field the worker owns
+    int lastRow;        // One past the last
+} Worker;
+
+struct RDDomain {
+    int width;
+    int height;
+    int stride;
+    long long generation;
+    RDKernelType kernel;
+    RDRateMap rates;    // The field's rate map, which the forked workers see at the same address
+    RDHaloTransport transport;
+    int threadsPerWorker;
+
+    int numWorkers;
+    Worker *workers;
+
+    // The memory shared with every worker, the rings and the planes stripes are gathered into
+    void *shared;
+    size_t sharedSize;
+    uint64_t *failed;       // Set by the coordinator when a worker dies, so its neighbours stop waiting for it
+    HaloRing *rings;        // Down then up for each edge between workers, edge k is below worker k
+    RDReal *ringRows;       // RING_SLOTS rows of a then b for each ring
+    RDReal *gatherA;
+    RDReal *gatherB;
+
+    // The sockets each edge's rows are sent over, [k][0] belongs to worker k and [k][1] to worker k + 1
+    int (*haloSockets)[2];
+};
+
+// Send or receive all of a buffer, carrying on after partial transfers and interruptions
+static bool sendAll(int socket, const void *buffer, size_t size)
+{
+    const char *bytes = (const char *) buffer;
+    while (size > 0)
+    {
+        ssize_t sent = send(socket, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= (size_t) sent;
+    }
+    return true;
+}
+
+static bool receiveAll(int socket, void *buffer, size_t size)
+{
+    char *bytes = (char *) buffer;
+    while (size > 0)
+    {
+        ssize_t received = recv(socket, bytes, size, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        bytes += received;
+        size -= (size_t) received;
+    }
+    return true;
+}
+
+// Wait for a count another process changes to reach a value, spinning briefly before yielding
+// so a worker sharing a core with its neighbour lets it run. Gives up if the coordinator says a
+// worker has died, as the count may never change.
+static bool waitForCount(const RDDomain *domain, const uint64_t *count, uint64_t value)
+{
+    for (int spins = 0; __atomic_load_n(count, __ATOMIC_ACQUIRE) < value; spins++)
+    {
+        if (spins < SPIN_LIMIT) continue;
+        if (__atomic_load_n(domain->failed, __ATOMIC_ACQUIRE)) return false;
+        sched_yield();
+    }
+    return true;
+}
+
+static RDReal *ringSlot(RDDomain *domain, int ring, uint64_t index)
+{
+    return domain->ringRows + ((size_t) ring * RING_SLOTS + index % RING_SLOTS) * 2 * domain->width;
+}
+
+// Copy a row of a and b into a ring once there's room for it
+static bool sendRingRow(RDDomain *domain, int ring, const RDReal *a, const RDReal *b)
+{
+    HaloRing *halo = &domain->rings[ring];
+    uint64_t written = halo->written;
+    if (written >= RING_SLOTS && !waitForCount(domain, &halo->read, written - RING_SLOTS + 1)) return false;
+
+    RDReal *slot = ringSlot(domain, ring, written);
+    memcpy(slot, a, domain->width * sizeof(RDReal));
+    memcpy(slot + domain->width, b, domain->width * sizeof(RDReal));
+    __atomic_store_n(&halo->written, written + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Copy the next row out of a ring once it's been sent
+static bool receiveRingRow(RDDomain *domain, int ring, RDReal *a, RDReal *b)
+{
+    HaloRing *halo = &domain->rings[ring];
+    uint64_t read = halo->read;
+    if (!waitForCount(domain, &halo->written, read + 1)) return false;
+
+    const RDReal *slot = ringSlot(domain, ring, read);
+    memcpy(a, slot, domain->width * sizeof(RDReal));
+    memcpy(b, slot + domain->width, domain->width * sizeof(RDReal));
+    __atomic_store_n(&halo->read, read + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool sendSocketRow(int socket, const RDReal *a, const RDReal *b, int width)
+{
+    return sendAll(socket, a, width * sizeof(RDReal)) && sendAll(socket, b, width * sizeof(RDReal));
+}
+
+static bool receiveSocketRow(int socket, RDReal *a, RDReal *b, int width)
+{
+    return receiveAll(socket, a, width * sizeof(RDReal)) && receiveAll(socket, b, width * sizeof(RDReal));
+}
+
+// Send a worker's first and last rows to its neighbours and fill its ghost rows with theirs
+static bool exchangeHalos(RDDomain *domain, int worker, RDField *stripe)
+{
+    int last = stripe->height - 2;
+    bool above = worker > 0;
+    bool below = worker < domain->numWorkers - 1;
+    RDReal *a = fieldA(stripe);
+    RDReal *b = fieldB(stripe);
+    size_t stride = stripe->stride;
+
+    if (domain->transport == HALO_SHARED_MEMORY)
+    {
+        // The rings have room for several rows, so sending never waits on a neighbour that's
+        // waiting to send as well. Edge k's rings are 2k going down and 2k + 1 going up.
+        return (!above || sendRingRow(domain, 2 * worker - 1, a + stride, b + stride))
+            && (!below || sendRingRow(domain, 2 * worker, a + last * stride, b + last * stride))
+            && (!above || receiveRingRow(domain, 2 * worker - 2, a, b))
+            && (!below || receiveRingRow(domain, 2 * worker + 1, a + (last + 1) * stride, b + (last + 1) * stride));
+    }
+
+    // A socket's buffer might not hold a whole row, so the even workers send while the odd ones
+    // receive and then the other way round, which means every send has a receive waiting for it
+    bool exchanged = true;
+    for (int phase = 0; phase < 2; phase++)
+    {
+        if ((worker & 1) == phase)
+        {
+            if (above) exchanged = exchanged && sendSocketRow(domain->haloSockets[worker - 1][1], a + stride,
+                b + stride, stripe->width);
+            if (below) exchanged = exchanged && sendSocketRow(domain->haloSockets[worker][0], a + last * stride,
+                b + last * stride, stripe->width);
+        }
+        else
+        {
+            if (above) exchanged = exchanged && receiveSocketRow(domain->haloSockets[worker - 1][1], a, b,
+                stripe->width);
+            if (below) exchanged = exchanged && receiveSocketRow(domain->haloSockets[worker][0],
+                a + (last + 1) * stride, b + (last + 1) * stride, stripe->width);
+        }
+    }
+    return exchanged;
+}
+
+// Read a list of CPUs like 0-15,32-47 into a set
+static bool readCpuList(const char *path, cpu_set_t *cpus)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return false;
+
+    CPU_ZERO(cpus);
+    int first, last;
+    while (fscanf(file, "%d", &first) == 1)
+    {
+        last = first;
+        if (fscanf(file, "-%d", &last) != 1) last = first;
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) CPU_SET(cpu, cpus);
+        if (fgetc(file) != ',') break;
+    }
+
+    fclose(file);
+    return CPU_COUNT(cpus) > 0;
+}
+
+// Count the machine's NUMA nodes, 0 if it doesn't say
+static int countNumaNodes(void)
+{
+    char path[64];
+    int numNodes = 0;
+    while (snprintf(path, sizeof(path), "/sys/devices/system/node/node%d", numNodes), access(path, F_OK) == 0)
+    {
+        numNodes++;
+    }
+    return numNodes;
+}
+
+int rdDefaultDomainWorkers(void)
+{
+    int numNodes = countNumaNodes();
+    return numNodes > 1 ? numNodes : 2;
+}
+
+// Pin a worker to its share of the NUMA nodes, or of the cores when there's only one node
+static void pinWorker(int worker, int numWorkers)
+{
+    char path[64];
+    int numNodes = countNumaNodes();
+
+    cpu_set_t cpus;
+    if (numNodes > 1)
+    {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", worker * numNodes / numWorkers);
+        if (readCpuList(path, &cpus)) sched_setaffinity(0, sizeof(cpus), &cpus);
+        return;
+    }
+
+    // Split the cores this process is allowed to use into a block for each worker, with more
+    // workers than cores they're left to share
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+
+    int count = CPU_COUNT(&allowed);
+    int first = worker * count / numWorkers;
+    int last = (worker + 1) * count / numWorkers;
+    if (last <= first) return;
+
+    CPU_ZERO(&cpus);
+    for (int cpu = 0, index = 0; cpu < CPU_SETSIZE && index < last; cpu++)
+    {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+        if (index >= first) CPU_SET(cpu, &cpus);
+        index++;
+    }
+    sched_setaffinity(0, sizeof(cpus), &cpus);
+}
+
+// The body of a worker process, it never returns
+static void workerMain(RDDomain *domain, int worker, int control)
+{
+    pinWorker(worker, domain->numWorkers);
+
+    // The stripe is allocated after pinning so its pages are first touched on the worker's node.
+    // Its top and bottom rows are the ghost rows, the border rows of the field for the first and
+    // last workers, and a field's border is never stepped so neither are they.
+    Worker *self = &domain->workers[worker];
+    RDField stripe;
+    int rows = self->lastRow - self->firstRow;
+    bool ready = initialiseField(&stripe, domain->width, rows + 2, SEED_CENTRE_SQUARE, 0);
+
+    if (ready)
+    {
+        stripe.kernel = domain->kernel;
+        shareFieldRates(&stripe, &domain->rates, 0, self->firstRow - 1);
+        for (int y = 0; y < rows + 2; y++)
+        {
+            size_t from = (size_t) (self->firstRow - 1 + y) * domain->stride;
+            size_t to = (size_t) y * stripe.stride;
+            for (int plane = 0; plane < 2; plane++)
+            {
+                memcpy(stripe.a[plane] + to, domain->gatherA + from, domain->width * sizeof(RDReal));
+                memcpy(stripe.b[plane] + to, domain->gatherB + from, domain->width * sizeof(RDReal));
+            }
+        }
+    }
+
+    int threads = domain->threadsPerWorker;
+    cpu_set_t cpus;
+    if (threads <= 0 && sched_getaffinity(0, sizeof(cpus), &cpus) == 0) threads = CPU_COUNT(&cpus);
+    RDWorkerPool *pool = ready && threads > 1 ? createWorkerPool(threads) : NULL;
+
+    Command command;
+    while (ready && receiveAll(control, &command, sizeof(command)) && command.type != COMMAND_QUIT)
+    {
+        bool done = true;
+
+        if (command.type == COMMAND_STEP)
+        {
+            for (int s = 0; s < command.steps && done; s++)
+            {
+                stepFieldParallel(pool, &stripe, &command.params, 1);
+                done = exchangeHalos(domain, worker, &stripe);
+            }
+        }
+        else if (command.type == COMMAND_GATHER)
+        {
+            for (int y = 1; y <= rows; y++)
+            {
+                size_t to = (size_t) (self->firstRow - 1 + y) * domain->stride;
+                size_t from = (size_t) y * stripe.stride;
+                memcpy(domain->gatherA + to, fieldA(&stripe) + from, domain->width * sizeof(RDReal));
+                memcpy(domain->gatherB + to, fieldB(&stripe) + from, domain->width * sizeof(RDReal));
+            }
+        }
+
+        int reply = done;
+        if (!sendAll(control, &reply, sizeof(reply)) || !done) break;
+    }
+
+    freeWorkerPool(pool);
+    if (ready) freeField(&stripe);
+    _exit(0);
+}
+
+static void closeDomainSockets(RDDomain *domain)
+{
+    for (int w = 0; w < domain->numWorkers; w++)
+    {
+        if (domain->workers[w].control >= 0) close(domain->workers[w].control);
+        domain->workers[w].control = -1;
+    }
+
+    for (int e = 0; domain->haloSockets != NULL && e < domain->numWorkers - 1; e++)
+    {
+        for (int end = 0; end < 2; end++)
+        {
+            if (domain->haloSockets[e][end] >= 0) close(domain->haloSockets[e][end]);
+            domain->haloSockets[e][end] = -1;
+        }
+    }
+}
+
+RDDomain *startDomain(const RDField *field, int numWorkers, int threadsPerWorker, RDHaloTransport transport)
+{
+    // Every worker needs at least one row inside the border
+    int interiorRows = field->height - 2;
+    if (numWorkers > interiorRows) numWorkers = interiorRows;
+    if (numWorkers < 1) return NULL;
+
+    RDDomain *domain = (RDDomain *) calloc(1, sizeof(RDDomain));
+    if (domain == NULL) return NULL;
+
+    domain->width = field->width;
+    domain->height = field->height;
+    domain->stride = field->stride;
+    domain->generation = field->generation;
+    domain->kernel = field->kernel;
+    domain->rates = field->rates;
+    domain->transport = transport;
+    domain->threadsPerWorker = threadsPerWorker;
+    domain->numWorkers = numWorkers;
+    domain->workers = (Worker *) calloc(numWorkers, sizeof(Worker));
+    domain->haloSockets = (int (*)[2]) malloc((numWorkers > 1 ? numWorkers - 1 : 1) * sizeof(int[2]));
+    if (domain->workers == NULL || domain->haloSockets == NULL)
+    {
+        free(domain->workers);
+        free(domain->haloSockets);
+        free(domain);
+        return NULL;
+    }
+
+    for (int w = 0; w < numWorkers; w++)
+    {
+        domain->workers[w].control = -1;
+        domain->workers[w].firstRow = 1 + (int) ((long long) interiorRows * w / numWorkers);
+        domain->workers[w].lastRow = 1 + (int) ((long long) interiorRows * (w + 1) / numWorkers);
+    }
+    for (int e = 0; e < numWorkers - 1; e++) domain->haloSockets[e][0] = domain->haloSockets[e][1] = -1;
+
+    // The failed flag, the rings, the rows they carry and the gathered planes share one mapping,
+    // set up before the workers are forked so they all see it at the same address
+    size_t flagSize = RD_FIELD_ALIGN;
+    size_t ringSize = (size_t) 2 * (numWorkers - 1) * sizeof(HaloRing);
+    size_t rowsSize = (size_t) 2 * (numWorkers - 1) * RING_SLOTS * 2 * field->width * sizeof(RDReal);
+    size_t planeSize = (size_t) field->stride * field->height * sizeof(RDReal);
+    rowsSize = (rowsSize + RD_FIELD_ALIGN - 1) / RD_FIELD_ALIGN * RD_FIELD_ALIGN;
+    domain->sharedSize = flagSize + ringSize + rowsSize + 2 * planeSize;
+    domain->shared = mmap(NULL, domain->sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (domain->shared == MAP_FAILED)
+    {
+        free(domain->workers);
+        free(domain->haloSockets);
+        free(domain);
+        return NULL;
+    }
+
+    domain->failed = (uint64_t *) domain->shared;
+    domain->rings = (HaloRing *) ((char *) domain->shared + flagSize);
+    domain->ringRows = (RDReal *) ((char *) domain->rings + ringSize);
+    domain->gatherA = (RDReal *) ((char *) domain->ringRows + rowsSize);
+    domain->gatherB = (RDReal *) ((char *) domain->gatherA + planeSize);
+
+    // The workers start from the field as it is now
+    memcpy(domain->gatherA, fieldA(field), planeSize);
+    memcpy(domain->gatherB, fieldB(field), planeSize);
+
+    bool started = true;
+    for (int e = 0; e < numWorkers - 1 && transport == HALO_SOCKET; e++)
+    {
+        started = started && socketpair(AF_UNIX, SOCK_STREAM, 0, domain->haloSockets[e]) == 0;
+    }
+
+    for (int w = 0; w < numWorkers && started; w++)
+    {
+        int control[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, control) != 0)
+        {
+            started = false;
+            break;
+        }
+
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            // The worker only keeps its own end of its control socket and the ends of the halo
+            // sockets on its own edges, so when a neighbour dies nothing else holds its end open
+            // and the worker sees it close
+            close(control[0]);
+            for (int other = 0; other < w; other++) close(domain->workers[other].control);
+            for (int e = 0; e < numWorkers - 1 && transport == HALO_SOCKET; e++)
+            {
+                for (int end = 0; end < 2; end++)
+                {
+                    if ((e == w - 1 && end == 1) || (e == w && end == 0)) continue;
+                    close(domain->haloSockets[e][end]);
+                    domain->haloSockets[e][end] = -1;
+                }
+            }
+            workerMain(domain, w, control[1]);
+        }
+
+        close(control[1]);
+        domain->workers[w].pid = pid;
+        domain->workers[w].control = control[0];
+        if (pid < 0)
+        {
+            close(control[0]);
+            domain->workers[w].control = -1;
+            started = false;
+        }
+    }
+
+    if (!started)
+    {
+        stopDomain(domain);
+        return NULL;
+    }
+
+    // Only the workers use the halo sockets
+    for (int e = 0; e < numWorkers - 1 && transport == HALO_SOCKET; e++)
+    {
+        close(domain->haloSockets[e][0]);
+        close(domain->haloSockets[e][1]);
+        domain->haloSockets[e][0] = domain->haloSockets[e][1] = -1;
+    }
+
+    return domain;
+}
+
+// Send every worker a command and wait for them all to finish it
+static bool commandWorkers(RDDomain *domain, const Command *command)
+{
+    // Replies are read in whatever order they come, so a worker that dies is noticed while its
+    // neighbours are still waiting on it rather than after they've replied, which they never would
+    struct pollfd *replies = (struct pollfd *) malloc(domain->numWorkers * sizeof(struct pollfd));
+    if (replies == NULL) return false;
+
+    bool succeeded = true;
+    int waiting = 0;
+    for (int w = 0; w < domain->numWorkers; w++)
+    {
+        bool sent = sendAll(domain->workers[w].control, command, sizeof(*command));
+        replies[w] = (struct pollfd) { sent ? domain->workers[w].control : -1, POLLIN, 0 };
+        waiting += sent;
+        succeeded = sent && succeeded;
+    }
+
+    while (waiting > 0)
+    {
+        // The workers waiting on a dead one give up once they see the flag and reply too
+        if (!succeeded) __atomic_store_n(domain->failed, 1, __ATOMIC_RELEASE);
+
+        int ready = poll(replies, domain->numWorkers, -1);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0)
+        {
+            succeeded = false;
+            break;
+        }
+
+        for (int w = 0; w < domain->numWorkers; w++)
+        {
+            if (replies[w].fd < 0 || replies[w].revents == 0) continue;
+
+            int reply = 0;
+            succeeded = receiveAll(replies[w].fd, &reply, sizeof(reply)) && reply && succeeded;
+            replies[w].fd = -1;
+            waiting--;
+        }
+    }
+
+    if (!succeeded) __atomic_store_n(domain->failed, 1, __ATOMIC_RELEASE);
+    free(replies);
+    return succeeded;
+}
+
+bool stepDomain(RDDomain *domain, const RDParams *params, int steps)
+{
+    if (steps <= 0) return true;
+
+    Command command = { COMMAND_STEP, steps, *params };
+    if (!commandWorkers(domain, &command)) return false;
+
+    domain->generation += steps;
+    return true;
+}
+
+bool gatherDomain(RDDomain *domain, RDField *field)
+{
+    Command command = { COMMAND_GATHER, 0 };
+    if (!commandWorkers(domain, &command)) return false;
+
+    // The border rows never change, so only the rows inside it are copied
+    for (int y = 1; y < domain->height - 1; y++)
+    {
+        size_t from = (size_t) y * domain->stride;
+        size_t to = (size_t) y * field->stride;
+        memcpy(fieldA(field) + to, domain->gatherA + from, domain->width * sizeof(RDReal));
+        memcpy(fieldB(field) + to, domain->gatherB + from, domain->width * sizeof(RDReal));
+    }
+
+    field->generation = domain->generation;
+    return true;
+}
+
+void stopDomain(RDDomain *domain)
+{
+    if (domain == NULL) return;
+
+    // Closing the control sockets tells any worker still waiting for a command to quit
+    Command command = { COMMAND_QUIT, 0 };
+    for (int w = 0; w < domain->numWorkers; w++)
+    {
+        if (domain->workers[w].control >= 0) sendAll(domain->workers[w].control, &command, sizeof(command));
+    }
+    closeDomainSockets(domain);
+
+    for (int w = 0; w < domain->numWorkers; w++)
+    {
+        if (domain->workers[w].pid > 0) waitpid(domain->workers[w].pid, NULL, 0);
+    }
+
+    munmap(domain->shared, domain->sharedSize);
+    free(domain->workers);
+    free(domain->haloSockets);
+    free(domain);
+}
+
+#endif
@@ -0,0 +1,72 @@
+// Splits a field across several worker processes that exchange the rows along their edges
+//
+// One process eventually runs out of memory bandwidth stepping a big field, and on a machine with
+// more than one socket its threads reach across to the other socket's memory. Each worker process
+// here owns a horizontal stripe of the field plus a ghost row above and below it, pins itself to
+// a NUMA node (or a block of cores when there's only one node) and only then allocates its stripe,
+// so the stripe's memory is local to the cores stepping it. After every generation each worker
+// sends its first and last rows to the workers above and below it, which copy them into their
+// ghost rows, either through ring buffers in shared memory or over local sockets.
+//
+// Every cell is stepped with the same row kernel and the same neighbours as stepping the whole
+// field in one process, so the results are bit identical. The process that starts the workers
+// acts as the coordinator, telling them how many generations to step and gathering their stripes
+// back into a field to colour and display, which the domain backend does every frame. When a
+// worker dies the coordinator tells the others to stop waiting for it, so stepping fails rather
+// than hangs.
+//
+// Workers are forked, so start them before the coordinator starts any threads of its own. They
+// aren't supported on Windows, where startDomain always fails.
+
+#ifndef RD_DOMAIN_H
+#define RD_DOMAIN_H
+
+#include "rd_field.h"
+
+/// How the workers send each other their edge rows
+typedef enum {
+    HALO_SHARED_MEMORY,     // Ring buffers in memory shared between the workers
+    HALO_SOCKET             // Unix domain sockets between neighbouring workers
+} RDHaloTransport;
+
+typedef struct RDDomain RDDomain;
+
+/// Get the number of worker processes to split a field between when there's no reason to pick
+/// another, one per NUMA node or 2 on a machine with only one
+/// @return The number of workers
+int rdDefaultDomainWorkers(void);
+
+/// Start worker processes that step a copy of a field between them
+/// @param field The field to start from, it isn't changed until gatherDomain copies the workers' rows back.
+///              The workers step with its kernel and its rate map as they are now, if it has one
+/// @param numWorkers The number of worker processes, at most one per row inside the border
+/// @param threadsPerWorker The number of threads each worker steps its stripe with, 0 or less
+///                         uses the cores of its NUMA node
+/// @param transport How the workers exchange their edge rows
+/// @return The running workers, or NULL if they couldn't be started
+RDDomain *startDomain(const RDField *field, int numWorkers, int threadsPerWorker, RDHaloTransport transport);
+
+/// Advance every worker's stripe by a number of generations, returning once they all have
+/// @param domain The running workers
+/// @param params The feed, kill and diffusion rates to use
+/// @param steps The number of generations to step
+/// @return False if a worker has died, after which the workers can only be stopped
+bool stepDomain(RDDomain *domain, const RDParams *params, int steps);
+
+/// Copy every worker's latest rows back into a field, the one the workers were started from or
+/// another of the same size
+/// @param domain The running workers
+/// @param field The field to copy into, its generation is set to the workers'
+/// @return False if a worker has died, after which the workers can only be stopped
+bool gatherDomain(RDDomain *domain, RDField *field);
+
+/// Get the name of a transport
+/// @param transport The transport to name
+/// @return Its name, e.g. "shm"
+const char *haloTransportName(RDHaloTransport transport);
+
+/// Stop the worker processes and free everything used to talk to them
+/// @param domain The workers to stop
+void stopDomain(RDDomain *domain);
+
+#endif
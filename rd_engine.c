@@ -0,0 +1,79 @@
+// Shared helpers for the headless reaction diffusion engine
+
+#include "rd_engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+int rdSeedSquares(RDSeed seed, int width, int height, RDSeedSquare *squares)
+{
+    if (seed == SEED_CENTRE_SQUARE)
+    {
+        squares[0] = (RDSeedSquare){ width / 2, height / 2 };
+        return 1;
+    }
+
+    // Three squares along the diagonal
+    for (int s = 1; s <= 3; s++)
+    {
+        squares[s - 1] = (RDSeedSquare){ width * s / 4, height * s / 4 };
+    }
+
+    // And one in each of the off diagonal corners
+    squares[3] = (RDSeedSquare){ width * 3 / 4, height * 1 / 4 };
+    squares[4] = (RDSeedSquare){ width * 1 / 4, height * 3 / 4 };
+
+    return 5;
+}
+
+bool rdSeedFits(RDSeed seed, int width, int height, int bSquareSize)
+{
+    if (bSquareSize <= 0) return true;
+
+    RDSeedSquare squares[RD_MAX_SEED_SQUARES];
+    int numSquares = rdSeedSquares(seed, width, height, squares);
+    for (int s = 0; s < numSquares; s++)
+    {
+        if (squares[s].x - bSquareSize < 1 || squares[s].x + bSquareSize > width - 1
+            || squares[s].y - bSquareSize < 1 || squares[s].y + bSquareSize > height - 1) return false;
+    }
+
+    return true;
+}
+
+double rdGetTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+
+void rdSleep(double seconds)
+{
+#ifdef _WIN32
+    Sleep((DWORD) (seconds * 1000));
+#else
+    struct timespec duration;
+    duration.tv_sec = (time_t) seconds;
+    duration.tv_nsec = (long) ((seconds - (double) duration.tv_sec) * 1e9);
+    nanosleep(&duration, NULL);
+#endif
+}
+
+void rdMachineName(char *name, size_t size)
+{
+#ifdef _WIN32
+    const char *computer = getenv("COMPUTERNAME");
+    snprintf(name, size, "%s", computer != NULL ? computer : "unknown");
+#else
+    if (gethostname(name, size) != 0) snprintf(name, size, "unknown");
+    name[size - 1] = '\0';
+#endif
+}
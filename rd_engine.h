@@ -0,0 +1,66 @@
+// Shared definitions for the headless reaction diffusion engine
+// Based on this tutorial http://karlsims.com/rd.html
+
+#ifndef RD_ENGINE_H
+#define RD_ENGINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/// The values used by the Gray-Scott update to calculate the new a and b of a cell
+typedef struct {
+    double feedRate;
+    double killRate;
+    double dA;
+    double dB;
+} RDParams;
+
+/// The parameters the visualisations have always used
+#define RD_DEFAULT_PARAMS (RDParams){ 0.055, 0.062, 1.0, 0.5 }
+
+/// The starting layouts of b = 1 squares
+typedef enum {
+    SEED_CENTRE_SQUARE,     // A single square in the middle of the grid
+    SEED_FIVE_SQUARES       // Three squares on the diagonal plus the two off diagonal corners
+} RDSeed;
+
+/// The most squares any seed layout places
+#define RD_MAX_SEED_SQUARES 5
+
+/// The centre of a square of b = 1 cells used to start the simulation
+typedef struct {
+    int x;
+    int y;
+} RDSeedSquare;
+
+/// Get the centres of the starting squares for a seed layout
+/// @param seed The layout to get the squares of
+/// @param width The number of horizontal cells in the simulation
+/// @param height The number of vertical cells in the simulation
+/// @param squares Filled with up to RD_MAX_SEED_SQUARES square centres
+/// @return The number of squares in the layout
+int rdSeedSquares(RDSeed seed, int width, int height, RDSeedSquare *squares);
+
+/// Check every starting square of a seed layout lies inside the border, which is never stepped
+/// @param seed The layout to check
+/// @param width The number of horizontal cells in the simulation
+/// @param height The number of vertical cells in the simulation
+/// @param bSquareSize Half the size of the squares, each covering the centre less it up to the centre
+///                    plus it less one
+/// @return False if any square reaches the border or off the grid
+bool rdSeedFits(RDSeed seed, int width, int height, int bSquareSize);
+
+/// Get the current time from a monotonic clock
+/// @return The time in seconds since an arbitrary fixed point
+double rdGetTime(void);
+
+/// Pause the calling thread
+/// @param seconds How long to pause for
+void rdSleep(double seconds);
+
+/// Get the name of the machine, to keep results from different machines apart
+/// @param name Filled with the name, "unknown" if it can't be found
+/// @param size The size of name
+void rdMachineName(char *name, size_t size);
+
+#endif
@@ -0,0 +1,166 @@
+// A contiguous structure-of-arrays grid for the reaction diffusion engine
+// Based on this tutorial http://karlsims.com/rd.html
+
+#include "rd_field.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+bool initialiseField(RDField *field, int width, int height, RDSeed seed, int bSquareSize)
+{
+    int valuesPerLine = RD_FIELD_ALIGN / sizeof(RDReal);
+
+    field->width = width;
+    field->height = height;
+    field->stride = (width + valuesPerLine - 1) / valuesPerLine * valuesPerLine;
+    field->current = 0;
+    field->generation = 0;
+    field->kernel = rdDefaultKernel();
+    field->rates = (RDRateMap) { 0 };
+
+    // The seed squares are written without bounds checks, so a grid they don't fit inside the border
+    // of is refused like one there's no memory for
+    field->memory = NULL;
+    if (!rdSeedFits(seed, width, height, bSquareSize)) return false;
+
+    // One allocation for all four planes with room to move the start up to the next cache line
+    size_t planeSize = (size_t) field->stride * height;
+    field->memory = malloc(4 * planeSize * sizeof(RDReal) + RD_FIELD_ALIGN);
+    if (field->memory == NULL) return false;
+
+    uintptr_t start = ((uintptr_t) field->memory + RD_FIELD_ALIGN - 1) & ~(uintptr_t) (RD_FIELD_ALIGN - 1);
+    RDReal *planes = (RDReal *) start;
+    field->a[0] = planes;
+    field->a[1] = planes + planeSize;
+    field->b[0] = planes + planeSize * 2;
+    field->b[1] = planes + planeSize * 3;
+
+    // Both generations start as the a = 1, b = 0 background so the border, which is never
+    // stepped, reads the same whichever generation is current
+    RDReal one = rdRealFromDouble(1.0);
+    for (size_t i = 0; i < planeSize; i++)
+    {
+        field->a[0][i] = one;
+        field->a[1][i] = one;
+        field->b[0][i] = 0;
+        field->b[1][i] = 0;
+    }
+
+    // Setup up the starting squares of cells
+    RDSeedSquare squares[RD_MAX_SEED_SQUARES];
+    int numSquares = rdSeedSquares(seed, width, height, squares);
+
+    for (int s = 0; s < numSquares; s++)
+    {
+        for (int y = squares[s].y - bSquareSize; y < squares[s].y + bSquareSize; y++)
+        {
+            for (int x = squares[s].x - bSquareSize; x < squares[s].x + bSquareSize; x++)
+            {
+                field->a[0][y * field->stride + x] = one;
+                field->b[0][y * field->stride + x] = one;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool addFieldRates(RDField *field, double feedLow, double feedHigh, double killLow, double killHigh)
+{
+    removeFieldRates(field);
+
+    // Both planes in one allocation, the kill plane starting on a cache line like the feed plane
+    size_t planeSize = ((size_t) field->stride * field->height * sizeof(uint16_t) + RD_FIELD_ALIGN - 1)
+        & ~(size_t) (RD_FIELD_ALIGN - 1);
+    void *memory = calloc(2 * planeSize + RD_FIELD_ALIGN, 1);
+    if (memory == NULL) return false;
+
+    uintptr_t start = ((uintptr_t) memory + RD_FIELD_ALIGN - 1) & ~(uintptr_t) (RD_FIELD_ALIGN - 1);
+    field->rates.feed = (uint16_t *) start;
+    field->rates.kill = (uint16_t *) (start + planeSize);
+    field->rates.stride = field->stride;
+    field->rates.feedLow = feedLow;
+    field->rates.feedHigh = feedHigh;
+    field->rates.killLow = killLow;
+    field->rates.killHigh = killHigh;
+    field->rates.memory = memory;
+    return true;
+}
+
+void shareFieldRates(RDField *field, const RDRateMap *rates, int left, int top)
+{
+    removeFieldRates(field);
+    if (rates->feed == NULL) return;
+
+    size_t origin = (size_t) top * rates->stride + left;
+    field->rates = *rates;
+    field->rates.feed += origin;
+    field->rates.kill += origin;
+    field->rates.memory = NULL;
+}
+
+void removeFieldRates(RDField *field)
+{
+    free(field->rates.memory);
+    field->rates = (RDRateMap) { 0 };
+}
+
+void stepFieldRect(RDField *field, const RDParams *params, int left, int top, int right, int bottom)
+{
+    int stride = field->stride;
+    int current = field->current;
+
+    // The border is never stepped
+    if (left < 1) left = 1;
+    if (top < 1) top = 1;
+    if (right > field->width - 1) right = field->width - 1;
+    if (bottom > field->height - 1) bottom = field->height - 1;
+
+    if (fieldHasRates(field))
+    {
+        RDMappedRowKernel stepMappedRow = rdGetMappedRowKernel(field->kernel);
+        const RDRateMap *rates = &field->rates;
+
+        for (int y = top; y < bottom; y++)
+        {
+            size_t row = (size_t) y * stride;
+            size_t levels = (size_t) y * rates->stride;
+            stepMappedRow(field->a[current] + row, field->b[current] + row,
+                field->a[1 - current] + row, field->b[1 - current] + row,
+                rates->feed + levels, rates->kill + levels, stride, left, right, params, rates);
+        }
+        return;
+    }
+
+    RDRowKernel stepRow = rdGetRowKernel(field->kernel);
+    for (int y = top; y < bottom; y++)
+    {
+        size_t row = (size_t) y * stride;
+        stepRow(field->a[current] + row, field->b[current] + row,
+            field->a[1 - current] + row, field->b[1 - current] + row,
+            stride, left, right, params);
+    }
+}
+
+void stepFieldRows(RDField *field, const RDParams *params, int firstRow, int lastRow)
+{
+    stepFieldRect(field, params, 1, firstRow, field->width - 1, lastRow);
+}
+
+void swapField(RDField *field)
+{
+    field->current = 1 - field->current;
+    field->generation++;
+}
+
+void stepField(RDField *field, const RDParams *params)
+{
+    stepFieldRows(field, params, 1, field->height - 1);
+    swapField(field);
+}
+
+void freeField(RDField *field)
+{
+    removeFieldRates(field);
+    free(field->memory);
+    field->memory = NULL;
+}
@@ -0,0 +1,105 @@
+// A contiguous structure-of-arrays grid for the reaction diffusion engine
+//
+// The a and b chemicals are stored in separate planes, two of each so the new generation
+// can be calculated without changing the old one. Every row is padded out to a multiple of
+// RD_FIELD_ALIGN bytes and all four planes come from one allocation.
+//
+// A field can also have a rate map, 16 bit feed and kill levels for every cell laid out like
+// the chemical planes, which the field kernels step with in place of the params' feed and kill
+// rates. The original pointer neighbour and 2D array layouts only step with the params' rates.
+
+#ifndef RD_FIELD_H
+#define RD_FIELD_H
+
+#include "rd_engine.h"
+#include "rd_kernel.h"
+#include <stddef.h>
+
+/// The alignment in bytes of every plane and row, one cache line
+#define RD_FIELD_ALIGN 64
+
+typedef struct {
+    int width;
+    int height;
+    int stride;         // The number of values between the start of one row and the next
+    int current;        // Which of the two planes of each chemical holds the latest generation
+    long long generation;   // The number of generations stepped since the field was seeded
+    RDKernelType kernel;    // The row kernel used to step the field
+    RDReal *a[2];
+    RDReal *b[2];
+    RDRateMap rates;    // The feed and kill rate of every cell, rates.feed is NULL when there isn't one
+    void *memory;       // The single allocation backing every plane
+} RDField;
+
+/// Initialise a field with cells set to a = 1, b = 0 with squares of cells set to a = 1, b = 1,
+/// stepped with the default kernel
+/// @param field The field to initialise
+/// @param width The number of horizontal cells in the simulation
+/// @param height The number of vertical cells in the simulation
+/// @param seed The layout of the starting squares
+/// @param bSquareSize Half the size of the squares of cells used to start the simulation
+/// @return False if the seed squares don't fit inside the border or the memory for the field couldn't be
+///         allocated
+bool initialiseField(RDField *field, int width, int height, RDSeed seed, int bSquareSize);
+
+/// Give a field a rate map with every cell at level 0, replacing any map it already has
+/// @param field The field
+/// @param feedLow The feed rate at level 0
+/// @param feedHigh The feed rate at RD_RATE_LEVEL_MAX
+/// @param killLow The kill rate at level 0
+/// @param killHigh The kill rate at RD_RATE_LEVEL_MAX
+/// @return False if the memory for the levels couldn't be allocated, which leaves the field without a map
+bool addFieldRates(RDField *field, double feedLow, double feedHigh, double killLow, double killHigh);
+
+/// Have a field step with part of another field's rate map, without copying it
+/// @param field The field, which must not outlive the map
+/// @param rates The other field's map, or one without levels to remove the field's map
+/// @param left The column of the map that the field's first column uses
+/// @param top The row of the map that the field's first row uses
+void shareFieldRates(RDField *field, const RDRateMap *rates, int left, int top);
+
+/// Go back to stepping a field with the params' feed and kill rates everywhere
+/// @param field The field
+void removeFieldRates(RDField *field);
+
+/// Check whether a field is stepped with a rate map
+static inline bool fieldHasRates(const RDField *field) { return field->rates.feed != NULL; }
+
+/// Advance every cell not on the border of the field by one generation
+/// @param field The field to step
+/// @param params The feed, kill and diffusion rates to use
+void stepField(RDField *field, const RDParams *params);
+
+/// Advance the cells of a range of rows by one generation without swapping generations
+/// @param field The field to step
+/// @param params The feed, kill and diffusion rates to use
+/// @param firstRow The first row to step, must be at least 1
+/// @param lastRow One past the last row to step, must be at most height - 1
+void stepFieldRows(RDField *field, const RDParams *params, int firstRow, int lastRow);
+
+/// Advance the cells of a rectangle by one generation without swapping generations, any part of
+/// the rectangle on the border is left alone
+/// @param field The field to step
+/// @param params The feed, kill and diffusion rates to use, the feed and kill rates are ignored if the
+///               field has a rate map
+/// @param left The first column to step
+/// @param top The first row to step
+/// @param right One past the last column to step
+/// @param bottom One past the last row to step
+void stepFieldRect(RDField *field, const RDParams *params, int left, int top, int right, int bottom);
+
+/// Make the generation written by stepFieldRows or stepFieldRect the current one and count it
+/// @param field The field to swap
+void swapField(RDField *field);
+
+/// Free the memory used by a field
+/// @param field The field to free
+void freeField(RDField *field);
+
+/// Get the a plane of the latest generation
+static inline RDReal *fieldA(const RDField *field) { return field->a[field->current]; }
+
+/// Get the b plane of the latest generation
+static inline RDReal *fieldB(const RDField *field) { return field->b[field->current]; }
+
+#endif
@@ -0,0 +1,537 @@
+// Steps a field with timesteps several generations long by solving the diffusion implicitly
+
+#include "rd_implicit.h"
+#include "rd_kernel.h"
+#include <math.h>
+#include <stdlib.h>
+
+#if RD_KERNEL_SIMD
+#include <immintrin.h>
+#endif
+
+// The nine point stencil's weights of 0.2 and 0.05 come to 0.3 of the five point Laplacian
+#define STENCIL_SCALE 0.3
+
+// The implicit solves spread a little b to every cell, which decays towards denormals that are
+// many times slower to calculate with, so anything solved below this is taken as 0
+#define NEGLIGIBLE 1e-20
+
+// The number of rows solved together, each row's solve is a chain of dependent multiplies
+#define ROW_BATCH 4
+
+/// The factors of the tridiagonal solve -r x[i - 1] + (1 + 2r) x[i] - r x[i + 1] = d[i], which only
+/// depend on r and the number of unknowns so are worked out once per call rather than per solve
+typedef struct {
+    double r;
+    double *upper;      // The upper diagonal after elimination
+    double *scale;      // What each row is divided by during elimination, as a multiplier
+} Solver;
+
+typedef struct ImplicitJob ImplicitJob;
+
+/// Step the reaction of a batch of rows explicitly and solve their diffusion along the rows,
+/// writing the result to the next generation. Each row's solve is a chain of dependent
+/// multiplies, so the rows of a batch are interleaved to keep several chains going at once.
+/// @param job The timestep being solved
+/// @param firstRow The first row of the batch
+/// @param rows The number of rows in the batch, at most ROW_BATCH
+/// @param aRows Scratch for ROW_BATCH rows of a, interleaved
+/// @param bRows Scratch for ROW_BATCH rows of b, interleaved
+typedef void (*RowSolve)(const ImplicitJob *job, int firstRow, int rows, double *aRows, double *bRows);
+
+/// Solve the diffusion of one chemical down a range of columns of the next generation in place.
+/// The columns are solved side by side a row at a time rather than one after another, so the
+/// solve walks through memory in order instead of striding down each column.
+/// @param job The timestep being solved
+/// @param plane The chemical's plane of the next generation
+/// @param solver The chemical's column solve
+/// @param left The first column of the range
+/// @param count The number of columns in the range
+/// @param strip Scratch for count columns of the height of the field less one
+typedef void (*StripSolve)(const ImplicitJob *job, RDReal *plane, const Solver *solver, int left, int count,
+    double *strip);
+
+/// The data for stepping every row then every column of a field a timestep at a time
+struct ImplicitJob {
+    RDField *field;
+    const RDParams *params;
+    RowSolve solveRows;     // The widest versions the field's kernel allows
+    StripSolve solveStrip;
+    double dt;              // The generations the timestep covers
+    int timeStep;           // The same as a whole number, to count the generations
+    Solver rowA;            // The solves along the rows and columns for each chemical
+    Solver rowB;
+    Solver columnA;
+    Solver columnB;
+    double *scratch;        // One share per thread, a batch of rows of each chemical then its columns
+    size_t scratchSize;     // The number of doubles in each thread's share
+    int phase;              // 0 while the rows are being solved, 1 while the columns are
+};
+
+static void initialiseSolver(Solver *solver, double r, int unknowns, double *memory)
+{
+    solver->r = r;
+    solver->upper = memory;
+    solver->scale = memory + unknowns;
+
+    // Thomas algorithm elimination, every pivot is at least 1 + r so it never needs pivoting
+    for (int i = 0; i < unknowns; i++)
+    {
+        double previous = i > 0 ? solver->upper[i - 1] : 0.0;
+        solver->scale[i] = 1.0 / (1.0 + 2.0 * r + r * previous);
+        solver->upper[i] = -r * solver->scale[i];
+    }
+}
+
+// Stop b decaying into denormals, see NEGLIGIBLE
+static inline double flushNegligible(double value)
+{
+    return fabs(value) < NEGLIGIBLE ? 0.0 : value;
+}
+
+// Clamp to the range of a and b
+static inline double clampUnit(double value)
+{
+    return value < 0.0 ? 0.0 : value > 1.0 ? 1.0 : value;
+}
+
+static void solveRowsScalar(const ImplicitJob *job, int firstRow, int rows, double *aRows, double *bRows)
+{
+    const RDField *field = job->field;
+    const RDReal *a[ROW_BATCH], *b[ROW_BATCH];
+    RDReal *aOut[ROW_BATCH], *bOut[ROW_BATCH];
+    double eliminatedA[ROW_BATCH], eliminatedB[ROW_BATCH];
+    const RDRateMap *rates = &field->rates;
+    const uint16_t *feedLevels[ROW_BATCH] = { NULL }, *killLevels[ROW_BATCH] = { NULL };
+    bool mapped = fieldHasRates(field);
+
+    for (int k = 0; k < rows; k++)
+    {
+        size_t row = (size_t) (firstRow + k) * field->stride;
+        a[k] = field->a[field->current] + row;
+        b[k] = field->b[field->current] + row;
+        aOut[k] = field->a[1 - field->current] + row;
+        bOut[k] = field->b[1 - field->current] + row;
+        if (mapped)
+        {
+            size_t levels = (size_t) (firstRow + k) * rates->stride;
+            feedLevels[k] = rates->feed + levels;
+            killLevels[k] = rates->kill + levels;
+        }
+
+        // Starting the elimination from the border cell adds its r times to the first row's right hand side
+        eliminatedA[k] = rdRealToDouble(a[k][0]);
+        eliminatedB[k] = rdRealToDouble(b[k][0]);
+    }
+
+    double dt = job->dt;
+    double feed = job->params->feedRate;
+    double feedKill = job->params->killRate + job->params->feedRate;
+    const Solver *solveA = &job->rowA;
+    const Solver *solveB = &job->rowB;
+    int unknowns = field->width - 2;
+
+    for (int i = 0; i < unknowns; i++)
+    {
+        for (int k = 0; k < rows; k++)
+        {
+            // The reaction is clamped to the range a and b can have, which only makes a difference
+            // when a long timestep would overshoot, like on the seed squares where a and b start at 1
+            double oldA = rdRealToDouble(a[k][i + 1]);
+            double oldB = rdRealToDouble(b[k][i + 1]);
+            double cellFeed = feed;
+            double cellFeedKill = feedKill;
+            if (mapped)
+            {
+                cellFeed = rdRateFromLevel(rates->feedLow, rates->feedHigh, feedLevels[k][i + 1]);
+                cellFeedKill = cellFeed + rdRateFromLevel(rates->killLow, rates->killHigh, killLevels[k][i + 1]);
+            }
+            double reaction = oldA * oldB * oldB;
+            double reactedA = clampUnit(oldA + dt * (cellFeed * (1.0 - oldA) - reaction));
+            double reactedB = clampUnit(oldB + dt * (reaction - cellFeedKill * oldB));
+
+            eliminatedA[k] = (reactedA + solveA->r * eliminatedA[k]) * solveA->scale[i];
+            eliminatedB[k] = flushNegligible((reactedB + solveB->r * eliminatedB[k]) * solveB->scale[i]);
+            aRows[i * ROW_BATCH + k] = eliminatedA[k];
+            bRows[i * ROW_BATCH + k] = eliminatedB[k];
+        }
+    }
+
+    double solvedA[ROW_BATCH], solvedB[ROW_BATCH];
+    int last = (unknowns - 1) * ROW_BATCH;
+    for (int k = 0; k < rows; k++)
+    {
+        // The border cell at the other end belongs to the last row's right hand side
+        solvedA[k] = aRows[last + k] + solveA->r * rdRealToDouble(a[k][unknowns + 1]) * solveA->scale[unknowns - 1];
+        solvedB[k] = bRows[last + k] + solveB->r * rdRealToDouble(b[k][unknowns + 1]) * solveB->scale[unknowns - 1];
+        aOut[k][unknowns] = rdRealFromDouble(solvedA[k]);
+        bOut[k][unknowns] = rdRealFromDouble(solvedB[k]);
+    }
+
+    for (int i = unknowns - 2; i >= 0; i--)
+    {
+        for (int k = 0; k < rows; k++)
+        {
+            solvedA[k] = aRows[i * ROW_BATCH + k] - solveA->upper[i] * solvedA[k];
+            solvedB[k] = flushNegligible(bRows[i * ROW_BATCH + k] - solveB->upper[i] * solvedB[k]);
+            aOut[k][i + 1] = rdRealFromDouble(solvedA[k]);
+            bOut[k][i + 1] = rdRealFromDouble(solvedB[k]);
+        }
+    }
+}
+
+static void solveStripScalar(const ImplicitJob *job, RDReal *plane, const Solver *solver, int left, int count,
+    double *strip)
+{
+    const RDField *field = job->field;
+    int stride = field->stride;
+    int unknowns = field->height - 2;
+    double r = solver->r;
+
+    // The strip's first row holds the border row, which starts the elimination like a row's border cell
+    for (int j = 0; j < count; j++) strip[j] = rdRealToDouble(plane[left + j]);
+
+    for (int i = 0; i < unknowns; i++)
+    {
+        const RDReal *in = plane + (size_t) (i + 1) * stride + left;
+        const double *previous = strip + (size_t) i * count;
+        double *eliminated = strip + (size_t) (i + 1) * count;
+        double scale = solver->scale[i];
+        for (int j = 0; j < count; j++) eliminated[j] = flushNegligible((rdRealToDouble(in[j]) + r * previous[j]) * scale);
+    }
+
+    double *solved = strip + (size_t) unknowns * count;
+    const RDReal *border = plane + (size_t) (unknowns + 1) * stride + left;
+    RDReal *out = plane + (size_t) unknowns * stride + left;
+    double lastScale = solver->scale[unknowns - 1];
+    for (int j = 0; j < count; j++)
+    {
+        solved[j] += r * rdRealToDouble(border[j]) * lastScale;
+        out[j] = rdRealFromDouble(solved[j]);
+    }
+
+    for (int i = unknowns - 2; i >= 0; i--)
+    {
+        const double *below = strip + (size_t) (i + 2) * count;
+        double upper = solver->upper[i];
+        solved = strip + (size_t) (i + 1) * count;
+        out = plane + (size_t) (i + 1) * stride + left;
+        for (int j = 0; j < count; j++)
+        {
+            solved[j] = flushNegligible(solved[j] - upper * below[j]);
+            out[j] = rdRealFromDouble(solved[j]);
+        }
+    }
+}
+
+#if RD_KERNEL_SIMD
+
+// The AVX2 solves do the same operations in the same order as the scalar ones, a lane per row
+// or column, and don't use fused multiply-adds so the results are bit identical
+
+#if RD_PRECISION == RD_PRECISION_FLOAT
+    #define LOAD_REALS(p) _mm256_cvtps_pd(_mm_loadu_ps(p))
+    #define STORE_REALS(p, v) _mm_storeu_ps(p, _mm256_cvtpd_ps(v))
+#else
+    #define LOAD_REALS(p) _mm256_loadu_pd(p)
+    #define STORE_REALS(p, v) _mm256_storeu_pd(p, v)
+#endif
+
+__attribute__((target("avx2")))
+static inline __m256d flushNegligibleAVX2(__m256d value)
+{
+    __m256d magnitude = _mm256_andnot_pd(_mm256_set1_pd(-0.0), value);
+    return _mm256_andnot_pd(_mm256_cmp_pd(magnitude, _mm256_set1_pd(NEGLIGIBLE), _CMP_LT_OQ), value);
+}
+
+// The operands are in the order that keeps a NaN or -0 the same as the scalar clamp
+__attribute__((target("avx2")))
+static inline __m256d clampUnitAVX2(__m256d value)
+{
+    return _mm256_min_pd(_mm256_set1_pd(1.0), _mm256_max_pd(_mm256_setzero_pd(), value));
+}
+
+// A cell from each row of a batch
+__attribute__((target("avx2")))
+static inline __m256d gatherRows(const RDReal *const *rows, int x)
+{
+    return _mm256_set_pd(rdRealToDouble(rows[3][x]), rdRealToDouble(rows[2][x]),
+        rdRealToDouble(rows[1][x]), rdRealToDouble(rows[0][x]));
+}
+
+// The rate a cell from each row of a batch has in a rate map, worked out as rdRateFromLevel does
+__attribute__((target("avx2")))
+static inline __m256d gatherRates(const uint16_t *const *levels, int x, double low, double high)
+{
+    __m256d cellLevels = _mm256_set_pd(levels[3][x], levels[2][x], levels[1][x], levels[0][x]);
+    __m256d step = _mm256_set1_pd((high - low) / RD_RATE_LEVEL_MAX);
+    return _mm256_add_pd(_mm256_set1_pd(low), _mm256_mul_pd(cellLevels, step));
+}
+
+__attribute__((target("avx2")))
+static inline void scatterRows(RDReal *const *rows, int x, __m256d values)
+{
+    double lanes[ROW_BATCH];
+    _mm256_storeu_pd(lanes, values);
+    for (int k = 0; k < ROW_BATCH; k++) rows[k][x] = rdRealFromDouble(lanes[k]);
+}
+
+// Only whole batches, the last few rows of a share are left to the scalar solve
+__attribute__((target("avx2")))
+static void solveRowsAVX2(const ImplicitJob *job, int firstRow, int rows, double *aRows, double *bRows)
+{
+    if (rows < ROW_BATCH)
+    {
+        solveRowsScalar(job, firstRow, rows, aRows, bRows);
+        return;
+    }
+
+    const RDField *field = job->field;
+    const RDReal *a[ROW_BATCH], *b[ROW_BATCH];
+    RDReal *aOut[ROW_BATCH], *bOut[ROW_BATCH];
+    const RDRateMap *rates = &field->rates;
+    const uint16_t *feedLevels[ROW_BATCH] = { NULL }, *killLevels[ROW_BATCH] = { NULL };
+    bool mapped = fieldHasRates(field);
+    for (int k = 0; k < ROW_BATCH; k++)
+    {
+        size_t row = (size_t) (firstRow + k) * field->stride;
+        a[k] = field->a[field->current] + row;
+        b[k] = field->b[field->current] + row;
+        aOut[k] = field->a[1 - field->current] + row;
+        bOut[k] = field->b[1 - field->current] + row;
+        if (mapped)
+        {
+            size_t levels = (size_t) (firstRow + k) * rates->stride;
+            feedLevels[k] = rates->feed + levels;
+            killLevels[k] = rates->kill + levels;
+        }
+    }
+
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d dt = _mm256_set1_pd(job->dt);
+    __m256d feed = _mm256_set1_pd(job->params->feedRate);
+    __m256d feedKill = _mm256_set1_pd(job->params->killRate + job->params->feedRate);
+    const Solver *solveA = &job->rowA;
+    const Solver *solveB = &job->rowB;
+    __m256d rA = _mm256_set1_pd(solveA->r);
+    __m256d rB = _mm256_set1_pd(solveB->r);
+    int unknowns = field->width - 2;
+
+    __m256d eliminatedA = gatherRows(a, 0);
+    __m256d eliminatedB = gatherRows(b, 0);
+    for (int i = 0; i < unknowns; i++)
+    {
+        __m256d oldA = gatherRows(a, i + 1);
+        __m256d oldB = gatherRows(b, i + 1);
+        __m256d cellFeed = feed;
+        __m256d cellFeedKill = feedKill;
+        if (mapped)
+        {
+            cellFeed = gatherRates(feedLevels, i + 1, rates->feedLow, rates->feedHigh);
+            cellFeedKill = _mm256_add_pd(cellFeed, gatherRates(killLevels, i + 1, rates->killLow, rates->killHigh));
+        }
+        __m256d reaction = _mm256_mul_pd(_mm256_mul_pd(oldA, oldB), oldB);
+        __m256d reactedA = clampUnitAVX2(_mm256_add_pd(oldA,
+            _mm256_mul_pd(dt, _mm256_sub_pd(_mm256_mul_pd(cellFeed, _mm256_sub_pd(one, oldA)), reaction))));
+        __m256d reactedB = clampUnitAVX2(_mm256_add_pd(oldB,
+            _mm256_mul_pd(dt, _mm256_sub_pd(reaction, _mm256_mul_pd(cellFeedKill, oldB)))));
+
+        eliminatedA = _mm256_mul_pd(_mm256_add_pd(reactedA, _mm256_mul_pd(rA, eliminatedA)),
+            _mm256_set1_pd(solveA->scale[i]));
+        eliminatedB = flushNegligibleAVX2(_mm256_mul_pd(_mm256_add_pd(reactedB, _mm256_mul_pd(rB, eliminatedB)),
+            _mm256_set1_pd(solveB->scale[i])));
+        _mm256_storeu_pd(aRows + i * ROW_BATCH, eliminatedA);
+        _mm256_storeu_pd(bRows + i * ROW_BATCH, eliminatedB);
+    }
+
+    int last = (unknowns - 1) * ROW_BATCH;
+    __m256d solvedA = _mm256_add_pd(_mm256_loadu_pd(aRows + last),
+        _mm256_mul_pd(_mm256_mul_pd(rA, gatherRows(a, unknowns + 1)), _mm256_set1_pd(solveA->scale[unknowns - 1])));
+    __m256d solvedB = _mm256_add_pd(_mm256_loadu_pd(bRows + last),
+        _mm256_mul_pd(_mm256_mul_pd(rB, gatherRows(b, unknowns + 1)), _mm256_set1_pd(solveB->scale[unknowns - 1])));
+    scatterRows(aOut, unknowns, solvedA);
+    scatterRows(bOut, unknowns, solvedB);
+
+    for (int i = unknowns - 2; i >= 0; i--)
+    {
+        solvedA = _mm256_sub_pd(_mm256_loadu_pd(aRows + i * ROW_BATCH),
+            _mm256_mul_pd(_mm256_set1_pd(solveA->upper[i]), solvedA));
+        solvedB = flushNegligibleAVX2(_mm256_sub_pd(_mm256_loadu_pd(bRows + i * ROW_BATCH),
+            _mm256_mul_pd(_mm256_set1_pd(solveB->upper[i]), solvedB)));
+        scatterRows(aOut, i + 1, solvedA);
+        scatterRows(bOut, i + 1, solvedB);
+    }
+}
+
+__attribute__((target("avx2")))
+static void solveStripAVX2(const ImplicitJob *job, RDReal *plane, const Solver *solver, int left, int count,
+    double *strip)
+{
+    const RDField *field = job->field;
+    int stride = field->stride;
+    int unknowns = field->height - 2;
+    int vectors = count & ~3;
+    double r = solver->r;
+    __m256d rVector = _mm256_set1_pd(r);
+
+    int j = 0;
+    for (; j < vectors; j += 4) _mm256_storeu_pd(strip + j, LOAD_REALS(plane + left + j));
+    for (; j < count; j++) strip[j] = rdRealToDouble(plane[left + j]);
+
+    for (int i = 0; i < unknowns; i++)
+    {
+        const RDReal *in = plane + (size_t) (i + 1) * stride + left;
+        const double *previous = strip + (size_t) i * count;
+        double *eliminated = strip + (size_t) (i + 1) * count;
+        double scale = solver->scale[i];
+        __m256d scaleVector = _mm256_set1_pd(scale);
+        for (j = 0; j < vectors; j += 4)
+        {
+            __m256d sum = _mm256_add_pd(LOAD_REALS(in + j), _mm256_mul_pd(rVector, _mm256_loadu_pd(previous + j)));
+            _mm256_storeu_pd(eliminated + j, flushNegligibleAVX2(_mm256_mul_pd(sum, scaleVector)));
+        }
+        for (; j < count; j++) eliminated[j] = flushNegligible((rdRealToDouble(in[j]) + r * previous[j]) * scale);
+    }
+
+    double *solved = strip + (size_t) unknowns * count;
+    const RDReal *border = plane + (size_t) (unknowns + 1) * stride + left;
+    RDReal *out = plane + (size_t) unknowns * stride + left;
+    double lastScale = solver->scale[unknowns - 1];
+    __m256d lastScaleVector = _mm256_set1_pd(lastScale);
+    for (j = 0; j < vectors; j += 4)
+    {
+        __m256d value = _mm256_add_pd(_mm256_loadu_pd(solved + j),
+            _mm256_mul_pd(_mm256_mul_pd(rVector, LOAD_REALS(border + j)), lastScaleVector));
+        _mm256_storeu_pd(solved + j, value);
+        STORE_REALS(out + j, value);
+    }
+    for (; j < count; j++)
+    {
+        solved[j] += r * rdRealToDouble(border[j]) * lastScale;
+        out[j] = rdRealFromDouble(solved[j]);
+    }
+
+    for (int i = unknowns - 2; i >= 0; i--)
+    {
+        const double *below = strip + (size_t) (i + 2) * count;
+        double upper = solver->upper[i];
+        __m256d upperVector = _mm256_set1_pd(upper);
+        solved = strip + (size_t) (i + 1) * count;
+        out = plane + (size_t) (i + 1) * stride + left;
+        for (j = 0; j < vectors; j += 4)
+        {
+            __m256d value = flushNegligibleAVX2(_mm256_sub_pd(_mm256_loadu_pd(solved + j),
+                _mm256_mul_pd(upperVector, _mm256_loadu_pd(below + j))));
+            _mm256_storeu_pd(solved + j, value);
+            STORE_REALS(out + j, value);
+        }
+        for (; j < count; j++)
+        {
+            solved[j] = flushNegligible(solved[j] - upper * below[j]);
+            out[j] = rdRealFromDouble(solved[j]);
+        }
+    }
+}
+
+#endif
+
+/// Solve one thread's share of the rows or the columns
+static void solveShare(void *data, int thread, int numThreads)
+{
+    ImplicitJob *job = (ImplicitJob *) data;
+    RDField *field = job->field;
+    double *scratch = job->scratch + job->scratchSize * thread;
+
+    if (job->phase == 0)
+    {
+        // Split the rows inside the border as evenly as possible
+        int interiorRows = field->height - 2;
+        int firstRow = 1 + (int) ((long long) interiorRows * thread / numThreads);
+        int lastRow = 1 + (int) ((long long) interiorRows * (thread + 1) / numThreads);
+        for (int y = firstRow; y < lastRow; y += ROW_BATCH)
+        {
+            int rows = lastRow - y < ROW_BATCH ? lastRow - y : ROW_BATCH;
+            job->solveRows(job, y, rows, scratch, scratch + (size_t) ROW_BATCH * field->width);
+        }
+        return;
+    }
+
+    // The same for the columns inside the border
+    int interiorColumns = field->width - 2;
+    int left = 1 + (int) ((long long) interiorColumns * thread / numThreads);
+    int right = 1 + (int) ((long long) interiorColumns * (thread + 1) / numThreads);
+    double *strip = scratch + 2 * (size_t) ROW_BATCH * field->width;
+    if (right > left)
+    {
+        job->solveStrip(job, field->a[1 - field->current], &job->columnA, left, right - left, strip);
+        job->solveStrip(job, field->b[1 - field->current], &job->columnB, left, right - left, strip);
+    }
+}
+
+/// Move on to the columns once the rows are done, and to the next timestep once the columns are
+static void finishPhase(void *data)
+{
+    ImplicitJob *job = (ImplicitJob *) data;
+    if (job->phase == 0)
+    {
+        job->phase = 1;
+        return;
+    }
+
+    job->phase = 0;
+    swapField(job->field);
+    job->field->generation += job->timeStep - 1;
+}
+
+/// Work out the solves for a timestep and step the field a number of them
+static void runTimeSteps(RDWorkerPool *pool, ImplicitJob *job, double *solverMemory, int timeStep, int steps)
+{
+    int rowUnknowns = job->field->width - 2;
+    int columnUnknowns = job->field->height - 2;
+    job->dt = timeStep;
+    job->timeStep = timeStep;
+    job->phase = 0;
+
+    double rA = STENCIL_SCALE * job->params->dA * timeStep;
+    double rB = STENCIL_SCALE * job->params->dB * timeStep;
+    initialiseSolver(&job->rowA, rA, rowUnknowns, solverMemory);
+    initialiseSolver(&job->rowB, rB, rowUnknowns, solverMemory + 2 * rowUnknowns);
+    initialiseSolver(&job->columnA, rA, columnUnknowns, solverMemory + 4 * rowUnknowns);
+    initialiseSolver(&job->columnB, rB, columnUnknowns, solverMemory + 4 * rowUnknowns + 2 * columnUnknowns);
+
+    // Every timestep is two passes, the rows then the columns
+    RDPoolJob poolJob = { solveShare, finishPhase, job, 2 * steps };
+    runPoolJob(pool, &poolJob);
+}
+
+bool stepFieldImplicit(RDWorkerPool *pool, RDField *field, const RDParams *params, int generations, int timeStep)
+{
+    if (timeStep <= 0) timeStep = RD_DEFAULT_TIME_STEP;
+    if (generations <= 0 || field->width < 3 || field->height < 3) return true;
+
+    // The factors of all four solves, then each thread's batch of rows of both chemicals and share of the columns
+    int numThreads = workerPoolSize(pool);
+    size_t solverSize = 4 * (size_t) (field->width - 2) + 4 * (size_t) (field->height - 2);
+    size_t columnShare = (size_t) (field->width - 2 + numThreads - 1) / numThreads + 1;
+    size_t scratchSize = 2 * (size_t) ROW_BATCH * field->width + columnShare * (field->height - 1);
+    double *memory = (double *) malloc((solverSize + scratchSize * numThreads) * sizeof(double));
+    if (memory == NULL) return false;
+
+    ImplicitJob job = { field, params, solveRowsScalar, solveStripScalar };
+#if RD_KERNEL_SIMD
+    if (field->kernel >= KERNEL_AVX2 && rdKernelSupported(KERNEL_AVX2))
+    {
+        job.solveRows = solveRowsAVX2;
+        job.solveStrip = solveStripAVX2;
+    }
+#endif
+    job.scratch = memory + solverSize;
+    job.scratchSize = scratchSize;
+
+    // Whole timesteps, then one shorter one for whatever is left
+    runTimeSteps(pool, &job, memory, timeStep, generations / timeStep);
+    if (generations % timeStep > 0) runTimeSteps(pool, &job, memory, generations % timeStep, 1);
+
+    free(memory);
+    return true;
+}
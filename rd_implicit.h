@@ -0,0 +1,37 @@
+// Steps a field with timesteps several generations long by solving the diffusion implicitly
+//
+// The kernels advance the field a generation at a time with an explicit update, which is only
+// stable while dA times the timestep is below about 1.25, so a generation is as far as a step can
+// go. The implicit integrator splits each timestep of dt generations into the reaction, stepped
+// explicitly, then the diffusion along the rows then along the columns, each solved implicitly
+// with a tridiagonal solve per row or column (alternating direction implicit, backward Euler in
+// each direction). The implicit solves are stable at any timestep, so the reaction's own accuracy
+// is what limits how long one can be.
+//
+// The implicit diffusion uses the five point Laplacian scaled to match the kernels' nine point
+// stencil, 0.3 * (left + right + up + down - 4 * centre), which is the same diffusion apart from
+// fourth order terms, and the border of the field stays fixed as it does for the kernels. The
+// results are an approximation of stepping a generation at a time, not the same generations,
+// so rd_bench --implicit reports how far the pattern drifts from the explicit one.
+
+#ifndef RD_IMPLICIT_H
+#define RD_IMPLICIT_H
+
+#include "rd_field.h"
+#include "rd_threads.h"
+
+/// The default number of generations each implicit timestep covers
+#define RD_DEFAULT_TIME_STEP 4
+
+/// Advance a field by a number of generations, timeStep generations at a time
+/// @param pool The pool to step with, NULL steps on the calling thread
+/// @param field The field to step
+/// @param params The feed, kill and diffusion rates to use, the feed and kill rates are ignored if the
+///               field has a rate map
+/// @param generations The number of generations to advance by, the last timestep is shorter if it
+///                    isn't a multiple of timeStep
+/// @param timeStep The number of generations each timestep covers, 0 or less uses RD_DEFAULT_TIME_STEP
+/// @return False if the scratch memory couldn't be allocated, in which case the field isn't stepped
+bool stepFieldImplicit(RDWorkerPool *pool, RDField *field, const RDParams *params, int generations, int timeStep);
+
+#endif
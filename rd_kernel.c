@@ -0,0 +1,254 @@
+// The scalar row kernels and runtime selection of the SIMD ones
+// Based on this tutorial http://karlsims.com/rd.html
+
+#include "rd_kernel.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *kernelNames[KERNEL_COUNT] = { "scalar", "sse2", "avx2", "avx512" };
+
+#if RD_PRECISION == RD_PRECISION_FIXED16
+
+// The rates are turned into fixed point with this many fractional bits for the multiplies
+#define RATE_SHIFT 30
+
+/// Shift a product right by a number of bits, rounding to the nearest value
+static inline int64_t roundShift(int64_t value, int shift)
+{
+    return (value + ((int64_t) 1 << (shift - 1))) >> shift;
+}
+
+/// Store a value, saturating it to the range of a fixed point cell
+static inline RDReal saturate(int64_t value)
+{
+    return (RDReal) (value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : value);
+}
+
+// The rates of a rate map's levels are kept with this many fractional bits so the steps between
+// levels stay exact enough before rounding them to RATE_SHIFT bits
+#define LEVEL_SHIFT 48
+
+void stepRowScalar(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    int stride, int first, int last, const RDParams *params)
+{
+    const RDReal *aUp = a - stride;
+    const RDReal *aDown = a + stride;
+    const RDReal *bUp = b - stride;
+    const RDReal *bDown = b + stride;
+
+    // The weights of 0.2 and 0.05 are 4 and 1 twentieths, so the convolutions are kept exact
+    // at twenty times their value and the twenty is folded into the diffusion rates
+    double rateScale = (double) ((int64_t) 1 << RATE_SHIFT);
+    int64_t dA = llround(params->dA / 20 * rateScale);
+    int64_t dB = llround(params->dB / 20 * rateScale);
+    int64_t feed = llround(params->feedRate * rateScale);
+    int64_t feedKill = llround((params->killRate + params->feedRate) * rateScale);
+
+    for (int x = first; x < last; x++)
+    {
+        int32_t aConvolution = 4 * (aUp[x] + aDown[x] + a[x - 1] + a[x + 1])
+            + (aUp[x - 1] + aUp[x + 1] + aDown[x - 1] + aDown[x + 1])
+            - 20 * a[x];
+        int32_t bConvolution = 4 * (bUp[x] + bDown[x] + b[x - 1] + b[x + 1])
+            + (bUp[x - 1] + bUp[x + 1] + bDown[x - 1] + bDown[x + 1])
+            - 20 * b[x];
+
+        int64_t oldA = a[x];
+        int64_t oldB = b[x];
+        int64_t reaction = roundShift(oldA * oldB * oldB, 2 * RD_FIXED_SHIFT);
+
+        aOut[x] = saturate(oldA + roundShift(dA * aConvolution, RATE_SHIFT) - reaction
+            + roundShift(feed * (RD_FIXED_ONE - oldA), RATE_SHIFT));
+        bOut[x] = saturate(oldB + roundShift(dB * bConvolution, RATE_SHIFT) + reaction
+            - roundShift(feedKill * oldB, RATE_SHIFT));
+    }
+}
+
+void stepMappedRowScalar(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    const uint16_t *feed, const uint16_t *kill, int stride, int first, int last, const RDParams *params,
+    const RDRateMap *rates)
+{
+    const RDReal *aUp = a - stride;
+    const RDReal *aDown = a + stride;
+    const RDReal *bUp = b - stride;
+    const RDReal *bDown = b + stride;
+
+    double rateScale = (double) ((int64_t) 1 << RATE_SHIFT);
+    double levelScale = (double) ((int64_t) 1 << LEVEL_SHIFT);
+    int64_t dA = llround(params->dA / 20 * rateScale);
+    int64_t dB = llround(params->dB / 20 * rateScale);
+    int64_t feedLow = llround(rates->feedLow * levelScale);
+    int64_t feedStep = llround((rates->feedHigh - rates->feedLow) / RD_RATE_LEVEL_MAX * levelScale);
+    int64_t killLow = llround(rates->killLow * levelScale);
+    int64_t killStep = llround((rates->killHigh - rates->killLow) / RD_RATE_LEVEL_MAX * levelScale);
+
+    for (int x = first; x < last; x++)
+    {
+        int32_t aConvolution = 4 * (aUp[x] + aDown[x] + a[x - 1] + a[x + 1])
+            + (aUp[x - 1] + aUp[x + 1] + aDown[x - 1] + aDown[x + 1])
+            - 20 * a[x];
+        int32_t bConvolution = 4 * (bUp[x] + bDown[x] + b[x - 1] + b[x + 1])
+            + (bUp[x - 1] + bUp[x + 1] + bDown[x - 1] + bDown[x + 1])
+            - 20 * b[x];
+
+        int64_t oldA = a[x];
+        int64_t oldB = b[x];
+        int64_t reaction = roundShift(oldA * oldB * oldB, 2 * RD_FIXED_SHIFT);
+
+        int64_t cellFeed = feedLow + feed[x] * feedStep;
+        int64_t cellKill = killLow + kill[x] * killStep;
+        int64_t cellFeedRate = roundShift(cellFeed, LEVEL_SHIFT - RATE_SHIFT);
+        int64_t cellFeedKill = roundShift(cellFeed + cellKill, LEVEL_SHIFT - RATE_SHIFT);
+
+        aOut[x] = saturate(oldA + roundShift(dA * aConvolution, RATE_SHIFT) - reaction
+            + roundShift(cellFeedRate * (RD_FIXED_ONE - oldA), RATE_SHIFT));
+        bOut[x] = saturate(oldB + roundShift(dB * bConvolution, RATE_SHIFT) + reaction
+            - roundShift(cellFeedKill * oldB, RATE_SHIFT));
+    }
+}
+
+#else
+
+void stepRowScalar(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    int stride, int first, int last, const RDParams *params)
+{
+    const RDReal *aUp = a - stride;
+    const RDReal *aDown = a + stride;
+    const RDReal *bUp = b - stride;
+    const RDReal *bDown = b + stride;
+
+    // Everything is done at the precision of the cells, which makes no difference for doubles
+    RDReal dA = (RDReal) params->dA;
+    RDReal dB = (RDReal) params->dB;
+    RDReal feed = (RDReal) params->feedRate;
+    RDReal feedKill = (RDReal) (params->killRate + params->feedRate);
+
+    for (int x = first; x < last; x++)
+    {
+        // Adjacent neighbours at a weight of 0.2 and diagonal neighbours at 0.05
+        RDReal aConvolution = (aUp[x] + aDown[x] + a[x - 1] + a[x + 1]) * (RDReal) 0.2
+            + (aUp[x - 1] + aUp[x + 1] + aDown[x - 1] + aDown[x + 1]) * (RDReal) 0.05
+            - a[x];
+        RDReal bConvolution = (bUp[x] + bDown[x] + b[x - 1] + b[x + 1]) * (RDReal) 0.2
+            + (bUp[x - 1] + bUp[x + 1] + bDown[x - 1] + bDown[x + 1]) * (RDReal) 0.05
+            - b[x];
+
+        RDReal oldA = a[x];
+        RDReal oldB = b[x];
+        RDReal reaction = oldA * (oldB * oldB);
+
+        aOut[x] = oldA + (dA * aConvolution - reaction + feed * (1 - oldA));
+        bOut[x] = oldB + (dB * bConvolution + reaction - feedKill * oldB);
+    }
+}
+
+void stepMappedRowScalar(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    const uint16_t *feed, const uint16_t *kill, int stride, int first, int last, const RDParams *params,
+    const RDRateMap *rates)
+{
+    const RDReal *aUp = a - stride;
+    const RDReal *aDown = a + stride;
+    const RDReal *bUp = b - stride;
+    const RDReal *bDown = b + stride;
+
+    RDReal dA = (RDReal) params->dA;
+    RDReal dB = (RDReal) params->dB;
+    RDReal feedLow = (RDReal) rates->feedLow;
+    RDReal feedStep = (RDReal) ((rates->feedHigh - rates->feedLow) / RD_RATE_LEVEL_MAX);
+    RDReal killLow = (RDReal) rates->killLow;
+    RDReal killStep = (RDReal) ((rates->killHigh - rates->killLow) / RD_RATE_LEVEL_MAX);
+
+    for (int x = first; x < last; x++)
+    {
+        // Adjacent neighbours at a weight of 0.2 and diagonal neighbours at 0.05
+        RDReal aConvolution = (aUp[x] + aDown[x] + a[x - 1] + a[x + 1]) * (RDReal) 0.2
+            + (aUp[x - 1] + aUp[x + 1] + aDown[x - 1] + aDown[x + 1]) * (RDReal) 0.05
+            - a[x];
+        RDReal bConvolution = (bUp[x] + bDown[x] + b[x - 1] + b[x + 1]) * (RDReal) 0.2
+            + (bUp[x - 1] + bUp[x + 1] + bDown[x - 1] + bDown[x + 1]) * (RDReal) 0.05
+            - b[x];
+
+        RDReal oldA = a[x];
+        RDReal oldB = b[x];
+        RDReal reaction = oldA * (oldB * oldB);
+        RDReal cellFeed = feedLow + (RDReal) feed[x] * feedStep;
+        RDReal cellFeedKill = cellFeed + (killLow + (RDReal) kill[x] * killStep);
+
+        aOut[x] = oldA + (dA * aConvolution - reaction + cellFeed * (1 - oldA));
+        bOut[x] = oldB + (dB * bConvolution + reaction - cellFeedKill * oldB);
+    }
+}
+
+#endif
+
+bool rdKernelSupported(RDKernelType kernel)
+{
+    switch (kernel)
+    {
+        case KERNEL_SCALAR: return true;
+#if RD_KERNEL_SIMD
+        case KERNEL_SSE2: return __builtin_cpu_supports("sse2");
+        case KERNEL_AVX2: return __builtin_cpu_supports("avx2");
+        case KERNEL_AVX512: return __builtin_cpu_supports("avx512f");
+#endif
+        default: return false;
+    }
+}
+
+RDKernelType rdDefaultKernel(void)
+{
+    const char *requested = getenv("RD_KERNEL");
+
+    if (requested != NULL)
+    {
+        for (int k = 0; k < KERNEL_COUNT; k++)
+        {
+            if (strcmp(requested, kernelNames[k]) == 0 && rdKernelSupported(k)) return k;
+        }
+    }
+
+    for (int k = KERNEL_COUNT - 1; k > KERNEL_SCALAR; k--)
+    {
+        if (rdKernelSupported(k)) return k;
+    }
+
+    return KERNEL_SCALAR;
+}
+
+const char *rdKernelName(RDKernelType kernel)
+{
+    if (kernel < 0 || kernel >= KERNEL_COUNT) return "unknown";
+
+    return kernelNames[kernel];
+}
+
+RDRowKernel rdGetRowKernel(RDKernelType kernel)
+{
+    if (!rdKernelSupported(kernel)) return stepRowScalar;
+
+    switch (kernel)
+    {
+#if RD_KERNEL_SIMD
+        case KERNEL_SSE2: return stepRowSSE2;
+        case KERNEL_AVX2: return stepRowAVX2;
+        case KERNEL_AVX512: return stepRowAVX512;
+#endif
+        default: return stepRowScalar;
+    }
+}
+
+RDMappedRowKernel rdGetMappedRowKernel(RDKernelType kernel)
+{
+    if (!rdKernelSupported(kernel)) return stepMappedRowScalar;
+
+    switch (kernel)
+    {
+#if RD_KERNEL_SIMD
+        case KERNEL_SSE2: return stepMappedRowSSE2;
+        case KERNEL_AVX2: return stepMappedRowAVX2;
+        case KERNEL_AVX512: return stepMappedRowAVX512;
+#endif
+        default: return stepMappedRowScalar;
+    }
+}
@@ -0,0 +1,148 @@
+// Row kernels for stepping a reaction diffusion field, with SIMD versions picked at runtime
+//
+// Every kernel does the same operations in the same order as the scalar kernel and none of
+// them use fused multiply-adds, so with the default build flags their results are bit
+// identical. RD_KERNEL_TOLERANCE is the largest difference allowed between any kernel and the
+// scalar one, which leaves room for a compiler that contracts the scalar kernel into FMAs.
+//
+// The mapped kernels step the same way with a feed and kill rate per cell instead of one of each,
+// turning each cell's 16 bit levels into rates as they go so the rates cost a quarter of the
+// memory traffic of a plane of doubles.
+
+#ifndef RD_KERNEL_H
+#define RD_KERNEL_H
+
+#include "rd_engine.h"
+#include "rd_real.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define RD_KERNEL_X86 1
+#else
+    #define RD_KERNEL_X86 0
+#endif
+
+// The SIMD kernels are only written for floating point cells, fixed point builds step with the
+// scalar kernel whichever one is asked for
+#if RD_KERNEL_X86 && RD_PRECISION != RD_PRECISION_FIXED16
+    #define RD_KERNEL_SIMD 1
+#else
+    #define RD_KERNEL_SIMD 0
+#endif
+
+/// The largest absolute difference in a or b allowed between a SIMD kernel and the scalar one
+#define RD_KERNEL_TOLERANCE 1e-12
+
+typedef enum {
+    KERNEL_SCALAR,
+    KERNEL_SSE2,
+    KERNEL_AVX2,
+    KERNEL_AVX512,
+    KERNEL_COUNT
+} RDKernelType;
+
+/// The level of a rate map that stands for its high rate, level 0 stands for the low rate
+#define RD_RATE_LEVEL_MAX 65535
+
+/// Feed and kill rates that vary from cell to cell, each quantised to a 16 bit level between a
+/// low and a high rate and stored in a plane laid out like the chemical planes
+typedef struct {
+    uint16_t *feed;     // The feed levels, NULL when the params' rates are used everywhere
+    uint16_t *kill;     // The kill levels
+    int stride;         // The number of levels between the start of one row and the next
+    double feedLow;
+    double feedHigh;
+    double killLow;
+    double killHigh;
+    void *memory;       // The allocation backing both planes, NULL if they belong to another map
+} RDRateMap;
+
+/// Get the rate a level of a rate map stands for
+/// @param low The rate at level 0
+/// @param high The rate at RD_RATE_LEVEL_MAX
+/// @param level The level
+/// @return The rate
+static inline double rdRateFromLevel(double low, double high, uint16_t level)
+{
+    return low + level * ((high - low) / RD_RATE_LEVEL_MAX);
+}
+
+/// Advance a span of one row of cells by one generation
+/// @param a The old a values of the row, the rows above and below are a stride away
+/// @param b The old b values of the row, the rows above and below are a stride away
+/// @param aOut Where to write the new a values of the row
+/// @param bOut Where to write the new b values of the row
+/// @param stride The number of values between the start of one row and the next
+/// @param first The first column to step
+/// @param last One past the last column to step
+/// @param params The feed, kill and diffusion rates to use
+typedef void (*RDRowKernel)(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    int stride, int first, int last, const RDParams *params);
+
+/// Advance a span of one row of cells by one generation with the feed and kill rates of each cell
+/// taken from a rate map
+/// @param a The old a values of the row, the rows above and below are a stride away
+/// @param b The old b values of the row, the rows above and below are a stride away
+/// @param aOut Where to write the new a values of the row
+/// @param bOut Where to write the new b values of the row
+/// @param feed The feed levels of the row
+/// @param kill The kill levels of the row
+/// @param stride The number of values between the start of one row and the next
+/// @param first The first column to step
+/// @param last One past the last column to step
+/// @param params The diffusion rates to use, the feed and kill rates are ignored
+/// @param rates The map the levels come from, for the range of rates they stand for
+typedef void (*RDMappedRowKernel)(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    const uint16_t *feed, const uint16_t *kill, int stride, int first, int last, const RDParams *params,
+    const RDRateMap *rates);
+
+/// Check whether this build and CPU can run a kernel
+/// @param kernel The kernel to check
+/// @return True if the kernel can be used
+bool rdKernelSupported(RDKernelType kernel);
+
+/// Get the kernel new fields should use, the widest supported one unless the RD_KERNEL
+/// environment variable names another supported kernel
+/// @return The kernel to use
+RDKernelType rdDefaultKernel(void);
+
+/// Get the name of a kernel
+/// @param kernel The kernel to name
+/// @return The name used by RD_KERNEL and rd_bench
+const char *rdKernelName(RDKernelType kernel);
+
+/// Get the row function of a kernel
+/// @param kernel The kernel to get, falls back to the scalar kernel if it isn't supported
+/// @return The function that steps a row span
+RDRowKernel rdGetRowKernel(RDKernelType kernel);
+
+/// Get the row function of a kernel that takes its feed and kill rates from a rate map
+/// @param kernel The kernel to get, falls back to the scalar kernel if it isn't supported
+/// @return The function that steps a row span
+RDMappedRowKernel rdGetMappedRowKernel(RDKernelType kernel);
+
+void stepRowScalar(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    int stride, int first, int last, const RDParams *params);
+
+void stepMappedRowScalar(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    const uint16_t *feed, const uint16_t *kill, int stride, int first, int last, const RDParams *params,
+    const RDRateMap *rates);
+
+#if RD_KERNEL_SIMD
+void stepRowSSE2(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    int stride, int first, int last, const RDParams *params);
+void stepRowAVX2(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    int stride, int first, int last, const RDParams *params);
+void stepRowAVX512(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    int stride, int first, int last, const RDParams *params);
+void stepMappedRowSSE2(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    const uint16_t *feed, const uint16_t *kill, int stride, int first, int last, const RDParams *params,
+    const RDRateMap *rates);
+void stepMappedRowAVX2(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    const uint16_t *feed, const uint16_t *kill, int stride, int first, int last, const RDParams *params,
+    const RDRateMap *rates);
+void stepMappedRowAVX512(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    const uint16_t *feed, const uint16_t *kill, int stride, int first, int last, const RDParams *params,
+    const RDRateMap *rates);
+#endif
+
+#endif
@@ -0,0 +1,36 @@
+// The AVX2 row kernels, only called when the CPU reports AVX2 support
+
+#include "rd_kernel.h"
+
+#if RD_KERNEL_SIMD
+
+#include <immintrin.h>
+
+#define SIMD_NAME stepRowAVX2
+#define SIMD_MAPPED_NAME stepMappedRowAVX2
+#define SIMD_TARGET "avx2"
+#if RD_PRECISION == RD_PRECISION_FLOAT
+    #define SIMD_WIDTH 8
+    #define SIMD_VEC __m256
+    #define SIMD_LOAD(p) _mm256_loadu_ps(p)
+    #define SIMD_STORE(p, v) _mm256_storeu_ps(p, v)
+    #define SIMD_SET1(v) _mm256_set1_ps(v)
+    #define SIMD_ADD(x, y) _mm256_add_ps(x, y)
+    #define SIMD_SUB(x, y) _mm256_sub_ps(x, y)
+    #define SIMD_MUL(x, y) _mm256_mul_ps(x, y)
+    #define SIMD_LEVELS(p) _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) (p))))
+#else
+    #define SIMD_WIDTH 4
+    #define SIMD_VEC __m256d
+    #define SIMD_LOAD(p) _mm256_loadu_pd(p)
+    #define SIMD_STORE(p, v) _mm256_storeu_pd(p, v)
+    #define SIMD_SET1(v) _mm256_set1_pd(v)
+    #define SIMD_ADD(x, y) _mm256_add_pd(x, y)
+    #define SIMD_SUB(x, y) _mm256_sub_pd(x, y)
+    #define SIMD_MUL(x, y) _mm256_mul_pd(x, y)
+    #define SIMD_LEVELS(p) _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *) (p))))
+#endif
+
+#include "rd_kernel_simd.h"
+
+#endif
@@ -0,0 +1,36 @@
+// The AVX-512 row kernels, only called when the CPU reports AVX-512F support
+
+#include "rd_kernel.h"
+
+#if RD_KERNEL_SIMD
+
+#include <immintrin.h>
+
+#define SIMD_NAME stepRowAVX512
+#define SIMD_MAPPED_NAME stepMappedRowAVX512
+#define SIMD_TARGET "avx512f"
+#if RD_PRECISION == RD_PRECISION_FLOAT
+    #define SIMD_WIDTH 16
+    #define SIMD_VEC __m512
+    #define SIMD_LOAD(p) _mm512_loadu_ps(p)
+    #define SIMD_STORE(p, v) _mm512_storeu_ps(p, v)
+    #define SIMD_SET1(v) _mm512_set1_ps(v)
+    #define SIMD_ADD(x, y) _mm512_add_ps(x, y)
+    #define SIMD_SUB(x, y) _mm512_sub_ps(x, y)
+    #define SIMD_MUL(x, y) _mm512_mul_ps(x, y)
+    #define SIMD_LEVELS(p) _mm512_cvtepi32_ps(_mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *) (p))))
+#else
+    #define SIMD_WIDTH 8
+    #define SIMD_VEC __m512d
+    #define SIMD_LOAD(p) _mm512_loadu_pd(p)
+    #define SIMD_STORE(p, v) _mm512_storeu_pd(p, v)
+    #define SIMD_SET1(v) _mm512_set1_pd(v)
+    #define SIMD_ADD(x, y) _mm512_add_pd(x, y)
+    #define SIMD_SUB(x, y) _mm512_sub_pd(x, y)
+    #define SIMD_MUL(x, y) _mm512_mul_pd(x, y)
+    #define SIMD_LEVELS(p) _mm512_cvtepi32_pd(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) (p))))
+#endif
+
+#include "rd_kernel_simd.h"
+
+#endif
@@ -0,0 +1,97 @@
+// The body shared by the SIMD row kernels, included once by each rd_kernel_*.c file after it
+// defines the vector type and operations for its instruction set:
+//   SIMD_NAME          the name of the row kernel function
+//   SIMD_MAPPED_NAME   the name of the row kernel function that takes its rates from a rate map
+//   SIMD_TARGET        the instruction set passed to the target attribute
+//   SIMD_WIDTH         the number of RDReal values in a vector
+//   SIMD_VEC           the vector type
+//   SIMD_LOAD, SIMD_STORE, SIMD_SET1, SIMD_ADD, SIMD_SUB, SIMD_MUL
+//   SIMD_LEVELS        load SIMD_WIDTH 16 bit rate map levels and convert them to a vector
+//
+// The operations are grouped exactly as they are in stepRowScalar and stepMappedRowScalar so each
+// lane produces the same result the scalar kernels would.
+
+/// Step the SIMD_WIDTH cells from x with a vector of feed rates and one of feed plus kill rates
+__attribute__((target(SIMD_TARGET), always_inline))
+static inline void stepVector(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut, int stride, int x,
+    SIMD_VEC dA, SIMD_VEC dB, SIMD_VEC feed, SIMD_VEC feedKill)
+{
+    const RDReal *aUp = a - stride;
+    const RDReal *aDown = a + stride;
+    const RDReal *bUp = b - stride;
+    const RDReal *bDown = b + stride;
+
+    SIMD_VEC adjacentWeight = SIMD_SET1(0.2);
+    SIMD_VEC diagonalWeight = SIMD_SET1(0.05);
+    SIMD_VEC one = SIMD_SET1(1.0);
+
+    SIMD_VEC oldA = SIMD_LOAD(a + x);
+    SIMD_VEC oldB = SIMD_LOAD(b + x);
+
+    // Adjacent neighbours at a weight of 0.2 and diagonal neighbours at 0.05
+    SIMD_VEC aAdjacent = SIMD_ADD(SIMD_ADD(SIMD_ADD(SIMD_LOAD(aUp + x), SIMD_LOAD(aDown + x)),
+        SIMD_LOAD(a + x - 1)), SIMD_LOAD(a + x + 1));
+    SIMD_VEC aDiagonal = SIMD_ADD(SIMD_ADD(SIMD_ADD(SIMD_LOAD(aUp + x - 1), SIMD_LOAD(aUp + x + 1)),
+        SIMD_LOAD(aDown + x - 1)), SIMD_LOAD(aDown + x + 1));
+    SIMD_VEC aConvolution = SIMD_SUB(SIMD_ADD(SIMD_MUL(aAdjacent, adjacentWeight),
+        SIMD_MUL(aDiagonal, diagonalWeight)), oldA);
+
+    SIMD_VEC bAdjacent = SIMD_ADD(SIMD_ADD(SIMD_ADD(SIMD_LOAD(bUp + x), SIMD_LOAD(bDown + x)),
+        SIMD_LOAD(b + x - 1)), SIMD_LOAD(b + x + 1));
+    SIMD_VEC bDiagonal = SIMD_ADD(SIMD_ADD(SIMD_ADD(SIMD_LOAD(bUp + x - 1), SIMD_LOAD(bUp + x + 1)),
+        SIMD_LOAD(bDown + x - 1)), SIMD_LOAD(bDown + x + 1));
+    SIMD_VEC bConvolution = SIMD_SUB(SIMD_ADD(SIMD_MUL(bAdjacent, adjacentWeight),
+        SIMD_MUL(bDiagonal, diagonalWeight)), oldB);
+
+    SIMD_VEC reaction = SIMD_MUL(oldA, SIMD_MUL(oldB, oldB));
+
+    SIMD_VEC newA = SIMD_ADD(oldA, SIMD_ADD(SIMD_SUB(SIMD_MUL(dA, aConvolution), reaction),
+        SIMD_MUL(feed, SIMD_SUB(one, oldA))));
+    SIMD_VEC newB = SIMD_ADD(oldB, SIMD_SUB(SIMD_ADD(SIMD_MUL(dB, bConvolution), reaction),
+        SIMD_MUL(feedKill, oldB)));
+
+    SIMD_STORE(aOut + x, newA);
+    SIMD_STORE(bOut + x, newB);
+}
+
+__attribute__((target(SIMD_TARGET)))
+void SIMD_NAME(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    int stride, int first, int last, const RDParams *params)
+{
+    SIMD_VEC dA = SIMD_SET1(params->dA);
+    SIMD_VEC dB = SIMD_SET1(params->dB);
+    SIMD_VEC feed = SIMD_SET1(params->feedRate);
+    SIMD_VEC feedKill = SIMD_SET1(params->killRate + params->feedRate);
+
+    int x = first;
+    for (; x + SIMD_WIDTH <= last; x += SIMD_WIDTH)
+    {
+        stepVector(a, b, aOut, bOut, stride, x, dA, dB, feed, feedKill);
+    }
+
+    // Finish off the cells that don't fill a whole vector
+    stepRowScalar(a, b, aOut, bOut, stride, x, last, params);
+}
+
+__attribute__((target(SIMD_TARGET)))
+void SIMD_MAPPED_NAME(const RDReal *a, const RDReal *b, RDReal *aOut, RDReal *bOut,
+    const uint16_t *feed, const uint16_t *kill, int stride, int first, int last, const RDParams *params,
+    const RDRateMap *rates)
+{
+    SIMD_VEC dA = SIMD_SET1(params->dA);
+    SIMD_VEC dB = SIMD_SET1(params->dB);
+    SIMD_VEC feedLow = SIMD_SET1(rates->feedLow);
+    SIMD_VEC feedStep = SIMD_SET1((rates->feedHigh - rates->feedLow) / RD_RATE_LEVEL_MAX);
+    SIMD_VEC killLow = SIMD_SET1(rates->killLow);
+    SIMD_VEC killStep = SIMD_SET1((rates->killHigh - rates->killLow) / RD_RATE_LEVEL_MAX);
+
+    int x = first;
+    for (; x + SIMD_WIDTH <= last; x += SIMD_WIDTH)
+    {
+        SIMD_VEC cellFeed = SIMD_ADD(feedLow, SIMD_MUL(SIMD_LEVELS(feed + x), feedStep));
+        SIMD_VEC cellKill = SIMD_ADD(killLow, SIMD_MUL(SIMD_LEVELS(kill + x), killStep));
+        stepVector(a, b, aOut, bOut, stride, x, dA, dB, cellFeed, SIMD_ADD(cellFeed, cellKill));
+    }
+
+    stepMappedRowScalar(a, b, aOut, bOut, feed, kill, stride, x, last, params, rates);
+}
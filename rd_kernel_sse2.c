@@ -0,0 +1,36 @@
+// The SSE2 row kernels, only called when the CPU reports SSE2 support
+
+#include "rd_kernel.h"
+
+#if RD_KERNEL_SIMD
+
+#include <emmintrin.h>
+
+#define SIMD_NAME stepRowSSE2
+#define SIMD_MAPPED_NAME stepMappedRowSSE2
+#define SIMD_TARGET "sse2"
+#if RD_PRECISION == RD_PRECISION_FLOAT
+    #define SIMD_WIDTH 4
+    #define SIMD_VEC __m128
+    #define SIMD_LOAD(p) _mm_loadu_ps(p)
+    #define SIMD_STORE(p, v) _mm_storeu_ps(p, v)
+    #define SIMD_SET1(v) _mm_set1_ps(v)
+    #define SIMD_ADD(x, y) _mm_add_ps(x, y)
+    #define SIMD_SUB(x, y) _mm_sub_ps(x, y)
+    #define SIMD_MUL(x, y) _mm_mul_ps(x, y)
+    #define SIMD_LEVELS(p) _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *) (p)), _mm_setzero_si128()))
+#else
+    #define SIMD_WIDTH 2
+    #define SIMD_VEC __m128d
+    #define SIMD_LOAD(p) _mm_loadu_pd(p)
+    #define SIMD_STORE(p, v) _mm_storeu_pd(p, v)
+    #define SIMD_SET1(v) _mm_set1_pd(v)
+    #define SIMD_ADD(x, y) _mm_add_pd(x, y)
+    #define SIMD_SUB(x, y) _mm_sub_pd(x, y)
+    #define SIMD_MUL(x, y) _mm_mul_pd(x, y)
+    #define SIMD_LEVELS(p) _mm_cvtepi32_pd(_mm_unpacklo_epi16(_mm_loadu_si32(p), _mm_setzero_si128()))
+#endif
+
+#include "rd_kernel_simd.h"
+
+#endif
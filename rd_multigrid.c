@@ -0,0 +1,149 @@
+// Starts a field from a simulation run at a coarser resolution
+
+#include "rd_multigrid.h"
+#include <stdio.h>
+
+int parseWarmStages(const char *text, RDWarmStage *stages, int maxStages)
+{
+    int numStages = 0;
+
+    while (numStages < maxStages)
+    {
+        int scale, steps, length;
+        if (sscanf(text, "%d:%d%n", &scale, &steps, &length) != 2 || scale < 1 || steps < 0) return 0;
+
+        stages[numStages++] = (RDWarmStage){ scale, steps };
+        text += length;
+
+        if (*text == '\0') return numStages;
+        if (*text++ != ',') return 0;
+    }
+
+    return 0;
+}
+
+// Get the two cells either side of a position along one axis and how far it is past the first,
+// positions are of cell centres so the edge cells are clamped rather than blended with the border
+static inline void sampleAxis(double position, int size, int *first, int *second, double *fraction)
+{
+    if (position < 0.0) position = 0.0;
+    if (position > size - 1) position = size - 1;
+
+    *first = (int) position;
+    *second = *first + 1 < size ? *first + 1 : *first;
+    *fraction = position - *first;
+}
+
+void resampleField(const RDField *source, RDField *destination)
+{
+    const RDReal *a = fieldA(source);
+    const RDReal *b = fieldB(source);
+    RDReal *newA = fieldA(destination);
+    RDReal *newB = fieldB(destination);
+
+    double scaleX = (double) source->width / destination->width;
+    double scaleY = (double) source->height / destination->height;
+
+    for (int y = 1; y < destination->height - 1; y++)
+    {
+        int top, bottom;
+        double fy;
+        sampleAxis((y + 0.5) * scaleY - 0.5, source->height, &top, &bottom, &fy);
+
+        const RDReal *aTop = a + (size_t) top * source->stride;
+        const RDReal *aBottom = a + (size_t) bottom * source->stride;
+        const RDReal *bTop = b + (size_t) top * source->stride;
+        const RDReal *bBottom = b + (size_t) bottom * source->stride;
+
+        for (int x = 1; x < destination->width - 1; x++)
+        {
+            int left, right;
+            double fx;
+            sampleAxis((x + 0.5) * scaleX - 0.5, source->width, &left, &right, &fx);
+
+            double aUpper = rdRealToDouble(aTop[left]) + (rdRealToDouble(aTop[right]) - rdRealToDouble(aTop[left])) * fx;
+            double aLower = rdRealToDouble(aBottom[left])
+                + (rdRealToDouble(aBottom[right]) - rdRealToDouble(aBottom[left])) * fx;
+            double bUpper = rdRealToDouble(bTop[left]) + (rdRealToDouble(bTop[right]) - rdRealToDouble(bTop[left])) * fx;
+            double bLower = rdRealToDouble(bBottom[left])
+                + (rdRealToDouble(bBottom[right]) - rdRealToDouble(bBottom[left])) * fx;
+
+            size_t i = (size_t) y * destination->stride + x;
+            newA[i] = rdRealFromDouble(aUpper + (aLower - aUpper) * fy);
+            newB[i] = rdRealFromDouble(bUpper + (bLower - bUpper) * fy);
+        }
+    }
+}
+
+RDParams coarseParams(const RDParams *params, double scale)
+{
+    // The laplacian of a grid with cells scale times as wide is scale squared times smaller for
+    // the same concentrations, so dividing the diffusion rates by that keeps every step the same
+    // amount of time. Reaction doesn't depend on the cell size at all.
+    RDParams coarse = *params;
+    coarse.dA /= scale * scale;
+    coarse.dB /= scale * scale;
+    return coarse;
+}
+
+// Initialise a field a scale smaller than the full grid, with seed squares covering the same area
+static bool initialiseCoarseField(RDField *field, int width, int height, int scale, RDSeed seed, int bSquareSize)
+{
+    // Too few cells and the seed squares won't fit
+    int coarseWidth = (width + scale - 1) / scale;
+    int coarseHeight = (height + scale - 1) / scale;
+    if (coarseWidth < 16) coarseWidth = 16;
+    if (coarseHeight < 16) coarseHeight = 16;
+
+    int coarseSquareSize = (bSquareSize + scale / 2) / scale;
+    if (coarseSquareSize < 1) coarseSquareSize = 1;
+
+    return initialiseField(field, coarseWidth, coarseHeight, seed, coarseSquareSize);
+}
+
+bool warmStartField(RDWorkerPool *pool, RDField *field, int width, int height, RDSeed seed, int bSquareSize,
+    const RDParams *params, const RDWarmStage *stages, int numStages)
+{
+    RDField coarse;
+    long long generation = 0;
+    bool haveCoarse = false;
+
+    for (int s = 0; s < numStages; s++)
+    {
+        RDField next;
+        if (!initialiseCoarseField(&next, width, height, stages[s].scale, seed, bSquareSize))
+        {
+            if (haveCoarse) freeField(&coarse);
+            return false;
+        }
+
+        if (haveCoarse)
+        {
+            resampleField(&coarse, &next);
+            freeField(&coarse);
+        }
+
+        // Each stage's cells are a different size from the full grid's depending on how it was rounded
+        RDParams stageParams = coarseParams(params, (double) width / next.width);
+        stepFieldParallel(pool, &next, &stageParams, stages[s].steps);
+        generation += stages[s].steps;
+
+        coarse = next;
+        haveCoarse = true;
+    }
+
+    if (!initialiseField(field, width, height, seed, bSquareSize))
+    {
+        if (haveCoarse) freeField(&coarse);
+        return false;
+    }
+
+    if (haveCoarse)
+    {
+        resampleField(&coarse, field);
+        freeField(&coarse);
+    }
+
+    field->generation = generation;
+    return true;
+}
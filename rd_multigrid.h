@@ -0,0 +1,65 @@
+// Starts a field from a simulation run at a coarser resolution
+//
+// Most of the time it takes a big field to develop a pattern is spent waiting for the pattern to
+// spread out from the seed squares. A grid with half the cells across covers the same area with a
+// quarter of the cells, and with the diffusion rates divided by four each of its steps advances
+// the same amount of time as a step of the full grid. Warm starting runs the early steps on one
+// or more coarse grids, upsamples each onto the next finer one and finishes at full resolution,
+// so the spreading happens at a fraction of the cost and the full grid only has to sharpen the
+// pattern it's handed.
+//
+// A coarse grid still has to resolve the pattern. With the default parameters the spots are only
+// a few cells across, so at half the resolution the pattern spreads just as it does at full
+// resolution but at a quarter it gets stuck to the grid and stops spreading altogether.
+
+#ifndef RD_MULTIGRID_H
+#define RD_MULTIGRID_H
+
+#include "rd_field.h"
+#include "rd_threads.h"
+
+/// The most stages a warm start can have
+#define RD_MAX_WARM_STAGES 8
+
+/// One coarse stage of a warm start
+typedef struct {
+    int scale;      // How many cells across of the full grid each coarse cell covers, e.g. 2 or 4
+    int steps;      // The number of generations to step at that scale
+} RDWarmStage;
+
+/// Parse warm start stages written as scale:steps pairs separated by commas, e.g. "4:3000,2:1000"
+/// @param text The text to parse
+/// @param stages Filled with the stages
+/// @param maxStages The most stages to fill
+/// @return The number of stages, 0 if the text isn't a list of stages
+int parseWarmStages(const char *text, RDWarmStage *stages, int maxStages);
+
+/// Resample a field onto a field of a different size covering the same area with bilinear
+/// interpolation, every cell not on the border of the destination is overwritten
+/// @param source The field to resample
+/// @param destination The field to write the latest generation of
+void resampleField(const RDField *source, RDField *destination);
+
+/// Get the parameters that step a grid scaled down by a factor at the same rate per generation as
+/// the full grid, only the diffusion rates change
+/// @param params The parameters of the full grid
+/// @param scale How many cells across of the full grid each coarse cell covers
+/// @return The parameters for the coarse grid
+RDParams coarseParams(const RDParams *params, double scale);
+
+/// Initialise a field from seed squares stepped through a series of coarse stages, coarsest first,
+/// and resampled onto it, as if it had been stepped from the seed squares for the total steps
+/// @param pool The pool to step the coarse stages with, NULL steps on the calling thread
+/// @param field The field to initialise
+/// @param width The number of horizontal cells in the simulation
+/// @param height The number of vertical cells in the simulation
+/// @param seed The layout of the starting squares
+/// @param bSquareSize Half the size of the squares of cells used to start the simulation
+/// @param params The feed, kill and diffusion rates of the full grid
+/// @param stages The coarse stages, NULL or none initialises the field from the seed squares
+/// @param numStages The number of stages
+/// @return False if the memory for any of the fields couldn't be allocated
+bool warmStartField(RDWorkerPool *pool, RDField *field, int width, int height, RDSeed seed, int bSquareSize,
+    const RDParams *params, const RDWarmStage *stages, int numStages);
+
+#endif
@@ -0,0 +1,175 @@
+// The pointer-neighbour layout the original reaction_diffusion_grid.c stepped
+// Based on this tutorial http://karlsims.com/rd.html
+
+#include "rd_neighbour.h"
+#include <stdlib.h>
+
+/// Calculate the average of all neighbours with weights depending position
+/// @param cell The cell to run the convolution on
+/// @param a Whether to run this operation on a cell's a chemical or b chemical
+/// @param oldIndex Which index in the a or b array is from the previous frame
+/// @return The weighted average of this cell's neighbouring cells
+static double convolution(NeighbourCell *cell, bool a, int oldIndex)
+{
+    double convolution = 0.0;
+
+    if (a)
+    {
+        // Calculate adjacent neightbours at a weight of 0.2
+        for (int i = 0; i < 4; i++)
+        {
+            convolution += cell->adjacent[i]->a[oldIndex] * 0.2;
+        }
+
+        // Calculate diagonal neightbours at a weight of 0.05
+        for (int i = 0; i < 4; i++)
+        {
+            convolution += cell->diagonal[i]->a[oldIndex] * 0.05;
+        }
+
+        convolution -= cell->a[oldIndex];
+    }
+    else
+    {
+        // Calculate adjacent neightbours at a weight of 0.2
+        for (int i = 0; i < 4; i++)
+        {
+            convolution += cell->adjacent[i]->b[oldIndex] * 0.2;
+        }
+
+        // Calculate diagonal neightbours at a weight of 0.05
+        for (int i = 0; i < 4; i++)
+        {
+            convolution += cell->diagonal[i]->b[oldIndex] * 0.05;
+        }
+
+        convolution -= cell->b[oldIndex];
+    }
+
+    return convolution;
+}
+
+bool initialiseNeighbourGrid(NeighbourGrid *grid, int rows, int columns, RDSeed seed, int bSquareSize)
+{
+    grid->rows = rows;
+    grid->columns = columns;
+    grid->current = 0;
+    grid->cells = NULL;
+
+    // The seed squares are set without bounds checks, so refuse any that would reach the border
+    if (!rdSeedFits(seed, rows, columns, bSquareSize)) return false;
+
+    // Calloced so a grid that runs out of memory part way through can be freed like a whole one
+    grid->cells = (NeighbourCell **) calloc(rows, sizeof(NeighbourCell *));
+    if (grid->cells == NULL) return false;
+    for (int i = 0; i < rows; i++)
+    {
+        grid->cells[i] = (NeighbourCell *) calloc(columns, sizeof(NeighbourCell));
+        if (grid->cells[i] == NULL)
+        {
+            freeNeighbourGrid(grid);
+            return false;
+        }
+        for (int j = 0; j < columns; j++)
+        {
+            grid->cells[i][j].a = (double *) malloc(2 * sizeof(double));
+            grid->cells[i][j].b = (double *) malloc(2 * sizeof(double));
+            grid->cells[i][j].adjacent = (NeighbourCell **) malloc(4 * sizeof(NeighbourCell *));
+            grid->cells[i][j].diagonal = (NeighbourCell **) malloc(4 * sizeof(NeighbourCell *));
+            if (grid->cells[i][j].a == NULL || grid->cells[i][j].b == NULL || grid->cells[i][j].adjacent == NULL
+                || grid->cells[i][j].diagonal == NULL)
+            {
+                freeNeighbourGrid(grid);
+                return false;
+            }
+
+            // Both generations start as the a = 1, b = 0 background so the border, which
+            // is never stepped, reads the same whichever generation is current
+            grid->cells[i][j].a[0] = 1;
+            grid->cells[i][j].b[0] = 0;
+            grid->cells[i][j].a[1] = 1;
+            grid->cells[i][j].b[1] = 0;
+            grid->cells[i][j].x = i;
+            grid->cells[i][j].y = j;
+        }
+    }
+
+    // Setup up the starting squares of pixels
+    RDSeedSquare squares[RD_MAX_SEED_SQUARES];
+    int numSquares = rdSeedSquares(seed, rows, columns, squares);
+
+    for (int s = 0; s < numSquares; s++)
+    {
+        for (int i = -bSquareSize; i < bSquareSize; i++)
+        {
+            for (int j = -bSquareSize; j < bSquareSize; j++)
+            {
+                grid->cells[squares[s].x + i][squares[s].y + j].a[0] = 1;
+                grid->cells[squares[s].x + i][squares[s].y + j].b[0] = 1;
+            }
+        }
+    }
+
+    // Store a pointer to each of a cells neighbours
+    for (int i = 1; i < rows - 1; i++)
+    {
+        for (int j = 1; j < columns - 1; j++)
+        {
+            grid->cells[i][j].adjacent[0] = &grid->cells[i + 1][j];
+            grid->cells[i][j].adjacent[1] = &grid->cells[i - 1][j];
+            grid->cells[i][j].adjacent[2] = &grid->cells[i][j + 1];
+            grid->cells[i][j].adjacent[3] = &grid->cells[i][j - 1];
+
+            grid->cells[i][j].diagonal[0] = &grid->cells[i + 1][j + 1];
+            grid->cells[i][j].diagonal[1] = &grid->cells[i + 1][j - 1];
+            grid->cells[i][j].diagonal[2] = &grid->cells[i - 1][j + 1];
+            grid->cells[i][j].diagonal[3] = &grid->cells[i - 1][j - 1];
+        }
+    }
+
+    return true;
+}
+
+void stepNeighbourGrid(NeighbourGrid *grid, const RDParams *params)
+{
+    int oldGridIndex = grid->current;
+    int newGridIndex = (grid->current + 1) % 2;
+
+    for (int i = 1; i < grid->rows - 1; i++)
+    {
+        for (int j = 1; j < grid->columns - 1; j++)
+        {
+            NeighbourCell *cell = &grid->cells[i][j];
+            double *oldA = &cell->a[oldGridIndex];
+            double *oldB = &cell->b[oldGridIndex];
+            double *newA = &cell->a[newGridIndex];
+            double *newB = &cell->b[newGridIndex];
+
+            double aConvolution = convolution(cell, true, oldGridIndex);
+            double bConvolution = convolution(cell, false, oldGridIndex);
+
+            *newA = *oldA + (params->dA * aConvolution - *oldA * (*oldB * *oldB) + params->feedRate * (1 - *oldA));
+            *newB = *oldB + (params->dB * bConvolution + *oldA * (*oldB * *oldB) - (params->killRate + params->feedRate) * *oldB);
+        }
+    }
+
+    grid->current = newGridIndex;
+}
+
+void freeNeighbourGrid(NeighbourGrid *grid)
+{
+    if (grid->cells == NULL) return;
+    for (int i = 0; i < grid->rows && grid->cells[i] != NULL; i++)
+    {
+        for (int j = 0; j < grid->columns; j++)
+        {
+            free(grid->cells[i][j].a);
+            free(grid->cells[i][j].b);
+            free(grid->cells[i][j].adjacent);
+            free(grid->cells[i][j].diagonal);
+        }
+        free(grid->cells[i]);
+    }
+    free(grid->cells);
+    grid->cells = NULL;
+}
@@ -0,0 +1,50 @@
+// The pointer-neighbour layout the original reaction_diffusion_grid.c stepped, where each cell stores
+// pointers to the eight cells around it
+//
+// It steps every cell every generation and is kept as the baseline the other layouts are measured
+// against, rd_tiles.c is the layout that skips the parts of a field that can't change.
+
+#ifndef RD_NEIGHBOUR_H
+#define RD_NEIGHBOUR_H
+
+#include "rd_engine.h"
+
+/// A stucture used to store the data for each pixel in the simulation
+typedef struct NeighbourCell NeighbourCell;
+
+struct NeighbourCell {
+    double *a;
+    double *b;
+    int x;
+    int y;
+    NeighbourCell **adjacent;
+    NeighbourCell **diagonal;
+};
+
+typedef struct {
+    NeighbourCell **cells;
+    int rows;
+    int columns;
+    int current;    // Which index in each cell's a and b arrays holds the latest generation
+} NeighbourGrid;
+
+/// initiailse a grid with cells set to a = 1, b = 0 with squares of cells set to a = 1, b = 1
+/// @param grid The grid to initialise
+/// @param rows The number of horizontal pixels in the simulation
+/// @param columns The number of vertical pixels in the simulation
+/// @param seed The layout of the starting squares
+/// @param bSquareSize Half the size of the squares of pixels used to start the simulation
+/// @return False if the seed squares don't fit inside the border or there wasn't the memory, leaving
+///         nothing allocated
+bool initialiseNeighbourGrid(NeighbourGrid *grid, int rows, int columns, RDSeed seed, int bSquareSize);
+
+/// Advance every cell not on the border of the grid by one generation
+/// @param grid The grid to step
+/// @param params The feed, kill and diffusion rates to use
+void stepNeighbourGrid(NeighbourGrid *grid, const RDParams *params);
+
+/// Free all the memory used by a grid
+/// @param grid The grid to free
+void freeNeighbourGrid(NeighbourGrid *grid);
+
+#endif
@@ -0,0 +1,57 @@
+// Gradients the field can be coloured with
+
+#include "rd_palette.h"
+#include <string.h>
+
+// The pattern is where b is high, so it's the dark end of each gradient and the background the light end
+static const RDPalette palettes[RD_PALETTE_COUNT] = {
+    { "grey", 2, { 0x000000, 0xFFFFFF } },
+    { "inferno", 7, { 0x000004, 0x320A5E, 0x781C6D, 0xBB3754, 0xED6925, 0xFBB61A, 0xFCFFA4 } },
+    { "viridis", 6, { 0x440154, 0x414487, 0x2A788E, 0x22A884, 0x7AD151, 0xFDE725 } },
+    { "ocean", 5, { 0x03045E, 0x0077B6, 0x00B4D8, 0x90E0EF, 0xFFFFFF } },
+    { "fire", 5, { 0x000000, 0x800000, 0xFF4000, 0xFFC000, 0xFFFFFF } },
+};
+
+const RDPalette *getPalette(int index)
+{
+    return &palettes[index];
+}
+
+const RDPalette *findPalette(const char *name)
+{
+    for (int i = 0; i < RD_PALETTE_COUNT; i++)
+    {
+        if (strcmp(palettes[i].name, name) == 0) return &palettes[i];
+    }
+    return NULL;
+}
+
+// One channel of a colour, 0 for red, 1 for green and 2 for blue
+static int channel(uint32_t colour, int which)
+{
+    return (int) (colour >> (16 - 8 * which)) & 0xFF;
+}
+
+void buildColourTable(const RDPalette *palette, uint32_t *table, int entries)
+{
+    int segments = palette->numColours - 1;
+
+    for (int i = 0; i < entries; i++)
+    {
+        // Where the level falls between two of the palette's colours
+        double position = (double) i / (entries - 1) * segments;
+        int segment = (int) position;
+        if (segment > segments - 1) segment = segments - 1;
+        double along = position - segment;
+
+        uint32_t from = palette->colours[segment];
+        uint32_t to = palette->colours[segment + 1];
+        uint32_t pixel = 0xFF000000u;
+        for (int c = 0; c < 3; c++)
+        {
+            double value = channel(from, c) + (channel(to, c) - channel(from, c)) * along;
+            pixel |= (uint32_t) (value + 0.5) << (8 * c);
+        }
+        table[i] = pixel;
+    }
+}
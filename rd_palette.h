@@ -0,0 +1,42 @@
+// Gradients the field can be coloured with, turned into lookup tables by the colour passes
+//
+// A palette is a handful of colours spread evenly from an a - b of 0 to 1. The colour passes never
+// interpolate per pixel, they quantise a - b to one of RD_COLOUR_LEVELS levels and look up the
+// colour of that level in a table built from the palette once.
+
+#ifndef RD_PALETTE_H
+#define RD_PALETTE_H
+
+#include <stdint.h>
+
+/// The most colours a palette's gradient can be made of
+#define RD_MAX_PALETTE_COLOURS 8
+
+/// The number of built in palettes
+#define RD_PALETTE_COUNT 5
+
+/// A gradient to colour the field with
+typedef struct {
+    const char *name;
+    int numColours;                             // At least 2
+    uint32_t colours[RD_MAX_PALETTE_COLOURS];   // 0xRRGGBB, the first for an a - b of 0 and the last for 1
+} RDPalette;
+
+/// Get a built in palette, the first is the original greys
+/// @param index Which palette, from 0 to RD_PALETTE_COUNT - 1
+/// @return The palette
+const RDPalette *getPalette(int index);
+
+/// Find a built in palette by name
+/// @param name The name of the palette, e.g. "grey" or "inferno"
+/// @return The palette, or NULL if there isn't one with that name
+const RDPalette *findPalette(const char *name);
+
+/// Fill a lookup table with a palette's gradient, as opaque RGBA pixels with red in the lowest byte
+/// @param palette The palette
+/// @param table Filled with the colour of each level, the first entry is the palette's first colour
+///              and the last is its last
+/// @param entries The number of entries in the table, at least 2
+void buildColourTable(const RDPalette *palette, uint32_t *table, int entries);
+
+#endif
@@ -0,0 +1,140 @@
+// Builds the rate maps that give every cell of a field its own feed and kill rates
+// Based on this tutorial http://karlsims.com/rd.html
+
+#include "rd_rates.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// A greyscale image as read from a PGM
+typedef struct {
+    int width;
+    int height;
+    int maxValue;       // The value white is written as
+    uint16_t *values;   // width * height values, a row at a time from the top
+} GreyImage;
+
+/// Get the level a fraction of the way from the low rate to the high one, rounded to the nearest
+static inline uint16_t levelAt(long long numerator, long long denominator)
+{
+    if (denominator <= 0) return 0;
+    return (uint16_t) ((numerator * RD_RATE_LEVEL_MAX + denominator / 2) / denominator);
+}
+
+bool setGradientRates(RDField *field, double feedLow, double feedHigh, double killLow, double killHigh)
+{
+    if (!addFieldRates(field, feedLow, feedHigh, killLow, killHigh)) return false;
+
+    RDRateMap *rates = &field->rates;
+    for (int y = 0; y < field->height; y++)
+    {
+        uint16_t feed = levelAt(y, field->height - 1);
+        uint16_t *feedRow = rates->feed + (size_t) y * rates->stride;
+        uint16_t *killRow = rates->kill + (size_t) y * rates->stride;
+
+        for (int x = 0; x < field->width; x++)
+        {
+            feedRow[x] = feed;
+            killRow[x] = levelAt(x, field->width - 1);
+        }
+    }
+
+    return true;
+}
+
+/// Read the next number in a PGM header, skipping whitespace and comments
+/// @return The number, or -1 if there isn't one
+static int readHeaderNumber(FILE *file)
+{
+    int c = fgetc(file);
+    while (c == '#' || isspace(c))
+    {
+        if (c == '#') while (c != '\n' && c != EOF) c = fgetc(file);
+        c = fgetc(file);
+    }
+
+    int value = -1;
+    while (c != EOF && isdigit(c) && value < 1 << 24)
+    {
+        value = (value < 0 ? 0 : value * 10) + (c - '0');
+        c = fgetc(file);
+    }
+
+    // The single whitespace character after the last number is the end of the header
+    if (c != EOF && !isspace(c)) return -1;
+    return value;
+}
+
+/// Read a binary PGM
+/// @param path The file to read
+/// @param image Filled with the image, free its values when done with it
+/// @return False if the file couldn't be read or isn't a binary PGM
+static bool readGreyImage(const char *path, GreyImage *image)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return false;
+
+    bool valid = fgetc(file) == 'P' && fgetc(file) == '5';
+    image->width = valid ? readHeaderNumber(file) : -1;
+    image->height = valid ? readHeaderNumber(file) : -1;
+    image->maxValue = valid ? readHeaderNumber(file) : -1;
+    image->values = NULL;
+    valid = image->width > 0 && image->height > 0 && image->maxValue > 0 && image->maxValue <= 65535;
+
+    // Values over 255 take two bytes, most significant first
+    size_t count = valid ? (size_t) image->width * image->height : 0;
+    int bytesPerValue = image->maxValue > 255 ? 2 : 1;
+    unsigned char *bytes = valid ? (unsigned char *) malloc(count * bytesPerValue) : NULL;
+    image->values = valid ? (uint16_t *) malloc(count * sizeof(uint16_t)) : NULL;
+    valid = bytes != NULL && image->values != NULL && fread(bytes, bytesPerValue, count, file) == count;
+
+    for (size_t i = 0; valid && i < count; i++)
+    {
+        image->values[i] = bytesPerValue == 2 ? (uint16_t) (bytes[2 * i] << 8 | bytes[2 * i + 1]) : bytes[i];
+    }
+
+    free(bytes);
+    fclose(file);
+    if (!valid)
+    {
+        free(image->values);
+        image->values = NULL;
+    }
+    return valid;
+}
+
+/// Fill a plane of levels from an image stretched to the size of the field, each cell taking the
+/// value of the pixel it falls in
+static void fillLevels(uint16_t *levels, int stride, const RDField *field, const GreyImage *image)
+{
+    for (int y = 0; y < field->height; y++)
+    {
+        size_t imageY = (size_t) ((long long) y * image->height / field->height);
+        const uint16_t *imageRow = image->values + imageY * image->width;
+        uint16_t *row = levels + (size_t) y * stride;
+
+        for (int x = 0; x < field->width; x++)
+        {
+            row[x] = levelAt(imageRow[(long long) x * image->width / field->width], image->maxValue);
+        }
+    }
+}
+
+bool loadRateImages(RDField *field, const char *feedPath, double feedLow, double feedHigh,
+    const char *killPath, double killLow, double killHigh)
+{
+    GreyImage feed = { 0 };
+    GreyImage kill = { 0 };
+    bool loaded = (feedPath == NULL || readGreyImage(feedPath, &feed))
+        && (killPath == NULL || readGreyImage(killPath, &kill))
+        && addFieldRates(field, feedLow, feedHigh, killLow, killHigh);
+
+    // A new map starts with every level at 0, the low rate
+    if (loaded && feed.values != NULL) fillLevels(field->rates.feed, field->rates.stride, field, &feed);
+    if (loaded && kill.values != NULL) fillLevels(field->rates.kill, field->rates.stride, field, &kill);
+    if (!loaded) removeFieldRates(field);
+
+    free(feed.values);
+    free(kill.values);
+    return loaded;
+}
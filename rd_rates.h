@@ -0,0 +1,45 @@
+// Builds the rate maps that give every cell of a field its own feed and kill rates
+//
+// Karl Sims' tutorial shows every kind of pattern in one image by stepping with a feed rate that
+// rises from the top of the image to the bottom and a kill rate that rises from left to right.
+// setGradientRates builds that map for a field of any size. loadRateImages reads the rates from
+// greyscale binary PGM images instead, 8 or 16 bit, stretched to the size of the field, with black
+// standing for the low rate and white for the high one.
+
+#ifndef RD_RATES_H
+#define RD_RATES_H
+
+#include "rd_field.h"
+
+/// The range of feed rates across the gradient in Karl Sims' map
+#define RD_GRADIENT_FEED_LOW 0.01
+#define RD_GRADIENT_FEED_HIGH 0.1
+
+/// The range of kill rates across the gradient in Karl Sims' map
+#define RD_GRADIENT_KILL_LOW 0.045
+#define RD_GRADIENT_KILL_HIGH 0.07
+
+/// Give a field feed rates that rise evenly from its top row to its bottom row and kill rates that
+/// rise evenly from its left column to its right column, replacing any rate map it has
+/// @param field The field
+/// @param feedLow The feed rate of the top row
+/// @param feedHigh The feed rate of the bottom row
+/// @param killLow The kill rate of the left column
+/// @param killHigh The kill rate of the right column
+/// @return False if the memory for the map couldn't be allocated
+bool setGradientRates(RDField *field, double feedLow, double feedHigh, double killLow, double killHigh);
+
+/// Give a field rates read from greyscale images, replacing any rate map it has
+/// @param field The field
+/// @param feedPath A binary PGM of the feed rates, or NULL for feedLow everywhere
+/// @param feedLow The feed rate black stands for
+/// @param feedHigh The feed rate white stands for
+/// @param killPath A binary PGM of the kill rates, or NULL for killLow everywhere
+/// @param killLow The kill rate black stands for
+/// @param killHigh The kill rate white stands for
+/// @return False if an image couldn't be read or the memory for the map couldn't be allocated, which
+///         leaves the field without a map
+bool loadRateImages(RDField *field, const char *feedPath, double feedLow, double feedHigh,
+    const char *killPath, double killLow, double killHigh);
+
+#endif
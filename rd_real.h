@@ -0,0 +1,71 @@
+// The type the a and b chemicals of a field are stored in, picked at build time
+//
+// Define RD_PRECISION as one of the values below to build the engine with that type, the
+// Makefile does this with PRECISION=double, float or fixed16. Doubles are the default and match
+// the original programs. Floats halve the memory used and double the cells per SIMD vector. The
+// 16 bit fixed point values quarter the memory but only have a scalar kernel. The visualisation
+// only shows 256 greys, so rd_bench --divergence reports how far each build drifts from doubles.
+
+#ifndef RD_REAL_H
+#define RD_REAL_H
+
+#include <stdint.h>
+
+#define RD_PRECISION_DOUBLE 0
+#define RD_PRECISION_FLOAT 1
+#define RD_PRECISION_FIXED16 2
+
+#ifndef RD_PRECISION
+    #define RD_PRECISION RD_PRECISION_DOUBLE
+#endif
+
+#if RD_PRECISION == RD_PRECISION_DOUBLE
+
+typedef double RDReal;
+#define RD_PRECISION_NAME "double"
+
+#elif RD_PRECISION == RD_PRECISION_FLOAT
+
+typedef float RDReal;
+#define RD_PRECISION_NAME "float"
+
+#elif RD_PRECISION == RD_PRECISION_FIXED16
+
+// Signed values with 14 fractional bits, so 1 is 16384 and anything from -2 to just under 2 fits
+typedef int16_t RDReal;
+#define RD_PRECISION_NAME "fixed16"
+#define RD_FIXED_SHIFT 14
+#define RD_FIXED_ONE (1 << RD_FIXED_SHIFT)
+
+#else
+    #error "RD_PRECISION must be RD_PRECISION_DOUBLE, RD_PRECISION_FLOAT or RD_PRECISION_FIXED16"
+#endif
+
+/// Convert a stored value to a double
+/// @param value The stored value
+/// @return The value it represents
+static inline double rdRealToDouble(RDReal value)
+{
+#if RD_PRECISION == RD_PRECISION_FIXED16
+    return (double) value / RD_FIXED_ONE;
+#else
+    return (double) value;
+#endif
+}
+
+/// Convert a double to the nearest value that can be stored
+/// @param value The value to store
+/// @return The stored value, saturated for fixed point
+static inline RDReal rdRealFromDouble(double value)
+{
+#if RD_PRECISION == RD_PRECISION_FIXED16
+    double scaled = value * RD_FIXED_ONE;
+    if (scaled >= INT16_MAX) return INT16_MAX;
+    if (scaled <= INT16_MIN) return INT16_MIN;
+    return (RDReal) (scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+#else
+    return (RDReal) value;
+#endif
+}
+
+#endif
@@ -0,0 +1,350 @@
+// Records a run to disk as a video or a numbered sequence of images without holding up the simulation
+
+#include "rd_record.h"
+#include "rd_colour.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *formatNames[RECORD_FORMAT_COUNT] = { "y4m", "ppm", "pgm" };
+
+/// A frame waiting to be written
+typedef struct {
+    unsigned char *data;    // RGBA pixels, or the a plane then the b plane for PGM
+    long long frame;        // Its number in the recording
+} RecordSlot;
+
+struct RDRecorder {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    bool stopping;
+
+    RDRecordFormat format;
+    char *path;
+    FILE *video;            // The Y4M file, the sequences open a file per frame
+    int width;
+    int height;
+    int every;
+    long long nextGeneration;   // Only touched by the thread recording
+
+    // The slots waiting to be written are a ring starting at first, the slot after the last of
+    // them is filled without the lock as only the recording thread adds to the ring
+    RecordSlot *slots;
+    int numSlots;
+    int first;
+    int waiting;
+
+    RDRecordStats stats;
+    unsigned char *encoded;     // The frame as it's written, only touched by the writing thread
+    size_t encodedSize;
+};
+
+const char *recordFormatName(RDRecordFormat format)
+{
+    return formatNames[format];
+}
+
+bool findRecordFormat(const char *name, RDRecordFormat *format)
+{
+    for (int i = 0; i < RECORD_FORMAT_COUNT; i++)
+    {
+        if (strcmp(formatNames[i], name) == 0)
+        {
+            *format = (RDRecordFormat) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Convert RGBA pixels to the Y, U and V planes of BT.601 limited range video, which is what
+/// players assume a Y4M file holds
+static void encodeYUV(const unsigned char *pixels, int count, unsigned char *planes)
+{
+    unsigned char *y = planes;
+    unsigned char *u = planes + count;
+    unsigned char *v = planes + 2 * (size_t) count;
+
+    // The offsets are folded in before the shift so nothing shifted is negative
+    for (int i = 0; i < count; i++)
+    {
+        int r = pixels[i * RD_PIXEL_SIZE];
+        int g = pixels[i * RD_PIXEL_SIZE + 1];
+        int b = pixels[i * RD_PIXEL_SIZE + 2];
+        y[i] = (unsigned char) ((66 * r + 129 * g + 25 * b + 128 + (16 << 8)) >> 8);
+        u[i] = (unsigned char) ((-38 * r - 74 * g + 112 * b + 128 + (128 << 8)) >> 8);
+        v[i] = (unsigned char) ((112 * r - 94 * g - 18 * b + 128 + (128 << 8)) >> 8);
+    }
+}
+
+/// Drop the alpha from RGBA pixels
+static void encodeRGB(const unsigned char *pixels, int count, unsigned char *rgb)
+{
+    for (int i = 0; i < count; i++)
+    {
+        rgb[i * 3] = pixels[i * RD_PIXEL_SIZE];
+        rgb[i * 3 + 1] = pixels[i * RD_PIXEL_SIZE + 1];
+        rgb[i * 3 + 2] = pixels[i * RD_PIXEL_SIZE + 2];
+    }
+}
+
+/// Scale values from 0-1 to 16 bit samples, most significant byte first as PGM stores them,
+/// with anything outside 0-1 clamped to the ends and NaN written as 0
+static void encodeSamples(const RDReal *values, int count, unsigned char *samples)
+{
+    for (int i = 0; i < count; i++)
+    {
+        double value = rdRealToDouble(values[i]);
+        uint16_t sample = value > 0.0 ? (value < 1.0 ? (uint16_t) (value * 65535.0 + 0.5) : 65535) : 0;
+        samples[i * 2] = (unsigned char) (sample >> 8);
+        samples[i * 2 + 1] = (unsigned char) (sample & 0xFF);
+    }
+}
+
+/// Write a frame of an image sequence to a file of its own
+static bool writeImage(const RDRecorder *recorder, long long frame, const char *header, size_t bytes)
+{
+    const char *extension = recorder->format == RECORD_PGM ? "pgm" : "ppm";
+    size_t nameSize = strlen(recorder->path) + 32;
+    char *name = (char *) malloc(nameSize);
+    if (name == NULL) return false;
+    snprintf(name, nameSize, "%s_%06lld.%s", recorder->path, frame, extension);
+
+    bool written = false;
+    FILE *file = fopen(name, "wb");
+    if (file != NULL)
+    {
+        written = fputs(header, file) >= 0 && fwrite(recorder->encoded, 1, bytes, file) == bytes;
+        written = (fclose(file) == 0) && written;
+    }
+
+    free(name);
+    return written;
+}
+
+/// Encode and write a frame
+/// @return The number of bytes written, or -1 if it couldn't be
+static long long writeFrame(RDRecorder *recorder, const RecordSlot *slot)
+{
+    int count = recorder->width * recorder->height;
+    char header[64];
+
+    switch (recorder->format)
+    {
+        case RECORD_Y4M:
+            encodeYUV(slot->data, count, recorder->encoded);
+            if (fputs("FRAME\n", recorder->video) < 0
+                || fwrite(recorder->encoded, 1, recorder->encodedSize, recorder->video) != recorder->encodedSize)
+            {
+                return -1;
+            }
+            return 6 + (long long) recorder->encodedSize;
+
+        case RECORD_PPM:
+            encodeRGB(slot->data, count, recorder->encoded);
+            snprintf(header, sizeof(header), "P6\n%d %d\n255\n", recorder->width, recorder->height);
+            break;
+
+        default:
+            // The a plane above the b plane, as one image twice the height of the field
+            encodeSamples((const RDReal *) slot->data, 2 * count, recorder->encoded);
+            snprintf(header, sizeof(header), "P5\n%d %d\n65535\n", recorder->width, 2 * recorder->height);
+            break;
+    }
+
+    if (!writeImage(recorder, slot->frame, header, recorder->encodedSize)) return -1;
+    return (long long) (strlen(header) + recorder->encodedSize);
+}
+
+static void *recorderMain(void *arg)
+{
+    RDRecorder *recorder = (RDRecorder *) arg;
+
+    pthread_mutex_lock(&recorder->mutex);
+    while (true)
+    {
+        while (recorder->waiting == 0 && !recorder->stopping) pthread_cond_wait(&recorder->changed, &recorder->mutex);
+
+        // Frames still waiting are written when stopping
+        if (recorder->waiting == 0) break;
+
+        // Nothing else touches a waiting slot, so it's written without the lock
+        RecordSlot *slot = &recorder->slots[recorder->first];
+        bool failed = recorder->stats.failed;
+        pthread_mutex_unlock(&recorder->mutex);
+        long long bytes = failed ? 0 : writeFrame(recorder, slot);
+        pthread_mutex_lock(&recorder->mutex);
+
+        if (bytes < 0) recorder->stats.failed = true;
+        else if (!failed)
+        {
+            recorder->stats.framesWritten++;
+            recorder->stats.bytesWritten += bytes;
+        }
+        recorder->first = (recorder->first + 1) % recorder->numSlots;
+        recorder->waiting--;
+        pthread_cond_broadcast(&recorder->changed);
+    }
+    pthread_mutex_unlock(&recorder->mutex);
+
+    return NULL;
+}
+
+RDRecorder *createRecorder(const char *path, RDRecordFormat format, int width, int height, int every, int slots)
+{
+    if (width <= 0 || height <= 0) return NULL;
+
+    RDRecorder *recorder = (RDRecorder *) calloc(1, sizeof(RDRecorder));
+    if (recorder == NULL) return NULL;
+
+    recorder->format = format;
+    recorder->width = width;
+    recorder->height = height;
+    recorder->every = every > 0 ? every : 1;
+    recorder->numSlots = slots > 0 ? slots : RD_RECORD_SLOTS;
+
+    // Every slot and the encoding buffer are allocated now so recording never allocates
+    size_t count = (size_t) width * height;
+    size_t slotSize = format == RECORD_PGM ? 2 * count * sizeof(RDReal) : count * RD_PIXEL_SIZE;
+    recorder->encodedSize = format == RECORD_PGM ? 2 * count * 2 : count * 3;
+    recorder->encoded = (unsigned char *) malloc(recorder->encodedSize);
+    recorder->slots = (RecordSlot *) calloc(recorder->numSlots, sizeof(RecordSlot));
+    recorder->path = (char *) malloc(strlen(path) + 1);
+
+    bool allocated = recorder->encoded != NULL && recorder->slots != NULL && recorder->path != NULL;
+    for (int i = 0; allocated && i < recorder->numSlots; i++)
+    {
+        recorder->slots[i].data = (unsigned char *) malloc(slotSize);
+        allocated = recorder->slots[i].data != NULL;
+    }
+
+    if (allocated)
+    {
+        strcpy(recorder->path, path);
+        if (format == RECORD_Y4M)
+        {
+            recorder->video = fopen(path, "wb");
+            allocated = recorder->video != NULL
+                && fprintf(recorder->video, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, RD_RECORD_FRAME_RATE) > 0;
+        }
+    }
+
+    if (allocated)
+    {
+        pthread_mutex_init(&recorder->mutex, NULL);
+        pthread_cond_init(&recorder->changed, NULL);
+        if (pthread_create(&recorder->thread, NULL, recorderMain, recorder) == 0) return recorder;
+
+        pthread_cond_destroy(&recorder->changed);
+        pthread_mutex_destroy(&recorder->mutex);
+    }
+
+    if (recorder->video != NULL)
+    {
+        fclose(recorder->video);
+        remove(path);
+    }
+    for (int i = 0; recorder->slots != NULL && i < recorder->numSlots; i++) free(recorder->slots[i].data);
+    free(recorder->slots);
+    free(recorder->encoded);
+    free(recorder->path);
+    free(recorder);
+    return NULL;
+}
+
+/// Check whether a frame is due at a generation and find the free slot to fill if it is
+/// @return The slot to fill, or NULL if no frame is due, every slot is waiting or a write has failed
+static RecordSlot *claimSlot(RDRecorder *recorder, long long generation)
+{
+    if (generation < recorder->nextGeneration) return NULL;
+    recorder->nextGeneration = (generation / recorder->every + 1) * recorder->every;
+
+    pthread_mutex_lock(&recorder->mutex);
+    RecordSlot *slot = NULL;
+    if (recorder->waiting == recorder->numSlots) recorder->stats.framesDropped++;
+    else if (!recorder->stats.failed) slot = &recorder->slots[(recorder->first + recorder->waiting) % recorder->numSlots];
+    pthread_mutex_unlock(&recorder->mutex);
+
+    return slot;
+}
+
+/// Hand a filled slot to the writing thread
+static void queueSlot(RDRecorder *recorder, RecordSlot *slot)
+{
+    pthread_mutex_lock(&recorder->mutex);
+    slot->frame = recorder->stats.framesRecorded++;
+    recorder->waiting++;
+    pthread_cond_broadcast(&recorder->changed);
+    pthread_mutex_unlock(&recorder->mutex);
+}
+
+bool recordField(RDRecorder *recorder, const RDField *field)
+{
+    if (field->width != recorder->width || field->height != recorder->height) return false;
+
+    RecordSlot *slot = claimSlot(recorder, field->generation);
+    if (slot == NULL) return false;
+
+    if (recorder->format == RECORD_PGM)
+    {
+        // The planes are copied without the padding at the end of each row
+        RDReal *a = (RDReal *) slot->data;
+        RDReal *b = a + (size_t) field->width * field->height;
+        size_t rowBytes = (size_t) field->width * sizeof(RDReal);
+        for (int y = 0; y < field->height; y++)
+        {
+            memcpy(a + (size_t) y * field->width, fieldA(field) + (size_t) y * field->stride, rowBytes);
+            memcpy(b + (size_t) y * field->width, fieldB(field) + (size_t) y * field->stride, rowBytes);
+        }
+    }
+    else colourField(field, slot->data);
+
+    queueSlot(recorder, slot);
+    return true;
+}
+
+bool recordPixels(RDRecorder *recorder, const unsigned char *pixels, long long generation)
+{
+    if (recorder->format == RECORD_PGM) return false;
+
+    RecordSlot *slot = claimSlot(recorder, generation);
+    if (slot == NULL) return false;
+
+    memcpy(slot->data, pixels, (size_t) recorder->width * recorder->height * RD_PIXEL_SIZE);
+    queueSlot(recorder, slot);
+    return true;
+}
+
+void getRecordStats(RDRecorder *recorder, RDRecordStats *stats)
+{
+    pthread_mutex_lock(&recorder->mutex);
+    *stats = recorder->stats;
+    pthread_mutex_unlock(&recorder->mutex);
+}
+
+bool freeRecorder(RDRecorder *recorder, RDRecordStats *stats)
+{
+    if (recorder == NULL) return true;
+
+    pthread_mutex_lock(&recorder->mutex);
+    recorder->stopping = true;
+    pthread_cond_broadcast(&recorder->changed);
+    pthread_mutex_unlock(&recorder->mutex);
+    pthread_join(recorder->thread, NULL);
+
+    if (recorder->video != NULL && fclose(recorder->video) != 0) recorder->stats.failed = true;
+    bool succeeded = !recorder->stats.failed;
+    if (stats != NULL) *stats = recorder->stats;
+
+    pthread_cond_destroy(&recorder->changed);
+    pthread_mutex_destroy(&recorder->mutex);
+    for (int i = 0; i < recorder->numSlots; i++) free(recorder->slots[i].data);
+    free(recorder->slots);
+    free(recorder->encoded);
+    free(recorder->path);
+    free(recorder);
+    return succeeded;
+}
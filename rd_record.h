@@ -0,0 +1,89 @@
+// Records a run to disk as a video or a numbered sequence of images without holding up the simulation
+//
+// Recording a frame only copies it into one of a fixed number of slots allocated up front, and a
+// background thread encodes the slots in the order they were filled and writes them out. When
+// every slot is still waiting to be written the frame is dropped rather than waiting on the disk,
+// and counted so a run can report how many it lost. Frames are recorded from one thread at a time.
+// Nothing here needs a window, so headless runs can record as well as the visualisation.
+//
+// Y4M is uncompressed 4:4:4 YUV video that ffmpeg and most players read directly. PPM writes a
+// numbered RGB image per frame, the colour counterpart of PGM, which writes a numbered 16 bit
+// greyscale image per frame of the raw a plane above the raw b plane instead of the colours.
+
+#ifndef RD_RECORD_H
+#define RD_RECORD_H
+
+#include "rd_field.h"
+
+/// The number of frames that can wait to be written before new ones are dropped
+#define RD_RECORD_SLOTS 8
+
+/// The frame rate written in a Y4M header, which only changes how fast players show it
+#define RD_RECORD_FRAME_RATE 30
+
+typedef enum {
+    RECORD_Y4M,     // A single video file
+    RECORD_PPM,     // A colour image per frame, numbered from 0
+    RECORD_PGM,     // The raw a and b planes per frame, numbered from 0
+    RECORD_FORMAT_COUNT
+} RDRecordFormat;
+
+typedef struct RDRecorder RDRecorder;
+
+/// How a recording has gone so far
+typedef struct {
+    long long framesRecorded;   // Frames copied into a slot
+    long long framesWritten;    // Frames written to disk
+    long long framesDropped;    // Frames due that were lost because every slot was waiting to be written
+    long long bytesWritten;
+    bool failed;                // Whether a write failed, nothing more is written after one does
+} RDRecordStats;
+
+/// Get the name of a format
+/// @param format The format to name
+/// @return The name, e.g. "y4m"
+const char *recordFormatName(RDRecordFormat format);
+
+/// Find a format by name
+/// @param name The name of the format, "y4m", "ppm" or "pgm"
+/// @param format Set to the format if there's one with that name
+/// @return False if there isn't a format with that name
+bool findRecordFormat(const char *name, RDRecordFormat *format);
+
+/// Allocate the slots and start the thread that writes a recording
+/// @param path The file to write for Y4M, or the start of each image's name for the sequences, which
+///             have _000000.ppm and so on added
+/// @param format The format to write
+/// @param width The width of every frame, the field's width for recordField
+/// @param height The height of every frame, the field's height for recordField
+/// @param every Record a frame each time the generation reaches another multiple of this
+/// @param slots The number of frames that can wait to be written, 0 or less uses RD_RECORD_SLOTS
+/// @return The recorder, or NULL if the slots couldn't be allocated or a Y4M file couldn't be created
+RDRecorder *createRecorder(const char *path, RDRecordFormat format, int width, int height, int every, int slots);
+
+/// Record a field if a frame is due, colouring it straight into a slot for Y4M and PPM or copying
+/// its planes for PGM
+/// @param recorder The recorder
+/// @param field The field, the size the recorder was created with
+/// @return True if a frame was recorded, false if one wasn't due or was dropped
+bool recordField(RDRecorder *recorder, const RDField *field);
+
+/// Record pixels that are already coloured if a frame is due, for Y4M and PPM
+/// @param recorder The recorder
+/// @param pixels width * height RGBA pixels, the size the recorder was created with
+/// @param generation The generation they were coloured from
+/// @return True if a frame was recorded, false if one wasn't due, was dropped or the format is PGM
+bool recordPixels(RDRecorder *recorder, const unsigned char *pixels, long long generation);
+
+/// Get how a recording has gone so far
+/// @param recorder The recorder
+/// @param stats Filled with the totals so far
+void getRecordStats(RDRecorder *recorder, RDRecordStats *stats);
+
+/// Write every frame still waiting, then stop the thread, close the recording and free the recorder
+/// @param recorder The recorder, can be NULL
+/// @param stats Filled with the final totals if not NULL
+/// @return False if any write failed
+bool freeRecorder(RDRecorder *recorder, RDRecordStats *stats);
+
+#endif
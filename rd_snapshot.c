@@ -0,0 +1,372 @@
+// Saves and resumes the state of a simulation
+
+#include "rd_snapshot.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// The planes start on a page boundary after the header
+#define SNAPSHOT_HEADER_SIZE 4096
+
+// Written as a 32 bit value, reads back differently on a machine with the other byte order
+#define BYTE_ORDER_MARK 0x01020304u
+
+static const char snapshotMagic[8] = { 'R', 'D', 'S', 'N', 'A', 'P', '\r', '\n' };
+
+/// The start of a snapshot file
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    int32_t width;
+    int32_t height;
+    int32_t stride;     // The number of values between the start of one row and the next
+    int32_t precision;  // The RD_PRECISION of the build that wrote it, always 0 for doubles
+    int64_t generation;
+    double feedRate;
+    double killRate;
+    double dA;
+    double dB;
+} SnapshotHeader;
+
+struct RDSnapshotWriter {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    bool pending;       // Whether the buffer holds a snapshot that hasn't been written yet
+    bool stopping;
+    bool succeeded;
+
+    char *path;
+    unsigned char *buffer;  // The header and both planes, laid out as they are in the file
+    size_t bufferSize;
+};
+
+/// Fill in the header for a field
+static void fillHeader(unsigned char *header, const RDField *field, const RDParams *params)
+{
+    SnapshotHeader snapshot = { 0 };
+    memcpy(snapshot.magic, snapshotMagic, sizeof(snapshotMagic));
+    snapshot.version = RD_SNAPSHOT_VERSION;
+    snapshot.byteOrder = BYTE_ORDER_MARK;
+    snapshot.width = field->width;
+    snapshot.height = field->height;
+    snapshot.stride = field->stride;
+    snapshot.precision = RD_PRECISION;
+    snapshot.generation = field->generation;
+    snapshot.feedRate = params->feedRate;
+    snapshot.killRate = params->killRate;
+    snapshot.dA = params->dA;
+    snapshot.dB = params->dB;
+
+    memset(header, 0, SNAPSHOT_HEADER_SIZE);
+    memcpy(header, &snapshot, sizeof(snapshot));
+}
+
+/// Get the size in bytes of one plane of a field as it's stored
+static size_t planeBytes(const RDField *field)
+{
+    return (size_t) field->stride * field->height * sizeof(RDReal);
+}
+
+/// Write a snapshot to a temporary file and rename it over the real one once it's complete
+static bool writeSnapshotFile(const char *path, const unsigned char *header, const RDReal *a, const RDReal *b,
+    size_t bytesPerPlane)
+{
+    size_t pathLength = strlen(path);
+    char *tempPath = (char *) malloc(pathLength + 5);
+    if (tempPath == NULL) return false;
+    memcpy(tempPath, path, pathLength);
+    memcpy(tempPath + pathLength, ".tmp", 5);
+
+    bool written = false;
+    FILE *file = fopen(tempPath, "wb");
+    if (file != NULL)
+    {
+        written = fwrite(header, 1, SNAPSHOT_HEADER_SIZE, file) == SNAPSHOT_HEADER_SIZE
+            && fwrite(a, 1, bytesPerPlane, file) == bytesPerPlane
+            && fwrite(b, 1, bytesPerPlane, file) == bytesPerPlane;
+        written = (fclose(file) == 0) && written;
+    }
+
+#ifdef _WIN32
+    // Windows won't rename over an existing file
+    if (written) remove(path);
+#endif
+    written = written && rename(tempPath, path) == 0;
+    if (!written) remove(tempPath);
+
+    free(tempPath);
+    return written;
+}
+
+bool saveSnapshot(const char *path, const RDField *field, const RDParams *params)
+{
+    unsigned char header[SNAPSHOT_HEADER_SIZE];
+    fillHeader(header, field, params);
+
+    return writeSnapshotFile(path, header, field->a[field->current], field->b[field->current], planeBytes(field));
+}
+
+/// Map a whole file read only
+/// @param path The file to map
+/// @param size Set to the size of the file
+/// @param handle Set to whatever is needed to unmap it
+/// @return The start of the file, or NULL if it couldn't be mapped
+static const unsigned char *mapFile(const char *path, size_t *size, void **handle)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+    {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    CloseHandle(file);
+    if (mapping == NULL) return NULL;
+
+    const unsigned char *data = (const unsigned char *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL)
+    {
+        CloseHandle(mapping);
+        return NULL;
+    }
+
+    *size = (size_t) fileSize.QuadPart;
+    *handle = mapping;
+    return data;
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0) return NULL;
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size <= 0)
+    {
+        close(file);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) return NULL;
+
+    // The planes are read front to back once, so let the kernel read ahead as far as it likes
+    madvise(data, (size_t) info.st_size, MADV_SEQUENTIAL);
+
+    *size = (size_t) info.st_size;
+    *handle = NULL;
+    return (const unsigned char *) data;
+#endif
+}
+
+/// Unmap a file mapped by mapFile
+static void unmapFile(const unsigned char *data, size_t size, void *handle)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle((HANDLE) handle);
+#else
+    munmap((void *) data, size);
+#endif
+}
+
+bool loadSnapshot(const char *path, RDField *field, RDParams *params)
+{
+    size_t size;
+    void *handle;
+    const unsigned char *data = mapFile(path, &size, &handle);
+    if (data == NULL) return false;
+
+    SnapshotHeader header;
+    bool valid = size >= SNAPSHOT_HEADER_SIZE;
+    if (valid)
+    {
+        memcpy(&header, data, sizeof(header));
+        valid = memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) == 0
+            && header.version == RD_SNAPSHOT_VERSION
+            && header.byteOrder == BYTE_ORDER_MARK
+            && header.precision == RD_PRECISION
+            && header.width >= 3 && header.height >= 3 && header.stride >= header.width;
+    }
+
+    // The sizes come from the file, so a corrupt header mustn't be able to wrap the size check
+    valid = valid && (size_t) header.height <= (SIZE_MAX - SNAPSHOT_HEADER_SIZE) / 2 / sizeof(RDReal)
+        / (size_t) header.stride;
+
+    size_t bytesPerPlane = valid ? (size_t) header.stride * header.height * sizeof(RDReal) : 0;
+    valid = valid && size >= SNAPSHOT_HEADER_SIZE + 2 * bytesPerPlane;
+
+    // Half a square size of 0 means no seed squares are set, everything is overwritten anyway
+    RDField loaded;
+    valid = valid && initialiseField(&loaded, header.width, header.height, SEED_CENTRE_SQUARE, 0);
+
+    if (valid)
+    {
+        const RDReal *a = (const RDReal *) (data + SNAPSHOT_HEADER_SIZE);
+        const RDReal *b = (const RDReal *) (data + SNAPSHOT_HEADER_SIZE + bytesPerPlane);
+
+        // Copy whole planes when the padding matches, which it does for snapshots from this build
+        if (header.stride == loaded.stride)
+        {
+            memcpy(loaded.a[0], a, bytesPerPlane);
+            memcpy(loaded.b[0], b, bytesPerPlane);
+        }
+        else
+        {
+            for (int y = 0; y < header.height; y++)
+            {
+                memcpy(loaded.a[0] + (size_t) y * loaded.stride, a + (size_t) y * header.stride, header.width * sizeof(RDReal));
+                memcpy(loaded.b[0] + (size_t) y * loaded.stride, b + (size_t) y * header.stride, header.width * sizeof(RDReal));
+            }
+        }
+
+        loaded.generation = header.generation;
+        *field = loaded;
+        if (params != NULL) *params = (RDParams){ header.feedRate, header.killRate, header.dA, header.dB };
+    }
+
+    unmapFile(data, size, handle);
+    return valid;
+}
+
+static void *writerMain(void *arg)
+{
+    RDSnapshotWriter *writer = (RDSnapshotWriter *) arg;
+
+    pthread_mutex_lock(&writer->mutex);
+    while (true)
+    {
+        while (!writer->pending && !writer->stopping) pthread_cond_wait(&writer->changed, &writer->mutex);
+
+        // A queued snapshot is still written when stopping
+        if (!writer->pending) break;
+
+        // Nothing else touches the buffer while it's pending, so it's written without the lock
+        pthread_mutex_unlock(&writer->mutex);
+        size_t bytesPerPlane = (writer->bufferSize - SNAPSHOT_HEADER_SIZE) / 2;
+        bool succeeded = writeSnapshotFile(writer->path, writer->buffer,
+            (const RDReal *) (writer->buffer + SNAPSHOT_HEADER_SIZE),
+            (const RDReal *) (writer->buffer + SNAPSHOT_HEADER_SIZE + bytesPerPlane), bytesPerPlane);
+        pthread_mutex_lock(&writer->mutex);
+
+        writer->succeeded = succeeded;
+        writer->pending = false;
+        pthread_cond_broadcast(&writer->changed);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+
+    return NULL;
+}
+
+RDSnapshotWriter *createSnapshotWriter(void)
+{
+    RDSnapshotWriter *writer = (RDSnapshotWriter *) calloc(1, sizeof(RDSnapshotWriter));
+    if (writer == NULL) return NULL;
+
+    writer->succeeded = true;
+    pthread_mutex_init(&writer->mutex, NULL);
+    pthread_cond_init(&writer->changed, NULL);
+
+    if (pthread_create(&writer->thread, NULL, writerMain, writer) != 0)
+    {
+        pthread_cond_destroy(&writer->changed);
+        pthread_mutex_destroy(&writer->mutex);
+        free(writer);
+        return NULL;
+    }
+
+    return writer;
+}
+
+bool queueSnapshot(RDSnapshotWriter *writer, const char *path, const RDField *field, const RDParams *params)
+{
+    pthread_mutex_lock(&writer->mutex);
+    if (writer->pending)
+    {
+        pthread_mutex_unlock(&writer->mutex);
+        return false;
+    }
+
+    // The buffer is kept between snapshots and only grows when the field does
+    size_t bytesPerPlane = planeBytes(field);
+    size_t bufferSize = SNAPSHOT_HEADER_SIZE + 2 * bytesPerPlane;
+    if (bufferSize != writer->bufferSize)
+    {
+        free(writer->buffer);
+        writer->buffer = (unsigned char *) malloc(bufferSize);
+        writer->bufferSize = writer->buffer != NULL ? bufferSize : 0;
+    }
+
+    size_t pathLength = strlen(path) + 1;
+    char *pathCopy = (char *) malloc(pathLength);
+
+    if (writer->buffer == NULL || pathCopy == NULL)
+    {
+        free(pathCopy);
+        pthread_mutex_unlock(&writer->mutex);
+        return false;
+    }
+
+    memcpy(pathCopy, path, pathLength);
+    free(writer->path);
+    writer->path = pathCopy;
+
+    fillHeader(writer->buffer, field, params);
+    memcpy(writer->buffer + SNAPSHOT_HEADER_SIZE, field->a[field->current], bytesPerPlane);
+    memcpy(writer->buffer + SNAPSHOT_HEADER_SIZE + bytesPerPlane, field->b[field->current], bytesPerPlane);
+
+    writer->pending = true;
+    pthread_cond_broadcast(&writer->changed);
+    pthread_mutex_unlock(&writer->mutex);
+
+    return true;
+}
+
+bool snapshotPending(RDSnapshotWriter *writer)
+{
+    pthread_mutex_lock(&writer->mutex);
+    bool pending = writer->pending;
+    pthread_mutex_unlock(&writer->mutex);
+
+    return pending;
+}
+
+bool lastSnapshotSucceeded(RDSnapshotWriter *writer)
+{
+    pthread_mutex_lock(&writer->mutex);
+    bool succeeded = writer->succeeded;
+    pthread_mutex_unlock(&writer->mutex);
+
+    return succeeded;
+}
+
+void freeSnapshotWriter(RDSnapshotWriter *writer)
+{
+    if (writer == NULL) return;
+
+    pthread_mutex_lock(&writer->mutex);
+    writer->stopping = true;
+    pthread_cond_broadcast(&writer->changed);
+    pthread_mutex_unlock(&writer->mutex);
+    pthread_join(writer->thread, NULL);
+
+    pthread_cond_destroy(&writer->changed);
+    pthread_mutex_destroy(&writer->mutex);
+    free(writer->path);
+    free(writer->buffer);
+    free(writer);
+}
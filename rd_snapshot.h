@@ -0,0 +1,65 @@
+// Saves and resumes the state of a simulation
+//
+// A snapshot is a 4096 byte header followed by the current a and b planes exactly as they're
+// laid out in memory, padding included, so loading one maps the file and copies each plane in
+// a single pass rather than parsing it. The header holds a magic string, the format version, the
+// field's size, stride and precision, the step counter and the feed, kill and diffusion rates.
+// Values are stored in the precision and byte order of the build that wrote them, which the
+// header records so a snapshot from a build with a different RD_PRECISION or byte order is
+// rejected rather than misread.
+//
+// Writing goes through a background thread. Queueing a snapshot only copies the planes into a
+// buffer, the file is written to a temporary name and renamed over the old one once it's
+// complete so a crash part way through never leaves a broken snapshot behind.
+
+#ifndef RD_SNAPSHOT_H
+#define RD_SNAPSHOT_H
+
+#include "rd_field.h"
+
+/// The version of the snapshot format written, bumped whenever the layout changes
+#define RD_SNAPSHOT_VERSION 1
+
+typedef struct RDSnapshotWriter RDSnapshotWriter;
+
+/// Save a snapshot of a field on the calling thread
+/// @param path The file to write
+/// @param field The field to save
+/// @param params The feed, kill and diffusion rates the field is being stepped with
+/// @return False if the file couldn't be written
+bool saveSnapshot(const char *path, const RDField *field, const RDParams *params);
+
+/// Load a snapshot into a new field, stepped with the default kernel
+/// @param path The file to read
+/// @param field The field to initialise, which is left untouched if the snapshot can't be loaded
+/// @param params Set to the feed, kill and diffusion rates saved with the field, can be NULL
+/// @return False if the file doesn't exist, isn't a snapshot this version and precision can read or is truncated
+bool loadSnapshot(const char *path, RDField *field, RDParams *params);
+
+/// Start the thread that writes queued snapshots
+/// @return The writer, or NULL if the thread couldn't be started
+RDSnapshotWriter *createSnapshotWriter(void);
+
+/// Copy a field's state to be written in the background, only the copy happens on the calling thread
+/// @param writer The writer to queue the snapshot on
+/// @param path The file to write
+/// @param field The field to save, it can be stepped again as soon as this returns
+/// @param params The feed, kill and diffusion rates the field is being stepped with
+/// @return False if the previous snapshot is still being written or the buffer couldn't be allocated
+bool queueSnapshot(RDSnapshotWriter *writer, const char *path, const RDField *field, const RDParams *params);
+
+/// Check whether a queued snapshot is still being written
+/// @param writer The writer to check
+/// @return True while a snapshot is being written
+bool snapshotPending(RDSnapshotWriter *writer);
+
+/// Check whether the last snapshot the writer finished was written successfully
+/// @param writer The writer to check
+/// @return False if writing the file failed
+bool lastSnapshotSucceeded(RDSnapshotWriter *writer);
+
+/// Wait for any queued snapshot to be written, then stop the thread and free the writer
+/// @param writer The writer to free
+void freeSnapshotWriter(RDSnapshotWriter *writer);
+
+#endif
@@ -0,0 +1,225 @@
+// This program sweeps the reaction diffusion engine over a grid of parameters without opening a window
+//
+// Usage: rd_sweep [--feed from:to:count] [--kill from:to:count] [--da from:to:count] [--db from:to:count]
+//   [--size n] [--steps n] [--thumb n] [--threads n] [--out prefix]
+// Each range can also be a single value, e.g. rd_sweep --feed 0.01:0.1:32 --kill 0.045:0.07:32 --da 1 --db 0.5
+// Every combination is stepped from the centre square for --steps generations on its own field,
+// spread over --threads threads (0 for one per core), and written out as:
+//   prefix.csv          the parameters and summary stats of every run
+//   prefix_<n>.pgm      each run's b shrunk to a --thumb by --thumb greyscale thumbnail
+//   prefix_mosaic.pgm   every thumbnail, feed increasing across and kill down, one block of rows
+//                       for each combination of diffusion rates
+// --thumb 0 skips the thumbnails and mosaic
+
+#include "rd_engine.h"
+#include "rd_field.h"
+#include "rd_threads.h"
+#include "rd_batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_SIZE 128
+#define DEFAULT_STEPS 2000
+#define DEFAULT_THUMB 64
+#define DEFAULT_OUT "rd_sweep"
+#define MAX_PATH 512
+
+/// A range of values swept evenly from one end to the other
+typedef struct {
+    double from;
+    double to;
+    int count;
+} SweepRange;
+
+/// Parse a range given as from:to:count or a single value
+/// @param text The text to parse
+/// @param range Set to the range
+/// @return False if the text isn't a range
+static bool parseRange(const char *text, SweepRange *range)
+{
+    if (sscanf(text, "%lf:%lf:%d", &range->from, &range->to, &range->count) == 3) return range->count > 0;
+
+    char *end;
+    range->from = range->to = strtod(text, &end);
+    range->count = 1;
+    return end != text && *end == '\0';
+}
+
+static double rangeValue(const SweepRange *range, int i)
+{
+    return range->count > 1 ? range->from + (range->to - range->from) * i / (range->count - 1) : range->from;
+}
+
+/// Write greys out as a binary PGM image
+/// @param path Where to write it
+/// @param greys width * height greys, one byte each
+/// @return False if it couldn't be written
+static bool writePgm(const char *path, const unsigned char *greys, int width, int height)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) return false;
+
+    fprintf(file, "P5\n%d %d\n255\n", width, height);
+    bool written = fwrite(greys, 1, (size_t) width * height, file) == (size_t) width * height;
+    return fclose(file) == 0 && written;
+}
+
+/// Write the parameters and stats of every run to a CSV file
+static bool writeCsv(const char *path, const RDBatchSettings *settings, const RDBatchRun *runs, int numRuns)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL) return false;
+
+    fprintf(file, "run,feed,kill,da,db,steps,mean_a,mean_b,max_b,pattern_fraction,activity,seconds\n");
+    for (int r = 0; r < numRuns; r++)
+    {
+        const RDBatchRun *run = &runs[r];
+        fprintf(file, "%d,%.6f,%.6f,%.6f,%.6f,%d,%.6f,%.6f,%.6f,%.6f,%.3e,%.4f\n", r, run->params.feedRate,
+            run->params.killRate, run->params.dA, run->params.dB, settings->steps, run->meanA, run->meanB, run->maxB,
+            run->patternFraction, run->activity, run->seconds);
+    }
+
+    return fclose(file) == 0;
+}
+
+/// Lay every thumbnail out in one image, columns wide, and write it as a PGM
+static bool writeMosaic(const char *path, const RDBatchSettings *settings, const RDBatchRun *runs, int numRuns,
+    int columns)
+{
+    int rows = (numRuns + columns - 1) / columns;
+    int width = columns * settings->thumbnailWidth;
+    int height = rows * settings->thumbnailHeight;
+    unsigned char *mosaic = (unsigned char *) calloc((size_t) width * height, 1);
+    if (mosaic == NULL) return false;
+
+    // Runs that didn't finish are left black
+    for (int r = 0; r < numRuns; r++)
+    {
+        if (!runs[r].finished) continue;
+
+        int left = (r % columns) * settings->thumbnailWidth;
+        int top = (r / columns) * settings->thumbnailHeight;
+
+        for (int y = 0; y < settings->thumbnailHeight; y++)
+        {
+            memcpy(mosaic + (size_t) (top + y) * width + left, runs[r].thumbnail + (size_t) y * settings->thumbnailWidth,
+                settings->thumbnailWidth);
+        }
+    }
+
+    bool written = writePgm(path, mosaic, width, height);
+    free(mosaic);
+    return written;
+}
+
+static void printUsage(void)
+{
+    printf("Usage: rd_sweep [--feed from:to:count] [--kill from:to:count] [--da from:to:count] [--db from:to:count]\n"
+        "    [--size n] [--steps n] [--thumb n] [--threads n] [--out prefix]\n");
+}
+
+int main(int argc, char **argv)
+{
+    SweepRange feed = { 0.01, 0.1, 8 };
+    SweepRange kill = { 0.045, 0.07, 8 };
+    SweepRange dA = { RD_DEFAULT_PARAMS.dA, RD_DEFAULT_PARAMS.dA, 1 };
+    SweepRange dB = { RD_DEFAULT_PARAMS.dB, RD_DEFAULT_PARAMS.dB, 1 };
+    int size = DEFAULT_SIZE;
+    int thumb = DEFAULT_THUMB;
+    int threads = 0;
+    const char *out = DEFAULT_OUT;
+    RDBatchSettings settings = { 0, 0, DEFAULT_STEPS, SEED_CENTRE_SQUARE, 5, 0, 0 };
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool parsed = true;
+
+        if (strcmp(argv[i], "--feed") == 0 && i + 1 < argc) parsed = parseRange(argv[++i], &feed);
+        else if (strcmp(argv[i], "--kill") == 0 && i + 1 < argc) parsed = parseRange(argv[++i], &kill);
+        else if (strcmp(argv[i], "--da") == 0 && i + 1 < argc) parsed = parseRange(argv[++i], &dA);
+        else if (strcmp(argv[i], "--db") == 0 && i + 1 < argc) parsed = parseRange(argv[++i], &dB);
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc) settings.steps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--thumb") == 0 && i + 1 < argc) thumb = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) out = argv[++i];
+        else parsed = false;
+
+        if (!parsed)
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // The fields refuse seed squares that would reach their border, so turn those down before sweeping
+    if (!rdSeedFits(settings.seed, size, size, settings.bSquareSize))
+    {
+        printf("Grid size %d is too small for the seed squares\n", size);
+        return 1;
+    }
+
+    settings.width = settings.height = size;
+    settings.thumbnailWidth = settings.thumbnailHeight = thumb < 0 ? 0 : thumb > size ? size : thumb;
+
+    // Feed changes fastest so each row of the mosaic is one kill rate
+    int numRuns = feed.count * kill.count * dA.count * dB.count;
+    RDBatchRun *runs = (RDBatchRun *) calloc(numRuns, sizeof(RDBatchRun));
+    if (runs == NULL)
+    {
+        printf("Couldn't allocate %d runs\n", numRuns);
+        return 1;
+    }
+
+    for (int r = 0; r < numRuns; r++)
+    {
+        int f = r % feed.count;
+        int k = r / feed.count % kill.count;
+        int b = r / (feed.count * kill.count) % dB.count;
+        int a = r / (feed.count * kill.count * dB.count);
+        runs[r].params = (RDParams){ rangeValue(&feed, f), rangeValue(&kill, k), rangeValue(&dA, a), rangeValue(&dB, b) };
+    }
+
+    RDWorkerPool *pool = createWorkerPool(threads);
+    if (pool == NULL) printf("Couldn't start the worker pool, running on one thread\n");
+
+    printf("Sweeping %d runs of %dx%d for %d steps on %d threads\n", numRuns, size, size, settings.steps,
+        workerPoolSize(pool));
+
+    RDBatchStats stats;
+    bool finished = runBatch(pool, &settings, runs, numRuns, &stats);
+    freeWorkerPool(pool);
+
+    if (!finished) printf("Some runs couldn't allocate their fields\n");
+
+    char path[MAX_PATH];
+    bool written = true;
+
+    snprintf(path, sizeof(path), "%s.csv", out);
+    written = writeCsv(path, &settings, runs, numRuns) && written;
+
+    if (settings.thumbnailWidth > 0)
+    {
+        for (int i = 0; i < numRuns; i++)
+        {
+            if (!runs[i].finished) continue;
+            snprintf(path, sizeof(path), "%s_%d.pgm", out, i);
+            written = writePgm(path, runs[i].thumbnail, settings.thumbnailWidth, settings.thumbnailHeight) && written;
+        }
+
+        snprintf(path, sizeof(path), "%s_mosaic.pgm", out);
+        written = writeMosaic(path, &settings, runs, numRuns, feed.count) && written;
+    }
+
+    if (!written) printf("Couldn't write every result for %s\n", out);
+
+    // Only cells inside the border are stepped
+    printf("%-12s %12s %14s %12s %12s %8s\n", "runs", "seconds", "cells/sec", "runs/sec", "utilisation", "steals");
+    printf("%-12d %12.3f %14.0f %12.2f %11.1f%% %8d\n", numRuns, stats.seconds, stats.cellSteps / stats.seconds,
+        numRuns / stats.seconds, stats.busySeconds * 100.0 / (stats.threads * stats.seconds), stats.steals);
+
+    freeBatchThumbnails(runs, numRuns);
+    free(runs);
+    return finished && written ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+// A persistent pool of threads that step a field in horizontal stripes
+
+#include "rd_threads.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+/// A reusable barrier, pthread_barrier_t isn't available on every platform
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int count;              // The number of threads that have to arrive before any are released
+    int waiting;
+    unsigned int phase;     // Incremented every time the barrier releases
+} Barrier;
+
+typedef struct {
+    RDWorkerPool *pool;
+    int index;
+} Worker;
+
+struct RDWorkerPool {
+    int numThreads;
+    pthread_t *threads;
+    Worker *workers;
+    Barrier barrier;
+
+    // The job being run, written by the calling thread before it waits on the start barrier
+    RDPoolJob job;
+    bool quit;
+};
+
+/// The data for stepping a field in stripes
+typedef struct {
+    RDField *field;
+    const RDParams *params;
+} StripeJob;
+
+static void initialiseBarrier(Barrier *barrier, int count)
+{
+    pthread_mutex_init(&barrier->mutex, NULL);
+    pthread_cond_init(&barrier->cond, NULL);
+    barrier->count = count;
+    barrier->waiting = 0;
+    barrier->phase = 0;
+}
+
+/// Wait until every thread has arrived at the barrier
+/// @param barrier The barrier to wait on
+/// @param onLast Called by the last thread to arrive before the others are released, can be NULL
+/// @param arg Passed to onLast
+static void waitBarrier(Barrier *barrier, void (*onLast)(void *), void *arg)
+{
+    pthread_mutex_lock(&barrier->mutex);
+
+    unsigned int phase = barrier->phase;
+    if (++barrier->waiting == barrier->count)
+    {
+        if (onLast != NULL) onLast(arg);
+        barrier->waiting = 0;
+        barrier->phase++;
+        pthread_cond_broadcast(&barrier->cond);
+    }
+    else
+    {
+        while (phase == barrier->phase) pthread_cond_wait(&barrier->cond, &barrier->mutex);
+    }
+
+    pthread_mutex_unlock(&barrier->mutex);
+}
+
+static void freeBarrier(Barrier *barrier)
+{
+    pthread_cond_destroy(&barrier->cond);
+    pthread_mutex_destroy(&barrier->mutex);
+}
+
+/// Run every generation of a job on one thread
+static void runJob(RDWorkerPool *pool, int index, RDPoolJob job)
+{
+    for (int g = 0; g < job.generations; g++)
+    {
+        job.work(job.data, index, pool->numThreads);
+
+        // Nobody starts the next generation until every share has been done and finished
+        waitBarrier(&pool->barrier, job.finish, job.data);
+    }
+}
+
+static void *workerMain(void *arg)
+{
+    Worker *worker = (Worker *) arg;
+    RDWorkerPool *pool = worker->pool;
+
+    while (true)
+    {
+        waitBarrier(&pool->barrier, NULL, NULL);
+        if (pool->quit) break;
+
+        // The job is passed by value as the calling thread may set up the next one as soon as
+        // the last generation's barrier releases
+        runJob(pool, worker->index, pool->job);
+    }
+
+    return NULL;
+}
+
+/// Step one thread's stripe of the field
+static void stepStripe(void *data, int thread, int numThreads)
+{
+    StripeJob *job = (StripeJob *) data;
+
+    // Split the rows inside the border as evenly as possible
+    int interiorRows = job->field->height - 2;
+    int firstRow = 1 + (int) ((long long) interiorRows * thread / numThreads);
+    int lastRow = 1 + (int) ((long long) interiorRows * (thread + 1) / numThreads);
+
+    stepFieldRows(job->field, job->params, firstRow, lastRow);
+}
+
+static void finishStripes(void *data)
+{
+    swapField(((StripeJob *) data)->field);
+}
+
+int rdDefaultThreadCount(void)
+{
+    const char *requested = getenv("RD_THREADS");
+    if (requested != NULL && atoi(requested) > 0) return atoi(requested);
+
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int cores = (int) info.dwNumberOfProcessors;
+#else
+    int cores = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    return cores > 0 ? cores : 1;
+}
+
+RDWorkerPool *createWorkerPool(int numThreads)
+{
+    if (numThreads <= 0) numThreads = rdDefaultThreadCount();
+
+    RDWorkerPool *pool = (RDWorkerPool *) calloc(1, sizeof(RDWorkerPool));
+    if (pool == NULL) return NULL;
+
+    pool->numThreads = numThreads;
+    pool->threads = (pthread_t *) malloc(numThreads * sizeof(pthread_t));
+    pool->workers = (Worker *) malloc(numThreads * sizeof(Worker));
+    if (pool->threads == NULL || pool->workers == NULL)
+    {
+        free(pool->threads);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+
+    initialiseBarrier(&pool->barrier, numThreads);
+
+    // The calling thread is worker 0 so only the rest need starting
+    for (int i = 1; i < numThreads; i++)
+    {
+        pool->workers[i] = (Worker){ pool, i };
+        if (pthread_create(&pool->threads[i], NULL, workerMain, &pool->workers[i]) != 0)
+        {
+            // Shrink the pool to the threads that did start so the barrier still releases, those
+            // threads may already be waiting on it so the count only changes under its lock
+            pthread_mutex_lock(&pool->barrier.mutex);
+            pool->numThreads = i;
+            pool->barrier.count = i;
+            pthread_mutex_unlock(&pool->barrier.mutex);
+            break;
+        }
+    }
+
+    return pool;
+}
+
+int workerPoolSize(const RDWorkerPool *pool)
+{
+    return pool != NULL ? pool->numThreads : 1;
+}
+
+void runPoolJob(RDWorkerPool *pool, const RDPoolJob *job)
+{
+    if (job->generations <= 0) return;
+
+    if (pool == NULL || pool->numThreads == 1)
+    {
+        for (int g = 0; g < job->generations; g++)
+        {
+            job->work(job->data, 0, 1);
+            if (job->finish != NULL) job->finish(job->data);
+        }
+        return;
+    }
+
+    pool->job = *job;
+
+    waitBarrier(&pool->barrier, NULL, NULL);
+    runJob(pool, 0, *job);
+}
+
+void stepFieldParallel(RDWorkerPool *pool, RDField *field, const RDParams *params, int steps)
+{
+    if (pool == NULL || pool->numThreads == 1)
+    {
+        for (int s = 0; s < steps; s++) stepField(field, params);
+        return;
+    }
+
+    StripeJob stripes = { field, params };
+    RDPoolJob job = { stepStripe, finishStripes, &stripes, steps };
+    runPoolJob(pool, &job);
+}
+
+void freeWorkerPool(RDWorkerPool *pool)
+{
+    if (pool == NULL) return;
+
+    if (pool->numThreads > 1)
+    {
+        pool->quit = true;
+        waitBarrier(&pool->barrier, NULL, NULL);
+
+        for (int i = 1; i < pool->numThreads; i++) pthread_join(pool->threads[i], NULL);
+    }
+
+    freeBarrier(&pool->barrier);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool);
+}
@@ -0,0 +1,53 @@
+// A persistent pool of threads that step a field in horizontal stripes
+//
+// The threads are started once and wait on a barrier between generations, so stepping doesn't
+// create any threads. Each stripe is stepped with the same row kernel as stepField, so the
+// results are bit identical to stepping on a single thread.
+
+#ifndef RD_THREADS_H
+#define RD_THREADS_H
+
+#include "rd_field.h"
+
+typedef struct RDWorkerPool RDWorkerPool;
+
+/// Work split between every thread of a pool, once per generation
+typedef struct {
+    void (*work)(void *data, int thread, int numThreads);   // Do one thread's share of a generation
+    void (*finish)(void *data);     // Run by a single thread once every share of a generation is done
+    void *data;
+    int generations;
+} RDPoolJob;
+
+/// Get the number of threads a pool uses when it isn't given one, the value of the RD_THREADS
+/// environment variable if it's set or else the number of cores
+/// @return The default number of threads
+int rdDefaultThreadCount(void);
+
+/// Start a pool of threads, the thread calling runPoolJob or stepFieldParallel counts as one of them
+/// @param numThreads The number of threads to step with, 0 or less uses rdDefaultThreadCount
+/// @return The pool, or NULL if the threads couldn't be started
+RDWorkerPool *createWorkerPool(int numThreads);
+
+/// Get the number of threads a pool steps with
+/// @param pool The pool to check
+/// @return The number of threads, including the one that runs the jobs
+int workerPoolSize(const RDWorkerPool *pool);
+
+/// Run a job on every thread in the pool, returning once every generation has finished
+/// @param pool The pool to run on, NULL runs the job on the calling thread
+/// @param job The job to run
+void runPoolJob(RDWorkerPool *pool, const RDPoolJob *job);
+
+/// Advance a field by a number of generations using every thread in the pool
+/// @param pool The pool to step with, NULL steps on the calling thread
+/// @param field The field to step
+/// @param params The feed, kill and diffusion rates to use
+/// @param steps The number of generations to step
+void stepFieldParallel(RDWorkerPool *pool, RDField *field, const RDParams *params, int steps);
+
+/// Stop the threads of a pool and free it
+/// @param pool The pool to free
+void freeWorkerPool(RDWorkerPool *pool);
+
+#endif
@@ -0,0 +1,264 @@
+// Steps only the parts of a field that can change
+
+#include "rd_tiles.h"
+#include "rd_colour.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The edges and corners of a tile, set when their cells are beyond epsilon
+#define EDGE_TOP 1
+#define EDGE_BOTTOM 2
+#define EDGE_LEFT 4
+#define EDGE_RIGHT 8
+#define CORNER_TOP_LEFT 16
+#define CORNER_TOP_RIGHT 32
+#define CORNER_BOTTOM_LEFT 64
+#define CORNER_BOTTOM_RIGHT 128
+
+/// The data for stepping the active tiles
+typedef struct {
+    RDTiles *tiles;
+    RDField *field;
+    const RDParams *params;
+} TileJob;
+
+/// Get the cells covered by a tile, clipped to the field
+static void getTileRect(const RDTiles *tiles, const RDField *field, int tile,
+    int *left, int *top, int *right, int *bottom)
+{
+    *left = (tile % tiles->tilesX) * tiles->tileSize;
+    *top = (tile / tiles->tilesX) * tiles->tileSize;
+    *right = *left + tiles->tileSize;
+    *bottom = *top + tiles->tileSize;
+
+    if (*right > field->width) *right = field->width;
+    if (*bottom > field->height) *bottom = field->height;
+}
+
+/// Check whether a cell is more than epsilon from the background
+static inline bool isDisturbed(const RDReal *a, const RDReal *b, size_t i, double epsilon)
+{
+    return fabs(rdRealToDouble(a[i]) - 1.0) > epsilon || fabs(rdRealToDouble(b[i])) > epsilon;
+}
+
+/// Check whether any cell in a run of a row is more than epsilon from the background, written
+/// without branches in the loop so it vectorises
+static bool isRunDisturbed(const RDReal *a, const RDReal *b, size_t first, size_t last, double epsilon)
+{
+    int disturbed = 0;
+    for (size_t i = first; i < last; i++)
+    {
+        disturbed |= (fabs(rdRealToDouble(a[i]) - 1.0) > epsilon) | (fabs(rdRealToDouble(b[i])) > epsilon);
+    }
+
+    return disturbed != 0;
+}
+
+/// Check how far a tile's newly written cells are from the background
+static void measureTile(RDTiles *tiles, const RDField *field, int tile)
+{
+    const RDReal *a = field->a[1 - field->current];
+    const RDReal *b = field->b[1 - field->current];
+    double epsilon = tiles->epsilon;
+    int left, top, right, bottom;
+    getTileRect(tiles, field, tile, &left, &top, &right, &bottom);
+
+    bool quiet = true;
+    for (int y = top; y < bottom && quiet; y++)
+    {
+        size_t row = (size_t) y * field->stride;
+        quiet = !isRunDisturbed(a, b, row + left, row + right, epsilon);
+    }
+
+    // Only the cells along the edges matter to the neighbours
+    unsigned char edges = 0;
+    if (!quiet)
+    {
+        size_t topRow = (size_t) top * field->stride;
+        size_t bottomRow = (size_t) (bottom - 1) * field->stride;
+
+        if (isRunDisturbed(a, b, topRow + left, topRow + right, epsilon)) edges |= EDGE_TOP;
+        if (isRunDisturbed(a, b, bottomRow + left, bottomRow + right, epsilon)) edges |= EDGE_BOTTOM;
+        if (isDisturbed(a, b, topRow + left, epsilon)) edges |= CORNER_TOP_LEFT | EDGE_LEFT;
+        if (isDisturbed(a, b, topRow + right - 1, epsilon)) edges |= CORNER_TOP_RIGHT | EDGE_RIGHT;
+        if (isDisturbed(a, b, bottomRow + left, epsilon)) edges |= CORNER_BOTTOM_LEFT | EDGE_LEFT;
+        if (isDisturbed(a, b, bottomRow + right - 1, epsilon)) edges |= CORNER_BOTTOM_RIGHT | EDGE_RIGHT;
+
+        for (int y = top + 1; y < bottom - 1 && (edges & (EDGE_LEFT | EDGE_RIGHT)) != (EDGE_LEFT | EDGE_RIGHT); y++)
+        {
+            size_t row = (size_t) y * field->stride;
+            if (isDisturbed(a, b, row + left, epsilon)) edges |= EDGE_LEFT;
+            if (isDisturbed(a, b, row + right - 1, epsilon)) edges |= EDGE_RIGHT;
+        }
+    }
+
+    tiles->quiet[tile] = quiet;
+    tiles->edges[tile] = edges;
+}
+
+/// Step one thread's share of the active tiles
+static void stepTileShare(void *data, int thread, int numThreads)
+{
+    TileJob *job = (TileJob *) data;
+    RDTiles *tiles = job->tiles;
+
+    for (int i = thread; i < tiles->numActive; i += numThreads)
+    {
+        int tile = tiles->activeList[i];
+        int left, top, right, bottom;
+        getTileRect(tiles, job->field, tile, &left, &top, &right, &bottom);
+
+        stepFieldRect(job->field, job->params, left, top, right, bottom);
+        measureTile(tiles, job->field, tile);
+    }
+}
+
+/// Wake a neighbouring tile if it's inside the grid of tiles
+static inline void wakeTile(RDTiles *tiles, int tileX, int tileY)
+{
+    if (tileX < 0 || tileY < 0 || tileX >= tiles->tilesX || tileY >= tiles->tilesY) return;
+
+    tiles->active[tileY * tiles->tilesX + tileX] = true;
+}
+
+/// Set a tile back to the background in both generations
+static void snapTile(const RDTiles *tiles, RDField *field, int tile)
+{
+    int left, top, right, bottom;
+    getTileRect(tiles, field, tile, &left, &top, &right, &bottom);
+
+    for (int g = 0; g < 2; g++)
+    {
+        for (int y = top; y < bottom; y++)
+        {
+            size_t row = (size_t) y * field->stride;
+            for (int x = left; x < right; x++)
+            {
+                field->a[g][row + x] = rdRealFromDouble(1.0);
+                field->b[g][row + x] = 0;
+            }
+        }
+    }
+}
+
+/// Work out which tiles are active next generation once every active tile has been stepped
+static void finishTileGeneration(void *data)
+{
+    TileJob *job = (TileJob *) data;
+    RDTiles *tiles = job->tiles;
+    long long generation = tiles->generation + 1;
+
+    memset(tiles->active, 0, (size_t) tiles->tilesX * tiles->tilesY);
+
+    for (int i = 0; i < tiles->numActive; i++)
+    {
+        int tile = tiles->activeList[i];
+        int tileX = tile % tiles->tilesX;
+        int tileY = tile / tiles->tilesX;
+        unsigned char edges = tiles->edges[tile];
+
+        tiles->lastChanged[tile] = generation;
+        if (!tiles->quiet[tile]) tiles->active[tile] = true;
+
+        // Neighbours only read the edge of this tile facing them
+        if (edges & EDGE_TOP) wakeTile(tiles, tileX, tileY - 1);
+        if (edges & EDGE_BOTTOM) wakeTile(tiles, tileX, tileY + 1);
+        if (edges & EDGE_LEFT) wakeTile(tiles, tileX - 1, tileY);
+        if (edges & EDGE_RIGHT) wakeTile(tiles, tileX + 1, tileY);
+        if (edges & CORNER_TOP_LEFT) wakeTile(tiles, tileX - 1, tileY - 1);
+        if (edges & CORNER_TOP_RIGHT) wakeTile(tiles, tileX + 1, tileY - 1);
+        if (edges & CORNER_BOTTOM_LEFT) wakeTile(tiles, tileX - 1, tileY + 1);
+        if (edges & CORNER_BOTTOM_RIGHT) wakeTile(tiles, tileX + 1, tileY + 1);
+    }
+
+    // Tiles going dormant need both generations holding the background so it doesn't matter
+    // which one is current when their neighbours read them
+    for (int i = 0; i < tiles->numActive; i++)
+    {
+        int tile = tiles->activeList[i];
+        if (tiles->active[tile]) continue;
+
+        snapTile(tiles, job->field, tile);
+        tiles->edges[tile] = 0;
+    }
+
+    tiles->tilesStepped += tiles->numActive;
+    tiles->numActive = 0;
+    for (int tile = 0; tile < tiles->tilesX * tiles->tilesY; tile++)
+    {
+        if (tiles->active[tile]) tiles->activeList[tiles->numActive++] = tile;
+    }
+
+    swapField(job->field);
+    tiles->generation = generation;
+}
+
+bool initialiseTiles(RDTiles *tiles, const RDField *field, int tileSize, double epsilon)
+{
+    tiles->tileSize = tileSize > 0 ? tileSize : RD_DEFAULT_TILE_SIZE;
+    tiles->tilesX = (field->width + tiles->tileSize - 1) / tiles->tileSize;
+    tiles->tilesY = (field->height + tiles->tileSize - 1) / tiles->tileSize;
+    tiles->epsilon = epsilon;
+    tiles->generation = 0;
+    tiles->tilesStepped = 0;
+
+    int numTiles = tiles->tilesX * tiles->tilesY;
+    tiles->active = (unsigned char *) malloc(numTiles);
+    tiles->quiet = (unsigned char *) calloc(numTiles, 1);
+    tiles->edges = (unsigned char *) calloc(numTiles, 1);
+    tiles->lastChanged = (long long *) calloc(numTiles, sizeof(long long));
+    tiles->activeList = (int *) malloc(numTiles * sizeof(int));
+
+    if (tiles->active == NULL || tiles->quiet == NULL || tiles->edges == NULL
+        || tiles->lastChanged == NULL || tiles->activeList == NULL)
+    {
+        freeTiles(tiles);
+        return false;
+    }
+
+    // Everything is stepped once to find out where the seeds are
+    memset(tiles->active, 1, numTiles);
+    for (int tile = 0; tile < numTiles; tile++) tiles->activeList[tile] = tile;
+    tiles->numActive = numTiles;
+
+    return true;
+}
+
+void stepTiles(RDWorkerPool *pool, RDTiles *tiles, RDField *field, const RDParams *params, int steps)
+{
+    TileJob tileJob = { tiles, field, params };
+    RDPoolJob job = { stepTileShare, finishTileGeneration, &tileJob, steps };
+    runPoolJob(pool, &job);
+}
+
+void colourChangedTiles(const RDTiles *tiles, const RDField *field, unsigned char *pixels, long long sinceGeneration)
+{
+    for (int tile = 0; tile < tiles->tilesX * tiles->tilesY; tile++)
+    {
+        if (tiles->lastChanged[tile] <= sinceGeneration) continue;
+
+        int left, top, right, bottom;
+        getTileRect(tiles, field, tile, &left, &top, &right, &bottom);
+        colourFieldRect(field, pixels, left, top, right, bottom);
+    }
+}
+
+double activeTileFraction(const RDTiles *tiles)
+{
+    return (double) tiles->numActive / (tiles->tilesX * tiles->tilesY);
+}
+
+void freeTiles(RDTiles *tiles)
+{
+    free(tiles->active);
+    free(tiles->quiet);
+    free(tiles->edges);
+    free(tiles->lastChanged);
+    free(tiles->activeList);
+    tiles->active = NULL;
+    tiles->quiet = NULL;
+    tiles->edges = NULL;
+    tiles->lastChanged = NULL;
+    tiles->activeList = NULL;
+}
@@ -0,0 +1,70 @@
+// Steps only the parts of a field that can change
+//
+// The field is split into square tiles that are either active or dormant. A dormant tile holds
+// the a = 1, b = 0 background in both generations, which the Gray-Scott update leaves exactly
+// as it is, so it's skipped until the edge of a neighbouring tile facing it moves more than
+// epsilon away from the background. After being stepped a tile goes dormant once none of its
+// cells are more than epsilon from the background and no neighbour is keeping it awake.
+//
+// With an epsilon of 0 the results are bit identical to stepping every cell. A larger epsilon
+// lets tiles settle sooner by snapping values within epsilon of the background to it.
+
+#ifndef RD_TILES_H
+#define RD_TILES_H
+
+#include "rd_field.h"
+#include "rd_threads.h"
+
+/// The default width and height of a tile in cells
+#define RD_DEFAULT_TILE_SIZE 32
+
+typedef struct {
+    int tileSize;
+    int tilesX;
+    int tilesY;
+    double epsilon;
+
+    unsigned char *active;      // Whether each tile is stepped this generation
+    unsigned char *quiet;       // Whether each tile was within epsilon of the background after its last step
+    unsigned char *edges;       // Which edges and corners of each tile were beyond epsilon after its last step
+    long long *lastChanged;     // The generation each tile's cells were last written
+    int *activeList;            // The indices of the active tiles
+    int numActive;
+
+    long long generation;       // The number of generations stepped
+    long long tilesStepped;     // The total number of tile steps, to compare with generation * numTiles
+} RDTiles;
+
+/// Split a field into tiles, all of which start active
+/// @param tiles The tiles to initialise
+/// @param field The field the tiles cover
+/// @param tileSize The width and height of a tile in cells
+/// @param epsilon How far from the background a cell can be and still count as background
+/// @return False if the memory for the tiles couldn't be allocated
+bool initialiseTiles(RDTiles *tiles, const RDField *field, int tileSize, double epsilon);
+
+/// Advance the active tiles of a field by a number of generations
+/// @param pool The pool to step with, NULL steps on the calling thread
+/// @param tiles The tiles covering the field
+/// @param field The field to step
+/// @param params The feed, kill and diffusion rates to use
+/// @param steps The number of generations to step
+void stepTiles(RDWorkerPool *pool, RDTiles *tiles, RDField *field, const RDParams *params, int steps);
+
+/// Colour the tiles written since a pixel buffer was last coloured
+/// @param tiles The tiles covering the field
+/// @param field The field to colour
+/// @param pixels A buffer of width * height * RD_PIXEL_SIZE bytes
+/// @param sinceGeneration The generation the buffer was last coloured at, -1 colours everything
+void colourChangedTiles(const RDTiles *tiles, const RDField *field, unsigned char *pixels, long long sinceGeneration);
+
+/// Get the fraction of tiles that will be stepped next generation
+/// @param tiles The tiles to check
+/// @return The fraction from 0 to 1
+double activeTileFraction(const RDTiles *tiles);
+
+/// Free the memory used by the tiles
+/// @param tiles The tiles to free
+void freeTiles(RDTiles *tiles);
+
+#endif
@@ -0,0 +1,275 @@
+// Picks the fastest backend for a field by timing each one on it, remembering the choice
+
+#include "rd_tune.h"
+#include "rd_colour.h"
+#include "rd_tiles.h"
+#include "rd_blocking.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The tile sizes and block steps tried, each default and one other
+static const int tileSizes[] = { RD_DEFAULT_TILE_SIZE, 2 * RD_DEFAULT_TILE_SIZE };
+static const int blockSteps[] = { RD_DEFAULT_BLOCK_STEPS / 2, RD_DEFAULT_BLOCK_STEPS };
+
+#define NUM_TILE_SIZES (int) (sizeof(tileSizes) / sizeof(tileSizes[0]))
+#define NUM_BLOCK_STEPS (int) (sizeof(blockSteps) / sizeof(blockSteps[0]))
+
+/// What a cached choice was tuned for, anything different has to be tuned again
+typedef struct {
+    char machine[256];
+    int width;
+    int height;
+    char precision[16];
+    int cores;
+    int stepsPerBatch;
+    bool rateMap;           // Whether the field has a rate map, which the original layouts can't step
+} CacheKey;
+
+static void addCandidate(RDBackendConfig *candidates, int maxCandidates, int *numCandidates,
+    const RDBackendConfig *candidate)
+{
+    if (*numCandidates < maxCandidates) candidates[(*numCandidates)++] = *candidate;
+}
+
+int listBackendCandidates(RDBackendConfig *candidates, int maxCandidates, double tileEpsilon)
+{
+    int numCandidates = 0;
+    int cores = rdDefaultThreadCount();
+    RDKernelType bestKernel = rdDefaultKernel();
+
+    for (int b = 0; b < backendCount(); b++)
+    {
+        const RDBackend *backend = getBackend(b);
+        RDBackendConfig candidate = {
+            backend->name, bestKernel, cores, RD_DEFAULT_TILE_SIZE, tileEpsilon, RD_DEFAULT_BLOCK_STEPS
+        };
+
+        // The original layouts only use the threads to colour
+        if (!backend->usesKernel)
+        {
+            addCandidate(candidates, maxCandidates, &numCandidates, &candidate);
+            continue;
+        }
+
+        // One thread and every core, there's rarely anything to gain in between
+        int threadCounts[2] = { 1, cores };
+        for (int n = 0; n < (cores > 1 ? 2 : 1); n++)
+        {
+            candidate.threads = threadCounts[n];
+
+            // Every kernel is tried on the whole field, the others just use the widest one
+            if (!backend->usesTiles && !backend->usesBlocks && !backend->usesProcesses)
+            {
+                for (int k = 0; k < KERNEL_COUNT; k++)
+                {
+                    if (!rdKernelSupported(k)) continue;
+                    candidate.kernel = k;
+                    addCandidate(candidates, maxCandidates, &numCandidates, &candidate);
+                }
+                continue;
+            }
+
+            for (int t = 0; t < (backend->usesTiles ? NUM_TILE_SIZES : 1); t++)
+            {
+                for (int s = 0; s < (backend->usesBlocks ? NUM_BLOCK_STEPS : 1); s++)
+                {
+                    candidate.tileSize = backend->usesTiles ? tileSizes[t] : RD_DEFAULT_TILE_SIZE;
+                    candidate.blockSteps = backend->usesBlocks ? blockSteps[s] : RD_DEFAULT_BLOCK_STEPS;
+                    addCandidate(candidates, maxCandidates, &numCandidates, &candidate);
+                }
+            }
+        }
+    }
+
+    return numCandidates;
+}
+
+double timeBackend(const RDField *field, const RDBackendConfig *config, const RDParams *params, const RDView *view,
+    int stepsPerBatch, double seconds)
+{
+    RDField copy;
+    RDMipPyramid pyramid;
+    if (!initialiseField(&copy, field->width, field->height, SEED_CENTRE_SQUARE, 0)) return 0.0;
+    if (!initialiseMipPyramid(&pyramid, &copy))
+    {
+        freeField(&copy);
+        return 0.0;
+    }
+
+    // Both generations start as the field's latest, so the border matches whichever is current
+    size_t planeSize = (size_t) field->stride * field->height * sizeof(RDReal);
+    for (int plane = 0; plane < 2; plane++)
+    {
+        memcpy(copy.a[plane], fieldA(field), planeSize);
+        memcpy(copy.b[plane], fieldB(field), planeSize);
+    }
+    copy.generation = field->generation;
+    shareFieldRates(&copy, &field->rates, 0, 0);
+
+    unsigned char *pixels = (unsigned char *) malloc((size_t) view->width * view->height * RD_PIXEL_SIZE);
+    RDStepper stepper;
+    double rate = 0.0;
+
+    if (pixels != NULL && startStepper(&stepper, &copy, config))
+    {
+        long long done = 0;
+        double start = rdGetTime();
+        double elapsed = 0.0;
+        while (done == 0 || elapsed < seconds)
+        {
+            stepStepper(&stepper, params, stepsPerBatch);
+            colouriseStepper(&stepper, &pyramid, view, pixels);
+            done += stepsPerBatch;
+            elapsed = rdGetTime() - start;
+        }
+        rate = done / elapsed;
+        stopStepper(&stepper);
+    }
+
+    free(pixels);
+    freeMipPyramid(&pyramid);
+    freeField(&copy);
+    return rate;
+}
+
+static bool sameKey(const CacheKey *key, const CacheKey *other)
+{
+    return strcmp(key->machine, other->machine) == 0 && key->width == other->width && key->height == other->height
+        && strcmp(key->precision, other->precision) == 0 && key->cores == other->cores
+        && key->stepsPerBatch == other->stepsPerBatch && key->rateMap == other->rateMap;
+}
+
+// Read a line of the cache, machine width height precision cores steps-per-batch rate-map then the
+// choice as backend kernel threads tile-size block-steps and the steps/sec it reached
+static bool parseCacheLine(const char *line, CacheKey *key, RDBackendConfig *config)
+{
+    char backend[64], kernel[16];
+    int rateMap;
+    double rate;
+    if (line[0] == '#' || sscanf(line, "%255s %d %d %15s %d %d %d %63s %15s %d %d %d %lf", key->machine,
+        &key->width, &key->height, key->precision, &key->cores, &key->stepsPerBatch, &rateMap, backend, kernel,
+        &config->threads, &config->tileSize, &config->blockSteps, &rate) != 13) return false;
+    key->rateMap = rateMap != 0;
+
+    // Only choices that can still be made on this build are used
+    const RDBackend *found = findBackend(backend);
+    if (found == NULL) return false;
+    config->backend = found->name;
+
+    for (int k = 0; k < KERNEL_COUNT; k++)
+    {
+        if (strcmp(kernel, rdKernelName(k)) == 0 && rdKernelSupported(k))
+        {
+            config->kernel = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool loadCachedChoice(const char *path, const CacheKey *key, RDBackendConfig *config)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return false;
+
+    char line[512];
+    bool found = false;
+    while (!found && fgets(line, sizeof(line), file) != NULL)
+    {
+        CacheKey lineKey;
+        RDBackendConfig lineConfig = *config;
+        if (parseCacheLine(line, &lineKey, &lineConfig) && sameKey(&lineKey, key))
+        {
+            *config = lineConfig;
+            found = true;
+        }
+    }
+
+    fclose(file);
+    return found;
+}
+
+// Rewrite the cache with this choice in place of any earlier one for the same key, false if it
+// couldn't be written
+static bool saveCachedChoice(const char *path, const CacheKey *key, const RDBackendConfig *config, double rate)
+{
+    // The other lines are kept as they are, however many there are
+    char *kept = NULL;
+    size_t keptSize = 0;
+    FILE *file = fopen(path, "r");
+    if (file != NULL)
+    {
+        char line[512];
+        while (fgets(line, sizeof(line), file) != NULL)
+        {
+            CacheKey lineKey;
+            RDBackendConfig lineConfig = *config;
+            if (line[0] == '#' || (parseCacheLine(line, &lineKey, &lineConfig) && sameKey(&lineKey, key))) continue;
+
+            size_t length = strlen(line);
+            char *grown = (char *) realloc(kept, keptSize + length + 1);
+            if (grown == NULL) break;
+            kept = grown;
+            memcpy(kept + keptSize, line, length + 1);
+            keptSize += length;
+        }
+        fclose(file);
+    }
+
+    file = fopen(path, "w");
+    bool saved = file != NULL;
+    if (file != NULL)
+    {
+        fprintf(file, "# The fastest backend for each machine and field size, delete a line to tune it again\n"
+            "# machine width height precision cores steps-per-batch rate-map backend kernel threads tile-size block-steps "
+            "steps/sec\n");
+        if (kept != NULL) fputs(kept, file);
+        fprintf(file, "%s %d %d %s %d %d %d %s %s %d %d %d %.2f\n", key->machine, key->width, key->height,
+            key->precision, key->cores, key->stepsPerBatch, key->rateMap ? 1 : 0, config->backend, rdKernelName(config->kernel), config->threads,
+            config->tileSize, config->blockSteps, rate);
+        saved = !ferror(file);
+        saved = fclose(file) == 0 && saved;
+    }
+
+    free(kept);
+    return saved;
+}
+
+RDTuneResult tuneBackend(const RDField *field, const RDParams *params, const RDView *view, int stepsPerBatch,
+    double tileEpsilon, double secondsPerCandidate, const char *cachePath, RDBackendConfig *config)
+{
+    CacheKey key = { { 0 } };
+    rdMachineName(key.machine, sizeof(key.machine));
+    key.width = field->width;
+    key.height = field->height;
+    snprintf(key.precision, sizeof(key.precision), "%s", RD_PRECISION_NAME);
+    key.cores = rdDefaultThreadCount();
+    key.stepsPerBatch = stepsPerBatch;
+    key.rateMap = fieldHasRates(field);
+
+    // The field backend with the default kernel is what ran before there was a choice
+    RDBackendConfig original = {
+        "field", rdDefaultKernel(), key.cores, RD_DEFAULT_TILE_SIZE, tileEpsilon, RD_DEFAULT_BLOCK_STEPS
+    };
+    *config = original;
+
+    if (cachePath != NULL && loadCachedChoice(cachePath, &key, config)) return TUNE_CACHED;
+
+    RDBackendConfig candidates[RD_MAX_TUNE_CANDIDATES];
+    int numCandidates = listBackendCandidates(candidates, RD_MAX_TUNE_CANDIDATES, tileEpsilon);
+    double bestRate = 0.0;
+
+    for (int c = 0; c < numCandidates; c++)
+    {
+        double rate = timeBackend(field, &candidates[c], params, view, stepsPerBatch, secondsPerCandidate);
+        if (rate > bestRate)
+        {
+            bestRate = rate;
+            *config = candidates[c];
+        }
+    }
+
+    if (cachePath != NULL && bestRate > 0.0 && saveCachedChoice(cachePath, &key, config, bestRate)) return TUNE_SAVED;
+    return TUNE_UNSAVED;
+}
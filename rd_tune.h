@@ -0,0 +1,57 @@
+// Picks the fastest backend for a field by timing each one on it, remembering the choice
+//
+// Which backend and settings are fastest depends on the CPU, the number of cores, the size of
+// the field and how much of it is active, so there's no one right answer. The auto-tuner steps
+// and colours a copy of the field with every backend, kernel, tile size and thread count worth
+// trying for a fraction of a second each and picks whichever got through the most generations.
+// The choice is written to a cache file keyed by the machine, the field's size and whether it has
+// a rate map, so later runs on the same machine skip straight to it.
+
+#ifndef RD_TUNE_H
+#define RD_TUNE_H
+
+#include "rd_backend.h"
+
+/// The most candidates listBackendCandidates returns
+#define RD_MAX_TUNE_CANDIDATES 64
+
+/// Where tuneBackend's choice came from
+typedef enum {
+    TUNE_CACHED,    // Read back from the cache
+    TUNE_SAVED,     // Timed and written to the cache
+    TUNE_UNSAVED    // Timed but not written, with no cache, nothing timed or a cache that couldn't be written
+} RDTuneResult;
+
+/// List every backend and settings worth timing on this machine
+/// @param candidates Filled with the candidates
+/// @param maxCandidates The most candidates to list
+/// @param tileEpsilon The epsilon to give the tiles backends
+/// @return The number of candidates
+int listBackendCandidates(RDBackendConfig *candidates, int maxCandidates, double tileEpsilon);
+
+/// Time how fast a backend steps and colours a copy of a field
+/// @param field The field to copy, it isn't changed
+/// @param config The backend and its settings
+/// @param params The feed, kill and diffusion rates to use
+/// @param view The view to colour after each batch
+/// @param stepsPerBatch The number of generations stepped between colourings
+/// @param seconds How long to time it for, at least one batch is always timed
+/// @return The generations stepped per second, 0 if the backend couldn't be started
+double timeBackend(const RDField *field, const RDBackendConfig *config, const RDParams *params, const RDView *view,
+    int stepsPerBatch, double seconds);
+
+/// Pick the fastest backend for a field, from the cache if this machine has already picked one
+/// for a field of its size with a rate map, or without one, like this field
+/// @param field The field as the simulation will start, it isn't changed
+/// @param params The feed, kill and diffusion rates to use
+/// @param view The view to colour after each batch
+/// @param stepsPerBatch The number of generations stepped between colourings
+/// @param tileEpsilon The epsilon to give the tiles backends
+/// @param secondsPerCandidate How long to time each candidate for
+/// @param cachePath The file choices are cached in, NULL always tunes and caches nothing
+/// @param config Set to the fastest backend and its settings
+/// @return Whether the choice came from the cache, or was timed and whether it was saved
+RDTuneResult tuneBackend(const RDField *field, const RDParams *params, const RDView *view, int stepsPerBatch,
+    double tileEpsilon, double secondsPerCandidate, const char *cachePath, RDBackendConfig *config);
+
+#endif
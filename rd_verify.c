@@ -0,0 +1,1046 @@
+// The checks rd_bench --verify runs against the engine
+
+#include "rd_verify.h"
+#include "rd_kernel.h"
+#include "rd_colour.h"
+#include "rd_tiles.h"
+#include "rd_blocking.h"
+#include "rd_snapshot.h"
+#include "rd_view.h"
+#include "rd_domain.h"
+#include "rd_backend.h"
+#include "rd_implicit.h"
+#include "rd_record.h"
+#include "rd_rates.h"
+#include "rd_palette.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VERIFY_BLOCK_SIZE 48
+#define VERIFY_DOMAIN_WORKERS 3
+#define VERIFY_BATCH_STEPS 8
+#define VERIFY_RECORD_FRAMES 5
+#define VERIFY_SNAPSHOT_PATH "rd_verify.rdsnap"
+#define VERIFY_RECORD_PATH "rd_verify_record"
+#define VERIFY_RATES_PATH "rd_verify_rates"
+
+// The original layouts only step doubles, so they match the field kernels far less closely at
+// the other precisions
+#if RD_PRECISION == RD_PRECISION_DOUBLE
+    #define BACKEND_TOLERANCE RD_KERNEL_TOLERANCE
+#else
+    #define BACKEND_TOLERANCE 1e-2
+#endif
+
+// A rate map works out each cell's feed plus kill rate at the cells' precision rather than in
+// doubles, so a map of one rate everywhere only steps exactly like the params' rates with doubles
+#if RD_PRECISION == RD_PRECISION_DOUBLE
+    #define RATES_TOLERANCE 0.0
+#else
+    #define RATES_TOLERANCE 1e-2
+#endif
+
+int countDifferentCells(const RDField *field, const RDField *expected)
+{
+    int differentCells = 0;
+    for (int y = 0; y < field->height; y++)
+    {
+        for (int x = 0; x < field->width; x++)
+        {
+            int i = y * field->stride + x;
+            differentCells += fieldA(field)[i] != fieldA(expected)[i] || fieldB(field)[i] != fieldB(expected)[i];
+        }
+    }
+
+    return differentCells;
+}
+
+double maxCellDifference(const RDField *field, const RDField *expected)
+{
+    double maxDifference = 0.0;
+    for (int y = 0; y < field->height; y++)
+    {
+        for (int x = 0; x < field->width; x++)
+        {
+            int i = y * field->stride + x;
+            maxDifference = fmax(maxDifference, fabs(rdRealToDouble(fieldA(field)[i]) - rdRealToDouble(fieldA(expected)[i])));
+            maxDifference = fmax(maxDifference, fabs(rdRealToDouble(fieldB(field)[i]) - rdRealToDouble(fieldB(expected)[i])));
+        }
+    }
+
+    return maxDifference;
+}
+
+double patternDifference(const RDField *field, const RDField *expected, double *maxDifference)
+{
+    long long differs = 0;
+    *maxDifference = 0.0;
+
+    for (int y = 0; y < field->height; y++)
+    {
+        for (int x = 0; x < field->width; x++)
+        {
+            double b = rdRealToDouble(fieldB(field)[y * field->stride + x]);
+            double expectedB = rdRealToDouble(fieldB(expected)[y * expected->stride + x]);
+            *maxDifference = isfinite(b) ? fmax(*maxDifference, fabs(b - expectedB)) : INFINITY;
+            differs += (b > RD_PATTERN_THRESHOLD) != (expectedB > RD_PATTERN_THRESHOLD);
+        }
+    }
+
+    return (double) differs / ((double) field->width * field->height);
+}
+
+/// Step every supported SIMD kernel, using the pool if there is one, and compare the results
+/// and their colour passes with the scalar kernel stepped on one thread
+/// @param pool The pool to step with, NULL to step on one thread
+/// @param size The width and height of the grid
+/// @param steps The number of generations to compare after
+/// @param params The feed, kill and diffusion rates to use
+/// @return False if any kernel differs by more than RD_KERNEL_TOLERANCE
+static bool verifyKernels(RDWorkerPool *pool, int size, int steps, const RDParams *params)
+{
+    RDField reference;
+    initialiseField(&reference, size, size, SEED_FIVE_SQUARES, 5);
+    reference.kernel = KERNEL_SCALAR;
+    for (int i = 0; i < steps; i++) stepField(&reference, params);
+
+    size_t bufferSize = (size_t) size * size * RD_PIXEL_SIZE;
+    unsigned char *referencePixels = (unsigned char *) malloc(bufferSize);
+    unsigned char *pixels = (unsigned char *) malloc(bufferSize);
+    colourField(&reference, referencePixels);
+
+    bool passed = true;
+    for (int k = KERNEL_SCALAR; k < KERNEL_COUNT; k++)
+    {
+        // The scalar kernel is only checked against itself when there's a pool to run it on
+        if (!rdKernelSupported(k) || (k == KERNEL_SCALAR && pool == NULL)) continue;
+
+        RDField field;
+        initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+        field.kernel = k;
+        stepFieldParallel(pool, &field, params, steps);
+
+        double maxDifference = maxCellDifference(&field, &reference);
+
+        // Splitting the field between threads mustn't change a single bit
+        double tolerance = (k == KERNEL_SCALAR) ? 0.0 : RD_KERNEL_TOLERANCE;
+        bool matches = maxDifference <= tolerance;
+        printf("%-10s %5dx%-5d %2d threads, max difference from scalar after %d steps %g %s\n",
+            rdKernelName(k), size, size, workerPoolSize(pool), steps, maxDifference, matches ? "ok" : "FAILED");
+        passed = passed && matches;
+
+        // The colour passes convert the same way so should give exactly the same pixels
+        colourField(&field, pixels);
+        int differentBytes = 0;
+        for (size_t i = 0; i < bufferSize; i++) differentBytes += pixels[i] != referencePixels[i];
+
+        printf("%-10s %5dx%-5d colour pass, %d bytes differ from scalar %s\n",
+            rdKernelName(k), size, size, differentBytes, differentBytes == 0 ? "ok" : "FAILED");
+        passed = passed && differentBytes == 0;
+
+        // Skipping dormant tiles with an epsilon of 0 has to give the same result as stepping everything
+        RDField tiledField;
+        RDTiles tiles;
+        initialiseField(&tiledField, size, size, SEED_FIVE_SQUARES, 5);
+        initialiseTiles(&tiles, &tiledField, RD_DEFAULT_TILE_SIZE, 0.0);
+        tiledField.kernel = k;
+        stepTiles(pool, &tiles, &tiledField, params, steps);
+
+        int differentCells = countDifferentCells(&tiledField, &field);
+        printf("%-10s %5dx%-5d active tiles, %d cells differ from stepping every cell, %.1f%% of tiles stepped %s\n",
+            rdKernelName(k), size, size, differentCells,
+            tiles.tilesStepped * 100.0 / ((double) tiles.tilesX * tiles.tilesY * steps), differentCells == 0 ? "ok" : "FAILED");
+        passed = passed && differentCells == 0;
+
+        freeTiles(&tiles);
+        freeField(&tiledField);
+
+        // So does stepping several generations per block, with block sizes that don't divide the
+        // field and step counts that leave a shorter final pass
+        static const int verifyBlockSteps[] = { 1, 3, 8 };
+        for (int b = 0; b < 3; b++)
+        {
+            RDField blockedField;
+            initialiseField(&blockedField, size, size, SEED_FIVE_SQUARES, 5);
+            blockedField.kernel = k;
+            stepFieldBlocked(pool, &blockedField, params, steps, VERIFY_BLOCK_SIZE, verifyBlockSteps[b]);
+
+            differentCells = countDifferentCells(&blockedField, &field);
+            printf("%-10s %5dx%-5d %d generations per block, %d cells differ from stepping one at a time %s\n",
+                rdKernelName(k), size, size, verifyBlockSteps[b], differentCells, differentCells == 0 ? "ok" : "FAILED");
+            passed = passed && differentCells == 0;
+
+            freeField(&blockedField);
+        }
+
+        freeField(&field);
+    }
+
+    free(referencePixels);
+    free(pixels);
+    freeField(&reference);
+    return passed;
+}
+
+/// Check every colour pass looks up exactly the level a - b falls in with every palette, with
+/// anything outside 0-1 clamped to the ends of the palette and NaN coloured like 0
+/// @param pool Unused, the colour passes don't step
+/// @param size The width and height of the grid
+/// @param steps Unused
+/// @param params Unused
+/// @return False if any pass gives a different pixel
+static bool verifyColour(RDWorkerPool *pool, int size, int steps, const RDParams *params)
+{
+    RDField field;
+    initialiseField(&field, size, size, SEED_CENTRE_SQUARE, 0);
+
+    // a - b runs from -1 to 2 across every row, b is 0 so the difference is exact at every precision
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            double a = -1.0 + 3.0 * (x + y * 0.37) / size;
+#if RD_PRECISION != RD_PRECISION_FIXED16
+            if (x % 11 == y % 7) a = NAN;
+#endif
+            fieldA(&field)[y * field.stride + x] = rdRealFromDouble(a);
+            fieldB(&field)[y * field.stride + x] = rdRealFromDouble(0.0);
+        }
+    }
+
+    size_t bufferSize = (size_t) size * size * RD_PIXEL_SIZE;
+    uint32_t *pixels = (uint32_t *) malloc(bufferSize);
+    const RDPalette *originalPalette = colourPalette();
+    bool passed = true;
+
+    for (int k = KERNEL_SCALAR; k < KERNEL_COUNT; k++)
+    {
+        if (!rdKernelSupported(k)) continue;
+        field.kernel = k;
+
+        int differentPixels = 0;
+        int wrongEnds = 0;
+        for (int p = 0; p < RD_PALETTE_COUNT; p++)
+        {
+            const RDPalette *palette = getPalette(p);
+            setColourPalette(palette);
+            colourField(&field, (unsigned char *) pixels);
+            const uint32_t *table = colourTable();
+
+            for (int y = 0; y < size; y++)
+            {
+                for (int x = 0; x < size; x++)
+                {
+                    double difference = rdRealToDouble(fieldA(&field)[y * field.stride + x]);
+                    int level = difference > 0.0 ? (int) fmin(floor(difference * RD_COLOUR_LEVELS), RD_COLOUR_LEVELS - 1) : 0;
+                    differentPixels += pixels[y * size + x] != table[level];
+                }
+            }
+
+            // The first and last entries are exactly the palette's first and last colours
+            uint32_t first = palette->colours[0];
+            uint32_t last = palette->colours[palette->numColours - 1];
+            wrongEnds += table[0] != (0xFF000000u | (first >> 16) | (first & 0xFF00) | ((first & 0xFF) << 16));
+            wrongEnds += table[RD_COLOUR_LEVELS - 1] != (0xFF000000u | (last >> 16) | (last & 0xFF00) | ((last & 0xFF) << 16));
+        }
+
+        bool matches = differentPixels == 0 && wrongEnds == 0;
+        printf("%-10s %5dx%-5d colour pass, %d palettes of %d levels, %d pixels differ from the table, %d wrong ends %s\n",
+            rdKernelName(k), size, size, RD_PALETTE_COUNT, RD_COLOUR_LEVELS, differentPixels, wrongEnds,
+            matches ? "ok" : "FAILED");
+        passed = passed && matches;
+    }
+
+    setColourPalette(originalPalette);
+    free(pixels);
+    freeField(&field);
+    return passed;
+}
+
+/// Save a stepped field through the background writer, load it back and check it's identical
+/// and keeps stepping identically
+/// @param pool The pool to step with, NULL to step on one thread
+/// @param size The width and height of the grid
+/// @param steps The number of generations to step before saving and again after loading
+/// @param params The feed, kill and diffusion rates to use
+/// @return False if anything about the loaded field differs
+static bool verifySnapshot(RDWorkerPool *pool, int size, int steps, const RDParams *params)
+{
+    RDField field;
+    initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+    stepFieldParallel(pool, &field, params, steps);
+
+    RDSnapshotWriter *writer = createSnapshotWriter();
+    bool saved = writer != NULL && queueSnapshot(writer, VERIFY_SNAPSHOT_PATH, &field, params);
+    while (saved && snapshotPending(writer)) rdSleep(0.001);
+    saved = saved && lastSnapshotSucceeded(writer);
+    freeSnapshotWriter(writer);
+
+    RDField loaded;
+    RDParams loadedParams;
+    bool passed = saved && loadSnapshot(VERIFY_SNAPSHOT_PATH, &loaded, &loadedParams);
+    remove(VERIFY_SNAPSHOT_PATH);
+
+    if (!passed)
+    {
+        printf("%-10s %5dx%-5d couldn't save and load a snapshot FAILED\n", "snapshot", size, size);
+        freeField(&field);
+        return false;
+    }
+
+    bool sameState = loaded.generation == field.generation && memcmp(&loadedParams, params, sizeof(RDParams)) == 0;
+    int differentCells = countDifferentCells(&loaded, &field);
+
+    // Resuming has to carry on exactly where the original left off
+    loaded.kernel = field.kernel;
+    stepFieldParallel(pool, &field, params, steps);
+    stepFieldParallel(pool, &loaded, &loadedParams, steps);
+    int resumedDifferentCells = countDifferentCells(&loaded, &field);
+
+    passed = sameState && differentCells == 0 && resumedDifferentCells == 0;
+    printf("%-10s %5dx%-5d %d cells differ after loading, %d after %d more steps %s\n", "snapshot", size, size,
+        differentCells, resumedDifferentCells, steps, passed ? "ok" : "FAILED");
+
+    freeField(&loaded);
+    freeField(&field);
+    return passed;
+}
+
+/// Read a whole file into memory
+/// @param path The file to read
+/// @param size Set to the size of the file
+/// @return The contents, to be freed, or NULL if it couldn't be read
+static unsigned char *readWholeFile(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data = length >= 0 ? (unsigned char *) malloc((size_t) length + 1) : NULL;
+    if (data != NULL && fread(data, 1, (size_t) length, file) != (size_t) length)
+    {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+
+    *size = (size_t) length;
+    return data;
+}
+
+/// Compare a frame read back from a recording with what it was recorded from, converting the
+/// colours with the floating point BT.601 formulas rather than the recorder's integer ones
+/// @param format The format it was written in
+/// @param data The frame's samples as they are in the file
+/// @param pixels The RGBA pixels of the field it was recorded from
+/// @param a The a values of the field, without padding
+/// @param b The b values of the field, without padding
+/// @param count The number of cells in the field
+/// @return The largest difference in any sample
+static int compareRecordedFrame(RDRecordFormat format, const unsigned char *data, const unsigned char *pixels,
+    const double *a, const double *b, int count)
+{
+    int maxDifference = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int expected[3], actual[3];
+        double red = pixels[i * RD_PIXEL_SIZE], green = pixels[i * RD_PIXEL_SIZE + 1], blue = pixels[i * RD_PIXEL_SIZE + 2];
+        switch (format)
+        {
+            case RECORD_Y4M:
+                expected[0] = (int) lround(16.0 + (65.481 * red + 128.553 * green + 24.966 * blue) / 255.0);
+                expected[1] = (int) lround(128.0 + (-37.797 * red - 74.203 * green + 112.0 * blue) / 255.0);
+                expected[2] = (int) lround(128.0 + (112.0 * red - 93.786 * green - 18.214 * blue) / 255.0);
+                for (int c = 0; c < 3; c++) actual[c] = data[(size_t) c * count + i];
+                break;
+
+            case RECORD_PPM:
+                for (int c = 0; c < 3; c++)
+                {
+                    expected[c] = pixels[i * RD_PIXEL_SIZE + c];
+                    actual[c] = data[i * 3 + c];
+                }
+                break;
+
+            default:
+                // The a plane is above the b plane, leaving the third sample to match itself
+                expected[0] = (int) lround(fmin(fmax(a[i], 0.0), 1.0) * 65535.0);
+                expected[1] = (int) lround(fmin(fmax(b[i], 0.0), 1.0) * 65535.0);
+                actual[0] = data[i * 2] << 8 | data[i * 2 + 1];
+                actual[1] = data[((size_t) count + i) * 2] << 8 | data[((size_t) count + i) * 2 + 1];
+                expected[2] = actual[2] = 0;
+                break;
+        }
+
+        for (int c = 0; c < 3; c++)
+        {
+            int difference = abs(expected[c] - actual[c]);
+            if (difference > maxDifference) maxDifference = difference;
+        }
+    }
+    return maxDifference;
+}
+
+/// Record a field in every format while it's stepped, then read the recordings back and check
+/// every frame was written, in order, from the generation it was recorded at
+/// @param pool The pool to step with, NULL to step on one thread
+/// @param size The width and height of the grid
+/// @param steps The number of generations to step while recording
+/// @param params The feed, kill and diffusion rates to use
+/// @return False if any frame is missing or differs by more than rounding
+static bool verifyRecord(RDWorkerPool *pool, int size, int steps, const RDParams *params)
+{
+    int count = size * size;
+    int every = steps / (VERIFY_RECORD_FRAMES - 1) > 0 ? steps / (VERIFY_RECORD_FRAMES - 1) : 1;
+    unsigned char *pixels = (unsigned char *) malloc((size_t) count * RD_PIXEL_SIZE * VERIFY_RECORD_FRAMES);
+    double *planes = (double *) malloc((size_t) count * 2 * VERIFY_RECORD_FRAMES * sizeof(double));
+    bool passed = true;
+
+    for (int f = 0; f < RECORD_FORMAT_COUNT; f++)
+    {
+        RDRecordFormat format = (RDRecordFormat) f;
+        RDField field;
+        initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+
+        // Stepped in uneven batches, so some are recorded part way past the generation they were due
+        RDRecorder *recorder = createRecorder(VERIFY_RECORD_PATH, format, size, size, every, VERIFY_RECORD_FRAMES);
+        int recorded = 0;
+        while (recorder != NULL && recorded < VERIFY_RECORD_FRAMES)
+        {
+            if (recordField(recorder, &field))
+            {
+                colourField(&field, pixels + (size_t) recorded * count * RD_PIXEL_SIZE);
+                double *a = planes + (size_t) recorded * 2 * count;
+                for (int y = 0; y < size; y++)
+                {
+                    for (int x = 0; x < size; x++)
+                    {
+                        a[y * size + x] = rdRealToDouble(fieldA(&field)[y * field.stride + x]);
+                        a[count + y * size + x] = rdRealToDouble(fieldB(&field)[y * field.stride + x]);
+                    }
+                }
+                recorded++;
+            }
+            stepFieldParallel(pool, &field, params, every / 3 + 1);
+        }
+
+        RDRecordStats stats;
+        bool written = recorder != NULL && freeRecorder(recorder, &stats)
+            && stats.framesWritten == VERIFY_RECORD_FRAMES && stats.framesDropped == 0;
+
+        // Y4M is one file with a header and the frames one after another, the others a file per frame
+        int framesRead = 0;
+        int maxDifference = 0;
+        char header[64];
+        size_t headerLength;
+        size_t fileSize = 0;
+        unsigned char *data = format == RECORD_Y4M ? readWholeFile(VERIFY_RECORD_PATH, &fileSize) : NULL;
+        if (format == RECORD_Y4M)
+        {
+            snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", size, size, RD_RECORD_FRAME_RATE);
+            headerLength = strlen(header);
+            size_t offset = headerLength;
+            bool valid = data != NULL && fileSize >= headerLength && memcmp(data, header, headerLength) == 0;
+            while (valid && framesRead < VERIFY_RECORD_FRAMES && offset + 6 + 3 * (size_t) count <= fileSize
+                && memcmp(data + offset, "FRAME\n", 6) == 0)
+            {
+                int difference = compareRecordedFrame(format, data + offset + 6,
+                    pixels + (size_t) framesRead * count * RD_PIXEL_SIZE, NULL, NULL, count);
+                maxDifference = difference > maxDifference ? difference : maxDifference;
+                offset += 6 + 3 * (size_t) count;
+                framesRead++;
+            }
+            if (offset != fileSize) framesRead = -1;
+            free(data);
+            remove(VERIFY_RECORD_PATH);
+        }
+        else
+        {
+            for (int i = 0; i < VERIFY_RECORD_FRAMES; i++)
+            {
+                char path[64];
+                snprintf(path, sizeof(path), "%s_%06d.%s", VERIFY_RECORD_PATH, i, recordFormatName(format));
+                if (format == RECORD_PPM) snprintf(header, sizeof(header), "P6\n%d %d\n255\n", size, size);
+                else snprintf(header, sizeof(header), "P5\n%d %d\n65535\n", size, 2 * size);
+                headerLength = strlen(header);
+                size_t samples = format == RECORD_PPM ? 3 * (size_t) count : 4 * (size_t) count;
+
+                data = readWholeFile(path, &fileSize);
+                if (data != NULL && fileSize == headerLength + samples && memcmp(data, header, headerLength) == 0)
+                {
+                    const double *a = planes + (size_t) i * 2 * count;
+                    int difference = compareRecordedFrame(format, data + headerLength,
+                        pixels + (size_t) i * count * RD_PIXEL_SIZE, a, a + count, count);
+                    maxDifference = difference > maxDifference ? difference : maxDifference;
+                    framesRead++;
+                }
+                free(data);
+                remove(path);
+            }
+        }
+
+        // The colours go through a different conversion so can be a level out, the rest is exact
+        int tolerance = format == RECORD_PPM ? 0 : 1;
+        bool matched = written && framesRead == VERIFY_RECORD_FRAMES && maxDifference <= tolerance;
+        printf("%-10s %5dx%-5d %s, %d of %d frames read back, max difference %d %s\n", "record", size, size,
+            recordFormatName(format), framesRead, VERIFY_RECORD_FRAMES, maxDifference, matched ? "ok" : "FAILED");
+        passed = matched && passed;
+
+        freeField(&field);
+    }
+
+    free(pixels);
+    free(planes);
+    return passed;
+}
+
+/// Check a view at one cell per pixel colours exactly what colourField does, every level of the
+/// pyramid holds the averages of its cells, and updating it a tile at a time matches averaging
+/// the whole field
+/// @param pool The pool to step with, NULL to step on one thread
+/// @param size The width and height of the grid
+/// @param steps The number of generations to step first
+/// @param params The feed, kill and diffusion rates to use
+/// @return False if anything differs
+static bool verifyView(RDWorkerPool *pool, int size, int steps, const RDParams *params)
+{
+    RDField field;
+    RDTiles tiles;
+    RDMipPyramid tiledPyramid, pyramid;
+    initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+    initialiseTiles(&tiles, &field, RD_DEFAULT_TILE_SIZE, 0.0);
+    initialiseMipPyramid(&tiledPyramid, &field);
+    initialiseMipPyramid(&pyramid, &field);
+
+    // Update one pyramid a few tiles at a time as the field is stepped, the way the visualisations do
+    for (int done = 0; done < steps; done += 8)
+    {
+        stepTiles(pool, &tiles, &field, params, 8);
+        updateMipPyramid(pool, &tiledPyramid, &field, &tiles);
+    }
+    updateMipPyramid(pool, &pyramid, &field, NULL);
+
+    int differentBlocks = 0;
+    double maxError = 0.0;
+    for (int level = 1; level < pyramid.levels; level++)
+    {
+        int width = pyramid.width[level];
+        size_t blocks = (size_t) width * pyramid.height[level];
+        differentBlocks += memcmp(pyramid.a[level], tiledPyramid.a[level], blocks * sizeof(float)) != 0;
+        differentBlocks += memcmp(pyramid.b[level], tiledPyramid.b[level], blocks * sizeof(float)) != 0;
+
+        // Every block whose cells are all on the field is the plain mean of them
+        int blockSize = 1 << level;
+        for (int by = 0; by < size / blockSize; by += 1 + size / blockSize / 8)
+        {
+            for (int bx = 0; bx < size / blockSize; bx += 1 + size / blockSize / 8)
+            {
+                double total = 0.0;
+                for (int y = by * blockSize; y < (by + 1) * blockSize; y++)
+                {
+                    for (int x = bx * blockSize; x < (bx + 1) * blockSize; x++)
+                    {
+                        total += rdRealToDouble(fieldB(&field)[y * field.stride + x]);
+                    }
+                }
+                maxError = fmax(maxError, fabs(total / (blockSize * blockSize) - pyramid.b[level][by * width + bx]));
+            }
+        }
+    }
+
+    unsigned char *expected = (unsigned char *) malloc((size_t) size * size * RD_PIXEL_SIZE);
+    unsigned char *pixels = (unsigned char *) malloc((size_t) size * size * RD_PIXEL_SIZE);
+    colourField(&field, expected);
+    RDView view = { 0.0, 0.0, 1.0, size, size };
+    colourView(&field, &pyramid, &view, pixels);
+    int differentBytes = 0;
+    for (size_t i = 0; i < (size_t) size * size * RD_PIXEL_SIZE; i++) differentBytes += pixels[i] != expected[i];
+
+    // Half a field to the left, the left half of the view is off the field and has to be left clear
+    view.x = -size / 2;
+    colourView(&field, &pyramid, &view, pixels);
+    int offField = 0;
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            bool clear = pixels[((size_t) y * size + x) * RD_PIXEL_SIZE + 3] == 0;
+            offField += clear != (x < size / 2);
+        }
+    }
+
+    bool passed = differentBlocks == 0 && maxError < 1e-5 && differentBytes == 0 && offField == 0;
+    printf("%-10s %5dx%-5d %d levels, %d differ updating by tiles, max error %.2g, %d bytes differ from colourField, "
+        "%d pixels wrong off the field %s\n", "view", size, size, pyramid.levels, differentBlocks, maxError,
+        differentBytes, offField, passed ? "ok" : "FAILED");
+
+    free(pixels);
+    free(expected);
+    freeMipPyramid(&pyramid);
+    freeMipPyramid(&tiledPyramid);
+    freeTiles(&tiles);
+    freeField(&field);
+    return passed;
+}
+
+/// Step and colour a field with a backend and check it copies the same generations back into the
+/// field as stepping it directly, exactly if it steps the field itself
+/// @param pool The pool to step with, NULL to step on one thread
+/// @param backend The backend to check
+/// @param expected The field stepped directly from the same seed
+/// @param steps The number of generations expected was stepped
+/// @param params The feed, kill and diffusion rates to use
+/// @return False if the backend couldn't be started or differs by too much
+static bool verifyBackend(RDWorkerPool *pool, const RDBackend *backend, const RDField *expected, int steps,
+    const RDParams *params)
+{
+    int size = expected->width;
+    RDBackendConfig config = {
+        backend->name, rdDefaultKernel(), workerPoolSize(pool), RD_DEFAULT_TILE_SIZE, 0.0, 3, VERIFY_DOMAIN_WORKERS
+    };
+
+    RDField field;
+    RDMipPyramid pyramid;
+    RDStepper stepper;
+    initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+    initialiseMipPyramid(&pyramid, &field);
+    if (!startStepper(&stepper, &field, &config))
+    {
+        printf("%-10s %5dx%-5d couldn't start the backend FAILED\n", backend->name, size, size);
+        freeMipPyramid(&pyramid);
+        freeField(&field);
+        return false;
+    }
+
+    // Coloured part way through too, which mustn't change what's stepped after it
+    RDView view = { 0.0, 0.0, 1.0, size, size };
+    unsigned char *pixels = (unsigned char *) malloc((size_t) size * size * RD_PIXEL_SIZE);
+    for (int done = 0; done < steps; done += VERIFY_BATCH_STEPS)
+    {
+        stepStepper(&stepper, params, steps - done < VERIFY_BATCH_STEPS ? steps - done : VERIFY_BATCH_STEPS);
+        colouriseStepper(&stepper, &pyramid, &view, pixels);
+    }
+    stopStepper(&stepper);
+
+    double maxDifference = maxCellDifference(&field, expected);
+
+    bool matched = field.generation == expected->generation
+        && (backend->usesKernel ? maxDifference == 0.0 : maxDifference <= BACKEND_TOLERANCE);
+    printf("%-10s %5dx%-5d backend, max difference from stepping the field after %d steps %.3g %s\n",
+        backend->name, size, size, steps, maxDifference, matched ? "ok" : "FAILED");
+
+    free(pixels);
+    freeMipPyramid(&pyramid);
+    freeField(&field);
+    return matched;
+}
+
+/// Step a field split between worker processes with each transport, with the gradient rate map and
+/// with the backends that fork them, and check it matches stepping it in this one, including after
+/// gathering it part way through. Run before the pool is started, as the workers are forked.
+/// @param pool The pool to step with, NULL to step on one thread
+/// @param size The width and height of the grid
+/// @param steps The number of generations to compare after
+/// @param params The feed, kill and diffusion rates to use
+/// @return False if any cell differs
+static bool verifyDomain(RDWorkerPool *pool, int size, int steps, const RDParams *params)
+{
+    RDField expected;
+    initialiseField(&expected, size, size, SEED_FIVE_SQUARES, 5);
+    stepFieldParallel(pool, &expected, params, steps);
+
+    bool passed = true;
+    RDHaloTransport transports[] = { HALO_SHARED_MEMORY, HALO_SOCKET };
+    for (int t = 0; t < 2; t++)
+    {
+        RDField field;
+        initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+
+        RDDomain *domain = startDomain(&field, VERIFY_DOMAIN_WORKERS, 1, transports[t]);
+        bool stepped = domain != NULL && stepDomain(domain, params, steps / 2) && gatherDomain(domain, &field)
+            && stepDomain(domain, params, steps - steps / 2) && gatherDomain(domain, &field);
+        stopDomain(domain);
+
+        if (!stepped)
+        {
+            printf("%-10s %5dx%-5d couldn't step the field in %d processes over %s FAILED\n", "domain", size, size,
+                VERIFY_DOMAIN_WORKERS, haloTransportName(transports[t]));
+            passed = false;
+        }
+        else
+        {
+            int differentCells = countDifferentCells(&field, &expected);
+            bool matched = differentCells == 0 && field.generation == expected.generation;
+            printf("%-10s %5dx%-5d %d processes over %s, %d cells differ after %d steps %s\n", "domain", size, size,
+                VERIFY_DOMAIN_WORKERS, haloTransportName(transports[t]), differentCells, steps,
+                matched ? "ok" : "FAILED");
+            passed = matched && passed;
+        }
+
+        freeField(&field);
+    }
+
+    for (int b = 0; b < backendCount(); b++)
+    {
+        if (getBackend(b)->usesProcesses) passed = verifyBackend(pool, getBackend(b), &expected, steps, params) && passed;
+    }
+
+    // The worker processes are forked with the map, so they step their stripes with it
+    RDField reference, field;
+    initialiseField(&reference, size, size, SEED_FIVE_SQUARES, 5);
+    initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+    reference.kernel = field.kernel = KERNEL_SCALAR;
+    setGradientRates(&reference, RD_GRADIENT_FEED_LOW, RD_GRADIENT_FEED_HIGH, RD_GRADIENT_KILL_LOW,
+        RD_GRADIENT_KILL_HIGH);
+    shareFieldRates(&field, &reference.rates, 0, 0);
+    stepFieldParallel(NULL, &reference, params, steps);
+
+    RDDomain *domain = startDomain(&field, VERIFY_DOMAIN_WORKERS, 1, HALO_SHARED_MEMORY);
+    bool stepped = domain != NULL && stepDomain(domain, params, steps) && gatherDomain(domain, &field);
+    stopDomain(domain);
+
+    int differentCells = stepped ? countDifferentCells(&field, &reference) : -1;
+    printf("%-10s %5dx%-5d %d processes with the gradient rate map, %d cells differ from one process %s\n",
+        "domain", size, size, VERIFY_DOMAIN_WORKERS, differentCells, differentCells == 0 ? "ok" : "FAILED");
+    passed = passed && differentCells == 0;
+
+    freeField(&field);
+    freeField(&reference);
+    freeField(&expected);
+    return passed;
+}
+
+/// Step and colour a field with every backend but the ones that fork worker processes, which
+/// verifyDomain checks before the pool is started, and check each one copies the same generations
+/// back into the field as stepping it directly, exactly for the ones that step the field itself
+/// @param pool The pool to step with, NULL to step on one thread
+/// @param size The width and height of the grid
+/// @param steps The number of generations to compare after
+/// @param params The feed, kill and diffusion rates to use
+/// @return False if any backend differs by too much
+static bool verifyBackends(RDWorkerPool *pool, int size, int steps, const RDParams *params)
+{
+    RDField expected;
+    initialiseField(&expected, size, size, SEED_FIVE_SQUARES, 5);
+    stepFieldParallel(pool, &expected, params, steps);
+
+    bool passed = true;
+    for (int b = 0; b < backendCount(); b++)
+    {
+        if (!getBackend(b)->usesProcesses) passed = verifyBackend(pool, getBackend(b), &expected, steps, params) && passed;
+    }
+
+    freeField(&expected);
+    return passed;
+}
+
+// The implicit steps are a different update from the explicit ones even at a timestep of one
+// generation: the diffusion is the five point Laplacian times 0.3 instead of the kernels' nine point
+// stencil, solved backward Euler along the rows then the columns, after the reaction rather than
+// alongside it. So the patterns split and spread at different times, and a quarter of the
+// pattern differs at dt 1 after 200 generations. Checked as the share of the cells in either
+// pattern that are only in one of them. Each bound is the most it reached on grids of 64 to 333
+// cells for 200 to 2000 generations plus 5 points, while a pattern that has died out or grown
+// somewhere else scores nearer 1. Smaller grids and longer runs can drift further.
+static const struct {
+    int timeStep;
+    double patternTolerance;
+} implicitTolerances[] = {
+    { 1, 0.30 },                        // At most 25.2%
+    { RD_DEFAULT_TIME_STEP, 0.25 },     // At most 19.3%
+    { 7, 0.22 },                        // At most 16.4%
+};
+
+#define NUM_IMPLICIT_TOLERANCES (int) (sizeof(implicitTolerances) / sizeof(implicitTolerances[0]))
+
+/// Get the share of the cells in either field's pattern that are only in one of them
+/// @param field The field to compare
+/// @param expected The reference
+/// @return The share, 0 if neither has a pattern
+static double patternShareDiffering(const RDField *field, const RDField *expected)
+{
+    long long differs = 0;
+    long long either = 0;
+    for (int y = 0; y < field->height; y++)
+    {
+        for (int x = 0; x < field->width; x++)
+        {
+            bool inPattern = rdRealToDouble(fieldB(field)[y * field->stride + x]) > RD_PATTERN_THRESHOLD;
+            bool inExpected = rdRealToDouble(fieldB(expected)[y * expected->stride + x]) > RD_PATTERN_THRESHOLD;
+            differs += inPattern != inExpected;
+            either += inPattern || inExpected;
+        }
+    }
+
+    return either > 0 ? (double) differs / either : 0.0;
+}
+
+/// Step the implicit integrator with every supported kernel's solves, using the pool if there is one,
+/// and check each gives exactly the same field as the scalar solves on one thread, with timesteps
+/// that do and don't divide the generations, and that it stays stable and its pattern stays within
+/// implicitTolerances of the explicit steps' pattern
+/// @param pool The pool to step with, NULL to step on one thread
+/// @param size The width and height of the grid
+/// @param steps The number of generations to compare after
+/// @param params The feed, kill and diffusion rates to use
+/// @return False if any solve differs or the field isn't stable or close enough to the explicit steps
+static bool verifyImplicit(RDWorkerPool *pool, int size, int steps, const RDParams *params)
+{
+    RDField explicitField;
+    initialiseField(&explicitField, size, size, SEED_FIVE_SQUARES, 5);
+    stepFieldParallel(pool, &explicitField, params, steps);
+
+    bool passed = true;
+    for (int t = 0; t < NUM_IMPLICIT_TOLERANCES; t++)
+    {
+        int timeStep = implicitTolerances[t].timeStep;
+        RDField reference;
+        initialiseField(&reference, size, size, SEED_FIVE_SQUARES, 5);
+        reference.kernel = KERNEL_SCALAR;
+        stepFieldImplicit(NULL, &reference, params, steps, timeStep);
+
+        double maxDifference;
+        patternDifference(&reference, &explicitField, &maxDifference);
+        double share = patternShareDiffering(&reference, &explicitField);
+        bool close = isfinite(maxDifference) && reference.generation == explicitField.generation
+            && share <= implicitTolerances[t].patternTolerance;
+        printf("%-10s %5dx%-5d dt %d, max b difference from explicit after %d steps %.3g, %.1f%% of the pattern "
+            "differs, at most %.0f%% %s\n", "implicit", size, size, timeStep, steps, maxDifference, share * 100.0,
+            implicitTolerances[t].patternTolerance * 100.0, close ? "ok" : "FAILED");
+        passed = passed && close;
+
+        for (int k = KERNEL_SCALAR; k < KERNEL_COUNT; k++)
+        {
+            if (!rdKernelSupported(k) || (k == KERNEL_SCALAR && pool == NULL)) continue;
+
+            RDField field;
+            initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+            field.kernel = k;
+            stepFieldImplicit(pool, &field, params, steps, timeStep);
+
+            int differentCells = countDifferentCells(&field, &reference);
+            bool matched = differentCells == 0 && field.generation == reference.generation;
+            printf("%-10s %5dx%-5d %2d threads, dt %d implicit, %d cells differ from scalar %s\n",
+                rdKernelName(k), size, size, workerPoolSize(pool), timeStep, differentCells, matched ? "ok" : "FAILED");
+            passed = passed && matched;
+
+            freeField(&field);
+        }
+
+        freeField(&reference);
+    }
+
+    freeField(&explicitField);
+    return passed;
+}
+
+/// Write a plane of rate map levels as a 16 bit PGM
+/// @return False if the file couldn't be written
+static bool writeLevels(const char *path, const uint16_t *levels, int stride, int width, int height)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) return false;
+
+    bool written = fprintf(file, "P5\n# rd_bench rate levels\n%d %d\n65535\n", width, height) > 0;
+    for (int y = 0; y < height && written; y++)
+    {
+        for (int x = 0; x < width && written; x++)
+        {
+            uint16_t level = levels[(size_t) y * stride + x];
+            written = fputc(level >> 8, file) != EOF && fputc(level & 0xff, file) != EOF;
+        }
+    }
+
+    return fclose(file) == 0 && written;
+}
+
+/// Step every supported kernel with a rate map, using the pool if there is one, and check a map of
+/// the params' rates everywhere steps like the params' rates, and that with the gradient map every
+/// kernel, the active tiles, the blocks and the implicit integrator all step the same as the scalar
+/// kernel on one thread. Also reads the gradient back from PGMs, verifyDomain checks worker processes
+/// with the map.
+/// @param pool The pool to step with, NULL to step on one thread
+/// @param size The width and height of the grid
+/// @param steps The number of generations to compare after
+/// @param params The feed, kill and diffusion rates to use
+/// @return False if anything differs by too much
+static bool verifyRates(RDWorkerPool *pool, int size, int steps, const RDParams *params)
+{
+    RDField uniformReference;
+    initialiseField(&uniformReference, size, size, SEED_FIVE_SQUARES, 5);
+    uniformReference.kernel = KERNEL_SCALAR;
+    stepFieldParallel(NULL, &uniformReference, params, steps);
+
+    RDField reference;
+    initialiseField(&reference, size, size, SEED_FIVE_SQUARES, 5);
+    reference.kernel = KERNEL_SCALAR;
+    setGradientRates(&reference, RD_GRADIENT_FEED_LOW, RD_GRADIENT_FEED_HIGH, RD_GRADIENT_KILL_LOW,
+        RD_GRADIENT_KILL_HIGH);
+    stepFieldParallel(NULL, &reference, params, steps);
+
+    RDField implicitReference;
+    initialiseField(&implicitReference, size, size, SEED_FIVE_SQUARES, 5);
+    implicitReference.kernel = KERNEL_SCALAR;
+    shareFieldRates(&implicitReference, &reference.rates, 0, 0);
+    stepFieldImplicit(NULL, &implicitReference, params, steps, RD_DEFAULT_TIME_STEP);
+
+    bool passed = true;
+    for (int k = KERNEL_SCALAR; k < KERNEL_COUNT; k++)
+    {
+        if (!rdKernelSupported(k)) continue;
+
+        RDField field;
+        initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+        field.kernel = k;
+        addFieldRates(&field, params->feedRate, params->feedRate, params->killRate, params->killRate);
+        stepFieldParallel(pool, &field, params, steps);
+
+        double maxDifference = maxCellDifference(&field, &uniformReference);
+        printf("%-10s %5dx%-5d uniform rate map, max difference from uniform rates after %d steps %g %s\n",
+            rdKernelName(k), size, size, steps, maxDifference, maxDifference <= RATES_TOLERANCE ? "ok" : "FAILED");
+        passed = passed && maxDifference <= RATES_TOLERANCE;
+        freeField(&field);
+
+        // The scalar kernel is only checked against itself when there's a pool to run it on
+        if (k == KERNEL_SCALAR && pool == NULL) continue;
+
+        initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+        field.kernel = k;
+        shareFieldRates(&field, &reference.rates, 0, 0);
+        stepFieldParallel(pool, &field, params, steps);
+
+        maxDifference = maxCellDifference(&field, &reference);
+        double tolerance = (k == KERNEL_SCALAR) ? 0.0 : RD_KERNEL_TOLERANCE;
+        printf("%-10s %5dx%-5d %2d threads, gradient rate map, max difference from scalar after %d steps %g %s\n",
+            rdKernelName(k), size, size, workerPoolSize(pool), steps, maxDifference,
+            maxDifference <= tolerance ? "ok" : "FAILED");
+        passed = passed && maxDifference <= tolerance;
+
+        RDField tiledField;
+        RDTiles tiles;
+        initialiseField(&tiledField, size, size, SEED_FIVE_SQUARES, 5);
+        initialiseTiles(&tiles, &tiledField, RD_DEFAULT_TILE_SIZE, 0.0);
+        tiledField.kernel = k;
+        shareFieldRates(&tiledField, &reference.rates, 0, 0);
+        stepTiles(pool, &tiles, &tiledField, params, steps);
+
+        int differentCells = countDifferentCells(&tiledField, &field);
+        printf("%-10s %5dx%-5d active tiles with the gradient rate map, %d cells differ from stepping every cell %s\n",
+            rdKernelName(k), size, size, differentCells, differentCells == 0 ? "ok" : "FAILED");
+        passed = passed && differentCells == 0;
+        freeTiles(&tiles);
+        freeField(&tiledField);
+
+        RDField blockedField;
+        initialiseField(&blockedField, size, size, SEED_FIVE_SQUARES, 5);
+        blockedField.kernel = k;
+        shareFieldRates(&blockedField, &reference.rates, 0, 0);
+        stepFieldBlocked(pool, &blockedField, params, steps, VERIFY_BLOCK_SIZE, 3);
+
+        differentCells = countDifferentCells(&blockedField, &field);
+        printf("%-10s %5dx%-5d 3 generations per block with the gradient rate map, %d cells differ %s\n",
+            rdKernelName(k), size, size, differentCells, differentCells == 0 ? "ok" : "FAILED");
+        passed = passed && differentCells == 0;
+        freeField(&blockedField);
+        freeField(&field);
+
+        initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+        field.kernel = k;
+        shareFieldRates(&field, &reference.rates, 0, 0);
+        stepFieldImplicit(pool, &field, params, steps, RD_DEFAULT_TIME_STEP);
+
+        differentCells = countDifferentCells(&field, &implicitReference);
+        printf("%-10s %5dx%-5d %2d threads, dt %d implicit with the gradient rate map, %d cells differ from scalar %s\n",
+            rdKernelName(k), size, size, workerPoolSize(pool), RD_DEFAULT_TIME_STEP, differentCells,
+            differentCells == 0 ? "ok" : "FAILED");
+        passed = passed && differentCells == 0;
+        freeField(&field);
+    }
+
+    // The original layouts can't step with a map, so they mustn't start on a field with one
+    RDField field;
+    initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+    shareFieldRates(&field, &reference.rates, 0, 0);
+    RDBackendConfig config = { "neighbour", KERNEL_SCALAR, 1, RD_DEFAULT_TILE_SIZE, 0.0, RD_DEFAULT_BLOCK_STEPS };
+    RDStepper stepper;
+    bool refused = !startStepper(&stepper, &field, &config);
+    if (!refused) stopStepper(&stepper);
+    printf("%-10s %5dx%-5d refuses a field with a rate map %s\n", "neighbour", size, size, refused ? "ok" : "FAILED");
+    passed = passed && refused;
+    freeField(&field);
+
+    // 16 bit images of the gradient's levels load back as exactly the same levels
+    char feedPath[256], killPath[256];
+    snprintf(feedPath, sizeof(feedPath), "%s_feed.pgm", VERIFY_RATES_PATH);
+    snprintf(killPath, sizeof(killPath), "%s_kill.pgm", VERIFY_RATES_PATH);
+    const RDRateMap *rates = &reference.rates;
+    bool loaded = writeLevels(feedPath, rates->feed, rates->stride, size, size)
+        && writeLevels(killPath, rates->kill, rates->stride, size, size);
+
+    initialiseField(&field, size, size, SEED_FIVE_SQUARES, 5);
+    loaded = loaded && loadRateImages(&field, feedPath, rates->feedLow, rates->feedHigh, killPath, rates->killLow,
+        rates->killHigh);
+    int differentCells = 0;
+    for (int y = 0; y < size && loaded; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            size_t i = (size_t) y * rates->stride + x;
+            size_t j = (size_t) y * field.rates.stride + x;
+            differentCells += field.rates.feed[j] != rates->feed[i] || field.rates.kill[j] != rates->kill[i];
+        }
+    }
+    printf("%-10s %5dx%-5d gradient rate map read back from PGMs, %d cells differ %s\n", "rates", size, size,
+        loaded ? differentCells : -1, loaded && differentCells == 0 ? "ok" : "FAILED");
+    passed = passed && loaded && differentCells == 0;
+    freeField(&field);
+    remove(feedPath);
+    remove(killPath);
+
+    freeField(&implicitReference);
+    freeField(&reference);
+    freeField(&uniformReference);
+    return passed;
+}
+
+/// A check run by --verify
+typedef struct {
+    const char *name;
+    bool (*check)(RDWorkerPool *pool, int size, int steps, const RDParams *params);
+    bool forks;     // Forks worker processes, so has to run before the caller starts any threads
+} VerifyCheck;
+
+static const VerifyCheck checks[] = {
+    { "domain", verifyDomain, true },
+    { "kernels", verifyKernels, false },
+    { "colour", verifyColour, false },
+    { "snapshot", verifySnapshot, false },
+    { "record", verifyRecord, false },
+    { "view", verifyView, false },
+    { "backends", verifyBackends, false },
+    { "implicit", verifyImplicit, false },
+    { "rates", verifyRates, false },
+};
+
+#define NUM_CHECKS (int) (sizeof(checks) / sizeof(checks[0]))
+
+bool runVerifyChecks(RDWorkerPool *pool, bool forking, int size, int steps, const RDParams *params)
+{
+    bool passed = true;
+    for (int c = 0; c < NUM_CHECKS; c++)
+    {
+        if (checks[c].forks != forking) continue;
+
+        bool checked = checks[c].check(pool, size, steps, params);
+        if (!checked) printf("%-10s %5dx%-5d the %s checks FAILED\n", "verify", size, size, checks[c].name);
+        passed = checked && passed;
+        fflush(stdout);
+    }
+    return passed;
+}
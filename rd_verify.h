@@ -0,0 +1,42 @@
+// The checks rd_bench --verify runs against the engine
+//
+// Every check steps a freshly seeded field some way that's meant to give the same result as a
+// simpler way of stepping it, usually the scalar kernel on one thread, and prints a line for each
+// comparison ending in ok or FAILED. The checks are kept in a table so adding one is a single
+// entry. Those that fork worker processes are run separately, before the caller starts any threads,
+// as a forked child only gets the thread that forked it.
+
+#ifndef RD_VERIFY_H
+#define RD_VERIFY_H
+
+#include "rd_threads.h"
+
+/// The b above which a cell counts as part of the pattern
+#define RD_PATTERN_THRESHOLD 0.2
+
+/// Run every check that forks worker processes, or every one that doesn't, on a grid
+/// @param pool The pool to step with, NULL to step on one thread. It has to be NULL when forking.
+/// @param forking True to run the checks that fork, false to run the rest
+/// @param size The width and height of the grid
+/// @param steps The number of generations each check steps
+/// @param params The feed, kill and diffusion rates to use
+/// @return False if any check failed
+bool runVerifyChecks(RDWorkerPool *pool, bool forking, int size, int steps, const RDParams *params);
+
+/// Count the cells where two fields of the same size differ at all
+/// @param field The field to check
+/// @param expected The field it should match
+/// @return The number of cells with a different a or b
+int countDifferentCells(const RDField *field, const RDField *expected);
+
+/// Get the largest difference in a or b between two fields of the same size
+double maxCellDifference(const RDField *field, const RDField *expected);
+
+/// Compare the pattern of a field with a reference's
+/// @param field The field to compare
+/// @param expected The reference
+/// @param maxDifference Set to the largest difference in b, infinite if any cell isn't a number
+/// @return The fraction of cells that are in one pattern but not the other
+double patternDifference(const RDField *field, const RDField *expected, double *maxDifference);
+
+#endif
@@ -0,0 +1,240 @@
+// Colours just the part of a field that's on screen, at whatever zoom it's shown at
+
+#include "rd_view.h"
+#include "rd_colour.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// The data for averaging every level of a pyramid on a pool
+typedef struct {
+    RDMipPyramid *pyramid;
+    const RDField *field;
+    int level;          // The level being averaged this generation
+} MipJob;
+
+bool initialiseMipPyramid(RDMipPyramid *pyramid, const RDField *field)
+{
+    pyramid->levels = 1;
+    pyramid->width[0] = field->width;
+    pyramid->height[0] = field->height;
+    pyramid->a[0] = NULL;
+    pyramid->b[0] = NULL;
+    pyramid->tileGeneration = -1;
+    pyramid->columns = NULL;
+    pyramid->columnCapacity = 0;
+
+    // Each level is half the size of the one below, rounded up so every cell is in a block
+    size_t blocks = 0;
+    while ((pyramid->width[pyramid->levels - 1] > 1 || pyramid->height[pyramid->levels - 1] > 1)
+        && pyramid->levels < RD_MAX_MIP_LEVELS)
+    {
+        int level = pyramid->levels++;
+        pyramid->width[level] = (pyramid->width[level - 1] + 1) / 2;
+        pyramid->height[level] = (pyramid->height[level - 1] + 1) / 2;
+        blocks += (size_t) pyramid->width[level] * pyramid->height[level];
+    }
+
+    pyramid->memory = malloc(2 * blocks * sizeof(float));
+    if (pyramid->memory == NULL && blocks > 0) return false;
+
+    float *next = (float *) pyramid->memory;
+    for (int level = 1; level < pyramid->levels; level++)
+    {
+        size_t size = (size_t) pyramid->width[level] * pyramid->height[level];
+        pyramid->a[level] = next;
+        pyramid->b[level] = next + size;
+        next += 2 * size;
+    }
+
+    return true;
+}
+
+// Average a rectangle of blocks of a level above 0 from the level below, blocks on the far edges
+// only average the cells that exist
+static void averageRect(RDMipPyramid *pyramid, const RDField *field, int level, int left, int top, int right,
+    int bottom)
+{
+    int belowWidth = pyramid->width[level - 1];
+    int belowHeight = pyramid->height[level - 1];
+    int width = pyramid->width[level];
+
+    for (int y = top; y < bottom; y++)
+    {
+        int y0 = y * 2;
+        int y1 = y0 + 1 < belowHeight ? y0 + 1 : y0;
+        float *a = pyramid->a[level] + (size_t) y * width;
+        float *b = pyramid->b[level] + (size_t) y * width;
+
+        if (level == 1)
+        {
+            const RDReal *a0 = fieldA(field) + (size_t) y0 * field->stride;
+            const RDReal *a1 = fieldA(field) + (size_t) y1 * field->stride;
+            const RDReal *b0 = fieldB(field) + (size_t) y0 * field->stride;
+            const RDReal *b1 = fieldB(field) + (size_t) y1 * field->stride;
+
+            for (int x = left; x < right; x++)
+            {
+                int x0 = x * 2;
+                int x1 = x0 + 1 < belowWidth ? x0 + 1 : x0;
+                a[x] = (float) (0.25 * (rdRealToDouble(a0[x0]) + rdRealToDouble(a0[x1]) + rdRealToDouble(a1[x0])
+                    + rdRealToDouble(a1[x1])));
+                b[x] = (float) (0.25 * (rdRealToDouble(b0[x0]) + rdRealToDouble(b0[x1]) + rdRealToDouble(b1[x0])
+                    + rdRealToDouble(b1[x1])));
+            }
+        }
+        else
+        {
+            const float *a0 = pyramid->a[level - 1] + (size_t) y0 * belowWidth;
+            const float *a1 = pyramid->a[level - 1] + (size_t) y1 * belowWidth;
+            const float *b0 = pyramid->b[level - 1] + (size_t) y0 * belowWidth;
+            const float *b1 = pyramid->b[level - 1] + (size_t) y1 * belowWidth;
+
+            for (int x = left; x < right; x++)
+            {
+                int x0 = x * 2;
+                int x1 = x0 + 1 < belowWidth ? x0 + 1 : x0;
+                a[x] = 0.25f * (a0[x0] + a0[x1] + a1[x0] + a1[x1]);
+                b[x] = 0.25f * (b0[x0] + b0[x1] + b1[x0] + b1[x1]);
+            }
+        }
+    }
+}
+
+// Average a rectangle of cells into every level, growing it to whole blocks on the way up
+static void updateRect(RDMipPyramid *pyramid, const RDField *field, int left, int top, int right, int bottom)
+{
+    for (int level = 1; level < pyramid->levels; level++)
+    {
+        left /= 2;
+        top /= 2;
+        right = (right + 1) / 2;
+        bottom = (bottom + 1) / 2;
+        averageRect(pyramid, field, level, left, top, right, bottom);
+    }
+}
+
+static void averageStripe(void *data, int thread, int numThreads)
+{
+    MipJob *job = (MipJob *) data;
+    int height = job->pyramid->height[job->level];
+    int top = (int) ((long long) height * thread / numThreads);
+    int bottom = (int) ((long long) height * (thread + 1) / numThreads);
+
+    averageRect(job->pyramid, job->field, job->level, 0, top, job->pyramid->width[job->level], bottom);
+}
+
+static void finishLevel(void *data)
+{
+    ((MipJob *) data)->level++;
+}
+
+void updateMipPyramid(RDWorkerPool *pool, RDMipPyramid *pyramid, const RDField *field, const RDTiles *tiles)
+{
+    if (tiles == NULL)
+    {
+        // Each level needs the whole of the one below, so the levels are averaged one at a time
+        MipJob mipJob = { pyramid, field, 1 };
+        RDPoolJob job = { averageStripe, finishLevel, &mipJob, pyramid->levels - 1 };
+        runPoolJob(pool, &job);
+        return;
+    }
+
+    for (int tile = 0; tile < tiles->tilesX * tiles->tilesY; tile++)
+    {
+        if (tiles->lastChanged[tile] <= pyramid->tileGeneration) continue;
+
+        int left = (tile % tiles->tilesX) * tiles->tileSize;
+        int top = (tile / tiles->tilesX) * tiles->tileSize;
+        int right = left + tiles->tileSize < field->width ? left + tiles->tileSize : field->width;
+        int bottom = top + tiles->tileSize < field->height ? top + tiles->tileSize : field->height;
+        updateRect(pyramid, field, left, top, right, bottom);
+    }
+
+    pyramid->tileGeneration = tiles->generation;
+}
+
+int viewLevel(const RDMipPyramid *pyramid, const RDView *view)
+{
+    int level = 0;
+    while (level + 1 < pyramid->levels && (double) (1LL << (level + 1)) <= view->cellsPerPixel) level++;
+    return level;
+}
+
+bool colourView(const RDField *field, RDMipPyramid *pyramid, const RDView *view, unsigned char *pixels)
+{
+    int level = viewLevel(pyramid, view);
+    const uint32_t *table = colourTable();
+    int width = pyramid->width[level];
+    int height = pyramid->height[level];
+    double blocksPerPixel = view->cellsPerPixel / (double) (1LL << level);
+
+    // The table only grows, so colouring the same view every frame doesn't allocate
+    if (view->width > pyramid->columnCapacity)
+    {
+        int *grown = (int *) realloc(pyramid->columns, (size_t) view->width * sizeof(int));
+        if (grown == NULL)
+        {
+            memset(pixels, 0, (size_t) view->width * view->height * RD_PIXEL_SIZE);
+            return false;
+        }
+        pyramid->columns = grown;
+        pyramid->columnCapacity = view->width;
+    }
+
+    // The block under the centre of each column of pixels, -1 when it's off the field
+    int *columns = pyramid->columns;
+
+    for (int px = 0; px < view->width; px++)
+    {
+        double x = floor((view->x / (double) (1LL << level)) + (px + 0.5) * blocksPerPixel);
+        columns[px] = x >= 0.0 && x < width ? (int) x : -1;
+    }
+
+    for (int py = 0; py < view->height; py++)
+    {
+        uint32_t *row = (uint32_t *) (pixels + (size_t) py * view->width * RD_PIXEL_SIZE);
+        double y = floor((view->y / (double) (1LL << level)) + (py + 0.5) * blocksPerPixel);
+
+        if (y < 0.0 || y >= height)
+        {
+            memset(row, 0, (size_t) view->width * RD_PIXEL_SIZE);
+            continue;
+        }
+
+        // Each pixel is written as one word, looked up in the same table colourField uses, or clear off the field
+        if (level == 0)
+        {
+            const RDReal *a = fieldA(field) + (size_t) y * field->stride;
+            const RDReal *b = fieldB(field) + (size_t) y * field->stride;
+            for (int px = 0; px < view->width; px++)
+            {
+                int x = columns[px];
+                row[px] = x < 0 ? 0 : table[colourLevel(a[x], b[x])];
+            }
+        }
+        else
+        {
+            const float *a = pyramid->a[level] + (size_t) y * width;
+            const float *b = pyramid->b[level] + (size_t) y * width;
+            for (int px = 0; px < view->width; px++)
+            {
+                int x = columns[px];
+                row[px] = x < 0 ? 0 : table[blockColourLevel(a[x], b[x])];
+            }
+        }
+    }
+
+    return true;
+}
+
+void freeMipPyramid(RDMipPyramid *pyramid)
+{
+    free(pyramid->memory);
+    free(pyramid->columns);
+    pyramid->memory = NULL;
+    pyramid->columns = NULL;
+    pyramid->columnCapacity = 0;
+    pyramid->levels = 0;
+}
@@ -0,0 +1,78 @@
+// Colours just the part of a field that's on screen, at whatever zoom it's shown at
+//
+// A view is a window onto the field that can be panned and zoomed independently of the field's
+// size. Only the view's pixels are coloured, so the cost depends on the size of the window rather
+// than the field. Zoomed out, each pixel covers many cells, so a mip pyramid keeps a and b averaged
+// over 2x2, 4x4, 8x8 and bigger blocks of cells and each pixel reads the one level whose cells are
+// closest to its size instead of averaging the cells itself. The pyramid is brought up to date
+// after stepping, and with tiles only the blocks that were written since are averaged again.
+
+#ifndef RD_VIEW_H
+#define RD_VIEW_H
+
+#include "rd_field.h"
+#include "rd_threads.h"
+#include "rd_tiles.h"
+
+/// The most levels a pyramid can have, enough for a field of over a billion cells across
+#define RD_MAX_MIP_LEVELS 32
+
+/// a and b averaged over blocks of cells, level 1 over 2x2 cells, level 2 over 4x4 and so on
+typedef struct {
+    int levels;                             // Including level 0, which is the field itself
+    int width[RD_MAX_MIP_LEVELS];           // The number of blocks across each level
+    int height[RD_MAX_MIP_LEVELS];
+    float *a[RD_MAX_MIP_LEVELS];            // The averages of each level above 0, one row after another
+    float *b[RD_MAX_MIP_LEVELS];
+    long long tileGeneration;               // The generation of the tiles when the pyramid was last updated
+    void *memory;                           // The single allocation backing every level
+
+    // The block under each column of pixels of the last view coloured, grown with the view's width
+    int *columns;
+    int columnCapacity;
+} RDMipPyramid;
+
+/// The part of a field shown in a window
+typedef struct {
+    double x;               // The position in cells of the window's top left corner, can be off the field
+    double y;
+    double cellsPerPixel;   // How many cells across each pixel covers, below 1 when zoomed in
+    int width;              // The size of the window in pixels
+    int height;
+} RDView;
+
+/// Initialise a pyramid for a field, every level is averaged down until it's a single block
+/// @param pyramid The pyramid to initialise
+/// @param field The field it's for, its size can't change
+/// @return False if the memory for the pyramid couldn't be allocated
+bool initialiseMipPyramid(RDMipPyramid *pyramid, const RDField *field);
+
+/// Average the parts of the field that have changed into every level of the pyramid
+/// @param pool The pool to average with, NULL averages on the calling thread
+/// @param pyramid The pyramid to update
+/// @param field The field it's for
+/// @param tiles The tiles the field is stepped with, only those written since the last update are
+///              averaged again, NULL averages the whole field
+void updateMipPyramid(RDWorkerPool *pool, RDMipPyramid *pyramid, const RDField *field, const RDTiles *tiles);
+
+/// Get the level of a pyramid a view is coloured from
+/// @param pyramid The pyramid
+/// @param view The view
+/// @return The largest level with blocks no bigger than the view's pixels
+int viewLevel(const RDMipPyramid *pyramid, const RDView *view);
+
+/// Colour the pixels of a view, reading the field when zoomed in and the pyramid when zoomed out,
+/// pixels off the field are left transparent
+/// @param field The field to colour
+/// @param pyramid The field's pyramid, brought up to date with updateMipPyramid, which keeps the
+///                view's column table so only a view wider than any before it allocates
+/// @param view The part of the field to colour
+/// @param pixels A buffer of view->width * view->height * RD_PIXEL_SIZE bytes to fill
+/// @return False if the column table couldn't be grown, in which case every pixel is cleared
+bool colourView(const RDField *field, RDMipPyramid *pyramid, const RDView *view, unsigned char *pixels);
+
+/// Free the memory used by a pyramid
+/// @param pyramid The pyramid to free
+void freeMipPyramid(RDMipPyramid *pyramid);
+
+#endif
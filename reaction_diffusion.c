@@ -0,0 +1,308 @@
+// This program runs a visualisation of a reaction diffusion algorithm
+// Based on this tutorial http://karlsims.com/rd.html
+
+#include "raylib.h"
+#include "rd_field.h"
+#include "rd_tiles.h"
+#include "rd_blocking.h"
+#include "rd_colour.h"
+#include "rd_async.h"
+#include "rd_backend.h"
+#include "rd_tune.h"
+#include "rd_snapshot.h"
+#include "rd_record.h"
+#include "rd_rates.h"
+#include "rd_view.h"
+#include "view_controls.h"
+#include "profiler_overlay.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CAMERA_CONTROLS true
+#define WORLD_WIDTH 2048            // The size of the simulation in cells, independent of the window
+#define WORLD_HEIGHT 2048
+#define SEED SEED_CENTRE_SQUARE     // The squares the simulation starts from, SEED_FIVE_SQUARES for more of them
+#define STEPS_PER_FRAME 8           // The number of generations stepped for each frame drawn
+#define ASYNC_SIMULATION true       // Step on a background thread instead of between frames
+#define AUTO_TUNE true              // Time every backend on the field at startup and use the fastest
+#define BACKEND "tiles"             // The backend to use without AUTO_TUNE, with the default kernel on every core
+#define TUNE_SECONDS 0.2            // How long to time each backend for when tuning
+#define TILE_EPSILON 1e-9           // How close to the background a tile has to be to stop stepping it
+#define PALETTE "grey"              // The palette to start with, P switches to the next one
+#define RATE_MAP false              // Step with Karl Sims' map of every pattern, feed rising down and kill across
+#define TUNE_FILE "reaction_diffusion.tune"         // The backend tuned for each machine and field size
+#define SNAPSHOT_FILE "reaction_diffusion.rdsnap"   // Resumed from on start, saved to on close and when S is pressed
+#define RECORD_FILE "reaction_diffusion.y4m"        // Every frame shown is recorded to it while V is toggled on
+
+int main(void)
+{
+    // Initialisation
+    //-----------------------------------------------------------------------------------
+    const int screenWidth = 800;
+    const int screenHeight = 600;
+
+    // Setup values for the function to calculate new values of a cells a and b properties
+    RDParams params = RD_DEFAULT_PARAMS;
+
+    // Initialise the grid
+    // Carry on from the last run if it was saved, otherwise start from the seed squares
+    RDField field;
+    if (!loadSnapshot(SNAPSHOT_FILE, &field, &params)
+        && !initialiseField(&field, WORLD_WIDTH, WORLD_HEIGHT, SEED, 5))
+    {
+        return 1;
+    }
+
+    // Snapshots only hold the chemicals, so the map is made again on every run
+    #if RATE_MAP
+    if (!setGradientRates(&field, RD_GRADIENT_FEED_LOW, RD_GRADIENT_FEED_HIGH, RD_GRADIENT_KILL_LOW,
+        RD_GRADIENT_KILL_HIGH))
+    {
+        freeField(&field);
+        return 1;
+    }
+    #endif
+
+    RDView view = fitView(field.width, field.height, screenWidth, screenHeight);
+
+    // Every colour pass looks up the same palette, so it's picked before anything is coloured
+    const RDPalette *palette = findPalette(PALETTE);
+    if (palette != NULL) setColourPalette(palette);
+
+    // Pick how to step the field before the window opens, tuning takes a few seconds the first
+    // time on each machine and is read back from TUNE_FILE after that
+    #if AUTO_TUNE
+    RDBackendConfig config;
+    RDTuneResult tuned = tuneBackend(&field, &params, &view, STEPS_PER_FRAME, TILE_EPSILON, TUNE_SECONDS, TUNE_FILE,
+        &config);
+    if (tuned == TUNE_SAVED)
+    {
+        printf("Tuned the backends and saved the fastest to %s\n", TUNE_FILE);
+    }
+    else if (tuned == TUNE_UNSAVED)
+    {
+        char tunedName[128];
+        describeBackend(&config, tunedName, sizeof(tunedName));
+        printf("Tuned the backends and picked %s, without saving it to %s\n", tunedName, TUNE_FILE);
+    }
+    #else
+    RDBackendConfig config = {
+        BACKEND, rdDefaultKernel(), 0, RD_DEFAULT_TILE_SIZE, TILE_EPSILON, RD_DEFAULT_BLOCK_STEPS
+    };
+    #endif
+
+    // Start the backend, which keeps its threads for the whole run
+    RDStepper stepper;
+    if (!startStepper(&stepper, &field, &config))
+    {
+        freeField(&field);
+        return 1;
+    }
+    char backendName[128];
+    describeBackend(&config, backendName, sizeof(backendName));
+    printf("Stepping with %s\n", backendName);
+
+    InitWindow(screenWidth, screenHeight, "Reaction Diffusion by Justin Johnson");
+
+    // Snapshots are written on their own thread so saving doesn't stall the simulation
+    RDSnapshotWriter *snapshotWriter = createSnapshotWriter();
+
+    // Averages of the field over bigger and bigger blocks, so zoomed out views don't have to
+    // read every cell they cover
+    RDMipPyramid pyramid;
+    if (!initialiseMipPyramid(&pyramid, &field))
+    {
+        freeSnapshotWriter(snapshotWriter);
+        stopStepper(&stepper);
+        freeField(&field);
+        CloseWindow();
+        return 1;
+    }
+
+    // Only the part of the field in view is coloured, into a buffer the size of the window that's
+    // uploaded to a texture once a frame. The simulation thread colours into its own frames.
+    #if !ASYNC_SIMULATION
+    unsigned char *pixels = (unsigned char *) malloc((size_t) screenWidth * screenHeight * RD_PIXEL_SIZE);
+    if (pixels == NULL)
+    {
+        freeSnapshotWriter(snapshotWriter);
+        freeMipPyramid(&pyramid);
+        stopStepper(&stepper);
+        freeField(&field);
+        CloseWindow();
+        return 1;
+    }
+    #endif
+    Image image = GenImageColor(screenWidth, screenHeight, BLANK);
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+
+    SetTargetFPS(144);
+    //-----------------------------------------------------------------------------------
+    
+    //int cellSize = 50;
+
+    #if ASYNC_SIMULATION
+    // The simulation runs freely on its own thread and publishes a frame every STEPS_PER_FRAME
+    // generations, the loop below just shows the latest one
+    RDAsyncSim *sim = startAsyncStepperSim(&stepper, &params, STEPS_PER_FRAME, &pyramid, &view);
+    if (sim == NULL)
+    {
+        freeSnapshotWriter(snapshotWriter);
+        UnloadTexture(texture);
+        freeMipPyramid(&pyramid);
+        stopStepper(&stepper);
+        freeField(&field);
+        CloseWindow();
+        return 1;
+    }
+    RDAsyncStats stats = { 0 };
+    long long uploadedGeneration = -1;
+    RDView uploadedView = view;
+    #else
+    long long generation = 0;
+    #endif
+
+    // Set while recording, the frames are written on the recorder's own thread
+    RDRecorder *recorder = NULL;
+    RDRecordStats recordStats = { 0 };
+    
+    // Main sim loop
+    while (!WindowShouldClose())        // Detect window close button or ESC key
+    {
+        // Update
+        //-------------------------------------------------------------------------------
+
+        #if CAMERA_CONTROLS
+        // Pan by dragging, zoom with the wheel and reset with R
+        updateViewControls(&view, field.width, field.height);
+        #endif
+
+        // Save a snapshot without waiting for it to be written
+        if (IsKeyPressed(KEY_S) && snapshotWriter != NULL)
+        {
+            #if ASYNC_SIMULATION
+            requestAsyncSnapshot(sim, snapshotWriter, SNAPSHOT_FILE);
+            #else
+            queueSnapshot(snapshotWriter, SNAPSHOT_FILE, &field, &params);
+            #endif
+        }
+
+        // Start or stop recording what's shown, frames are dropped rather than slowing anything down
+        // if the disk can't keep up
+        if (IsKeyPressed(KEY_V))
+        {
+            if (recorder == NULL)
+            {
+                recorder = createRecorder(RECORD_FILE, RECORD_Y4M, screenWidth, screenHeight, 1, 0);
+                #if ASYNC_SIMULATION
+                if (recorder != NULL) setAsyncRecorder(sim, recorder);
+                #endif
+            }
+            else
+            {
+                #if ASYNC_SIMULATION
+                setAsyncRecorder(sim, NULL);
+                #endif
+                freeRecorder(recorder, &recordStats);
+                recorder = NULL;
+                printf("Recorded %lld frames to %s, %lld dropped\n", recordStats.framesWritten, RECORD_FILE,
+                    recordStats.framesDropped);
+            }
+        }
+        if (recorder != NULL) getRecordStats(recorder, &recordStats);
+
+        // Switch to the next palette, every frame coloured from now on uses it
+        if (IsKeyPressed(KEY_P))
+        {
+            int next = (int) (colourPalette() - getPalette(0)) + 1;
+            setColourPalette(getPalette(next % RD_PALETTE_COUNT));
+        }
+
+        #if ASYNC_SIMULATION
+        // The simulation colours the view from the next frame it publishes, until then the
+        // latest frame is drawn where its view lines up with the new one
+        setAsyncView(sim, &view);
+
+        // Upload the latest published frame if it's one we haven't shown yet
+        const RDFrame *frame = latestFrame(sim);
+        PROFILE_START(PROFILE_DRAW);
+        if (frame != NULL && frame->generation != uploadedGeneration)
+        {
+            UpdateTexture(texture, frame->pixels);
+            uploadedGeneration = frame->generation;
+            uploadedView = frame->view;
+        }
+        updateAsyncStats(sim, frame, &stats);
+        #else
+        // Step the simulation forward, bring the field and pyramid up to date and colour the
+        // view straight into the pixel buffer
+        PROFILE_START(PROFILE_STEP);
+        stepStepper(&stepper, &params, STEPS_PER_FRAME);
+        generation += STEPS_PER_FRAME;
+        PROFILE_STOP(PROFILE_STEP);
+
+        PROFILE_START(PROFILE_COLOUR);
+        colouriseStepper(&stepper, &pyramid, &view, pixels);
+        RDView uploadedView = view;
+        if (recorder != NULL) recordPixels(recorder, pixels, generation);
+        PROFILE_STOP(PROFILE_COLOUR);
+
+        // Upload it as a single texture
+        PROFILE_START(PROFILE_DRAW);
+        UpdateTexture(texture, pixels);
+        #endif
+
+        // Draw
+        //-------------------------------------------------------------------------------
+        BeginDrawing();
+            ClearBackground(RAYWHITE);
+
+            drawViewFrame(texture, &uploadedView, &view);
+            DrawFPS(0, 0);
+            DrawText(backendName, 100, 0, 10, DARKGRAY);
+            DrawText(colourPalette()->name, 100, 10, 10, DARKGRAY);
+            if (recorder != NULL)
+            {
+                DrawText(TextFormat("Recording, %lld dropped", recordStats.framesDropped), 100, 20, 10, RED);
+            }
+            #if ASYNC_SIMULATION
+            DrawText(TextFormat("%.0f steps/s", stats.stepsPerSecond), 0, 20, 10, DARKGRAY);
+            DrawText(TextFormat("%.1f ms stale", stats.staleness * 1000.0), 0, 30, 10, DARKGRAY);
+            #endif
+            PROFILE_OVERLAY(0, 40, 10, DARKGRAY);
+            PROFILE_STOP(PROFILE_DRAW);
+
+            // Presenting includes waiting for the target frame rate
+            PROFILE_START(PROFILE_PRESENT);
+        EndDrawing();
+        PROFILE_STOP(PROFILE_PRESENT);
+        //-------------------------------------------------------------------------------
+    }
+    // De-Initialisation
+    //-----------------------------------------------------------------------------------
+    #if ASYNC_SIMULATION
+    stopAsyncSim(sim);
+    #endif
+    freeRecorder(recorder, NULL);
+
+    // Keep the latest frame timings to see where the time went
+    PROFILE_DUMP("reaction_diffusion_profile");
+
+    // Save where the simulation got to so the next run carries on from there
+    freeSnapshotWriter(snapshotWriter);
+    saveSnapshot(SNAPSHOT_FILE, &field, &params);
+
+    UnloadTexture(texture);
+    #if !ASYNC_SIMULATION
+    free(pixels);
+    #endif
+    freeMipPyramid(&pyramid);
+    stopStepper(&stepper);
+    freeField(&field);
+    CloseWindow();        // Close window and OpenGL context
+    //-----------------------------------------------------------------------------------
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Generates the Recamán sequence, which circle_test draws as arcs between consecutive terms
+
+#include "recaman.h"
+#include <string.h>
+
+// The number of terms generated at a time when streaming arcs into a ring store
+#define RING_BATCH 256
+
+static inline bool isVisited(const unsigned char *bits, uint64_t value)
+{
+    return (bits[value >> 3] >> (value & 7)) & 1;
+}
+
+static inline void markVisited(unsigned char *bits, uint64_t value)
+{
+    bits[value >> 3] |= (unsigned char) (1u << (value & 7));
+}
+
+bool initialiseRecaman(Recaman *sequence, uint64_t maxValue)
+{
+    if (maxValue == 0) maxValue = RECAMAN_DEFAULT_MAX_VALUE;
+
+    sequence->maxValue = maxValue;
+    if (!initialiseArena(&sequence->visited, (size_t) (maxValue / 8 + 1))) return false;
+
+    // Fresh pages are zeroed, so only the first term needs marking
+    if (!arenaCommit(&sequence->visited, 1))
+    {
+        freeArena(&sequence->visited);
+        return false;
+    }
+
+    resetRecaman(sequence);
+    return true;
+}
+
+size_t nextRecamanTerms(Recaman *sequence, uint64_t *terms, size_t count)
+{
+    unsigned char *bits = sequence->visited.base;
+    uint64_t term = sequence->term;
+    uint64_t index = sequence->index;
+    uint64_t largest = sequence->largest;
+
+    // Every value below this has its bit committed, so only going past it needs to grow the bitset
+    uint64_t committedValues = (uint64_t) sequence->visited.committed * 8;
+    size_t generated = 0;
+
+    for (; generated < count; generated++)
+    {
+        index++;
+
+        if (term > index && !isVisited(bits, term - index))
+        {
+            term -= index;
+        }
+        else
+        {
+            uint64_t next = term + index;
+            if (next > sequence->maxValue) break;
+
+            // The term only moves on once its bit is committed, so a failed commit leaves it as it was
+            if (next >= committedValues)
+            {
+                // The arena doubles what it commits so this only happens a logarithmic number of times
+                if (!arenaCommit(&sequence->visited, (size_t) (next / 8 + 1))) break;
+                committedValues = (uint64_t) sequence->visited.committed * 8;
+            }
+
+            term = next;
+            if (term > largest) largest = term;
+        }
+
+        markVisited(bits, term);
+        if (terms != NULL) terms[generated] = term;
+    }
+
+    // A term that couldn't be generated leaves the index where it was
+    if (generated < count) index--;
+
+    sequence->term = term;
+    sequence->index = index;
+    sequence->largest = largest;
+    return generated;
+}
+
+size_t appendRecamanRings(Recaman *sequence, RingStore *store, size_t count, float spacing, float thickness,
+    float centreY)
+{
+    uint64_t terms[RING_BATCH];
+    size_t appended = 0;
+
+    // Reserve the rings up front so appending them one at a time can't fail part way through a batch
+    if (!reserveRings(store, store->count + count)) return 0;
+
+    while (appended < count)
+    {
+        size_t batch = count - appended < RING_BATCH ? count - appended : RING_BATCH;
+        uint64_t from = sequence->term;
+        uint64_t index = sequence->index;
+        size_t generated = nextRecamanTerms(sequence, terms, batch);
+
+        for (size_t t = 0; t < generated; t++)
+        {
+            uint64_t to = terms[t];
+            float radius = 0.5f * spacing * (float) (to > from ? to - from : from - to);
+
+            // Odd indices arc over the axis and even ones under it, angles going clockwise from
+            // the right as y points down the screen
+            index++;
+            bool above = index & 1;
+
+            Ring ring = {
+                0.5f * spacing * (float) (from + to), centreY, radius, radius + thickness,
+                above ? 180.0f : 0.0f, above ? 360.0f : 180.0f, 100, { 0, 0, 0, 255 }
+            };
+            appendRing(store, ring);
+            from = to;
+        }
+
+        appended += generated;
+        if (generated < batch) break;
+    }
+
+    return appended;
+}
+
+size_t recamanMemory(const Recaman *sequence)
+{
+    return sequence->visited.committed;
+}
+
+void resetRecaman(Recaman *sequence)
+{
+    memset(sequence->visited.base, 0, sequence->visited.committed);
+    markVisited(sequence->visited.base, 0);
+
+    sequence->term = 0;
+    sequence->index = 0;
+    sequence->largest = 0;
+}
+
+void freeRecaman(Recaman *sequence)
+{
+    freeArena(&sequence->visited);
+}
@@ -0,0 +1,65 @@
+// Generates the Recamán sequence, which circle_test draws as arcs between consecutive terms
+//
+// Each term is the last one minus its index if that's positive and hasn't been seen before, and
+// the last one plus its index otherwise. Finding out whether a value has been seen is the slow
+// part of a naive version, which searches the terms so far and goes quadratic. Here each value
+// gets one bit in a bitset that grows as the terms do, so checking and marking a value is O(1)
+// and the memory is one bit per value up to the largest term.
+
+#ifndef RECAMAN_H
+#define RECAMAN_H
+
+#include "arena.h"
+#include "ring_store.h"
+#include <stdint.h>
+
+/// The default largest value the sequence can reach, only the address space for its bits is reserved up front
+#define RECAMAN_DEFAULT_MAX_VALUE ((uint64_t) 1 << 36)
+
+typedef struct {
+    Arena visited;          // One bit per value, set once it's been a term
+    uint64_t term;          // The last term generated
+    uint64_t index;         // The index of the last term, the first term 0 is index 0
+    uint64_t largest;       // The largest term so far
+    uint64_t maxValue;
+} Recaman;
+
+/// Initialise a sequence at its first term, 0
+/// @param sequence The sequence to initialise
+/// @param maxValue The largest value it can reach, 0 uses RECAMAN_DEFAULT_MAX_VALUE
+/// @return False if the address space for the bitset couldn't be reserved
+bool initialiseRecaman(Recaman *sequence, uint64_t maxValue);
+
+/// Generate the next terms of the sequence
+/// @param sequence The sequence to generate
+/// @param terms Where to write the terms, NULL to only step the sequence
+/// @param count The number of terms to generate
+/// @return The number of terms generated, less than count if the sequence reached its largest value
+size_t nextRecamanTerms(Recaman *sequence, uint64_t *terms, size_t count);
+
+/// Generate the next terms of the sequence as arcs appended to a ring store, each from the last
+/// term to the next along the x axis, alternately above and below it
+/// @param sequence The sequence to generate
+/// @param store The store to append the arcs to
+/// @param count The number of terms to generate
+/// @param spacing The distance between consecutive values along the x axis
+/// @param thickness The width of each arc
+/// @param centreY Where the x axis is
+/// @return The number of arcs appended
+size_t appendRecamanRings(Recaman *sequence, RingStore *store, size_t count, float spacing, float thickness,
+    float centreY);
+
+/// Get the memory used by the sequence
+/// @param sequence The sequence to check
+/// @return The bytes committed for its bitset
+size_t recamanMemory(const Recaman *sequence);
+
+/// Start the sequence again from 0, keeping the memory for its bitset
+/// @param sequence The sequence to reset
+void resetRecaman(Recaman *sequence);
+
+/// Free the memory used by the sequence
+/// @param sequence The sequence to free
+void freeRecaman(Recaman *sequence);
+
+#endif
@@ -0,0 +1,708 @@
+// This program times appending rings to the ring store circle_test draws from and walking them,
+// against the linked list it used to keep them in, without opening a window
+//
+// Usage: ring_bench [--list n] [--frames] [--recaman terms] [--verify] [count ...]
+// Each count is a number of rings to append and then walk, 1000000 by default
+// --list n sets how many rings the linked list is timed with (20000 by default), it walks to the
+// end of the list to append each ring so its time grows with the square of the count
+// --frames times a frame's worth of tessellation with each count of rings already on screen, both
+//   re-tessellating every ring like calling DrawRing on each does and only tessellating the new
+//   ring onto the cached mesh, counts default to 1000, 10000 and 100000,
+//   along with only tessellating the rings in view at the detail they need, at 1:1 and zoomed out
+//   until every ring is in view
+// --recaman generates that many terms of the Recamán sequence (10^8 by default), reporting terms/sec
+//   and peak memory, then streams the first count of them (10^6 by default) into a ring store as arcs
+// --verify checks the cached mesh matches tessellating every ring from scratch, the index finds
+//   exactly the rings in view, the level of detail is sensible and the Recamán sequence matches a
+//   simple version, instead of timing
+
+#include "ring_store.h"
+#include "ring_mesh.h"
+#include "ring_index.h"
+#include "recaman.h"
+#include "rd_engine.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+    #include <sys/resource.h>
+#endif
+
+#define DEFAULT_COUNT 1000000
+#define DEFAULT_LIST_COUNT 20000
+#define WALKS 10
+#define MIN_FRAME_TIME 0.5
+#define VERIFY_RINGS 5000
+#define VERIFY_VIEWS 200
+#define VIEW_SIZE 800.0f
+#define DEFAULT_RECAMAN_TERMS 100000000
+#define RECAMAN_BATCH 4096
+#define VERIFY_RECAMAN_TERMS 1000000
+
+// The linked list circle_test kept its rings in
+typedef struct node {
+    Ring ring;
+    struct node *next;
+} node_t;
+
+// The ring circle_test adds each frame, for the ith frame
+static Ring makeRing(size_t i)
+{
+    float radius = 12.0f;
+    return (Ring){ 1.0f + 25.0f * i + radius, 400.0f, radius, radius + 1, 90, 270, 100, { 0, 0, 0, 255 } };
+}
+
+// Reads every field drawing a ring would, so walking can't be optimised away
+static double sumRing(const Ring *ring)
+{
+    return ring->centreX + ring->centreY + ring->innerRadius + ring->outerRadius + ring->startAngle + ring->endAngle
+        + ring->segments + ring->colour[3];
+}
+
+static void benchList(size_t count)
+{
+    node_t *head = NULL;
+
+    double start = rdGetTime();
+    for (size_t i = 0; i < count; i++)
+    {
+        node_t *node = (node_t *) malloc(sizeof(node_t));
+        node->next = NULL;
+        node->ring = makeRing(i);
+
+        if (head == NULL)
+        {
+            head = node;
+            continue;
+        }
+
+        node_t *current = head;
+        while (current->next != NULL) current = current->next;
+        current->next = node;
+    }
+    double appendTime = rdGetTime() - start;
+
+    double sum = 0.0;
+    start = rdGetTime();
+    for (int walk = 0; walk < WALKS; walk++)
+    {
+        for (node_t *current = head; current != NULL; current = current->next) sum += sumRing(&current->ring);
+    }
+    double walkTime = (rdGetTime() - start) / WALKS;
+
+    printf("list  %9zu rings: append %10.2f ns/ring, walk %7.2f ns/ring (%g)\n",
+        count, appendTime / count * 1e9, walkTime / count * 1e9, sum);
+
+    while (head != NULL)
+    {
+        node_t *next = head->next;
+        free(head);
+        head = next;
+    }
+}
+
+static bool benchStore(size_t count)
+{
+    RingStore store;
+    if (!initialiseRingStore(&store, 0))
+    {
+        fprintf(stderr, "Couldn't reserve the ring store\n");
+        return false;
+    }
+
+    double start = rdGetTime();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!appendRing(&store, makeRing(i)))
+        {
+            fprintf(stderr, "Couldn't append ring %zu\n", i);
+            freeRingStore(&store);
+            return false;
+        }
+    }
+    double appendTime = rdGetTime() - start;
+
+    double sum = 0.0;
+    start = rdGetTime();
+    for (int walk = 0; walk < WALKS; walk++)
+    {
+        for (size_t i = 0; i < store.count; i++) sum += sumRing(&store.rings[i]);
+    }
+    double walkTime = (rdGetTime() - start) / WALKS;
+
+    // Appending again after a reset reuses the committed memory so shouldn't need to commit any more
+    resetRingStore(&store);
+    start = rdGetTime();
+    for (size_t i = 0; i < count; i++) appendRing(&store, makeRing(i));
+    double reuseTime = rdGetTime() - start;
+
+    printf("store %9zu rings: append %10.2f ns/ring, walk %7.2f ns/ring, append after reset %.2f ns/ring, "
+        "capacity %zu (%g)\n",
+        count, appendTime / count * 1e9, walkTime / count * 1e9, reuseTime / count * 1e9, ringCapacity(&store), sum);
+
+    freeRingStore(&store);
+    return true;
+}
+
+// Fills a store with count of the rings circle_test adds
+static bool fillStore(RingStore *store, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!appendRing(store, makeRing(i))) return false;
+    }
+
+    return true;
+}
+
+// What a culled frame tessellates the rings it can see into
+typedef struct {
+    RingMesh *mesh;
+    float zoom;
+} VisibleRings;
+
+static void addVisibleRing(const Ring *ring, void *context)
+{
+    VisibleRings *visible = (VisibleRings *) context;
+    appendRingMeshLod(visible->mesh, ring, visible->zoom);
+}
+
+// Times a frame that only tessellates the rings in an 800 pixel square view at a zoom, centred on
+// a point, returning the time per frame and how many rings were in view
+static double timeCulledFrames(const RingIndex *index, const RingStore *store, RingMesh *mesh, float centreX,
+    float centreY, float zoom, float *positions, unsigned char *colours, size_t *inView)
+{
+    VisibleRings visible = { mesh, zoom };
+    float halfView = 0.5f * VIEW_SIZE / zoom;
+    int frames = 0;
+    double start = rdGetTime();
+    double elapsed;
+
+    do
+    {
+        resetRingMesh(mesh);
+        *inView = queryRingIndex(index, store, centreX - halfView, centreY - halfView, centreX + halfView,
+            centreY + halfView, addVisibleRing, &visible);
+        memcpy(positions, ringMeshPositions(mesh), mesh->vertexCount * 3 * sizeof(float));
+        memcpy(colours, ringMeshColours(mesh), mesh->vertexCount * 4);
+        frames++;
+        elapsed = rdGetTime() - start;
+    } while (elapsed < MIN_FRAME_TIME);
+
+    return elapsed / frames;
+}
+
+// Times how long a frame's tessellation takes with count rings on screen
+static bool benchFrames(size_t count)
+{
+    RingStore store;
+    RingMesh mesh;
+    if (!initialiseRingStore(&store, 0) || !initialiseRingMesh(&mesh, 0))
+    {
+        fprintf(stderr, "Couldn't reserve the rings\n");
+        return false;
+    }
+
+    bool filled = fillStore(&store, count);
+    for (size_t i = 0; filled && i < store.count; i++) filled = appendRingMesh(&mesh, &store.rings[i]);
+
+    // Somewhere to tessellate every ring each frame like the batch DrawRing writes into
+    size_t scratchVertices = mesh.vertexCount + ringVertexCount(&store.rings[0]);
+    float *positions = (float *) malloc(scratchVertices * 3 * sizeof(float));
+    unsigned char *colours = (unsigned char *) malloc(scratchVertices * 4);
+
+    if (!filled || positions == NULL || colours == NULL)
+    {
+        fprintf(stderr, "Couldn't tessellate %zu rings\n", count);
+        free(positions);
+        free(colours);
+        freeRingMesh(&mesh);
+        freeRingStore(&store);
+        return false;
+    }
+
+    int frames = 0;
+    double start = rdGetTime();
+    double elapsed;
+    do
+    {
+        size_t written = 0;
+        for (size_t i = 0; i < store.count; i++)
+        {
+            written += tessellateRing(&store.rings[i], positions + written * 3, colours + written * 4);
+        }
+        frames++;
+        elapsed = rdGetTime() - start;
+    } while (elapsed < MIN_FRAME_TIME);
+    double immediateTime = elapsed / frames;
+
+    // Each cached frame adds a ring and copies its vertices out like uploading them to the GPU
+    size_t cachedFrames = 0;
+    start = rdGetTime();
+    do
+    {
+        Ring ring = makeRing(count + cachedFrames);
+        size_t from = mesh.vertexCount;
+        if (!appendRingMesh(&mesh, &ring)) break;
+
+        size_t added = mesh.vertexCount - from;
+        memcpy(positions, ringMeshPositions(&mesh) + from * 3, added * 3 * sizeof(float));
+        memcpy(colours, ringMeshColours(&mesh) + from * 4, added * 4);
+        cachedFrames++;
+        elapsed = rdGetTime() - start;
+    } while (elapsed < MIN_FRAME_TIME);
+    double cachedTime = elapsed / cachedFrames;
+
+    // Culled frames look at the end of the rings like circle_test's camera, and then zoom out
+    // until they're all in view and only a pixel or two across
+    RingIndex index;
+    RingMesh visibleMesh;
+    if (!initialiseRingIndex(&index, 0, 0) || !initialiseRingMesh(&visibleMesh, 0))
+    {
+        fprintf(stderr, "Couldn't reserve the index\n");
+        return false;
+    }
+
+    start = rdGetTime();
+    for (size_t i = 0; i < store.count; i++) indexNextRing(&index, &store);
+    double indexTime = (rdGetTime() - start) / store.count;
+
+    Ring last = store.rings[count - 1];
+    float width = last.centreX + last.outerRadius;
+    size_t inView, allInView;
+    double culledTime = timeCulledFrames(&index, &store, &visibleMesh, last.centreX - 0.5f * VIEW_SIZE, last.centreY,
+        1.0f, positions, colours, &inView);
+    double zoomedOutTime = timeCulledFrames(&index, &store, &visibleMesh, 0.5f * width, last.centreY,
+        VIEW_SIZE / width, positions, colours, &allInView);
+
+    printf("%9zu rings: re-tessellating every ring %10.1f us/frame, cached mesh %6.2f us/frame, "
+        "culled %6.2f us/frame (%zu in view), zoomed out %10.1f us/frame (%zu in view), indexing %.1f ns/ring\n",
+        count, immediateTime * 1e6, cachedTime * 1e6, culledTime * 1e6, inView, zoomedOutTime * 1e6, allInView,
+        indexTime * 1e9);
+
+    free(positions);
+    free(colours);
+    freeRingMesh(&visibleMesh);
+    freeRingIndex(&index);
+    freeRingMesh(&mesh);
+    freeRingStore(&store);
+    return true;
+}
+
+// Makes rings of every shape DrawRing has to fix up, not just the ones circle_test adds
+static Ring makeAwkwardRing(size_t i)
+{
+    // Kept near the origin so float positions are precise enough to check against the radii
+    Ring ring = makeRing(i % 64);
+
+    switch (i % 6)
+    {
+        case 1: ring.innerRadius = ring.outerRadius + 3; break;             // Radii the wrong way round
+        case 2: ring.innerRadius = 0; break;                                // A solid sector
+        case 3: ring.segments = 2; ring.endAngle = 359; break;              // Too few segments
+        case 4: ring.startAngle = 300; ring.endAngle = -45; break;          // Angles the wrong way round
+        case 5: ring.endAngle = ring.startAngle; break;                     // Nothing to draw
+    }
+
+    ring.colour[0] = (unsigned char) i;
+    return ring;
+}
+
+// Checks every vertex of a ring's triangles is on its inner or outer edge, or the centre of a sector
+static bool checkRingVertices(const Ring *ring, const float *positions, size_t count)
+{
+    float inner = fminf(ring->innerRadius, ring->outerRadius);
+    float outer = fmaxf(ring->innerRadius, ring->outerRadius);
+
+    for (size_t v = 0; v < count; v++)
+    {
+        float distance = hypotf(positions[v * 3] - ring->centreX, positions[v * 3 + 1] - ring->centreY);
+        bool onInner = inner <= 0.0f ? distance < 1e-3f : fabsf(distance - inner) < 1e-3f;
+        if (!onInner && fabsf(distance - outer) > 1e-3f) return false;
+        if (positions[v * 3 + 2] != 0.0f) return false;
+    }
+
+    return true;
+}
+
+// A small random number generator so the checks are the same on every machine
+static unsigned int verifySeed = 12345;
+
+static float randomFloat(float from, float to)
+{
+    verifySeed = verifySeed * 1103515245u + 12345u;
+    return from + (to - from) * (float) ((verifySeed >> 8) & 0xFFFFFF) / (float) 0xFFFFFF;
+}
+
+// Marks each ring a query visits
+typedef struct {
+    const RingStore *store;
+    unsigned char *found;
+} FoundRings;
+
+static void markFoundRing(const Ring *ring, void *context)
+{
+    FoundRings *found = (FoundRings *) context;
+    found->found[ring - found->store->rings]++;
+}
+
+// Checks the index finds exactly the rings whose bounding squares overlap random views, rings of
+// every size from a fraction of a cell to thousands of them
+static bool verifyIndex(void)
+{
+    RingStore store;
+    RingIndex index;
+    unsigned char *found = (unsigned char *) calloc(VERIFY_RINGS, 1);
+    if (found == NULL || !initialiseRingStore(&store, 0) || !initialiseRingIndex(&index, 0, 0))
+    {
+        fprintf(stderr, "Couldn't reserve the index\n");
+        free(found);
+        return false;
+    }
+
+    for (size_t i = 0; i < VERIFY_RINGS; i++)
+    {
+        float radius = expf(randomFloat(-2.0f, 9.0f));
+        Ring ring = { randomFloat(-20000, 20000), randomFloat(-20000, 20000), radius * 0.9f, radius, 0, 360, 100,
+            { 0, 0, 0, 255 } };
+        appendRing(&store, ring);
+        indexNextRing(&index, &store);
+    }
+
+    size_t bad = 0;
+    size_t totalFound = 0;
+    FoundRings context = { &store, found };
+    for (int v = 0; v < VERIFY_VIEWS; v++)
+    {
+        float size = expf(randomFloat(0.0f, 11.0f));
+        float minX = randomFloat(-25000, 25000), minY = randomFloat(-25000, 25000);
+        float maxX = minX + size, maxY = minY + size * randomFloat(0.25f, 4.0f);
+
+        memset(found, 0, VERIFY_RINGS);
+        size_t visited = queryRingIndex(&index, &store, minX, minY, maxX, maxY, markFoundRing, &context);
+        totalFound += visited;
+
+        for (size_t i = 0; i < VERIFY_RINGS; i++)
+        {
+            const Ring *ring = &store.rings[i];
+            float extent = fmaxf(ring->innerRadius, ring->outerRadius);
+            bool overlaps = ring->centreX + extent >= minX && ring->centreX - extent <= maxX
+                && ring->centreY + extent >= minY && ring->centreY - extent <= maxY;
+
+            if (found[i] != (overlaps ? 1 : 0)) bad++;
+        }
+    }
+
+    printf("%s index: %d views found %zu rings, %zu rings wrongly found or missed\n", bad == 0 ? "PASS" : "FAIL",
+        VERIFY_VIEWS, totalFound, bad);
+
+    free(found);
+    freeRingIndex(&index);
+    freeRingStore(&store);
+    return bad == 0;
+}
+
+// Checks rings drawn at a level of detail never get more segments than DrawRing would give them,
+// stay on their edges while they're big enough to curve, and collapse to lines when they're tiny
+static bool verifyLod(void)
+{
+    float positions[6 * 512 * 3];
+    unsigned char colours[6 * 512 * 4];
+    size_t bad = 0;
+    size_t lines = 0;
+    float scales[] = { 0.001f, 0.01f, 0.1f, 0.5f, 1.0f, 4.0f, 100.0f };
+    int numScales = (int) (sizeof(scales) / sizeof(scales[0]));
+
+    for (size_t i = 0; i < VERIFY_RINGS; i++)
+    {
+        Ring ring = makeAwkwardRing(i);
+
+        for (int s = 0; s < numScales; s++)
+        {
+            size_t count = ringLodVertexCount(&ring, scales[s]);
+            size_t written = tessellateRingLod(&ring, scales[s], positions, colours);
+            float sweep = fabsf(ring.endAngle - ring.startAngle) * 3.14159265f / 180.0f;
+            float screenRadius = fmaxf(ring.innerRadius, ring.outerRadius) * scales[s];
+            bool line = screenRadius * sweep < RING_LOD_LINE_LENGTH || screenRadius <= RING_LOD_ERROR;
+
+            // Lines thinner than a pixel are widened, and ones around a point become a filled sector
+            size_t maxLineVertices = 6 * (size_t) ceilf(sweep * 180.0f / 3.14159265f / 90);
+
+            if (written != count || count > ringVertexCount(&ring)) bad++;
+            else if (count > 0 && line && count > maxLineVertices) bad++;
+            else if (count > 0 && !line && !checkRingVertices(&ring, positions, count)) bad++;
+
+            if (count > 0 && line) lines++;
+        }
+    }
+
+    printf("%s level of detail: %d rings at %d scales, %zu drawn as lines, %zu wrong\n", bad == 0 ? "PASS" : "FAIL",
+        VERIFY_RINGS, numScales, lines, bad);
+    return bad == 0;
+}
+
+// The peak resident memory of the process in bytes, 0 where it can't be found
+static size_t peakMemory(void)
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+
+    #ifdef __APPLE__
+        return (size_t) usage.ru_maxrss;
+    #else
+        return (size_t) usage.ru_maxrss * 1024;
+    #endif
+#endif
+}
+
+static bool benchRecaman(size_t terms, size_t rings)
+{
+    Recaman sequence;
+    if (!initialiseRecaman(&sequence, 0))
+    {
+        fprintf(stderr, "Couldn't reserve the Recaman bitset\n");
+        return false;
+    }
+
+    // Generate in batches like streaming them into something, summing them so they're all used
+    uint64_t batch[RECAMAN_BATCH];
+    uint64_t sum = 0;
+    size_t generated = 0;
+    double start = rdGetTime();
+    while (generated < terms)
+    {
+        size_t count = terms - generated < RECAMAN_BATCH ? terms - generated : RECAMAN_BATCH;
+        size_t made = nextRecamanTerms(&sequence, batch, count);
+        for (size_t t = 0; t < made; t++) sum += batch[t];
+
+        generated += made;
+        if (made < count) break;
+    }
+    double elapsed = rdGetTime() - start;
+
+    printf("recaman %zu terms: %.1f million terms/sec, %.2f ns/term, largest term %llu, last term %llu, "
+        "bitset committed %.1f MB, peak resident %.1f MB (sum %llu)\n",
+        generated, generated / elapsed * 1e-6, elapsed / generated * 1e9, (unsigned long long) sequence.largest,
+        (unsigned long long) sequence.term, recamanMemory(&sequence) / 1048576.0, peakMemory() / 1048576.0,
+        (unsigned long long) sum);
+
+    if (rings > 0)
+    {
+        RingStore store;
+        if (!initialiseRingStore(&store, 0))
+        {
+            fprintf(stderr, "Couldn't reserve the ring store\n");
+            freeRecaman(&sequence);
+            return false;
+        }
+
+        resetRecaman(&sequence);
+        start = rdGetTime();
+        size_t appended = appendRecamanRings(&sequence, &store, rings, 1.0f, 1.0f, 0.0f);
+        elapsed = rdGetTime() - start;
+
+        printf("recaman %zu terms streamed into rings: %.1f million terms/sec, %.2f ns/term\n",
+            appended, appended / elapsed * 1e-6, elapsed / appended * 1e9);
+        freeRingStore(&store);
+    }
+
+    freeRecaman(&sequence);
+    return generated == terms;
+}
+
+// Checks the sequence against its first few published terms and a simple version that keeps a
+// byte per value, including across a reset
+static bool verifyRecaman(void)
+{
+    static const uint64_t firstTerms[] = { 1, 3, 6, 2, 7, 13, 20, 12, 21, 11, 22, 10, 23, 9, 24, 8, 25, 43, 62, 42 };
+    size_t numFirst = sizeof(firstTerms) / sizeof(firstTerms[0]);
+
+    Recaman sequence;
+    uint64_t *terms = (uint64_t *) malloc(VERIFY_RECAMAN_TERMS * sizeof(uint64_t));
+    size_t seenSize = 8 * (size_t) VERIFY_RECAMAN_TERMS;
+    unsigned char *seen = (unsigned char *) calloc(seenSize, 1);
+    if (terms == NULL || seen == NULL || !initialiseRecaman(&sequence, 0))
+    {
+        fprintf(stderr, "Couldn't allocate the Recaman check\n");
+        free(terms);
+        free(seen);
+        return false;
+    }
+
+    bool passed = true;
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        // Generate in uneven batches so the batch boundaries get checked too
+        size_t generated = 0;
+        size_t batch = 1;
+        while (generated < VERIFY_RECAMAN_TERMS)
+        {
+            size_t count = VERIFY_RECAMAN_TERMS - generated < batch ? VERIFY_RECAMAN_TERMS - generated : batch;
+            generated += nextRecamanTerms(&sequence, terms + generated, count);
+            batch = batch * 3 + 1;
+        }
+
+        size_t bad = 0;
+        for (size_t t = 0; t < numFirst; t++) bad += terms[t] != firstTerms[t];
+
+        memset(seen, 0, seenSize);
+        seen[0] = 1;
+        uint64_t term = 0;
+        for (uint64_t n = 1; n <= VERIFY_RECAMAN_TERMS; n++)
+        {
+            term = term > n && !seen[term - n] ? term - n : term + n;
+            if (term >= seenSize) break;
+
+            seen[term] = 1;
+            bad += terms[n - 1] != term;
+        }
+
+        printf("%s recaman pass %d: %d terms, %zu differ from the simple version\n", bad == 0 ? "PASS" : "FAIL",
+            pass + 1, VERIFY_RECAMAN_TERMS, bad);
+        passed = passed && bad == 0;
+        resetRecaman(&sequence);
+    }
+
+    free(terms);
+    free(seen);
+    freeRecaman(&sequence);
+    return passed;
+}
+
+static bool verify(void)
+{
+    RingStore store;
+    RingMesh mesh;
+    if (!initialiseRingStore(&store, 0) || !initialiseRingMesh(&mesh, 0))
+    {
+        fprintf(stderr, "Couldn't reserve the rings\n");
+        return false;
+    }
+
+    bool passed = true;
+
+    // Build the mesh twice, the second time after a reset to check the reused memory
+    for (int pass = 0; pass < 2 && passed; pass++)
+    {
+        resetRingStore(&store);
+        resetRingMesh(&mesh);
+        for (size_t i = 0; i < VERIFY_RINGS; i++)
+        {
+            Ring ring = makeAwkwardRing(i + pass);
+            passed = passed && appendRing(&store, ring) && appendRingMesh(&mesh, &ring);
+        }
+
+        if (!passed)
+        {
+            printf("FAIL couldn't build the mesh\n");
+            break;
+        }
+
+        // Tessellate each ring on its own and compare it with its part of the cached mesh
+        float positions[6 * 512 * 3];
+        unsigned char colours[6 * 512 * 4];
+        size_t offset = 0;
+        size_t bad = 0;
+        for (size_t i = 0; i < store.count; i++)
+        {
+            size_t count = ringVertexCount(&store.rings[i]);
+            size_t written = tessellateRing(&store.rings[i], positions, colours);
+
+            if (written != count || offset + count > mesh.vertexCount
+                || memcmp(positions, ringMeshPositions(&mesh) + offset * 3, count * 3 * sizeof(float)) != 0
+                || memcmp(colours, ringMeshColours(&mesh) + offset * 4, count * 4) != 0
+                || !checkRingVertices(&store.rings[i], positions, count))
+            {
+                bad++;
+            }
+
+            offset += count;
+        }
+
+        bool sizeMatches = offset == mesh.vertexCount;
+        printf("%s cached mesh pass %d: %zu rings, %zu vertices, %zu rings differ%s\n",
+            bad == 0 && sizeMatches ? "PASS" : "FAIL", pass + 1, store.count, mesh.vertexCount, bad,
+            sizeMatches ? "" : ", vertex count differs");
+        passed = bad == 0 && sizeMatches;
+    }
+
+    freeRingMesh(&mesh);
+    freeRingStore(&store);
+
+    bool indexPassed = verifyIndex();
+    bool lodPassed = verifyLod();
+    bool recamanPassed = verifyRecaman();
+    return passed && indexPassed && lodPassed && recamanPassed;
+}
+
+int main(int argc, char **argv)
+{
+    size_t listCount = DEFAULT_LIST_COUNT;
+    bool frames = false;
+    bool verifyMesh = false;
+    size_t recamanTerms = 0;
+    size_t counts[32];
+    int numCounts = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--list") == 0 && i + 1 < argc)
+        {
+            listCount = (size_t) strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--recaman") == 0)
+        {
+            recamanTerms = DEFAULT_RECAMAN_TERMS;
+            if (i + 1 < argc && argv[i + 1][0] != '-') recamanTerms = (size_t) strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--frames") == 0)
+        {
+            frames = true;
+        }
+        else if (strcmp(argv[i], "--verify") == 0)
+        {
+            verifyMesh = true;
+        }
+        else if (numCounts < 32)
+        {
+            counts[numCounts++] = (size_t) strtoull(argv[i], NULL, 10);
+        }
+    }
+
+    if (verifyMesh) return verify() ? 0 : 1;
+    if (recamanTerms > 0) return benchRecaman(recamanTerms, numCounts > 0 ? counts[0] : DEFAULT_COUNT) ? 0 : 1;
+
+    if (frames)
+    {
+        if (numCounts == 0)
+        {
+            counts[numCounts++] = 1000;
+            counts[numCounts++] = 10000;
+            counts[numCounts++] = 100000;
+        }
+
+        for (int c = 0; c < numCounts; c++)
+        {
+            if (counts[c] > 0 && !benchFrames(counts[c])) return 1;
+        }
+
+        return 0;
+    }
+
+    if (numCounts == 0) counts[numCounts++] = DEFAULT_COUNT;
+
+    if (listCount > 0) benchList(listCount);
+
+    for (int c = 0; c < numCounts; c++)
+    {
+        if (counts[c] > 0 && !benchStore(counts[c])) return 1;
+    }
+
+    return 0;
+}
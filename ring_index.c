@@ -0,0 +1,226 @@
+// A spatial index over a ring store, for finding the rings that overlap a view
+
+#include "ring_index.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define MIN_CELL_CAPACITY 1024
+
+// Cell coordinates are clamped to this so rings far from the origin can't overflow them
+#define MAX_CELL_COORDINATE (1 << 30)
+
+static float ringExtent(const Ring *ring)
+{
+    return fmaxf(fabsf(ring->innerRadius), fabsf(ring->outerRadius));
+}
+
+static int cellCoordinate(float position, float cellSize)
+{
+    float cell = floorf(position / cellSize);
+    if (!(cell > -MAX_CELL_COORDINATE)) return -MAX_CELL_COORDINATE;
+    if (cell > MAX_CELL_COORDINATE) return MAX_CELL_COORDINATE;
+    return (int) cell;
+}
+
+static size_t hashCell(int level, int x, int y)
+{
+    uint64_t hash = (uint64_t) (uint32_t) x * 0x9E3779B97F4A7C15ull;
+    hash ^= (uint64_t) (uint32_t) y * 0xC2B2AE3D27D4EB4Full;
+    hash ^= (uint64_t) level * 0x165667B19E3779F9ull;
+    return (size_t) (hash ^ (hash >> 29));
+}
+
+// Find a cell's slot in the hash table, which is either the cell or the empty slot it would go in
+static size_t findCell(const RingCell *cells, size_t capacity, int level, int x, int y)
+{
+    size_t slot = hashCell(level, x, y) & (capacity - 1);
+
+    while (cells[slot].level >= 0 && (cells[slot].level != level || cells[slot].x != x || cells[slot].y != y))
+    {
+        slot = (slot + 1) & (capacity - 1);
+    }
+
+    return slot;
+}
+
+static bool allocateCells(RingIndex *index, size_t capacity)
+{
+    RingCell *cells = (RingCell *) malloc(capacity * sizeof(RingCell));
+    if (cells == NULL) return false;
+
+    for (size_t c = 0; c < capacity; c++) cells[c].level = -1;
+
+    // Move the occupied cells over, their rings stay chained to them
+    for (size_t c = 0; c < index->cellCapacity; c++)
+    {
+        RingCell cell = index->cells[c];
+        if (cell.level >= 0) cells[findCell(cells, capacity, cell.level, cell.x, cell.y)] = cell;
+    }
+
+    free(index->cells);
+    index->cells = cells;
+    index->cellCapacity = capacity;
+    return true;
+}
+
+bool initialiseRingIndex(RingIndex *index, float cellSize, size_t maxRings)
+{
+    if (cellSize <= 0.0f) cellSize = RING_INDEX_DEFAULT_CELL_SIZE;
+    if (maxRings == 0) maxRings = RING_STORE_DEFAULT_MAX;
+
+    index->cellSize = cellSize;
+    index->cells = NULL;
+    index->cellCapacity = 0;
+    index->cellCount = 0;
+    index->count = 0;
+    for (int l = 0; l < RING_INDEX_LEVELS; l++) index->levelCells[l] = 0;
+
+    if (!initialiseArena(&index->next, maxRings * sizeof(uint32_t))) return false;
+    if (!allocateCells(index, MIN_CELL_CAPACITY))
+    {
+        freeArena(&index->next);
+        return false;
+    }
+
+    return true;
+}
+
+bool indexNextRing(RingIndex *index, const RingStore *store)
+{
+    if (index->count >= store->count || index->count >= RING_INDEX_NONE) return false;
+
+    // Keep the hash table at most half full so the probes stay short
+    if ((index->cellCount + 1) * 2 > index->cellCapacity && !allocateCells(index, index->cellCapacity * 2)) return false;
+
+    uint32_t *next = (uint32_t *) arenaPush(&index->next, sizeof(uint32_t));
+    if (next == NULL) return false;
+
+    // The smallest level whose cells are at least as wide as the ring's radius
+    uint32_t r = (uint32_t) index->count;
+    const Ring *ring = &store->rings[r];
+    float extent = ringExtent(ring);
+    int level = 0;
+    float cellSize = index->cellSize;
+    while (level < RING_INDEX_LEVELS - 1 && cellSize < extent)
+    {
+        level++;
+        cellSize *= 2;
+    }
+
+    int x = cellCoordinate(ring->centreX, cellSize);
+    int y = cellCoordinate(ring->centreY, cellSize);
+    size_t slot = findCell(index->cells, index->cellCapacity, level, x, y);
+    RingCell *cell = &index->cells[slot];
+
+    if (cell->level < 0)
+    {
+        *cell = (RingCell){ level, x, y, RING_INDEX_NONE };
+        index->cellCount++;
+        index->levelCells[level]++;
+    }
+
+    *next = cell->first;
+    cell->first = r;
+    index->count++;
+    return true;
+}
+
+// Visit the rings of a cell that overlap the rectangle
+static size_t visitCell(const RingIndex *index, const RingStore *store, const RingCell *cell, float minX, float minY,
+    float maxX, float maxY, RingVisitor visit, void *context)
+{
+    const uint32_t *next = (const uint32_t *) index->next.base;
+    size_t visited = 0;
+
+    for (uint32_t r = cell->first; r != RING_INDEX_NONE; r = next[r])
+    {
+        const Ring *ring = &store->rings[r];
+        float extent = ringExtent(ring);
+
+        if (ring->centreX + extent >= minX && ring->centreX - extent <= maxX
+            && ring->centreY + extent >= minY && ring->centreY - extent <= maxY)
+        {
+            visit(ring, context);
+            visited++;
+        }
+    }
+
+    return visited;
+}
+
+size_t queryRingIndex(const RingIndex *index, const RingStore *store, float minX, float minY, float maxX, float maxY,
+    RingVisitor visit, void *context)
+{
+    // The cells on each level any overlapping ring's centre could be in
+    int fromX[RING_INDEX_LEVELS], fromY[RING_INDEX_LEVELS], toX[RING_INDEX_LEVELS], toY[RING_INDEX_LEVELS];
+    bool scanLevel[RING_INDEX_LEVELS];
+    bool scanTable = false;
+    float cellSize = index->cellSize;
+
+    for (int l = 0; l < RING_INDEX_LEVELS; l++, cellSize *= 2)
+    {
+        fromX[l] = cellCoordinate(minX, cellSize) - 1;
+        fromY[l] = cellCoordinate(minY, cellSize) - 1;
+        toX[l] = cellCoordinate(maxX, cellSize) + 1;
+        toY[l] = cellCoordinate(maxY, cellSize) + 1;
+
+        // When there are fewer occupied cells than cells in the range, as when zoomed right out,
+        // it's quicker to go through the occupied ones than look up every cell in the range
+        double rangeCells = ((double) toX[l] - fromX[l] + 1) * ((double) toY[l] - fromY[l] + 1);
+        scanLevel[l] = index->levelCells[l] > 0 && rangeCells > (double) index->levelCells[l];
+        scanTable = scanTable || scanLevel[l];
+    }
+
+    size_t visited = 0;
+
+    if (scanTable)
+    {
+        for (size_t c = 0; c < index->cellCapacity; c++)
+        {
+            const RingCell *cell = &index->cells[c];
+            int l = cell->level;
+
+            if (l >= 0 && scanLevel[l] && cell->x >= fromX[l] && cell->x <= toX[l] && cell->y >= fromY[l]
+                && cell->y <= toY[l])
+            {
+                visited += visitCell(index, store, cell, minX, minY, maxX, maxY, visit, context);
+            }
+        }
+    }
+
+    for (int l = 0; l < RING_INDEX_LEVELS; l++)
+    {
+        if (index->levelCells[l] == 0 || scanLevel[l]) continue;
+
+        for (int y = fromY[l]; y <= toY[l]; y++)
+        {
+            for (int x = fromX[l]; x <= toX[l]; x++)
+            {
+                const RingCell *cell = &index->cells[findCell(index->cells, index->cellCapacity, l, x, y)];
+                if (cell->level >= 0) visited += visitCell(index, store, cell, minX, minY, maxX, maxY, visit, context);
+            }
+        }
+    }
+
+    return visited;
+}
+
+void resetRingIndex(RingIndex *index)
+{
+    for (size_t c = 0; c < index->cellCapacity; c++) index->cells[c].level = -1;
+    for (int l = 0; l < RING_INDEX_LEVELS; l++) index->levelCells[l] = 0;
+
+    resetArena(&index->next);
+    index->cellCount = 0;
+    index->count = 0;
+}
+
+void freeRingIndex(RingIndex *index)
+{
+    free(index->cells);
+    freeArena(&index->next);
+    index->cells = NULL;
+    index->cellCapacity = 0;
+    index->cellCount = 0;
+    index->count = 0;
+}
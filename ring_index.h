@@ -0,0 +1,81 @@
+// A spatial index over a ring store, for finding the rings that overlap a view
+//
+// Rings are sorted into levels by size, each level a grid whose cells are at least as wide as
+// the rings in it, and each ring is kept in the one cell of its level its centre falls in. Any
+// ring overlapping a rectangle then has its centre within one cell of it on its own level, so a
+// query only visits the cells around the rectangle on each level instead of every ring. Cells are
+// kept in a hash table so the rings can be spread over any area without a grid covering it all.
+
+#ifndef RING_INDEX_H
+#define RING_INDEX_H
+
+#include "arena.h"
+#include "ring_store.h"
+#include <stdint.h>
+
+/// The number of levels, each one's cells twice the width of the last
+#define RING_INDEX_LEVELS 24
+
+/// The default width of the smallest cells, in the same units as the rings
+#define RING_INDEX_DEFAULT_CELL_SIZE 16.0f
+
+/// Marks the end of a cell's list of rings
+#define RING_INDEX_NONE UINT32_MAX
+
+typedef struct {
+    int level;              // -1 for an empty slot in the hash table
+    int x;
+    int y;
+    uint32_t first;         // The first ring in the cell, the rest are chained through next
+} RingCell;
+
+typedef struct {
+    float cellSize;                             // The width of the cells of level 0
+    RingCell *cells;                            // Open addressed hash table of the occupied cells
+    size_t cellCapacity;                        // Always a power of two
+    size_t cellCount;
+    size_t levelCells[RING_INDEX_LEVELS];       // The number of occupied cells on each level
+    Arena next;                                 // The next ring in each ring's cell
+    size_t count;
+} RingIndex;
+
+/// Called for each ring a query finds
+/// @param ring The ring that overlaps the view
+/// @param context The context passed to the query
+typedef void (*RingVisitor)(const Ring *ring, void *context);
+
+/// Initialise an empty index
+/// @param index The index to initialise
+/// @param cellSize The width of the smallest cells, 0 uses RING_INDEX_DEFAULT_CELL_SIZE
+/// @param maxRings The most rings it can ever hold, 0 uses RING_STORE_DEFAULT_MAX
+/// @return False if the memory for it couldn't be reserved
+bool initialiseRingIndex(RingIndex *index, float cellSize, size_t maxRings);
+
+/// Add the next ring in a store to the index, rings have to be added in the order they're stored
+/// @param index The index to add to
+/// @param store The store the ring is in
+/// @return False if the index is full or out of memory
+bool indexNextRing(RingIndex *index, const RingStore *store);
+
+/// Visit every ring whose bounding square overlaps a rectangle
+/// @param index The index to search
+/// @param store The store the rings are in
+/// @param minX The left of the rectangle
+/// @param minY The top of the rectangle
+/// @param maxX The right of the rectangle
+/// @param maxY The bottom of the rectangle
+/// @param visit Called for each ring that overlaps, in no particular order
+/// @param context Passed to visit
+/// @return The number of rings visited
+size_t queryRingIndex(const RingIndex *index, const RingStore *store, float minX, float minY, float maxX, float maxY,
+    RingVisitor visit, void *context);
+
+/// Remove every ring, keeping the memory for the next ones
+/// @param index The index to empty
+void resetRingIndex(RingIndex *index);
+
+/// Free the memory used by the index
+/// @param index The index to free
+void freeRingIndex(RingIndex *index);
+
+#endif
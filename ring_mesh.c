@@ -0,0 +1,269 @@
+// The triangles of every ring circle_test draws, kept in one vertex stream that only grows
+
+#include "ring_mesh.h"
+#include <math.h>
+
+#define POSITION_SIZE (3 * sizeof(float))
+#define COLOUR_SIZE 4
+
+// How far a segment of an auto segmented ring can be from a true circle, the same as raylib's
+#define SMOOTH_CIRCLE_ERROR_RATE 0.5f
+
+#define DEG_TO_RAD (3.14159265358979323846f / 180.0f)
+
+// The shape DrawRing actually draws once it's fixed up the radii, angles and segments it's given
+typedef struct {
+    float innerRadius;
+    float outerRadius;
+    float startAngle;
+    float endAngle;
+    int segments;
+} RingShape;
+
+// Fix up a ring the same way DrawRing does, returning false if it has nothing to draw
+static bool ringShape(const Ring *ring, RingShape *shape)
+{
+    if (ring->startAngle == ring->endAngle) return false;
+
+    shape->innerRadius = fminf(ring->innerRadius, ring->outerRadius);
+    shape->outerRadius = fmaxf(ring->innerRadius, ring->outerRadius);
+    if (shape->outerRadius <= 0.0f) shape->outerRadius = 0.1f;
+
+    shape->startAngle = fminf(ring->startAngle, ring->endAngle);
+    shape->endAngle = fmaxf(ring->startAngle, ring->endAngle);
+
+    // Too few segments are replaced with enough to keep the outer edge smooth
+    float sweep = shape->endAngle - shape->startAngle;
+    int minSegments = (int) ceilf(sweep / 90);
+    shape->segments = ring->segments;
+    if (shape->segments < minSegments)
+    {
+        float th = acosf(2 * powf(1 - SMOOTH_CIRCLE_ERROR_RATE / shape->outerRadius, 2) - 1);
+        shape->segments = (int) (sweep * ceilf(2 * 3.14159265358979323846f / th) / 360);
+        if (shape->segments <= 0) shape->segments = minSegments;
+    }
+
+    return true;
+}
+
+static inline void writeVertex(float **positions, float x, float y)
+{
+    (*positions)[0] = x;
+    (*positions)[1] = y;
+    (*positions)[2] = 0.0f;
+    *positions += 3;
+}
+
+static size_t shapeVertexCount(const RingShape *shape)
+{
+    // A solid sector has one triangle per segment and a ring has two
+    return (shape->innerRadius <= 0.0f ? 3 : 6) * (size_t) shape->segments;
+}
+
+size_t ringVertexCount(const Ring *ring)
+{
+    RingShape shape;
+    if (!ringShape(ring, &shape)) return 0;
+
+    return shapeVertexCount(&shape);
+}
+
+// Tessellate a ring into the triangles of an already fixed up shape
+static size_t tessellateShape(const Ring *ring, const RingShape *shape, float *positions, unsigned char *colours)
+{
+    float x = ring->centreX;
+    float y = ring->centreY;
+    float inner = shape->innerRadius;
+    float outer = shape->outerRadius;
+    float stepLength = (shape->endAngle - shape->startAngle) / (float) shape->segments;
+    float angle = shape->startAngle;
+    float *start = positions;
+
+    // The same vertices in the same order as DrawRing and DrawCircleSector so the triangles face
+    // the same way, with the angle stepped the same way so they land in exactly the same places
+    for (int i = 0; i < shape->segments; i++)
+    {
+        float cosFrom = cosf(DEG_TO_RAD * angle), sinFrom = sinf(DEG_TO_RAD * angle);
+        float cosTo = cosf(DEG_TO_RAD * (angle + stepLength)), sinTo = sinf(DEG_TO_RAD * (angle + stepLength));
+
+        if (inner <= 0.0f)
+        {
+            writeVertex(&positions, x, y);
+            writeVertex(&positions, x + cosTo * outer, y + sinTo * outer);
+            writeVertex(&positions, x + cosFrom * outer, y + sinFrom * outer);
+        }
+        else
+        {
+            writeVertex(&positions, x + cosFrom * outer, y + sinFrom * outer);
+            writeVertex(&positions, x + cosFrom * inner, y + sinFrom * inner);
+            writeVertex(&positions, x + cosTo * inner, y + sinTo * inner);
+
+            writeVertex(&positions, x + cosTo * outer, y + sinTo * outer);
+            writeVertex(&positions, x + cosFrom * outer, y + sinFrom * outer);
+            writeVertex(&positions, x + cosTo * inner, y + sinTo * inner);
+        }
+
+        angle += stepLength;
+    }
+
+    size_t count = (size_t) (positions - start) / 3;
+    for (size_t v = 0; v < count; v++)
+    {
+        for (int c = 0; c < COLOUR_SIZE; c++) colours[v * COLOUR_SIZE + c] = ring->colour[c];
+    }
+
+    return count;
+}
+
+size_t tessellateRing(const Ring *ring, float *positions, unsigned char *colours)
+{
+    RingShape shape;
+    if (!ringShape(ring, &shape)) return 0;
+
+    return tessellateShape(ring, &shape, positions, colours);
+}
+
+// Fix up a ring for drawing at a scale, with just enough segments to look round on screen
+static bool ringLodShape(const Ring *ring, float scale, RingShape *shape)
+{
+    if (!ringShape(ring, shape)) return false;
+
+    float sweep = (shape->endAngle - shape->startAngle) * DEG_TO_RAD;
+    float screenRadius = shape->outerRadius * scale;
+    int minSegments = (int) ceilf((shape->endAngle - shape->startAngle) / 90);
+
+    // Arcs too short to see the curve of are drawn as straight lines at least a pixel wide, one
+    // per quarter turn so the ends of a half ring don't meet in a line with no width
+    if (screenRadius * sweep < RING_LOD_LINE_LENGTH || screenRadius <= RING_LOD_ERROR)
+    {
+        shape->segments = minSegments;
+
+        float halfWidth = 0.5f / scale;
+        if (shape->innerRadius > 0.0f && shape->outerRadius - shape->innerRadius < 2 * halfWidth)
+        {
+            float middle = 0.5f * (shape->innerRadius + shape->outerRadius);
+            shape->innerRadius = fmaxf(middle - halfWidth, 0.0f);
+            shape->outerRadius = middle + halfWidth;
+        }
+
+        return true;
+    }
+
+    // Each segment can turn by as much as keeps its middle within the error of the true circle,
+    // but never more segments than the ring asked for or fewer than DrawRing would use
+    float segmentAngle = 2 * acosf(1 - RING_LOD_ERROR / screenRadius);
+    int segments = (int) ceilf(sweep / segmentAngle);
+    if (segments < minSegments) segments = minSegments;
+    if (segments < shape->segments) shape->segments = segments;
+
+    return true;
+}
+
+size_t ringLodVertexCount(const Ring *ring, float scale)
+{
+    RingShape shape;
+    if (!ringLodShape(ring, scale, &shape)) return 0;
+
+    return shapeVertexCount(&shape);
+}
+
+size_t tessellateRingLod(const Ring *ring, float scale, float *positions, unsigned char *colours)
+{
+    RingShape shape;
+    if (!ringLodShape(ring, scale, &shape)) return 0;
+
+    return tessellateShape(ring, &shape, positions, colours);
+}
+
+bool initialiseRingMesh(RingMesh *mesh, size_t maxVertices)
+{
+    if (maxVertices == 0) maxVertices = RING_MESH_DEFAULT_MAX_VERTICES;
+
+    mesh->vertexCount = 0;
+    mesh->maxVertices = maxVertices;
+
+    if (!initialiseArena(&mesh->positions, maxVertices * POSITION_SIZE)) return false;
+    if (!initialiseArena(&mesh->colours, maxVertices * COLOUR_SIZE))
+    {
+        freeArena(&mesh->positions);
+        return false;
+    }
+
+    return true;
+}
+
+// Push room for count vertices onto both streams, leaving the mesh as it was if either is full
+static bool pushVertices(RingMesh *mesh, size_t count, float **positions, unsigned char **colours)
+{
+    if (count > mesh->maxVertices - mesh->vertexCount) return false;
+
+    *positions = (float *) arenaPush(&mesh->positions, count * POSITION_SIZE);
+    if (*positions == NULL) return false;
+
+    *colours = (unsigned char *) arenaPush(&mesh->colours, count * COLOUR_SIZE);
+    if (*colours == NULL)
+    {
+        mesh->positions.used -= count * POSITION_SIZE;
+        return false;
+    }
+
+    mesh->vertexCount += count;
+    return true;
+}
+
+bool appendRingMesh(RingMesh *mesh, const Ring *ring)
+{
+    size_t count = ringVertexCount(ring);
+    if (count == 0) return true;
+
+    float *positions;
+    unsigned char *colours;
+    if (!pushVertices(mesh, count, &positions, &colours)) return false;
+
+    tessellateRing(ring, positions, colours);
+    return true;
+}
+
+bool appendRingMeshLod(RingMesh *mesh, const Ring *ring, float scale)
+{
+    RingShape shape;
+    if (!ringLodShape(ring, scale, &shape)) return true;
+
+    float *positions;
+    unsigned char *colours;
+    if (!pushVertices(mesh, shapeVertexCount(&shape), &positions, &colours)) return false;
+
+    tessellateShape(ring, &shape, positions, colours);
+    return true;
+}
+
+bool reserveRingVertices(RingMesh *mesh, size_t vertices)
+{
+    return vertices <= mesh->maxVertices
+        && arenaCommit(&mesh->positions, vertices * POSITION_SIZE)
+        && arenaCommit(&mesh->colours, vertices * COLOUR_SIZE);
+}
+
+float *ringMeshPositions(const RingMesh *mesh)
+{
+    return (float *) mesh->positions.base;
+}
+
+unsigned char *ringMeshColours(const RingMesh *mesh)
+{
+    return mesh->colours.base;
+}
+
+void resetRingMesh(RingMesh *mesh)
+{
+    resetArena(&mesh->positions);
+    resetArena(&mesh->colours);
+    mesh->vertexCount = 0;
+}
+
+void freeRingMesh(RingMesh *mesh)
+{
+    freeArena(&mesh->positions);
+    freeArena(&mesh->colours);
+    mesh->vertexCount = 0;
+}
@@ -0,0 +1,105 @@
+// The triangles of every ring circle_test draws, kept in one vertex stream that only grows
+//
+// Each ring is tessellated once when it's added, into the same triangles raylib's DrawRing makes
+// every time it's called, and appended to the end of the stream. The stream is laid out the way
+// raylib's Mesh wants it so it can be uploaded to the GPU as it grows and drawn with one call, but
+// building it doesn't need raylib so it can be checked and timed without a GPU.
+//
+// Rings can also be tessellated at a level of detail, with only as many segments as they need at
+// the scale they're drawn at, for building a mesh of just the rings in view each frame.
+
+#ifndef RING_MESH_H
+#define RING_MESH_H
+
+#include "arena.h"
+#include "ring_store.h"
+
+/// The default most vertices a mesh can hold, only the address space is reserved up front
+#define RING_MESH_DEFAULT_MAX_VERTICES ((size_t) 1 << 27)
+
+/// How far, in pixels, the middle of a segment of a ring drawn at a level of detail can be from the true circle
+#define RING_LOD_ERROR 0.25f
+
+/// Arcs shorter than this many pixels on screen are drawn as straight lines, one per quarter turn
+#define RING_LOD_LINE_LENGTH 3.0f
+
+typedef struct {
+    Arena positions;        // Three floats per vertex, x, y and a z that's always 0
+    Arena colours;          // Four bytes per vertex, red, green, blue and alpha
+    size_t vertexCount;
+    size_t maxVertices;
+} RingMesh;
+
+/// Get the number of vertices a ring is tessellated into
+/// @param ring The ring to check
+/// @return The number of vertices, three for every triangle, 0 if there's nothing to draw
+size_t ringVertexCount(const Ring *ring);
+
+/// Tessellate a ring into the same triangles DrawRing draws
+/// @param ring The ring to tessellate
+/// @param positions Where to write three floats per vertex, room for ringVertexCount vertices
+/// @param colours Where to write four bytes per vertex, room for ringVertexCount vertices
+/// @return The number of vertices written
+size_t tessellateRing(const Ring *ring, float *positions, unsigned char *colours);
+
+/// Get the number of vertices a ring is tessellated into when it's drawn at a scale
+/// @param ring The ring to check
+/// @param scale The number of pixels per unit the ring is drawn at, e.g. the camera's zoom
+/// @return The number of vertices, 0 if there's nothing to draw
+size_t ringLodVertexCount(const Ring *ring, float scale);
+
+/// Tessellate a ring with only as many segments as it needs to look round at a scale, never more
+/// than DrawRing would use, or as straight lines at least a pixel wide if its arc is only a few
+/// pixels long
+/// @param ring The ring to tessellate
+/// @param scale The number of pixels per unit the ring is drawn at
+/// @param positions Where to write three floats per vertex, room for ringLodVertexCount vertices
+/// @param colours Where to write four bytes per vertex, room for ringLodVertexCount vertices
+/// @return The number of vertices written
+size_t tessellateRingLod(const Ring *ring, float scale, float *positions, unsigned char *colours);
+
+/// Initialise an empty mesh
+/// @param mesh The mesh to initialise
+/// @param maxVertices The most vertices it can ever hold, 0 uses RING_MESH_DEFAULT_MAX_VERTICES
+/// @return False if the address space for the vertices couldn't be reserved
+bool initialiseRingMesh(RingMesh *mesh, size_t maxVertices);
+
+/// Tessellate a ring onto the end of the mesh
+/// @param mesh The mesh to add to
+/// @param ring The ring to add
+/// @return False if the mesh is full or out of memory
+bool appendRingMesh(RingMesh *mesh, const Ring *ring);
+
+/// Tessellate a ring onto the end of the mesh at the detail it needs at a scale
+/// @param mesh The mesh to add to
+/// @param ring The ring to add
+/// @param scale The number of pixels per unit the ring is drawn at
+/// @return False if the mesh is full or out of memory
+bool appendRingMeshLod(RingMesh *mesh, const Ring *ring, float scale);
+
+/// Make sure the memory for a number of vertices is committed, so they can be read even past the
+/// end of the mesh, e.g. when uploading a GPU buffer with room to grow
+/// @param mesh The mesh to grow
+/// @param vertices The number of vertices that need to be committed
+/// @return False if there isn't room for that many
+bool reserveRingVertices(RingMesh *mesh, size_t vertices);
+
+/// Get the positions of every vertex
+/// @param mesh The mesh to read
+/// @return Three floats per vertex
+float *ringMeshPositions(const RingMesh *mesh);
+
+/// Get the colours of every vertex
+/// @param mesh The mesh to read
+/// @return Four bytes per vertex
+unsigned char *ringMeshColours(const RingMesh *mesh);
+
+/// Remove every vertex, keeping the memory for the next ones
+/// @param mesh The mesh to empty
+void resetRingMesh(RingMesh *mesh);
+
+/// Free the memory used by the mesh
+/// @param mesh The mesh to free
+void freeRingMesh(RingMesh *mesh);
+
+#endif
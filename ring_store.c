@@ -0,0 +1,48 @@
+// The rings drawn by circle_test, stored back to back in an arena
+
+#include "ring_store.h"
+
+bool initialiseRingStore(RingStore *store, size_t maxRings)
+{
+    if (maxRings == 0) maxRings = RING_STORE_DEFAULT_MAX;
+
+    store->count = 0;
+    if (!initialiseArena(&store->arena, maxRings * sizeof(Ring))) return false;
+
+    // Nothing else is pushed onto the arena, so the rings are one array from its start
+    store->rings = (Ring *) store->arena.base;
+    return true;
+}
+
+bool appendRing(RingStore *store, Ring ring)
+{
+    Ring *slot = (Ring *) arenaPush(&store->arena, sizeof(Ring));
+    if (slot == NULL) return false;
+
+    *slot = ring;
+    store->count++;
+    return true;
+}
+
+bool reserveRings(RingStore *store, size_t capacity)
+{
+    return arenaCommit(&store->arena, capacity * sizeof(Ring));
+}
+
+size_t ringCapacity(const RingStore *store)
+{
+    return store->arena.committed / sizeof(Ring);
+}
+
+void resetRingStore(RingStore *store)
+{
+    resetArena(&store->arena);
+    store->count = 0;
+}
+
+void freeRingStore(RingStore *store)
+{
+    freeArena(&store->arena);
+    store->rings = NULL;
+    store->count = 0;
+}
@@ -0,0 +1,65 @@
+// The rings drawn by circle_test, stored back to back in an arena
+//
+// Appending a ring writes it straight after the last one, which is amortised O(1) however many
+// rings there are, and drawing them walks one contiguous array instead of chasing list nodes
+// scattered around the heap. Rings never move once they're added. Nothing here needs raylib so
+// the store can be benchmarked headlessly.
+
+#ifndef RING_STORE_H
+#define RING_STORE_H
+
+#include "arena.h"
+
+/// The default most rings a store can hold, only the address space is reserved up front
+#define RING_STORE_DEFAULT_MAX ((size_t) 1 << 28)
+
+/// A ring or an arc of one, with the same fields raylib's DrawRing takes
+typedef struct {
+    float centreX;
+    float centreY;
+    float innerRadius;
+    float outerRadius;
+    float startAngle;
+    float endAngle;
+    int segments;
+    unsigned char colour[4];    // Red, green, blue and alpha
+} Ring;
+
+typedef struct {
+    Arena arena;
+    Ring *rings;        // The first ring, the rest follow it
+    size_t count;
+} RingStore;
+
+/// Initialise an empty store
+/// @param store The store to initialise
+/// @param maxRings The most rings it can ever hold, 0 uses RING_STORE_DEFAULT_MAX
+/// @return False if the address space for the rings couldn't be reserved
+bool initialiseRingStore(RingStore *store, size_t maxRings);
+
+/// Add a ring after the last one
+/// @param store The store to add to
+/// @param ring The ring to add
+/// @return False if the store is full or out of memory
+bool appendRing(RingStore *store, Ring ring);
+
+/// Make room for a number of rings up front so appending up to them can't fail
+/// @param store The store to grow
+/// @param capacity The number of rings to make room for
+/// @return False if there isn't room for that many
+bool reserveRings(RingStore *store, size_t capacity);
+
+/// Get the number of rings that can be added before more memory is needed
+/// @param store The store to check
+/// @return The number of rings the committed memory holds
+size_t ringCapacity(const RingStore *store);
+
+/// Remove every ring, keeping the memory for the next ones
+/// @param store The store to empty
+void resetRingStore(RingStore *store);
+
+/// Free the memory used by the store
+/// @param store The store to free
+void freeRingStore(RingStore *store);
+
+#endif
@@ -0,0 +1,59 @@
+// Pans and zooms a view onto a field with the mouse and draws frames coloured for it
+
+#include "view_controls.h"
+#include <math.h>
+
+// How much each notch of the mouse wheel zooms by
+#define ZOOM_STEP 1.1
+
+RDView fitView(int fieldWidth, int fieldHeight, int windowWidth, int windowHeight)
+{
+    double cellsPerPixel = fmax((double) fieldWidth / windowWidth, (double) fieldHeight / windowHeight);
+
+    return (RDView){
+        0.5 * (fieldWidth - windowWidth * cellsPerPixel), 0.5 * (fieldHeight - windowHeight * cellsPerPixel),
+        cellsPerPixel, windowWidth, windowHeight
+    };
+}
+
+void updateViewControls(RDView *view, int fieldWidth, int fieldHeight)
+{
+    // Raylib 3.5 has no mouse delta, so the drag is measured from where the mouse was last frame
+    static Vector2 lastMouse = { 0.0f, 0.0f };
+    Vector2 mouse = GetMousePosition();
+
+    if (IsMouseButtonDown(MOUSE_LEFT_BUTTON))
+    {
+        view->x -= (mouse.x - lastMouse.x) * view->cellsPerPixel;
+        view->y -= (mouse.y - lastMouse.y) * view->cellsPerPixel;
+    }
+    lastMouse = mouse;
+
+    // Zoom about the cell under the mouse so it stays put, out as far as twice the field's size
+    float wheel = GetMouseWheelMove();
+    if (wheel != 0.0f)
+    {
+        double maxCellsPerPixel = 2.0 * fmax((double) fieldWidth / view->width, (double) fieldHeight / view->height);
+        double cellsPerPixel = view->cellsPerPixel * pow(ZOOM_STEP, -wheel);
+        cellsPerPixel = fmin(fmax(cellsPerPixel, VIEW_MIN_CELLS_PER_PIXEL), maxCellsPerPixel);
+
+        view->x += mouse.x * (view->cellsPerPixel - cellsPerPixel);
+        view->y += mouse.y * (view->cellsPerPixel - cellsPerPixel);
+        view->cellsPerPixel = cellsPerPixel;
+    }
+
+    if (IsKeyPressed(KEY_R)) *view = fitView(fieldWidth, fieldHeight, view->width, view->height);
+}
+
+void drawViewFrame(Texture2D texture, const RDView *frameView, const RDView *view)
+{
+    // Where the frame's corner is in the current view, and how much bigger its pixels are
+    float scale = (float) (frameView->cellsPerPixel / view->cellsPerPixel);
+    Rectangle source = { 0.0f, 0.0f, (float) frameView->width, (float) frameView->height };
+    Rectangle destination = {
+        (float) ((frameView->x - view->x) / view->cellsPerPixel), (float) ((frameView->y - view->y) / view->cellsPerPixel),
+        frameView->width * scale, frameView->height * scale
+    };
+
+    DrawTexturePro(texture, source, destination, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
+}
@@ -0,0 +1,34 @@
+// Pans and zooms a view onto a field with the mouse and draws frames coloured for it
+
+#ifndef VIEW_CONTROLS_H
+#define VIEW_CONTROLS_H
+
+#include "raylib.h"
+#include "rd_view.h"
+
+/// The fewest cells across each pixel the view zooms in to, so a cell is at most 8 pixels across
+#define VIEW_MIN_CELLS_PER_PIXEL 0.125
+
+/// Get the view that fits the whole field in the window
+/// @param fieldWidth The width of the field in cells
+/// @param fieldHeight The height of the field in cells
+/// @param windowWidth The width of the window in pixels
+/// @param windowHeight The height of the window in pixels
+/// @return The view, centred on the field
+RDView fitView(int fieldWidth, int fieldHeight, int windowWidth, int windowHeight);
+
+/// Zoom the view about the mouse with the wheel, pan it by dragging with the left button and
+/// reset it to fit the field with R
+/// @param view The view to move
+/// @param fieldWidth The width of the field in cells
+/// @param fieldHeight The height of the field in cells
+void updateViewControls(RDView *view, int fieldWidth, int fieldHeight);
+
+/// Draw a frame coloured for one view where it belongs in another, so a frame coloured before the
+/// view last moved still lines up with the field
+/// @param texture The frame's pixels, the size of the window
+/// @param frameView The view the frame was coloured for
+/// @param view The view being shown
+void drawViewFrame(Texture2D texture, const RDView *frameView, const RDView *view);
+
+#endif